@@ -0,0 +1,196 @@
+/*
+ * bloom_filter.c
+ *
+ * This file provides the implementations of a BloomFilter, a blocked
+ * Bloom filter of 64-bit hash codes.
+ *
+ * The high half of the hash code selects the block, and the low half
+ * is multiplied by a different odd constant for each word of the block,
+ * whose top 6 bits select the bit to set in that word.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "bloom_filter.h"
+
+/**
+ * Bits of the filter per key it is sized for; a full filter passes
+ * about 0.5% of absent keys, and a filter at half its size about 5%
+ */
+#ifndef DEFAULT_BLOOM_BITS_PER_KEY
+#define DEFAULT_BLOOM_BITS_PER_KEY 16
+#endif
+
+/** Number of 64-bit words in a block of one cache line */
+#define BLOOM_BLOCK_WORDS 8
+
+/** Multipliers that select the bit in each word of a block */
+static const uint32_t bloomBlockSalts[BLOOM_BLOCK_WORDS] = {
+	0x47B6137BU, 0x44974D91U, 0x8824AD5BU, 0xA2B7289DU,
+	0x705495C7U, 0x2DF1424BU, 0x9EFC4947U, 0x5C6BFB31U
+};
+
+/**
+ * Allocates zeroed blocks for a number of keys.
+ *
+ * @param filter the BloomFilter
+ * @param keyCapacity the number of keys
+ */
+static void allocBloomFilterBlocks(BloomFilter* filter, int keyCapacity) {
+	long bits = (long)((keyCapacity > 0) ? keyCapacity : 1) * DEFAULT_BLOOM_BITS_PER_KEY;
+	int blockCount = 1;
+	while ((long)blockCount * BLOOM_BLOCK_WORDS * 64 < bits) {
+		blockCount *= 2;
+	}
+	size_t size = (size_t)blockCount * BLOOM_BLOCK_WORDS * sizeof(uint64_t);
+	filter->blocks = (uint64_t*)aligned_alloc(BLOOM_BLOCK_WORDS * sizeof(uint64_t), size);
+	assert(filter->blocks != (uint64_t*)NULL);
+	memset(filter->blocks, 0, size);
+	filter->blockCount = blockCount;
+	filter->keyCapacity = (int)((long)blockCount * BLOOM_BLOCK_WORDS * 64 / DEFAULT_BLOOM_BITS_PER_KEY);
+	filter->keyCount = 0;
+	filter->staleCount = 0;
+}
+
+/**
+ * Create a filter sized for a number of keys.
+ *
+ * @param keyCapacity the number of keys
+ * @return a new BloomFilter
+ */
+BloomFilter* createBloomFilter(int keyCapacity) {
+	BloomFilter* filter = (BloomFilter*)malloc(sizeof(BloomFilter));
+	allocBloomFilterBlocks(filter, keyCapacity);
+	memset(&filter->stats, 0, sizeof(BloomFilterStats));
+	return filter;
+}
+
+/**
+ * Frees a filter.
+ *
+ * @param filter the BloomFilter to free
+ */
+void freeBloomFilter(BloomFilter* filter) {
+	free(filter->blocks);
+	filter->blocks = (uint64_t*)NULL;
+	free(filter);
+}
+
+/**
+ * Removes all keys from the filter and resizes it for a number of keys.
+ * The statistics are not changed.
+ *
+ * @param filter the BloomFilter
+ * @param keyCapacity the number of keys
+ */
+void clearBloomFilter(BloomFilter* filter, int keyCapacity) {
+	free(filter->blocks);
+	allocBloomFilterBlocks(filter, keyCapacity);
+}
+
+/**
+ * Returns the block for a hash code.
+ *
+ * @param filter the BloomFilter
+ * @param code the hash code
+ * @return the first word of the block
+ */
+static inline uint64_t* getBloomFilterBlock(const BloomFilter* filter, uint64_t code) {
+	int block = (int)((code >> 32) & (uint64_t)(filter->blockCount - 1));
+	return &filter->blocks[block * BLOOM_BLOCK_WORDS];
+}
+
+/**
+ * Adds the hash code of a key to the filter.
+ *
+ * @param filter the BloomFilter
+ * @param code the mixed 64-bit hash code of the key
+ */
+void addBloomFilterCode(BloomFilter* filter, uint64_t code) {
+	uint64_t* block = getBloomFilterBlock(filter, code);
+	uint32_t low = (uint32_t)code;
+	for (int w = 0; w < BLOOM_BLOCK_WORDS; w++) {
+		block[w] |= 1ULL << ((low * bloomBlockSalts[w]) >> 26);
+	}
+	filter->keyCount++;
+}
+
+/**
+ * Determines whether a key with the hash code may have been added.
+ * The statistics are not changed, so several threads can test a filter
+ * that is not being changed.
+ *
+ * @param filter the BloomFilter
+ * @param code the mixed 64-bit hash code of the key
+ * @return false if the key was definitely not added
+ */
+bool mayContainBloomFilterCode(const BloomFilter* filter, uint64_t code) {
+	const uint64_t* block = getBloomFilterBlock(filter, code);
+	uint32_t low = (uint32_t)code;
+	// combine all eight words so the loop has no early exit to predict
+	uint64_t missing = 0;
+	for (int w = 0; w < BLOOM_BLOCK_WORDS; w++) {
+		missing |= ~block[w] & (1ULL << ((low * bloomBlockSalts[w]) >> 26));
+	}
+	return missing == 0;
+}
+
+/**
+ * Counts a lookup that tested the filter.
+ *
+ * @param filter the BloomFilter
+ * @param passed the result of the filter test
+ * @param found true if the key was found in the table
+ */
+void countBloomFilterQuery(BloomFilter* filter, bool passed, bool found) {
+	filter->stats.queries++;
+	if (!passed) {
+		filter->stats.negatives++;
+	} else if (!found) {
+		filter->stats.falsePositives++;
+	}
+}
+
+/**
+ * Counts a key removed by the owner. The bits of the key stay set.
+ *
+ * @param filter the BloomFilter
+ */
+void countBloomFilterRemoval(BloomFilter* filter) {
+	filter->staleCount++;
+}
+
+/**
+ * Determines whether the owner should rebuild the filter, because more
+ * keys were added than it is sized for, or because half of the added
+ * keys were removed.
+ *
+ * @param filter the BloomFilter
+ * @return true if the filter should be rebuilt
+ */
+bool isBloomFilterStale(const BloomFilter* filter) {
+	return filter->keyCount > filter->keyCapacity
+		|| (filter->staleCount > 64 && filter->staleCount * 2 > filter->keyCount);
+}
+
+/**
+ * Returns the statistics of the filter.
+ *
+ * @param filter the BloomFilter
+ * @param stats the BloomFilterStats to fill in
+ */
+void getBloomFilterStats(const BloomFilter* filter, BloomFilterStats* stats) {
+	*stats = filter->stats;
+}
+
+/**
+ * Returns the fraction of lookups of absent keys that the filter passed.
+ *
+ * @param filter the BloomFilter
+ * @return the false positive rate, or 0 if no absent keys were looked up
+ */
+double getBloomFilterFalsePositiveRate(const BloomFilter* filter) {
+	long absent = filter->stats.negatives + filter->stats.falsePositives;
+	return (absent > 0) ? filter->stats.falsePositives / (double)absent : 0.0;
+}
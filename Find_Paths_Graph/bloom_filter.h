@@ -0,0 +1,128 @@
+/*
+ * bloom_filter.h
+ *
+ * This file provides the structures and function declarations of a
+ * BloomFilter, an approximate membership filter that a HashMap or
+ * HashSet can keep alongside its table so that most lookups of absent
+ * keys are answered without probing the table.
+ *
+ * The filter is split into blocks of one cache line. A key sets one bit
+ * in each of the eight words of the block chosen by its hash code, so a
+ * test reads a single cache line. A filter reports no false negatives,
+ * but cannot remove keys; the owner counts removals and rebuilds the
+ * filter from its keys when too many of the set bits are stale.
+ */
+
+#ifndef BLOOM_FILTER_H_
+#define BLOOM_FILTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Statistics of the lookups answered with a filter
+ */
+typedef struct {
+	long queries;					// lookups that tested the filter
+	long negatives;					// lookups the filter answered as absent
+	long falsePositives;			// lookups the filter passed for absent keys
+} BloomFilterStats;
+
+/**
+ * A blocked Bloom filter of 64-bit hash codes.
+ */
+typedef struct {
+	uint64_t* blocks;				// blockCount blocks of 8 words, cache line aligned
+	int blockCount;					// number of blocks (power of 2)
+	int keyCapacity;				// number of keys the filter is sized for
+	int keyCount;					// keys added since the filter was cleared
+	int staleCount;					// keys removed by the owner since then
+	BloomFilterStats stats;			// the statistics
+} BloomFilter;
+
+/**
+ * Create a filter sized for a number of keys.
+ *
+ * @param keyCapacity the number of keys
+ * @return a new BloomFilter
+ */
+BloomFilter* createBloomFilter(int keyCapacity);
+
+/**
+ * Frees a filter.
+ *
+ * @param filter the BloomFilter to free
+ */
+void freeBloomFilter(BloomFilter* filter);
+
+/**
+ * Removes all keys from the filter and resizes it for a number of keys.
+ * The statistics are not changed.
+ *
+ * @param filter the BloomFilter
+ * @param keyCapacity the number of keys
+ */
+void clearBloomFilter(BloomFilter* filter, int keyCapacity);
+
+/**
+ * Adds the hash code of a key to the filter.
+ *
+ * @param filter the BloomFilter
+ * @param code the mixed 64-bit hash code of the key
+ */
+void addBloomFilterCode(BloomFilter* filter, uint64_t code);
+
+/**
+ * Determines whether a key with the hash code may have been added.
+ * The statistics are not changed, so several threads can test a filter
+ * that is not being changed.
+ *
+ * @param filter the BloomFilter
+ * @param code the mixed 64-bit hash code of the key
+ * @return false if the key was definitely not added
+ */
+bool mayContainBloomFilterCode(const BloomFilter* filter, uint64_t code);
+
+/**
+ * Counts a lookup that tested the filter.
+ *
+ * @param filter the BloomFilter
+ * @param passed the result of the filter test
+ * @param found true if the key was found in the table
+ */
+void countBloomFilterQuery(BloomFilter* filter, bool passed, bool found);
+
+/**
+ * Counts a key removed by the owner. The bits of the key stay set.
+ *
+ * @param filter the BloomFilter
+ */
+void countBloomFilterRemoval(BloomFilter* filter);
+
+/**
+ * Determines whether the owner should rebuild the filter, because more
+ * keys were added than it is sized for, or because half of the added
+ * keys were removed.
+ *
+ * @param filter the BloomFilter
+ * @return true if the filter should be rebuilt
+ */
+bool isBloomFilterStale(const BloomFilter* filter);
+
+/**
+ * Returns the statistics of the filter.
+ *
+ * @param filter the BloomFilter
+ * @param stats the BloomFilterStats to fill in
+ */
+void getBloomFilterStats(const BloomFilter* filter, BloomFilterStats* stats);
+
+/**
+ * Returns the fraction of lookups of absent keys that the filter passed.
+ *
+ * @param filter the BloomFilter
+ * @return the false positive rate, or 0 if no absent keys were looked up
+ */
+double getBloomFilterFalsePositiveRate(const BloomFilter* filter);
+
+#endif /* BLOOM_FILTER_H_ */
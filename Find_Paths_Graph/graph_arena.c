@@ -0,0 +1,185 @@
+/*
+ * graph_arena.c
+ *
+ * This file provides the implementations of a GraphArena, which
+ * allocates graph storage from large blocks that are all released
+ * together when the arena is freed.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <assert.h>
+#include "graph_arena.h"
+
+#ifndef DEFAULT_ARENA_BLOCK_SIZE
+#define DEFAULT_ARENA_BLOCK_SIZE (64*1024)
+#endif
+
+#ifndef ARENA_SLAB_SIZE
+#define ARENA_SLAB_SIZE 4096
+#endif
+
+/** largest size class that is a multiple of 8 bytes */
+#define SMALL_CLASS_LIMIT 256
+
+/** alignment of storage allocated from the arena */
+#define ARENA_ALIGNMENT _Alignof(max_align_t)
+
+/** size of block header rounded up to arena alignment */
+#define ARENA_HEADER_SIZE \
+	((sizeof(GraphArenaBlock) + ARENA_ALIGNMENT-1) & ~(ARENA_ALIGNMENT-1))
+
+/**
+ * Create a new arena block with the specified storage capacity.
+ *
+ * @param capacity the storage capacity of the block
+ * @return the new block
+ */
+static GraphArenaBlock* newGraphArenaBlock(size_t capacity) {
+	GraphArenaBlock* block = (GraphArenaBlock*)malloc(ARENA_HEADER_SIZE + capacity);
+	assert(block != (GraphArenaBlock*)NULL);
+	block->nextBlock = (GraphArenaBlock*)NULL;
+	block->capacity = capacity;
+	block->used = 0;
+	return block;
+}
+
+/**
+ * Create a new empty GraphArena.
+ *
+ * @param blockSize the storage size of each block, or 0 for default size
+ * @return a new GraphArena
+ */
+GraphArena* createGraphArena(size_t blockSize) {
+	GraphArena* arena = (GraphArena*)malloc(sizeof(GraphArena));
+	arena->blocks = (GraphArenaBlock*)NULL;
+	arena->blockSize = (blockSize == 0) ? DEFAULT_ARENA_BLOCK_SIZE : blockSize;
+	arena->allocated = 0;
+	for (int i = 0; i < GRAPH_ARENA_SIZE_CLASSES; i++) {
+		arena->freeLists[i] = (GraphArenaFreeEntry*)NULL;
+	}
+	return arena;
+}
+
+/**
+ * Frees a GraphArena and all storage allocated from it.
+ *
+ * @param arena the GraphArena to free
+ */
+void freeGraphArena(GraphArena* arena) {
+	GraphArenaBlock* block = arena->blocks;
+	while (block != (GraphArenaBlock*)NULL) {
+		GraphArenaBlock* nextBlock = block->nextBlock;
+		free(block);
+		block = nextBlock;
+	}
+	arena->blocks = (GraphArenaBlock*)NULL;
+	arena->allocated = 0;
+	free(arena);
+}
+
+/**
+ * Allocates storage from the arena. The storage is suitably aligned
+ * for any type, and remains valid until the arena is freed.
+ *
+ * @param arena the GraphArena
+ * @param size the number of bytes to allocate
+ * @return pointer to the allocated storage
+ */
+void* allocGraphArena(GraphArena* arena, size_t size) {
+	size = (size + ARENA_ALIGNMENT-1) & ~(ARENA_ALIGNMENT-1);
+	GraphArenaBlock* block = arena->blocks;
+	if (block == (GraphArenaBlock*)NULL || block->capacity - block->used < size) {
+		if (size > arena->blockSize/4 && block != (GraphArenaBlock*)NULL) {
+			// large allocation gets its own block after the current block
+			GraphArenaBlock* largeBlock = newGraphArenaBlock(size);
+			largeBlock->nextBlock = block->nextBlock;
+			block->nextBlock = largeBlock;
+			block = largeBlock;
+		} else {
+			// start a new current block
+			block = newGraphArenaBlock(size > arena->blockSize ? size : arena->blockSize);
+			block->nextBlock = arena->blocks;
+			arena->blocks = block;
+		}
+	}
+	void* storage = (char*)block + ARENA_HEADER_SIZE + block->used;
+	block->used += size;
+	arena->allocated += size;
+	return storage;
+}
+
+/**
+ * Get the pool size class for the requested size.
+ *
+ * @param size the number of bytes requested
+ * @param classSize set to the size of the size class in bytes
+ * @return the size class index
+ */
+static int getGraphArenaSizeClass(size_t size, size_t* classSize) {
+	if (size <= SMALL_CLASS_LIMIT) {
+		*classSize = (size < sizeof(GraphArenaFreeEntry))
+			? sizeof(GraphArenaFreeEntry) : (size + 7) & ~(size_t)7;
+		return (int)(*classSize / 8) - 1;
+	}
+	int sizeClass = SMALL_CLASS_LIMIT/8;
+	for (*classSize = 2*SMALL_CLASS_LIMIT; *classSize < size; *classSize *= 2) {
+		sizeClass++;
+	}
+	assert(sizeClass < GRAPH_ARENA_SIZE_CLASSES);
+	return sizeClass;
+}
+
+/**
+ * Allocates storage from the pool for the size class of the requested
+ * size. Small size classes are carved from the arena in slabs of many
+ * objects, so that objects allocated together are adjacent in memory.
+ *
+ * @param arena the GraphArena
+ * @param size the number of bytes to allocate
+ * @return pointer to the allocated storage
+ */
+void* allocGraphArenaPool(GraphArena* arena, size_t size) {
+	size_t classSize;
+	int sizeClass = getGraphArenaSizeClass(size, &classSize);
+	GraphArenaFreeEntry* entry = arena->freeLists[sizeClass];
+	if (entry != (GraphArenaFreeEntry*)NULL) {
+		arena->freeLists[sizeClass] = entry->nextEntry;
+		return entry;
+	}
+	if (classSize > SMALL_CLASS_LIMIT) {
+		return allocGraphArena(arena, classSize);
+	}
+
+	// carve a slab of objects and add all but the first to the free list
+	size_t count = ARENA_SLAB_SIZE / classSize;
+	char* slab = (char*)allocGraphArena(arena, count * classSize);
+	for (size_t i = count-1; i > 0; i--) {
+		GraphArenaFreeEntry* freeEntry = (GraphArenaFreeEntry*)(slab + i*classSize);
+		freeEntry->nextEntry = arena->freeLists[sizeClass];
+		arena->freeLists[sizeClass] = freeEntry;
+	}
+	return slab;
+}
+
+/**
+ * Releases storage to the pool for its size class so that it can be
+ * reused. Storage whose size is not exactly a size class is not pooled,
+ * and is reclaimed when the arena is freed.
+ *
+ * @param arena the GraphArena
+ * @param storage the storage to release
+ * @param size the size of the storage in bytes
+ */
+void releaseGraphArenaPool(GraphArena* arena, void* storage, size_t size) {
+	size_t classSize;
+	if (size < sizeof(GraphArenaFreeEntry) || storage == NULL) {
+		return;
+	}
+	int sizeClass = getGraphArenaSizeClass(size, &classSize);
+	if (classSize == size) {
+		GraphArenaFreeEntry* entry = (GraphArenaFreeEntry*)storage;
+		entry->nextEntry = arena->freeLists[sizeClass];
+		arena->freeLists[sizeClass] = entry;
+	}
+}
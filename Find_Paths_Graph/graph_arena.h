@@ -0,0 +1,94 @@
+/*
+ * graph_arena.h
+ *
+ * This file provides the structures and function declarations of a
+ * GraphArena, which allocates graph storage from large blocks that
+ * are all released together when the arena is freed. Storage that is
+ * released before then is kept in size-classed pools for reuse.
+ */
+
+#ifndef GRAPH_ARENA_H_
+#define GRAPH_ARENA_H_
+
+#include <stdlib.h>
+
+/**
+ * A block of arena storage. Storage follows the block header.
+ */
+typedef struct _GraphArenaBlock {
+	struct _GraphArenaBlock* nextBlock;	// next block in the arena
+	size_t capacity;					// bytes of storage in the block
+	size_t used;						// bytes of storage allocated
+} GraphArenaBlock;
+
+/**
+ * Number of pool size classes: multiples of 8 bytes up to 256 bytes,
+ * then powers of two up to 2^30 bytes.
+ */
+#define GRAPH_ARENA_SIZE_CLASSES (32 + 22)
+
+/**
+ * An entry in the free list of a pool size class.
+ */
+typedef struct _GraphArenaFreeEntry {
+	struct _GraphArenaFreeEntry* nextEntry;	// next free storage in class
+} GraphArenaFreeEntry;
+
+/**
+ * The graph arena
+ */
+typedef struct _GraphArena {
+	GraphArenaBlock* blocks;			// list of blocks; head is current block
+	size_t blockSize;					// storage size of a new block
+	size_t allocated;					// total bytes allocated from arena
+	GraphArenaFreeEntry* freeLists[GRAPH_ARENA_SIZE_CLASSES];  // pools by size class
+} GraphArena;
+
+/**
+ * Create a new empty GraphArena.
+ *
+ * @param blockSize the storage size of each block, or 0 for default size
+ * @return a new GraphArena
+ */
+GraphArena* createGraphArena(size_t blockSize);
+
+/**
+ * Frees a GraphArena and all storage allocated from it.
+ *
+ * @param arena the GraphArena to free
+ */
+void freeGraphArena(GraphArena* arena);
+
+/**
+ * Allocates storage from the arena. The storage is suitably aligned
+ * for any type, and remains valid until the arena is freed.
+ *
+ * @param arena the GraphArena
+ * @param size the number of bytes to allocate
+ * @return pointer to the allocated storage
+ */
+void* allocGraphArena(GraphArena* arena, size_t size);
+
+/**
+ * Allocates storage from the pool for the size class of the requested
+ * size. Small size classes are carved from the arena in slabs of many
+ * objects, so that objects allocated together are adjacent in memory.
+ *
+ * @param arena the GraphArena
+ * @param size the number of bytes to allocate
+ * @return pointer to the allocated storage
+ */
+void* allocGraphArenaPool(GraphArena* arena, size_t size);
+
+/**
+ * Releases storage to the pool for its size class so that it can be
+ * reused. Storage whose size is not exactly a size class is not pooled,
+ * and is reclaimed when the arena is freed.
+ *
+ * @param arena the GraphArena
+ * @param storage the storage to release
+ * @param size the size of the storage in bytes
+ */
+void releaseGraphArenaPool(GraphArena* arena, void* storage, size_t size);
+
+#endif /* GRAPH_ARENA_H_ */
@@ -8,15 +8,26 @@
  */
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdbool.h>
 #include <strings.h>
 #include "graph_node_vertex_impl.h"
+#include "node_graph.h"
+#include "graph_arena.h"
 
 #ifndef INITIAL_EDGE_CAPACITY
 #define INITIAL_EDGE_CAPACITY 4
 #endif
 
+// edge count above which a node vertex maintains a hash index of its edges
+#ifndef EDGE_INDEX_THRESHOLD
+#define EDGE_INDEX_THRESHOLD 16
+#endif
+
+/** value of an empty edge index slot */
+#define EDGE_INDEX_EMPTY -1
+
 /**
  * Compare the data for two graph nodes.
  *
@@ -35,13 +46,269 @@ int compareGraphVertexData(GraphVertexData data1, GraphVertexData data2)
  *
  * @param node the graph node vertex
  * @param data the graph data
+ * @param edgeTo the initial edge array storage
  */
-static void initGraphNodeVertex(GraphNodeVertex* node, GraphVertexData data) {
+static void initGraphNodeVertex(
+		GraphNodeVertex* node, GraphVertexData data, GraphNodeEdge* edgeTo) {
 	node->data = data;
 	node->edgeCount = 0;
 	node->edgeCapacity = INITIAL_EDGE_CAPACITY;
-	node->edgeTo =
-		(GraphNodeEdge*)malloc(INITIAL_EDGE_CAPACITY * sizeof(GraphNodeEdge));
+	node->index = -1;
+	node->graph = (struct _NodeGraph*)NULL;
+	node->edgeTo = edgeTo;
+	node->edgeIndex = (int*)NULL;
+	node->edgeIndexCapacity = 0;
+}
+
+/**
+ * Determines whether the storage for the node vertex and its edges
+ * is allocated from the arena of the graph that owns it.
+ *
+ * @param node the graph node vertex
+ * @return true if storage is allocated from a graph arena
+ */
+static bool isGraphNodeVertexInArena(GraphNodeVertex* node) {
+	return node->graph != (struct _NodeGraph*)NULL
+		&& node->graph->arena != (GraphArena*)NULL;
+}
+
+/**
+ * Records a change to the edges of a graph node vertex in the version
+ * of the graph that owns it.
+ *
+ * @param node the graph node vertex
+ */
+static void markGraphNodeVertexChanged(GraphNodeVertex* node) {
+	if (node->graph != (struct _NodeGraph*)NULL) {
+		node->graph->version++;
+	}
+}
+
+/**
+ * Grow the edge array of the graph node vertex to the new capacity.
+ * Edge arrays in a graph arena are moved to storage from the arena pool.
+ *
+ * @param node the graph node vertex
+ * @param newCapacity the new capacity of the edge array
+ */
+static void growGraphNodeEdges(GraphNodeVertex* node, int newCapacity) {
+	if (isGraphNodeVertexInArena(node)) {
+		GraphArena* arena = node->graph->arena;
+		GraphNodeEdge* edgeTo = (GraphNodeEdge*)allocGraphArenaPool(
+			arena, newCapacity * sizeof(GraphNodeEdge));
+		memcpy(edgeTo, node->edgeTo, node->edgeCount * sizeof(GraphNodeEdge));
+		releaseGraphArenaPool(arena, node->edgeTo, node->edgeCapacity * sizeof(GraphNodeEdge));
+		node->edgeTo = edgeTo;
+	} else {
+		node->edgeTo =
+			(GraphNodeEdge*)realloc(node->edgeTo, newCapacity * sizeof(GraphNodeEdge));
+	}
+	node->edgeCapacity = newCapacity;
+}
+
+/**
+ * Get the home slot in an edge index for an edge to the vertex.
+ *
+ * @param vertex the vertex the edge points to
+ * @param capacity the capacity of the edge index (power of 2)
+ * @return the home slot for the vertex
+ */
+static int getEdgeIndexSlot(GraphNodeVertex* vertex, int capacity) {
+	uint64_t hash = (uint64_t)(uintptr_t)vertex * 0x9E3779B97F4A7C15ull;
+	return (int)(hash >> 32) & (capacity-1);
+}
+
+/**
+ * Free the edge index of the graph node vertex.
+ *
+ * @param node the graph node vertex
+ */
+static void freeGraphNodeEdgeIndex(GraphNodeVertex* node) {
+	if (node->edgeIndex == (int*)NULL) {
+		return;
+	}
+	if (isGraphNodeVertexInArena(node)) {
+		releaseGraphArenaPool(node->graph->arena, node->edgeIndex,
+							  node->edgeIndexCapacity * sizeof(int));
+	} else {
+		free(node->edgeIndex);
+	}
+	node->edgeIndex = (int*)NULL;
+	node->edgeIndexCapacity = 0;
+}
+
+/**
+ * Insert the position of an edge in the edge array into the edge index.
+ *
+ * @param node the graph node vertex
+ * @param pos the position of the edge in the edge array
+ */
+static void insertGraphNodeEdgeIndex(GraphNodeVertex* node, int pos) {
+	int mask = node->edgeIndexCapacity-1;
+	int slot = getEdgeIndexSlot(node->edgeTo[pos].vertex, node->edgeIndexCapacity);
+	while (node->edgeIndex[slot] != EDGE_INDEX_EMPTY) {
+		slot = (slot+1) & mask;
+	}
+	node->edgeIndex[slot] = pos;
+}
+
+/**
+ * Build an edge index with the specified capacity for the edges in
+ * the edge array of the graph node vertex.
+ *
+ * @param node the graph node vertex
+ * @param capacity the capacity of the edge index (power of 2)
+ */
+static void buildGraphNodeEdgeIndex(GraphNodeVertex* node, int capacity) {
+	freeGraphNodeEdgeIndex(node);
+	node->edgeIndex = isGraphNodeVertexInArena(node)
+		? (int*)allocGraphArenaPool(node->graph->arena, capacity * sizeof(int))
+		: (int*)malloc(capacity * sizeof(int));
+	node->edgeIndexCapacity = capacity;
+	for (int i = 0; i < capacity; i++) {
+		node->edgeIndex[i] = EDGE_INDEX_EMPTY;
+	}
+	for (int pos = 0; pos < node->edgeCount; pos++) {
+		insertGraphNodeEdgeIndex(node, pos);
+	}
+}
+
+/**
+ * Rebuild the edge index of a graph node vertex after its edge array
+ * or the storage of the vertices it has edges to has been changed.
+ * The vertex must not currently have an edge index.
+ *
+ * @param node the node vertex
+ */
+void rebuildGraphNodeEdgeIndex(GraphNodeVertex* node) {
+	node->edgeIndex = (int*)NULL;
+	node->edgeIndexCapacity = 0;
+	if (node->edgeCount > EDGE_INDEX_THRESHOLD) {
+		int capacity = 2*EDGE_INDEX_THRESHOLD;
+		while (capacity < 2*node->edgeCount) {
+			capacity *= 2;
+		}
+		buildGraphNodeEdgeIndex(node, capacity);
+	}
+}
+
+/**
+ * Find the slot in the edge index for the edge to the specified vertex.
+ *
+ * @param node the graph node vertex with an edge index
+ * @param toNode the other node vertex
+ * @return the edge index slot, or -1 if there is no edge to toNode
+ */
+static int findGraphNodeEdgeIndexSlot(GraphNodeVertex* node, GraphNodeVertex* toNode) {
+	int mask = node->edgeIndexCapacity-1;
+	int slot = getEdgeIndexSlot(toNode, node->edgeIndexCapacity);
+	for ( ; node->edgeIndex[slot] != EDGE_INDEX_EMPTY; slot = (slot+1) & mask) {
+		if (node->edgeTo[node->edgeIndex[slot]].vertex == toNode) {
+			return slot;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Remove the entry in an edge index slot, shifting back later entries
+ * of its probe sequence so that no tombstones are needed.
+ *
+ * @param node the graph node vertex with an edge index
+ * @param slot the slot to remove
+ */
+static void removeGraphNodeEdgeIndexSlot(GraphNodeVertex* node, int slot) {
+	int mask = node->edgeIndexCapacity-1;
+	int next = (slot+1) & mask;
+	for ( ; node->edgeIndex[next] != EDGE_INDEX_EMPTY; next = (next+1) & mask) {
+		// move entry back if the empty slot is between its home and its slot
+		int home = getEdgeIndexSlot(
+			node->edgeTo[node->edgeIndex[next]].vertex, node->edgeIndexCapacity);
+		if (((next - home) & mask) >= ((next - slot) & mask)) {
+			node->edgeIndex[slot] = node->edgeIndex[next];
+			slot = next;
+		}
+	}
+	node->edgeIndex[slot] = EDGE_INDEX_EMPTY;
+}
+
+/**
+ * Compares the addresses of two vertices for bsearch.
+ *
+ * @param v1 pointer to the first GraphNodeVertex*
+ * @param v2 pointer to the second GraphNodeVertex*
+ * @return <0 if v1<v2, =0 if v1=v2, >0 if v1>v2
+ */
+static int compareGraphNodeVertexAddress(const void* v1, const void* v2) {
+	GraphNodeVertex* vertex1 = *(GraphNodeVertex* const*)v1;
+	GraphNodeVertex* vertex2 = *(GraphNodeVertex* const*)v2;
+	return (vertex1 < vertex2) ? -1 : (vertex1 > vertex2);
+}
+
+/**
+ * Applies a set of edge changes to a graph node vertex in one pass.
+ * Edges to the vertices in removeVertices are removed, keeping the
+ * order of the remaining edges, then the new edges are appended. The
+ * edge array is reallocated at most once, and the edge index is
+ * rebuilt once for the final edges.
+ *
+ * @param node the node vertex
+ * @param removeVertices the vertices of edges to remove, sorted by address
+ * @param removeCount the number of vertices of edges to remove
+ * @param addEdges the new edges to append; must not already exist
+ * @param addCount the number of new edges
+ */
+void applyGraphNodeEdgeChanges(GraphNodeVertex* node,
+		GraphNodeVertex** removeVertices, int removeCount,
+		GraphNodeEdge* addEdges, int addCount) {
+	// positions change, so the index is rebuilt at the end
+	freeGraphNodeEdgeIndex(node);
+
+	if (removeCount > 0) {
+		int count = 0;
+		for (int i = 0; i < node->edgeCount; i++) {
+			if (bsearch(&node->edgeTo[i].vertex, removeVertices, removeCount,
+						sizeof(GraphNodeVertex*), compareGraphNodeVertexAddress) == NULL) {
+				node->edgeTo[count++] = node->edgeTo[i];
+			}
+		}
+		node->edgeCount = count;
+	}
+
+	if (node->edgeCount + addCount > node->edgeCapacity) {
+		int newCapacity = (node->edgeCapacity == 0) ? INITIAL_EDGE_CAPACITY : node->edgeCapacity;
+		while (newCapacity < node->edgeCount + addCount) {
+			newCapacity *= 2;
+		}
+		growGraphNodeEdges(node, newCapacity);
+	}
+	memcpy(&node->edgeTo[node->edgeCount], addEdges, addCount * sizeof(GraphNodeEdge));
+	node->edgeCount += addCount;
+
+	rebuildGraphNodeEdgeIndex(node);
+	markGraphNodeVertexChanged(node);
+}
+
+/**
+ * Find the position of the edge to the specified vertex in the edge
+ * array. Low degree vertices scan the edge array; high degree vertices
+ * look up the position in the edge index.
+ *
+ * @param node the graph node vertex
+ * @param toNode the other node vertex
+ * @return the position in the edge array, or -1 if not found
+ */
+static int findGraphNodeEdge(GraphNodeVertex* node, GraphNodeVertex* toNode) {
+	if (node->edgeIndex != (int*)NULL) {
+		int slot = findGraphNodeEdgeIndexSlot(node, toNode);
+		return (slot < 0) ? -1 : node->edgeIndex[slot];
+	}
+	for (int i = 0; i < node->edgeCount; i++) {
+		if (node->edgeTo[i].vertex == toNode) {
+			return i;
+		}
+	}
+	return -1;
 }
 
 /**
@@ -52,7 +319,24 @@ static void initGraphNodeVertex(GraphNodeVertex* node, GraphVertexData data) {
  */
 GraphNodeVertex* newGraphNodeVertex(GraphVertexData data) {
 	GraphNodeVertex* node = (GraphNodeVertex*)malloc(sizeof(GraphNodeVertex));
-	initGraphNodeVertex(node, data);
+	initGraphNodeVertex(node, data,
+		(GraphNodeEdge*)malloc(INITIAL_EDGE_CAPACITY * sizeof(GraphNodeEdge)));
+	return node;
+}
+
+/**
+ * Create a new GraphNodeVertex with specified data whose storage and
+ * edge storage is allocated from the arena.
+ *
+ * @param arena the arena for the node vertex storage
+ * @param data the value of the data field
+ * @return a new GraphNode
+ */
+GraphNodeVertex* newGraphNodeVertexInArena(GraphArena* arena, GraphVertexData data) {
+	GraphNodeVertex* node =
+		(GraphNodeVertex*)allocGraphArenaPool(arena, sizeof(GraphNodeVertex));
+	initGraphNodeVertex(node, data, (GraphNodeEdge*)allocGraphArenaPool(
+		arena, INITIAL_EDGE_CAPACITY * sizeof(GraphNodeEdge)));
 	return node;
 }
 
@@ -65,6 +349,15 @@ GraphNodeVertex* newGraphNodeVertex(GraphVertexData data) {
 void deleteGraphNodeVertex(GraphNodeVertex* node) {
 	// remove edges
 	clearGraphNodeEdges(node);
+	freeGraphNodeEdgeIndex(node);
+	if (isGraphNodeVertexInArena(node)) {
+		// return storage to the arena pools for reuse
+		GraphArena* arena = node->graph->arena;
+		releaseGraphArenaPool(arena, node->edgeTo, node->edgeCapacity * sizeof(GraphNodeEdge));
+		node->edgeTo = (GraphNodeEdge*)NULL;
+		releaseGraphArenaPool(arena, node, sizeof(GraphNodeVertex));
+		return;
+	}
 	free(node->edgeTo);
 	node->edgeTo = (GraphNodeEdge*)NULL;
 
@@ -76,7 +369,11 @@ void deleteGraphNodeVertex(GraphNodeVertex* node) {
  * edges from the vertices connected by this node vertex.
  */
 void clearGraphNodeEdges(GraphNodeVertex* node) {
+	if (node->edgeCount > 0) {
+		markGraphNodeVertexChanged(node);
+	}
 	node->edgeCount = 0;
+	freeGraphNodeEdgeIndex(node);
 }
 
 /**
@@ -88,7 +385,7 @@ void clearGraphNodeBidirectionalEdges(GraphNodeVertex* node) {
 	for (int i = 0; i < node->edgeCount; i++) {
 		removeEdgeToGraphNodeVertex(node->edgeTo[i].vertex, node);
 	}
-	node->edgeCount = 0;
+	clearGraphNodeEdges(node);
 }
 
 /**
@@ -150,12 +447,7 @@ bool isGraphNodeVertexBidirectionalRoot(GraphNodeVertex* node) {
  * @return true if graph has edge to other node vertex, false otherwise
  */
 bool hasEdgeToGraphNodeVertex(GraphNodeVertex *node, GraphNodeVertex* toNode) {
-	for (int i = 0; i < node->edgeCount; i++) {
-		if (node->edgeTo[i].vertex == toNode) {
-			return true;
-		}
-	}
-	return false;
+	return findGraphNodeEdge(node, toNode) >= 0;
 }
 
 /**
@@ -166,12 +458,8 @@ bool hasEdgeToGraphNodeVertex(GraphNodeVertex *node, GraphNodeVertex* toNode) {
  * @return the edge between the two node vertices
  */
 GraphNodeEdge* getEdgeToGraphNodeVertex(GraphNodeVertex *node, GraphNodeVertex* toNode) {
-	for (int i = 0; i < node->edgeCount; i++) {
-		if (node->edgeTo[i].vertex == toNode) {
-			return &(node->edgeTo[i]);
-		}
-	}
-	return (GraphNodeEdge*)NULL;
+	int pos = findGraphNodeEdge(node, toNode);
+	return (pos < 0) ? (GraphNodeEdge*)NULL : &(node->edgeTo[pos]);
 }
 
 
@@ -184,13 +472,8 @@ GraphNodeEdge* getEdgeToGraphNodeVertex(GraphNodeVertex *node, GraphNodeVertex*
  * @return true if graph is linked, false otherwise
  */
 bool hasBindirectionalEdgeToGraphNodeVertex(GraphNodeVertex *node, GraphNodeVertex* toNode) {
-	for (int i = 0; i < node->edgeCount; i++) {
-		if (   node->edgeTo[i].vertex == toNode
-			&& hasEdgeToGraphNodeVertex(toNode, node)) {
-			return true;
-		}
-	}
-	return false;
+	return    hasEdgeToGraphNodeVertex(node, toNode)
+		   && hasEdgeToGraphNodeVertex(toNode, node);
 }
 
 /**
@@ -203,21 +486,30 @@ bool hasBindirectionalEdgeToGraphNodeVertex(GraphNodeVertex *node, GraphNodeVert
  */
 GraphNodeEdge* addEdgeToGraphNodeVertex(
 		GraphNodeVertex* node, GraphNodeVertex* toNode, GraphEdgeData edgeData) {
-	for (int i = 0; i < node->edgeCount; i++) {
-		if (node->edgeTo[i].vertex == toNode) {
-			return (GraphNodeEdge*)NULL;
-		}
+	if (findGraphNodeEdge(node, toNode) >= 0) {
+		return (GraphNodeEdge*)NULL;
 	}
 	// grow linkTo array if necessary
 	if (node->edgeCount >= node->edgeCapacity) {
-		node->edgeCapacity *= 2;
-		node->edgeTo =
-			(GraphNodeEdge*)realloc(node->edgeTo, node->edgeCapacity * sizeof(GraphNodeEdge));
+		growGraphNodeEdges(node,
+			(node->edgeCapacity == 0) ? INITIAL_EDGE_CAPACITY : 2*node->edgeCapacity);
 	}
 	// add edge to end of edge array
 	node->edgeTo[node->edgeCount].vertex = toNode;
 	node->edgeTo[node->edgeCount].data = edgeData;
 	node->edgeCount++;
+	markGraphNodeVertexChanged(node);
+
+	// index edge, growing index to keep it at most half full
+	if (node->edgeIndex != (int*)NULL) {
+		if (2*node->edgeCount > node->edgeIndexCapacity) {
+			buildGraphNodeEdgeIndex(node, 2*node->edgeIndexCapacity);
+		} else {
+			insertGraphNodeEdgeIndex(node, node->edgeCount-1);
+		}
+	} else if (node->edgeCount > EDGE_INDEX_THRESHOLD) {
+		rebuildGraphNodeEdgeIndex(node);
+	}
 
 	return &node->edgeTo[node->edgeCount-1];
 }
@@ -253,23 +545,32 @@ GraphNodeEdge* addBidirectionalEdgeToGraphNodeVertex(
  * @return true if link was removed, false otherwise
  */
 bool removeEdgeToGraphNodeVertex(GraphNodeVertex* node, GraphNodeVertex* toNode) {
-
-	int i = 0;
-	for ( ; i < node->edgeCount; i++) {
-		if (node->edgeTo[i].vertex == toNode) {
-			break;
-		}
-	}
+	int pos = findGraphNodeEdge(node, toNode);
 	// not found
-	if (i >= node->edgeCount) {
+	if (pos < 0) {
 		return false;
 	}
 
-	for (node->edgeCount--; i < node->edgeCount; i++) {
-		node->edgeTo[i] = node->edgeTo[i+1];
+	int last = node->edgeCount-1;
+	if (node->edgeIndex != (int*)NULL) {
+		removeGraphNodeEdgeIndexSlot(node, findGraphNodeEdgeIndexSlot(node, toNode));
+		if (pos != last) {
+			// re-point index entry of last edge to its new position
+			int slot = findGraphNodeEdgeIndexSlot(node, node->edgeTo[last].vertex);
+			node->edgeIndex[slot] = pos;
+		}
 	}
-	return true;
 
+	// move last edge into place of removed edge
+	node->edgeTo[pos] = node->edgeTo[last];
+	node->edgeCount--;
+	markGraphNodeVertexChanged(node);
+
+	// drop the index when degree falls well below the threshold
+	if (node->edgeIndex != (int*)NULL && node->edgeCount < EDGE_INDEX_THRESHOLD/2) {
+		freeGraphNodeEdgeIndex(node);
+	}
+	return true;
 }
 
 /**
@@ -24,7 +24,7 @@ typedef struct _GraphVertexData {
  * Graph edge data field. Defines type of data in a graph edge
  */
 typedef struct {
-// something
+	double weight;		// relative weight of the edge for weighted walks
 } GraphEdgeData;
 
 /**
@@ -35,6 +35,11 @@ typedef struct {
 	struct _GraphNodeVertex* vertex;	// pointer to the other vertex
 } GraphNodeEdge;
 
+/**
+ * The graph that owns a node vertex
+ */
+struct _NodeGraph;
+
 /**
  * Graph node vertex with a data field and a edgeTo field to connected
  * GraphNodeVertex.
@@ -44,6 +49,10 @@ typedef struct _GraphNodeVertex {
 	GraphNodeEdge* edgeTo;
 	int edgeCount;
 	int edgeCapacity;
+	int index;					// index in graph vertex array, or -1 if not in a graph
+	struct _NodeGraph* graph;	// graph that owns the vertex, or NULL
+	int* edgeIndex;				// hash index of edgeTo positions, or NULL for low degree
+	int edgeIndexCapacity;		// capacity of edge index (power of 2)
 } GraphNodeVertex;
 
 /**
@@ -160,6 +169,8 @@ GraphNodeEdge* addBidirectionalEdgeToGraphNodeVertex(
 
 /**
  * Removes an edge from node vertex to specified node vertex.
+ * The last edge of the node vertex is moved into the place of the
+ * removed edge.
  *
  * @param node the node vertex
  * @param toNode the other node
@@ -12,6 +12,7 @@
 
 #include <stdbool.h>
 #include "graph_node_vertex.h"
+#include "graph_arena.h"
 
 /**
  * Create a new GraphNode with specified data
@@ -21,6 +22,16 @@
  */
 GraphNodeVertex* newGraphNodeVertex(GraphVertexData data);
 
+/**
+ * Create a new GraphNode with specified data whose storage and
+ * edge storage is allocated from the arena.
+ *
+ * @param arena the arena for the node vertex storage
+ * @param data the value of the data field
+ * @return a new GraphNode
+ */
+GraphNodeVertex* newGraphNodeVertexInArena(GraphArena* arena, GraphVertexData data);
+
 /**
  * Delete a graphNode and ensure edges bi-directionally in and out are
  * removed. Data must be freed by caller.
@@ -29,5 +40,30 @@ GraphNodeVertex* newGraphNodeVertex(GraphVertexData data);
  */
 void deleteGraphNodeVertex(GraphNodeVertex* node);
 
+/**
+ * Rebuild the edge index of a graph node vertex after its edge array
+ * or the storage of the vertices it has edges to has been changed.
+ * The vertex must not currently have an edge index.
+ *
+ * @param node the node vertex
+ */
+void rebuildGraphNodeEdgeIndex(GraphNodeVertex* node);
+
+/**
+ * Applies a set of edge changes to a graph node vertex in one pass.
+ * Edges to the vertices in removeVertices are removed, keeping the
+ * order of the remaining edges, then the new edges are appended. The
+ * edge array is reallocated at most once, and the edge index is
+ * rebuilt once for the final edges.
+ *
+ * @param node the node vertex
+ * @param removeVertices the vertices of edges to remove, sorted by address
+ * @param removeCount the number of vertices of edges to remove
+ * @param addEdges the new edges to append; must not already exist
+ * @param addCount the number of new edges
+ */
+void applyGraphNodeEdgeChanges(GraphNodeVertex* node,
+		GraphNodeVertex** removeVertices, int removeCount,
+		GraphNodeEdge* addEdges, int addCount);
 
 #endif /* GRAPH_NODE_VERTEX_IMPL_H_ */
@@ -0,0 +1,598 @@
+/*
+ * hash_bench_main.c
+ *
+ * This file provides a benchmark of the hash containers. For each
+ * container layout, key distribution and size, it measures insert, hit
+ * lookup, miss lookup, iteration, delete and clear in nanoseconds per
+ * operation, the hardware cache misses per operation when the kernel
+ * allows perf_event_open, and the bytes per entry of the container.
+ * Results are written as CSV or JSON records like node_graph_bench.
+ *
+ * Usage: hash_bench [-c container] [-k keys] [-n minSize] [-x maxSize]
+ *                   [-s seed] [-f csv|json]
+ *
+ *   container is one of chained, robinhood, chained_filter, set,
+ *     set_filter, template_set, or all (default)
+ *   keys is one of sequential, random, clustered, zipf, or all (default)
+ *   sizes are minSize, 10 * minSize, ... up to maxSize
+ *     (default 1000 to 1000000; 100000000 needs several GB)
+ *
+ * Keys are addresses that are compared but never dereferenced.
+ * Sequential keys are the vertices of an array, random keys are spread
+ * over a range 16 times larger than needed, and clustered keys are
+ * random pages of 64 consecutive vertices, like an arena. Zipf keys are
+ * random keys whose hit lookups follow a Zipf distribution (theta 0.99);
+ * the other distributions look up keys uniformly. Miss lookups use keys
+ * of the same distribution that were not inserted.
+ */
+
+#define _GNU_SOURCE		// syscall() and __NR_perf_event_open
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "hash_map.h"
+#include "hash_map_iterator.h"
+#include "hash_set.h"
+#include "hash_set_iterator.h"
+#include "hash_table_template.h"
+
+DEFINE_HASH_SET(PointerSet, MapKey, hashTemplatePointer, HASH_TEMPLATE_EQUAL)
+
+/**
+ * Minimum number of operations timed for each measurement, so that
+ * small sizes repeat their operations
+ */
+#define BENCH_MIN_OPERATIONS 1000000L
+
+/**
+ * Benchmark options
+ */
+typedef struct {
+	const char* container;	// name of the container, or "all"
+	const char* keys;		// name of the key distribution, or "all"
+	long minSize;			// smallest number of entries
+	long maxSize;			// largest number of entries
+	unsigned long seed;		// random seed
+	bool json;				// true for JSON output, false for CSV
+} BenchOptions;
+
+/**
+ * The operations of a container layout
+ */
+typedef struct {
+	const char* name;							// name of the layout
+	void* (*create)(void);						// creates an empty container
+	void (*destroy)(void* container);			// frees the container
+	void (*insert)(void* container, MapKey key);	// adds a key
+	bool (*contains)(void* container, MapKey key);	// looks up a key
+	void (*remove)(void* container, MapKey key);	// removes a key
+	long (*iterate)(void* container);			// visits every entry
+	void (*clear)(void* container);				// removes all keys
+	size_t (*bytes)(void* container);			// memory used
+} BenchContainer;
+
+/** true if no record has been written yet */
+static bool firstRecord = true;
+
+/** value of every map entry */
+static MapValue benchValue = { "value" };
+
+static void* createChainedMap(void) { return createHashMap(); }
+static void* createRobinHoodMap(void) { return createHashMapWithMode(HASH_MAP_ROBIN_HOOD); }
+static void* createFilteredMap(void) {
+	HashMap* map = createHashMap();
+	enableHashMapFilter(map);
+	return map;
+}
+static void destroyMap(void* map) { freeHashMap((HashMap*)map); }
+static void insertMap(void* map, MapKey key) { putHashMapEntry((HashMap*)map, key, &benchValue); }
+static bool containsMap(void* map, MapKey key) { return containsHashMapKey((HashMap*)map, key); }
+static void removeMap(void* map, MapKey key) { removeHashMapEntryForKey((HashMap*)map, key); }
+static long iterateMap(void* map) {
+	long sum = 0;
+	HashMapIterator* itr = createHashMapIterator((HashMap*)map);
+	while (hasNextHashMapEntry(itr)) {
+		sum += (long)(uintptr_t)getNextHashMapEntry(itr)->key;
+	}
+	freeHashMapIterator(itr);
+	return sum;
+}
+static void clearMap(void* map) { clearHashMap((HashMap*)map); }
+static size_t bytesMap(void* map) {
+	HashMapMemoryStats stats;
+	getHashMapMemoryStats((HashMap*)map, &stats);
+	return stats.totalBytes;
+}
+
+static void* createSet(void) { return createHashSet(); }
+static void* createFilteredSet(void) {
+	HashSet* set = createHashSet();
+	enableHashSetFilter(set);
+	return set;
+}
+static void destroySet(void* set) { freeHashSet((HashSet*)set); }
+static void insertSet(void* set, MapKey key) { addHashSetKey((HashSet*)set, key); }
+static bool containsSet(void* set, MapKey key) { return containsHashSetKey((HashSet*)set, key); }
+static void removeSet(void* set, MapKey key) { removeHashSetKey((HashSet*)set, key); }
+static long iterateSet(void* set) {
+	long sum = 0;
+	HashSetIterator* itr = createHashSetIterator((HashSet*)set);
+	for (MapKey* key; (key = getNextHashSetKey(itr)) != (MapKey*)NULL; ) {
+		sum += (long)(uintptr_t)*key;
+	}
+	freeHashSetIterator(itr);
+	return sum;
+}
+static void clearSet(void* set) { clearHashSet((HashSet*)set); }
+static size_t bytesSet(void* container) {
+	HashSet* set = (HashSet*)container;
+	size_t bytes = sizeof(HashSet) + set->capacity * (sizeof(MapKey) + sizeof(uint8_t));
+	if (set->filter != (BloomFilter*)NULL) {
+		bytes += sizeof(BloomFilter) + set->filter->blockCount * 8 * sizeof(uint64_t);
+	}
+	return bytes;
+}
+
+static void* createTemplateSet(void) { return createPointerSet(); }
+static void destroyTemplateSet(void* set) { freePointerSet((PointerSet*)set); }
+static void insertTemplateSet(void* set, MapKey key) { addPointerSetKey((PointerSet*)set, key); }
+static bool containsTemplateSet(void* set, MapKey key) {
+	return containsPointerSetKey((PointerSet*)set, key);
+}
+static void removeTemplateSet(void* set, MapKey key) { removePointerSetKey((PointerSet*)set, key); }
+static long iterateTemplateSet(void* set) {
+	long sum = 0;
+	int position = 0;
+	for (PointerSetEntry* entry;
+		 (entry = getNextPointerSetEntry((PointerSet*)set, &position)) != NULL; ) {
+		sum += (long)(uintptr_t)entry->key;
+	}
+	return sum;
+}
+static void clearTemplateSet(void* set) { clearPointerSet((PointerSet*)set); }
+static size_t bytesTemplateSet(void* container) {
+	PointerSet* set = (PointerSet*)container;
+	return sizeof(PointerSet) + set->capacity * (sizeof(PointerSetEntry) + sizeof(uint8_t));
+}
+
+/** the container layouts */
+static const BenchContainer benchContainers[] = {
+	{"chained", createChainedMap, destroyMap, insertMap, containsMap,
+		removeMap, iterateMap, clearMap, bytesMap},
+	{"robinhood", createRobinHoodMap, destroyMap, insertMap, containsMap,
+		removeMap, iterateMap, clearMap, bytesMap},
+	{"chained_filter", createFilteredMap, destroyMap, insertMap, containsMap,
+		removeMap, iterateMap, clearMap, bytesMap},
+	{"set", createSet, destroySet, insertSet, containsSet,
+		removeSet, iterateSet, clearSet, bytesSet},
+	{"set_filter", createFilteredSet, destroySet, insertSet, containsSet,
+		removeSet, iterateSet, clearSet, bytesSet},
+	{"template_set", createTemplateSet, destroyTemplateSet, insertTemplateSet,
+		containsTemplateSet, removeTemplateSet, iterateTemplateSet, clearTemplateSet,
+		bytesTemplateSet},
+};
+
+/** the key distributions */
+static const char* benchDistributions[] = {"sequential", "random", "clustered", "zipf"};
+
+/**
+ * Returns the current time in seconds.
+ *
+ * @return the current monotonic time in seconds
+ */
+static double getTimeSeconds(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Returns the next value of a splitmix64 generator.
+ *
+ * @param state the generator state
+ * @return the next value
+ */
+static uint64_t nextBenchRandom(uint64_t* state) {
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/**
+ * Permutes the values of a number of bits, so that distinct values give
+ * distinct results spread over the range.
+ *
+ * @param x the value (less than 2^bits)
+ * @param bits the number of bits
+ * @return the permuted value
+ */
+static uint64_t permuteBenchBits(uint64_t x, int bits) {
+	uint64_t mask = (bits < 64) ? (1ULL << bits) - 1 : ~0ULL;
+	int shift = (bits + 1) / 2;
+	x = (x * 0x9E3779B97F4A7C15ULL) & mask;
+	x ^= x >> shift;
+	x = (x * 0xBF58476D1CE4E5B9ULL) & mask;
+	x ^= x >> shift;
+	return x;
+}
+
+/**
+ * Fills an array with distinct keys of a distribution.
+ *
+ * @param distribution the name of the distribution
+ * @param keys the array to fill
+ * @param count the number of keys
+ */
+static void createBenchKeys(const char* distribution, MapKey* keys, long count) {
+	uintptr_t base = (uintptr_t)1 << 40;  // keys are never dereferenced
+	int bits = 4;
+	while ((1L << bits) < 16 * count) {
+		bits++;
+	}
+	for (long i = 0; i < count; i++) {
+		uintptr_t address;
+		if (strcmp(distribution, "sequential") == 0) {
+			address = base + i * sizeof(GraphNodeVertex);
+		} else if (strcmp(distribution, "clustered") == 0) {
+			uint64_t page = permuteBenchBits(i / 64, bits - 6);
+			address = base + page * 4096 + (i % 64) * sizeof(GraphNodeVertex);
+		} else {
+			address = base + permuteBenchBits(i, bits) * 8;
+		}
+		keys[i] = (MapKey)address;
+	}
+}
+
+/**
+ * Fills an array with the keys looked up by hit lookups: uniformly
+ * chosen keys, or Zipf-distributed keys for the zipf distribution.
+ *
+ * @param distribution the name of the distribution
+ * @param keys the inserted keys
+ * @param count the number of inserted keys
+ * @param probes the array to fill
+ * @param probeCount the number of lookups
+ * @param seed the random seed
+ */
+static void createBenchProbes(const char* distribution, MapKey* keys, long count,
+		MapKey* probes, long probeCount, uint64_t seed) {
+	uint64_t state = seed;
+	if (strcmp(distribution, "zipf") != 0) {
+		for (long i = 0; i < probeCount; i++) {
+			probes[i] = keys[nextBenchRandom(&state) % count];
+		}
+		return;
+	}
+
+	// Gray et al. method; ranks are scattered over the keys
+	double theta = 0.99;
+	double zetan = 0.0;
+	for (long i = 1; i <= count; i++) {
+		zetan += 1.0 / pow((double)i, theta);
+	}
+	double zeta2 = 1.0 + 1.0 / pow(2.0, theta);
+	double alpha = 1.0 / (1.0 - theta);
+	double eta = (1.0 - pow(2.0 / count, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+	for (long i = 0; i < probeCount; i++) {
+		double u = (nextBenchRandom(&state) >> 11) * 0x1.0p-53;
+		double uz = u * zetan;
+		long rank = (uz < 1.0) ? 0
+				  : (uz < zeta2) ? 1
+				  : (long)(count * pow(eta * u - eta + 1.0, alpha));
+		if (rank >= count) {
+			rank = count - 1;
+		}
+		probes[i] = keys[(uint64_t)rank * 0x9E3779B97F4A7C15ULL % (uint64_t)count];
+	}
+}
+
+/**
+ * Opens a counter of hardware cache misses of this thread.
+ *
+ * @return the counter file descriptor, or -1 if not available
+ */
+static int openCacheMissCounter(void) {
+#ifdef __linux__
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_CACHE_MISSES;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+	return -1;
+#endif
+}
+
+/**
+ * Starts counting cache misses from zero.
+ *
+ * @param counter the counter, or -1
+ */
+static void startCacheMissCounter(int counter) {
+#ifdef __linux__
+	if (counter >= 0) {
+		ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+		ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+	}
+#endif
+}
+
+/**
+ * Stops counting cache misses.
+ *
+ * @param counter the counter, or -1
+ * @return the number of cache misses since started, or 0
+ */
+static long stopCacheMissCounter(int counter) {
+	uint64_t count = 0;
+#ifdef __linux__
+	if (counter >= 0) {
+		ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+		if (read(counter, &count, sizeof(count)) != sizeof(count)) {
+			count = 0;
+		}
+	}
+#endif
+	return (long)count;
+}
+
+/**
+ * Writes one measurement record.
+ *
+ * @param options the benchmark options
+ * @param container the name of the container layout
+ * @param distribution the name of the key distribution
+ * @param size the number of entries
+ * @param metric the name of the measurement
+ * @param value the measured value
+ * @param unit the unit of the value
+ */
+static void writeRecord(const BenchOptions* options, const char* container,
+		const char* distribution, long size, const char* metric, double value, const char* unit) {
+	if (options->json) {
+		printf("%s\n  {\"container\": \"%s\", \"keys\": \"%s\", \"size\": %ld, "
+			   "\"metric\": \"%s\", \"value\": %.6g, \"unit\": \"%s\"}",
+			   firstRecord ? "[" : ",", container, distribution, size, metric, value, unit);
+	} else {
+		if (firstRecord) {
+			printf("container,keys,size,metric,value,unit\n");
+		}
+		printf("%s,%s,%ld,%s,%.6g,%s\n", container, distribution, size, metric, value, unit);
+	}
+	firstRecord = false;
+	fflush(stdout);
+}
+
+/**
+ * Time and cache misses of one kind of operation
+ */
+typedef struct {
+	const char* metric;		// name of the operation
+	double seconds;			// total time
+	long cacheMisses;		// total cache misses
+	long operations;		// total operations
+} BenchMeasure;
+
+/**
+ * Returns a stride that visits every index below count once, so that
+ * (i * stride) % count for i in [0,count) is a permutation.
+ *
+ * @param count the number of indexes
+ * @return a stride that is coprime with count
+ */
+static long getBenchStride(long count) {
+	for (long stride = 7919; ; stride++) {
+		long a = stride, b = count;
+		while (b != 0) {
+			long r = a % b;
+			a = b;
+			b = r;
+		}
+		if (a == 1) {
+			return stride;
+		}
+	}
+}
+
+/**
+ * Measures the operations of a container for keys of a distribution
+ * and writes the records.
+ *
+ * @param options the benchmark options
+ * @param container the container layout
+ * @param distribution the name of the key distribution
+ * @param size the number of entries
+ * @param counter the cache miss counter, or -1
+ */
+static void benchmarkContainer(const BenchOptions* options, const BenchContainer* container,
+		const char* distribution, long size, int counter) {
+	// the first half of the keys are inserted, the second half are misses
+	MapKey* keys = (MapKey*)malloc(2 * size * sizeof(MapKey));
+	createBenchKeys(distribution, keys, 2 * size);
+	// sequential keys are inserted in address order, so only the misses
+	// after them are shuffled
+	long shuffled = (strcmp(distribution, "sequential") == 0) ? size : 0;
+	uint64_t state = options->seed;
+	for (long i = 2 * size - 1; i > shuffled; i--) {
+		long j = shuffled + (long)(nextBenchRandom(&state) % (uint64_t)(i - shuffled + 1));
+		MapKey key = keys[i];
+		keys[i] = keys[j];
+		keys[j] = key;
+	}
+	long probeCount = (size < BENCH_MIN_OPERATIONS) ? BENCH_MIN_OPERATIONS : size;
+	MapKey* probes = (MapKey*)malloc(probeCount * sizeof(MapKey));
+	createBenchProbes(distribution, keys, size, probes, probeCount, options->seed + 1);
+	MapKey* misses = &keys[size];
+	long stride = getBenchStride(size);  // deletes in a scattered order
+
+	enum { INSERT, HIT, MISS, ITERATE, DELETE, CLEAR, MEASURE_COUNT };
+	BenchMeasure measures[MEASURE_COUNT] = {
+		{.metric = "insert"}, {.metric = "hit"}, {.metric = "miss"},
+		{.metric = "iterate"}, {.metric = "delete"}, {.metric = "clear"}
+	};
+	size_t bytes = 0;
+	long sum = 0;
+	long rounds = (BENCH_MIN_OPERATIONS + size - 1) / size;
+	for (long round = 0; round < rounds; round++) {
+		void* c = container->create();
+		double start = getTimeSeconds();
+		startCacheMissCounter(counter);
+		for (long i = 0; i < size; i++) {
+			container->insert(c, keys[i]);
+		}
+		measures[INSERT].cacheMisses += stopCacheMissCounter(counter);
+		measures[INSERT].seconds += getTimeSeconds() - start;
+		measures[INSERT].operations += size;
+		bytes = container->bytes(c);
+
+		if (round == 0) {
+			// each lookup is timed over at least BENCH_MIN_OPERATIONS
+			start = getTimeSeconds();
+			startCacheMissCounter(counter);
+			for (long i = 0; i < probeCount; i++) {
+				sum += container->contains(c, probes[i]);
+			}
+			measures[HIT].cacheMisses += stopCacheMissCounter(counter);
+			measures[HIT].seconds += getTimeSeconds() - start;
+			measures[HIT].operations += probeCount;
+
+			start = getTimeSeconds();
+			startCacheMissCounter(counter);
+			for (long i = 0; i < probeCount; i++) {
+				sum += container->contains(c, misses[i % size]);
+			}
+			measures[MISS].cacheMisses += stopCacheMissCounter(counter);
+			measures[MISS].seconds += getTimeSeconds() - start;
+			measures[MISS].operations += probeCount;
+		}
+
+		start = getTimeSeconds();
+		startCacheMissCounter(counter);
+		sum += container->iterate(c);
+		measures[ITERATE].cacheMisses += stopCacheMissCounter(counter);
+		measures[ITERATE].seconds += getTimeSeconds() - start;
+		measures[ITERATE].operations += size;
+
+		// delete in a different order than insertion
+		start = getTimeSeconds();
+		startCacheMissCounter(counter);
+		for (long i = size - 1; i >= 0; i--) {
+			container->remove(c, keys[(i * stride) % size]);
+		}
+		measures[DELETE].cacheMisses += stopCacheMissCounter(counter);
+		measures[DELETE].seconds += getTimeSeconds() - start;
+		measures[DELETE].operations += size;
+
+		for (long i = 0; i < size; i++) {
+			container->insert(c, keys[i]);
+		}
+		start = getTimeSeconds();
+		startCacheMissCounter(counter);
+		container->clear(c);
+		measures[CLEAR].cacheMisses += stopCacheMissCounter(counter);
+		measures[CLEAR].seconds += getTimeSeconds() - start;
+		measures[CLEAR].operations += size;
+		container->destroy(c);
+	}
+
+	for (int m = 0; m < MEASURE_COUNT; m++) {
+		BenchMeasure* measure = &measures[m];
+		char metric[32];
+		writeRecord(options, container->name, distribution, size, measure->metric,
+					measure->seconds * 1e9 / measure->operations, "ns/op");
+		if (counter >= 0) {
+			snprintf(metric, sizeof(metric), "%s_misses", measure->metric);
+			writeRecord(options, container->name, distribution, size, metric,
+						measure->cacheMisses / (double)measure->operations, "misses/op");
+		}
+	}
+	writeRecord(options, container->name, distribution, size, "memory",
+				bytes / (double)size, "bytes/entry");
+	if (sum == 42) {
+		fprintf(stderr, "\n");  // keeps the lookups from being optimized away
+	}
+	free(probes);
+	free(keys);
+}
+
+/**
+ * Main program to run the benchmark
+ *
+ * @return the exit status of the program
+ */
+int main(int argc, char* argv[]) {
+	BenchOptions options = {"all", "all", 1000, 1000000, 2017, false};
+	int opt;
+	while ((opt = getopt(argc, argv, "c:k:n:x:s:f:")) != -1) {
+		switch (opt) {
+		case 'c': options.container = optarg; break;
+		case 'k': options.keys = optarg; break;
+		case 'n': options.minSize = atol(optarg); break;
+		case 'x': options.maxSize = atol(optarg); break;
+		case 's': options.seed = strtoul(optarg, NULL, 10); break;
+		case 'f': options.json = (strcmp(optarg, "json") == 0); break;
+		default:
+			fprintf(stderr, "usage: %s [-c container] [-k keys] [-n minSize] [-x maxSize] "
+					"[-s seed] [-f csv|json]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (options.minSize < 1 || options.maxSize < options.minSize
+			|| options.maxSize > 1000000000L) {
+		fprintf(stderr, "%s: invalid option value\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	int containerCount = sizeof(benchContainers) / sizeof(benchContainers[0]);
+	int distributionCount = sizeof(benchDistributions) / sizeof(benchDistributions[0]);
+	bool foundContainer = false;
+	bool foundDistribution = false;
+	int counter = openCacheMissCounter();
+	for (int c = 0; c < containerCount; c++) {
+		if (strcmp(options.container, "all") != 0
+				&& strcmp(options.container, benchContainers[c].name) != 0) {
+			continue;
+		}
+		foundContainer = true;
+		for (int d = 0; d < distributionCount; d++) {
+			if (strcmp(options.keys, "all") != 0
+					&& strcmp(options.keys, benchDistributions[d]) != 0) {
+				continue;
+			}
+			foundDistribution = true;
+			for (long size = options.minSize; size <= options.maxSize; size *= 10) {
+				benchmarkContainer(&options, &benchContainers[c], benchDistributions[d],
+								   size, counter);
+			}
+		}
+	}
+	if (counter >= 0) {
+		close(counter);
+	}
+	if (options.json && !firstRecord) {
+		printf("\n]\n");
+	}
+	if (!foundContainer || !foundDistribution) {
+		fprintf(stderr, "%s: unknown %s %s\n", argv[0],
+				foundContainer ? "keys" : "container",
+				foundContainer ? options.keys : options.container);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -7,9 +7,12 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
 #include <strings.h>
+#include <assert.h>
 #include "hash_map.h"
 #include "hash_map_iterator.h"
+#include "hash_table_template.h"
 
 #ifndef DEFAULT_LOADING_FACTOR
 #define DEFAULT_LOADING_FACTOR 0.75f;
@@ -19,6 +22,24 @@
 #define DEFAULT_CAPACITY 16
 #endif
 
+#ifndef DEFAULT_ROBIN_HOOD_LOADING_FACTOR
+#define DEFAULT_ROBIN_HOOD_LOADING_FACTOR 0.9f
+#endif
+
+/**
+ * Percentage of the load factor below which removal halves the table,
+ * or 0 to never shrink automatically
+ */
+#ifndef HASH_MAP_SHRINK_PERCENT
+#define HASH_MAP_SHRINK_PERCENT 25
+#endif
+
+/**
+ * Number of entries that scans of the whole map get from the iterator
+ * at a time
+ */
+#define HASH_MAP_SCAN_BATCH 64
+
 /**
  * Get the hash table index for the hash key in a table of a given capacity.
  *
@@ -30,6 +51,288 @@ static int indexForTableEntryArray(int hashCode, int capacity) {
 	return hashCode & (capacity-1);  // mod function for power of 2 capacity
 }
 
+/**
+ * Get the filter hash code for the hash key. The bits of the hash key
+ * are mixed so that the filter block and bits are well distributed.
+ *
+ * @param hashCode the hash key
+ * @return the filter hash code
+ */
+static inline uint64_t getFilterCodeForHashCode(int hashCode) {
+	return mixHashTemplateCode((uint64_t)(unsigned)hashCode);
+}
+
+/**
+ * Clears the filter and adds the keys of the map, sizing the filter
+ * for twice the current number of entries.
+ *
+ * @param map the map
+ */
+static void rebuildHashMapFilter(HashMap* map) {
+	clearBloomFilter(map->filter, 2 * map->size);
+	if (map->mode == HASH_MAP_ROBIN_HOOD) {
+		for (int i = 0; i < map->capacity; i++) {
+			if (map->slots[i].probeLength > 0) {
+				addBloomFilterCode(map->filter, getFilterCodeForHashCode(map->slots[i].hashCode));
+			}
+		}
+		return;
+	}
+	for (int i = 0; i < map->capacity; i++) {
+		HashChainEntry* listEntry = map->hashTable[i].hashChain;
+		for ( ; listEntry != (HashChainEntry*)NULL; listEntry = listEntry->nextEntry) {
+			addBloomFilterCode(map->filter, getFilterCodeForHashCode(listEntry->hashCode));
+		}
+	}
+}
+
+/**
+ * Adds the hash key of an entry just added to the map to the filter,
+ * if there is one, and rebuilds the filter if it is full.
+ *
+ * @param map the map
+ * @param hashCode the hash key of the entry key
+ */
+static void addHashMapFilterCode(HashMap* map, int hashCode) {
+	if (map->filter != (BloomFilter*)NULL) {
+		addBloomFilterCode(map->filter, getFilterCodeForHashCode(hashCode));
+		if (isBloomFilterStale(map->filter)) {
+			rebuildHashMapFilter(map);
+		}
+	}
+}
+
+/**
+ * Counts an entry just removed from the map in the filter, if there is
+ * one, and rebuilds the filter if too many of its keys were removed.
+ *
+ * @param map the map
+ */
+static void countHashMapFilterRemoval(HashMap* map) {
+	if (map->filter != (BloomFilter*)NULL) {
+		countBloomFilterRemoval(map->filter);
+		if (isBloomFilterStale(map->filter)) {
+			rebuildHashMapFilter(map);
+		}
+	}
+}
+
+/**
+ * Moves a key from its old value to its new value in the value index,
+ * if there is one.
+ *
+ * @param map the map
+ * @param key the key
+ * @param oldValue the value the key was mapped to, or NULL if none
+ * @param value the value the key is mapped to, or NULL if none
+ */
+static void updateHashMapValueIndex(HashMap* map, MapKey key, MapValue* oldValue,
+		MapValue* value) {
+	if (map->valueIndex != (ValueIndex*)NULL) {
+		removeValueIndexKey(map->valueIndex, oldValue, key);
+		addValueIndexKey(map->valueIndex, value, key);
+	}
+}
+
+/**
+ * Allocates empty entry slots for a map in Robin Hood mode.
+ *
+ * @param map the map
+ * @param capacity the number of slots (power of 2)
+ */
+static void allocHashMapSlots(HashMap* map, int capacity) {
+	map->slots = (HashSlotEntry*)calloc(capacity, sizeof(HashSlotEntry));
+	assert(map->slots != (HashSlotEntry*)NULL);
+	map->capacity = capacity;
+}
+
+/**
+ * Returns the slot of the key in a map in Robin Hood mode. The search
+ * stops at the first slot whose entry is closer to its home slot than
+ * the key would be, because the key would have taken that slot.
+ *
+ * @param map the map
+ * @param hashCode the hash key of the key
+ * @param key the key to find
+ * @return the slot of the key, or NULL if the key is not in the map
+ */
+static HashSlotEntry* findHashMapSlot(HashMap* map, int hashCode, MapKey key) {
+	int mask = map->capacity - 1;
+	int i = indexForTableEntryArray(hashCode, map->capacity);
+	for (int probeLength = 1; map->slots[i].probeLength >= probeLength; probeLength++) {
+		if (map->slots[i].hashCode == hashCode
+			&& compareMapKey(key, map->slots[i].entry.key) == 0) {
+			return &map->slots[i];
+		}
+		i = (i+1) & mask;
+	}
+	return (HashSlotEntry*)NULL;
+}
+
+/**
+ * Inserts an entry that is not in a map in Robin Hood mode, without
+ * resizing. Each entry passed that is closer to its home slot than the
+ * entry being placed is displaced and placed further on.
+ *
+ * @param map the map
+ * @param hashCode the hash key of the key
+ * @param key the key to add
+ * @param value the value to add
+ */
+static void insertHashMapSlot(HashMap* map, int hashCode, MapKey key, MapValue* value) {
+	HashSlotEntry carried = { { key, value }, hashCode, 1 };
+	int mask = map->capacity - 1;
+	int i = indexForTableEntryArray(hashCode, map->capacity);
+	for ( ; map->slots[i].probeLength != 0; i = (i+1) & mask) {
+		if (map->slots[i].probeLength < carried.probeLength) {
+			HashSlotEntry displaced = map->slots[i];
+			map->slots[i] = carried;
+			carried = displaced;
+		}
+		carried.probeLength++;
+	}
+	map->slots[i] = carried;
+}
+
+/**
+ * Replaces the entry slots of a map in Robin Hood mode with slots of a
+ * new capacity, and inserts the entries into them.
+ *
+ * @param map the map
+ * @param newCapacity the new capacity (power of 2)
+ */
+static void resizeHashMapSlots(HashMap* map, int newCapacity) {
+	HashSlotEntry* oldSlots = map->slots;
+	int oldCapacity = map->capacity;
+	allocHashMapSlots(map, newCapacity);
+	for (int i = 0; i < oldCapacity; i++) {
+		if (oldSlots[i].probeLength != 0) {
+			insertHashMapSlot(map, oldSlots[i].hashCode,
+				oldSlots[i].entry.key, oldSlots[i].entry.value);
+		}
+	}
+	free(oldSlots);
+}
+
+/**
+ * Removes the entry in a slot of a map in Robin Hood mode, and shifts
+ * back the following entries until one is in its home slot.
+ *
+ * @param map the map
+ * @param slot the slot of the entry
+ */
+static void removeHashMapSlot(HashMap* map, HashSlotEntry* slot) {
+	int mask = map->capacity - 1;
+	int i = (int)(slot - map->slots);
+	for (int j = (i+1) & mask; map->slots[j].probeLength > 1; j = (j+1) & mask) {
+		map->slots[i] = map->slots[j];
+		map->slots[i].probeLength--;
+		i = j;
+	}
+	map->slots[i].probeLength = 0;
+}
+
+
+/**
+ * Transfers all entries from current table to newTable.
+ *
+ * @param oldTable the old table entry array
+ * @param oldCapacity the capacity of the old table entry array
+ * @param newTable the new table entry array
+ * @param newCapacity the capacity of the new table entry array
+ */
+static void transferTableEntryArray(HashTableEntry* oldTable, int oldCapacity,
+		           HashTableEntry* newTable, int newCapacity) {
+	// transfer entries for each table entry
+	for (int index = 0; index < oldCapacity; index++) {
+		// transfer entries for list entries at current index
+		HashChainEntry* listEntry = oldTable[index].hashChain;
+		oldTable[index].hashChain = (HashChainEntry*)NULL;  // disconnect chain
+		while (listEntry != (HashChainEntry*)NULL) {
+			HashChainEntry* nextEntry = listEntry->nextEntry;
+
+			// splice in at head of the new table entry chain
+			int newIndex = indexForTableEntryArray(listEntry->hashCode, newCapacity);
+			listEntry->nextEntry = newTable[newIndex].hashChain;
+			newTable[newIndex].hashChain = listEntry;
+
+			listEntry = nextEntry;
+		}
+	}
+}
+
+/**
+ * Replace old table entry array in map with resized table entry array
+ * with contents transferred to the new table entry array. This method
+ * is used with the table is at its threshold, or when it is sparse.
+ *
+ * @param map the map
+ * @param newCapacity the new capacity, must be a power of two
+ */
+static void resizeTableEntryArray(HashMap* map, int newCapacity) {
+	HashTableEntry* oldTable = map->hashTable;
+	int oldCapacity = map->capacity;
+
+	HashTableEntry* newTable = (HashTableEntry*)malloc(newCapacity*sizeof(HashTableEntry));
+	for (int i = 0; i < newCapacity; i++) {  // initialize new table
+		newTable[i].hashChain = (HashChainEntry*)NULL;
+	}
+	transferTableEntryArray(oldTable, oldCapacity, newTable, newCapacity);
+	map->hashTable = newTable;
+	map->capacity = newCapacity;
+	free(oldTable);
+}
+
+/**
+ * Resizes the table of the map in either mode.
+ *
+ * @param map the map
+ * @param newCapacity the new capacity, must be a power of two that
+ *   holds the entries without growing
+ */
+static void resizeHashMap(HashMap* map, int newCapacity) {
+	if (map->mode == HASH_MAP_ROBIN_HOOD) {
+		resizeHashMapSlots(map, newCapacity);
+	} else {
+		resizeTableEntryArray(map, newCapacity);
+	}
+}
+
+/**
+ * Halves the table if removal has left it less than HASH_MAP_SHRINK_PERCENT
+ * percent as full as the load that makes it grow. The halved table is
+ * at most half as full as that load, so it does not soon grow again.
+ *
+ * @param map the map
+ */
+static void shrinkHashMapIfSparse(HashMap* map) {
+	if (HASH_MAP_SHRINK_PERCENT > 0 && map->capacity > DEFAULT_CAPACITY
+			&& map->size * 100.0f < map->capacity * map->loadFactor * HASH_MAP_SHRINK_PERCENT) {
+		resizeHashMap(map, map->capacity / 2);
+	}
+}
+
+/**
+ * Frees the hash chain entries of a map in chained mode, leaving the
+ * table entries empty. Does nothing in Robin Hood mode.
+ *
+ * @param map the map
+ */
+static void freeHashMapChains(HashMap* map) {
+	if (map->hashTable != (HashTableEntry*)NULL) {  // call assert?
+		for (int i = 0; i < map->capacity; i++) {
+			// free the list entry chain
+			HashChainEntry* listEntry = map->hashTable[i].hashChain;
+			while (listEntry != (HashChainEntry*)NULL) {
+				HashChainEntry* nextListEntry = listEntry->nextEntry;
+				listEntry->nextEntry = (HashChainEntry*)NULL;
+				free(listEntry);
+				listEntry = nextListEntry;
+			}
+			map->hashTable[i].hashChain = (HashChainEntry*)NULL;
+		}
+	}
+}
 
 /**
  * Create new empty HashMap.
@@ -37,13 +340,34 @@ static int indexForTableEntryArray(int hashCode, int capacity) {
  * @return new HashMap
  */
 HashMap* createHashMap(void) {
+	return createHashMapWithMode(HASH_MAP_CHAINED);
+}
+
+/**
+ * Create new empty HashMap that stores its entries in a given way.
+ *
+ * @param mode how the entries are stored
+ * @return new HashMap
+ */
+HashMap* createHashMapWithMode(HashMapMode mode) {
 	// create and initialize the map
 	HashMap* map = (HashMap*)malloc(sizeof(HashMap));
 	map->size = 0;
-	map->loadFactor = DEFAULT_LOADING_FACTOR;
+	map->mode = mode;
 	map->capacity = DEFAULT_CAPACITY;
+	map->filter = (BloomFilter*)NULL;
+	map->valueIndex = (ValueIndex*)NULL;
+	map->hashTable = (HashTableEntry*)NULL;
+	map->slots = (HashSlotEntry*)NULL;
+
+	if (mode == HASH_MAP_ROBIN_HOOD) {
+		map->loadFactor = DEFAULT_ROBIN_HOOD_LOADING_FACTOR;
+		allocHashMapSlots(map, DEFAULT_CAPACITY);
+		return map;
+	}
 
 	// create and initial hash table list for the map
+	map->loadFactor = DEFAULT_LOADING_FACTOR;
 	map->hashTable =
 		(HashTableEntry*)malloc(map->capacity * sizeof (HashTableEntry));
 	for (int i = 0; i < map->capacity; i++) {
@@ -59,9 +383,13 @@ HashMap* createHashMap(void) {
  * @param map the HashMap to free
  */
 void freeHashMap(HashMap* map) {
-	clearHashMap(map);
+	disableHashMapFilter(map);
+	disableHashMapValueIndex(map);
+	freeHashMapChains(map);
 	free(map->hashTable);
+	free(map->slots);
 	map->hashTable = (HashTableEntry*)NULL;
+	map->slots = (HashSlotEntry*)NULL;
 	free(map);
 }
 
@@ -71,21 +399,25 @@ void freeHashMap(HashMap* map) {
  * @param map the HashMap
  */
 void clearHashMap(HashMap* map) {
-	// clear the table entries
-	if (map->hashTable != (HashTableEntry*)NULL) {  // call assert?
-		for (int i = 0; i < map->capacity; i++) {
-			// free the list entry chain
-			HashChainEntry* listEntry = map->hashTable[i].hashChain;
-			while (listEntry != (HashChainEntry*)NULL) {
-				HashChainEntry* nextListEntry = listEntry->nextEntry;
-				listEntry->nextEntry = (HashChainEntry*)NULL;
-				free(listEntry);
-				listEntry = nextListEntry;
-			}
-			map->hashTable[i].hashChain = (HashChainEntry*)NULL;
+	freeHashMapChains(map);
+	map->size = 0;
+	if (HASH_MAP_SHRINK_PERCENT > 0 && map->capacity > DEFAULT_CAPACITY) {
+		if (map->slots != (HashSlotEntry*)NULL) {
+			// replace the slots rather than clearing them first
+			free(map->slots);
+			allocHashMapSlots(map, DEFAULT_CAPACITY);
+		} else {
+			resizeTableEntryArray(map, DEFAULT_CAPACITY);
 		}
+	} else if (map->slots != (HashSlotEntry*)NULL) {
+		memset(map->slots, 0, map->capacity * sizeof(HashSlotEntry));
+	}
+	if (map->filter != (BloomFilter*)NULL) {
+		clearBloomFilter(map->filter, 0);
+	}
+	if (map->valueIndex != (ValueIndex*)NULL) {
+		clearValueIndex(map->valueIndex);
 	}
-	map->size = 0;
 }
 
 /**
@@ -105,16 +437,22 @@ bool containsHashMapKey(HashMap* map, MapKey key) {
  * @param value the entry value to check
  */
 bool containsHashMapValue(HashMap* map, MapValue* value) {
+	if (map->valueIndex != (ValueIndex*)NULL) {
+		return getValueIndexKeyCount(map->valueIndex, value) > 0;
+	}
+	MapEntry* entries[HASH_MAP_SCAN_BATCH];
+	bool found = false;
 	HashMapIterator* itr = createHashMapIterator(map);
-	while (hasNextHashMapEntry(itr)) {
-		MapEntry* mapEntry = getNextHashMapEntry(itr);
-		if (compareMapValue(mapEntry->value, value) == 0) {
-			freeHashMapIterator(itr);
-			return true;
+	for (int n; !found && (n = getNextHashMapEntries(itr, entries, HASH_MAP_SCAN_BATCH)) > 0; ) {
+		for (int i = 0; i < n; i++) {
+			if (compareMapValue(entries[i]->value, value) == 0) {
+				found = true;
+				break;
+			}
 		}
 	}
 	freeHashMapIterator(itr);
-	return false;
+	return found;
 }
 
 /**
@@ -126,13 +464,9 @@ bool containsHashMapValue(HashMap* map, MapValue* value) {
  */
 MapEntry** getHashMapEntries(HashMap* map) {
 	// allocate MapEntrySet array
-	MapEntry** mapEntrySet = (MapEntry**)malloc(map->size*sizeof(MapEntry*) + 1);
-	int i = 0;
+	MapEntry** mapEntrySet = (MapEntry**)malloc((map->size+1)*sizeof(MapEntry*));
 	HashMapIterator* itr = createHashMapIterator(map);
-	while (hasNextHashMapEntry(itr)) {
-		MapEntry* mapEntry = getNextHashMapEntry(itr);
-		mapEntrySet[i++] = mapEntry;
-	}
+	int i = getNextHashMapEntries(itr, mapEntrySet, map->size);
 	mapEntrySet[i] = (MapEntry*)NULL; // NULL terminated array
 
 	freeHashMapIterator(itr);
@@ -149,16 +483,36 @@ MapEntry** getHashMapEntries(HashMap* map) {
  */
 MapEntry* getHashMapEntry(HashMap* map, MapKey key) {
 	int hashCode = getMapEntryKeyHashCode(key);
-	int entryIndex = indexForTableEntryArray(hashCode, map->capacity);
-
-	HashChainEntry* chainEntry = map->hashTable[entryIndex].hashChain;
-	for ( ; chainEntry != (HashChainEntry*)NULL; chainEntry= chainEntry->nextEntry) {
-		if (hashCode == chainEntry->hashCode &&
-			compareMapKey(key, chainEntry->entry.key) == 0) { // what if different? assert?
-			return &chainEntry->entry;
+	bool passed = true;
+	if (map->filter != (BloomFilter*)NULL) {
+		// a definite miss needs no chain access
+		passed = mayContainBloomFilterCode(map->filter, getFilterCodeForHashCode(hashCode));
+		if (!passed) {
+			countBloomFilterQuery(map->filter, false, false);
+			return (MapEntry*)NULL;
+		}
+	}
+	MapEntry* entry = (MapEntry*)NULL;
+	if (map->mode == HASH_MAP_ROBIN_HOOD) {
+		HashSlotEntry* slot = findHashMapSlot(map, hashCode, key);
+		if (slot != (HashSlotEntry*)NULL) {
+			entry = &slot->entry;
+		}
+	} else {
+		int entryIndex = indexForTableEntryArray(hashCode, map->capacity);
+		HashChainEntry* chainEntry = map->hashTable[entryIndex].hashChain;
+		for ( ; chainEntry != (HashChainEntry*)NULL; chainEntry= chainEntry->nextEntry) {
+			if (hashCode == chainEntry->hashCode &&
+				compareMapKey(key, chainEntry->entry.key) == 0) { // what if different? assert?
+				entry = &chainEntry->entry;
+				break;
+			}
 		}
 	}
-	return (MapEntry*)NULL;
+	if (map->filter != (BloomFilter*)NULL) {
+		countBloomFilterQuery(map->filter, passed, entry != (MapEntry*)NULL);
+	}
+	return entry;
 }
 
 /**
@@ -183,12 +537,14 @@ MapValue* getHashMapValue(HashMap* map, MapKey key) {
  */
 MapValue** getHashMapValues(HashMap* map) {
 	// allocate MapEntrySet array
-	MapValue** valueSet = (MapValue**)malloc(map->size*sizeof(MapValue*) + 1);
+	MapValue** valueSet = (MapValue**)malloc((map->size+1)*sizeof(MapValue*));
+	MapEntry* entries[HASH_MAP_SCAN_BATCH];
 	int i = 0;
 	HashMapIterator* itr = createHashMapIterator(map);
-	while (hasNextHashMapEntry(itr)) {
-		MapEntry* mapEntry = getNextHashMapEntry(itr);
-		valueSet[i++] = mapEntry->value;
+	for (int n; (n = getNextHashMapEntries(itr, entries, HASH_MAP_SCAN_BATCH)) > 0; ) {
+		for (int j = 0; j < n; j++) {
+			valueSet[i++] = entries[j]->value;
+		}
 	}
 	valueSet[i] = (MapValue*)NULL; // NULL terminated array
 
@@ -215,12 +571,14 @@ bool isHashMapEmpty(HashMap* map) {
  */
 MapKey** getHashMapKeys(HashMap* map) {
 	// allocate MapEntrySet array
-	MapKey** keySet = (MapKey**)malloc(map->size*sizeof(MapKey*) + 1);
+	MapKey** keySet = (MapKey**)malloc((map->size+1)*sizeof(MapKey*));
+	MapEntry* entries[HASH_MAP_SCAN_BATCH];
 	int i = 0;
 	HashMapIterator* itr = createHashMapIterator(map);
-	while (hasNextHashMapEntry(itr)) {
-		MapEntry* mapEntry = getNextHashMapEntry(itr);
-		keySet[i++] = &mapEntry->key;
+	for (int n; (n = getNextHashMapEntries(itr, entries, HASH_MAP_SCAN_BATCH)) > 0; ) {
+		for (int j = 0; j < n; j++) {
+			keySet[i++] = &entries[j]->key;
+		}
 	}
 	keySet[i] = (MapKey*)NULL; // NULL terminated array
 
@@ -228,57 +586,6 @@ MapKey** getHashMapKeys(HashMap* map) {
 	return keySet;
 }
 
-/**
- * Transfers all entries from current table to newTable.
- *
- * @param oldTable the old table entry array
- * @param oldCapacity the capacity of the old table entry array
- * @param newTable the new table entry array
- * @param newCapacity the capacity of the new table entry array
- */
-static void transferTableEntryArray(HashTableEntry* oldTable, int oldCapacity,
-		           HashTableEntry* newTable, int newCapacity) {
-	// transfer entries for each table entry
-	for (int index = 0; index < oldCapacity; index++) {
-		// transfer entries for list entries at current index
-		HashChainEntry* listEntry = oldTable[index].hashChain;
-		oldTable[index].hashChain = (HashChainEntry*)NULL;  // disconnect chain
-		while (listEntry != (HashChainEntry*)NULL) {
-			HashChainEntry* nextEntry = listEntry->nextEntry;
-
-			// splice in at head of the new table entry chain
-			int newIndex = indexForTableEntryArray(listEntry->hashCode, newCapacity);
-			listEntry->nextEntry = newTable[newIndex].hashChain;
-			newTable[newIndex].hashChain = listEntry;
-
-			listEntry = nextEntry;
-		}
-	}
-}
-
-/**
- * Replace old table entry array in map with resized table entry array
- * with contents transferred to the new table entry array. This method
- * is used with the table is at its threshold.
- *
- * @param map the map
- * @param newCapacity the new capacity, must be a power of two that is
- *  greater than current capacity.
- */
-static void resizeTableEntryArray(HashMap* map, int newCapacity) {
-	HashTableEntry* oldTable = map->hashTable;
-	int oldCapacity = map->capacity;
-
-	HashTableEntry* newTable = (HashTableEntry*)malloc(newCapacity*sizeof(HashTableEntry));
-	for (int i = 0; i < newCapacity; i++) {  // initialize new table
-		newTable[i].hashChain = (HashChainEntry*)NULL;
-	}
-	transferTableEntryArray(oldTable, oldCapacity, newTable, newCapacity);
-	map->hashTable = newTable;
-	map->capacity = newCapacity;
-	free(oldTable);
-}
-
 /**
  * Adds a new entry with the key, value and hash code to the map,
  * and resizes the map entry table array if necessary.
@@ -304,10 +611,11 @@ static void addEntryToTableEntryArray(
 	// splice entry to head of list
 	newChainEntry->nextEntry = map->hashTable[entryIndex].hashChain;
 	map->hashTable[entryIndex].hashChain = newChainEntry;
+	addHashMapFilterCode(map, hashCode);
 
 	// resize table if at threshold (map capacity * loadFactor)
 	if (++map->size > map->capacity*map->loadFactor) {
-		resizeTableEntryArray(map, 2* map->capacity);
+		resizeHashMap(map, 2* map->capacity);
 	}
  }
 
@@ -323,6 +631,25 @@ static void addEntryToTableEntryArray(
  */
 MapValue* putHashMapEntry(HashMap* map, MapKey key, MapValue* value) {
 	int hashCode = getMapEntryKeyHashCode(key);
+	if (map->mode == HASH_MAP_ROBIN_HOOD) {
+		HashSlotEntry* slot = findHashMapSlot(map, hashCode, key);
+		if (slot != (HashSlotEntry*)NULL) {
+			MapValue* oldValue = slot->entry.value;
+			slot->entry.value = value;
+			updateHashMapValueIndex(map, key, oldValue, value);
+			return oldValue;
+		}
+		// resize first, so the table always has an empty slot
+		if (map->size+1 > map->capacity*map->loadFactor) {
+			resizeHashMap(map, 2 * map->capacity);
+		}
+		insertHashMapSlot(map, hashCode, key, value);
+		map->size++;
+		addHashMapFilterCode(map, hashCode);
+		updateHashMapValueIndex(map, key, (MapValue*)NULL, value);
+		return (MapValue*)NULL;
+	}
+
 	int entryIndex = indexForTableEntryArray(hashCode, map->capacity);
 
 	// look for existing entry in entry chain
@@ -332,11 +659,13 @@ MapValue* putHashMapEntry(HashMap* map, MapKey key, MapValue* value) {
 			&& compareMapKey(key, listEntry->entry.key) == 0) {
 			MapValue* oldValue = listEntry->entry.value;
 			listEntry->entry.value = value;
+			updateHashMapValueIndex(map, key, oldValue, value);
 			return oldValue;
 		}
 	}
 	// add entry to map and resize if necessary
 	addEntryToTableEntryArray(map, hashCode, key, value,entryIndex);
+	updateHashMapValueIndex(map, key, (MapValue*)NULL, value);
 
 	return (MapValue*)NULL;
 }
@@ -354,6 +683,7 @@ void putAllHashMapEntries(HashMap* map, HashMap* aMap) {
 		MapEntry* entry = getNextHashMapEntry(itr);
 		putHashMapEntry(map, entry->key, entry->value);
 	}
+	freeHashMapIterator(itr);
 }
 
 /**
@@ -365,6 +695,23 @@ void putAllHashMapEntries(HashMap* map, HashMap* aMap) {
  */
 MapValue* removeHashMapEntryForKey(HashMap* map, MapKey key) {
 	int hashCode = getMapEntryKeyHashCode(key);
+	if (map->filter != (BloomFilter*)NULL
+			&& !mayContainBloomFilterCode(map->filter, getFilterCodeForHashCode(hashCode))) {
+		return (MapValue*)NULL;
+	}
+	if (map->mode == HASH_MAP_ROBIN_HOOD) {
+		HashSlotEntry* slot = findHashMapSlot(map, hashCode, key);
+		if (slot == (HashSlotEntry*)NULL) {
+			return (MapValue*)NULL;
+		}
+		MapValue* value = slot->entry.value;
+		removeHashMapSlot(map, slot);
+		map->size--;
+		countHashMapFilterRemoval(map);
+		updateHashMapValueIndex(map, key, value, (MapValue*)NULL);
+		shrinkHashMapIfSparse(map);
+		return value;
+	}
 	int entryIndex = indexForTableEntryArray(hashCode, map->capacity);
 
 	HashChainEntry* listEntry = map->hashTable[entryIndex].hashChain;
@@ -387,6 +734,9 @@ MapValue* removeHashMapEntryForKey(HashMap* map, MapKey key) {
 			free(listEntry);
 
 			map->size--;
+			countHashMapFilterRemoval(map);
+			updateHashMapValueIndex(map, key, value, (MapValue*)NULL);
+			shrinkHashMapIfSparse(map);
 			return value;
 		}
 		prevListEntry = listEntry;
@@ -404,3 +754,185 @@ MapValue* removeHashMapEntryForKey(HashMap* map, MapKey key) {
 int getHashMapSize(HashMap* map) {
 	return map->size;
 }
+
+/**
+ * Counts the probe length of a key in the statistics.
+ *
+ * @param stats the HashMapProbeStats
+ * @param probeLength the probe length of the key
+ */
+static void countHashMapProbe(HashMapProbeStats* stats, int probeLength) {
+	if (probeLength > stats->maxProbeLength) {
+		stats->maxProbeLength = probeLength;
+	}
+	int bucket = (probeLength < HASH_MAP_PROBE_HISTOGRAM) ? probeLength : HASH_MAP_PROBE_HISTOGRAM;
+	stats->histogram[bucket-1]++;
+	stats->meanProbeLength += probeLength;
+}
+
+/**
+ * Returns the probe length statistics of the keys in the map.
+ *
+ * @param map the HashMap
+ * @param stats the HashMapProbeStats to fill in
+ */
+void getHashMapProbeStats(HashMap* map, HashMapProbeStats* stats) {
+	memset(stats, 0, sizeof(HashMapProbeStats));
+	for (int i = 0; i < map->capacity; i++) {
+		if (map->mode == HASH_MAP_ROBIN_HOOD) {
+			if (map->slots[i].probeLength > 0) {
+				countHashMapProbe(stats, map->slots[i].probeLength);
+			}
+		} else {
+			// the nth entry of a chain is found after n comparisons
+			int probeLength = 1;
+			HashChainEntry* listEntry = map->hashTable[i].hashChain;
+			for ( ; listEntry != (HashChainEntry*)NULL; listEntry = listEntry->nextEntry) {
+				countHashMapProbe(stats, probeLength++);
+			}
+		}
+	}
+	if (map->size > 0) {
+		stats->meanProbeLength /= map->size;
+	}
+}
+
+/**
+ * Keeps a BloomFilter of the entry keys, which getHashMapEntry() and
+ * removeHashMapEntryForKey() test before following a hash chain.
+ * Lookups that test the filter update its statistics, so a map with a
+ * filter must not be used by more than one thread at a time.
+ *
+ * @param map the HashMap
+ */
+void enableHashMapFilter(HashMap* map) {
+	if (map->filter == (BloomFilter*)NULL) {
+		map->filter = createBloomFilter(0);
+		rebuildHashMapFilter(map);
+	}
+}
+
+/**
+ * Discards the BloomFilter of the entry keys, if any.
+ *
+ * @param map the HashMap
+ */
+void disableHashMapFilter(HashMap* map) {
+	if (map->filter != (BloomFilter*)NULL) {
+		freeBloomFilter(map->filter);
+		map->filter = (BloomFilter*)NULL;
+	}
+}
+
+/**
+ * Keeps a ValueIndex of the entry values, which containsHashMapValue()
+ * and getHashMapKeysForValue() use instead of scanning the entries. The
+ * valuestr of a value must not change while the value is in the map.
+ *
+ * @param map the HashMap
+ */
+void enableHashMapValueIndex(HashMap* map) {
+	if (map->valueIndex != (ValueIndex*)NULL) {
+		return;
+	}
+	map->valueIndex = createValueIndex();
+	MapEntry* entries[HASH_MAP_SCAN_BATCH];
+	HashMapIterator* itr = createHashMapIterator(map);
+	for (int n; (n = getNextHashMapEntries(itr, entries, HASH_MAP_SCAN_BATCH)) > 0; ) {
+		for (int i = 0; i < n; i++) {
+			addValueIndexKey(map->valueIndex, entries[i]->value, entries[i]->key);
+		}
+	}
+	freeHashMapIterator(itr);
+}
+
+/**
+ * Discards the ValueIndex of the entry values, if any.
+ *
+ * @param map the HashMap
+ */
+void disableHashMapValueIndex(HashMap* map) {
+	if (map->valueIndex != (ValueIndex*)NULL) {
+		freeValueIndex(map->valueIndex);
+		map->valueIndex = (ValueIndex*)NULL;
+	}
+}
+
+/**
+ * Returns the keys that are mapped to the specified value. Caller is
+ * responsible for freeing the set.
+ *
+ * @param map the HashMap
+ * @param value the value
+ * @return a new HashSet of the keys mapped to a value equal to value
+ */
+HashSet* getHashMapKeysForValue(HashMap* map, MapValue* value) {
+	HashSet* keys = createHashSet();
+	if (map->valueIndex != (ValueIndex*)NULL) {
+		addValueIndexKeysToSet(map->valueIndex, value, keys);
+		return keys;
+	}
+	MapEntry* entries[HASH_MAP_SCAN_BATCH];
+	HashMapIterator* itr = createHashMapIterator(map);
+	for (int n; (n = getNextHashMapEntries(itr, entries, HASH_MAP_SCAN_BATCH)) > 0; ) {
+		for (int i = 0; i < n; i++) {
+			if (compareMapValue(entries[i]->value, value) == 0) {
+				addHashSetKey(keys, entries[i]->key);
+			}
+		}
+	}
+	freeHashMapIterator(itr);
+	return keys;
+}
+
+/**
+ * Returns the memory used by the map.
+ *
+ * @param map the HashMap
+ * @param stats the HashMapMemoryStats to fill in
+ */
+void getHashMapMemoryStats(HashMap* map, HashMapMemoryStats* stats) {
+	memset(stats, 0, sizeof(HashMapMemoryStats));
+	stats->overheadBytes = sizeof(HashMap);
+	if (map->mode == HASH_MAP_ROBIN_HOOD) {
+		stats->tableBytes = map->capacity * sizeof(HashSlotEntry);
+	} else {
+		stats->tableBytes = map->capacity * sizeof(HashTableEntry);
+		stats->entryBytes = map->size * sizeof(HashChainEntry);
+	}
+	if (map->filter != (BloomFilter*)NULL) {
+		stats->filterBytes = map->filter->blockCount * 8 * sizeof(uint64_t);
+		stats->overheadBytes += sizeof(BloomFilter);
+	}
+	if (map->valueIndex != (ValueIndex*)NULL) {
+		stats->indexBytes = getValueIndexBytes(map->valueIndex);
+	}
+	stats->totalBytes = stats->tableBytes + stats->entryBytes + stats->filterBytes
+					  + stats->indexBytes + stats->overheadBytes;
+}
+
+/**
+ * Resizes the table to the smallest capacity that holds the entries
+ * without growing, and resizes the BloomFilter, if any, for the entries.
+ * A MapEntry returned by a map in Robin Hood mode is no longer valid.
+ *
+ * @param map the HashMap
+ * @return the number of bytes released
+ */
+size_t shrinkHashMapToFit(HashMap* map) {
+	HashMapMemoryStats before;
+	getHashMapMemoryStats(map, &before);
+	int capacity = DEFAULT_CAPACITY;
+	while (map->size > capacity * map->loadFactor) {
+		capacity *= 2;
+	}
+	if (capacity < map->capacity) {
+		resizeHashMap(map, capacity);
+	}
+	if (map->filter != (BloomFilter*)NULL) {
+		rebuildHashMapFilter(map);
+	}
+	HashMapMemoryStats after;
+	getHashMapMemoryStats(map, &after);
+	return (before.totalBytes > after.totalBytes) ? before.totalBytes - after.totalBytes : 0;
+}
@@ -12,6 +12,9 @@
 #ifndef HASH_MAP_H_
 #define HASH_MAP_H_
 #include "map_entry.h"
+#include "bloom_filter.h"
+#include "hash_set.h"
+#include "value_index.h"
 
 /**
  * Entry in the hash chain for a hash table entry
@@ -30,13 +33,77 @@ typedef struct {
 } HashTableEntry;
 
 /**
- * The hash table
+ * An entry slot in the table of a map in HASH_MAP_ROBIN_HOOD mode.
  */
 typedef struct {
-	HashTableEntry* hashTable;			// the hash table
+	MapEntry entry;						// entry key/value pair
+	int hashCode;						// hash code for the entry key
+	int probeLength;					// 1 + distance from home slot, or 0 if empty
+} HashSlotEntry;
+
+/**
+ * How a HashMap stores its entries
+ */
+typedef enum {
+	HASH_MAP_CHAINED,					// a chain of entries for each table entry
+	HASH_MAP_ROBIN_HOOD					// entries in the table in Robin Hood order
+} HashMapMode;
+
+/**
+ * Number of probe lengths counted separately by HashMapProbeStats
+ */
+#define HASH_MAP_PROBE_HISTOGRAM 16
+
+/**
+ * Probe length statistics of a HashMap. The probe length of a key is
+ * the number of entries compared to find it.
+ */
+typedef struct {
+	int maxProbeLength;					// longest probe length of a key
+	double meanProbeLength;				// mean probe length of the keys
+	int histogram[HASH_MAP_PROBE_HISTOGRAM];  // keys by probe length - 1; last is longer
+} HashMapProbeStats;
+
+/**
+ * Memory used by a HashMap in bytes, not counting allocator overhead
+ * or the keys and values the entries point to.
+ */
+typedef struct {
+	size_t tableBytes;					// the hash table or entry slots
+	size_t entryBytes;					// the hash chain entries
+	size_t filterBytes;					// the BloomFilter, if any
+	size_t indexBytes;					// the ValueIndex, if any
+	size_t overheadBytes;				// the HashMap and BloomFilter structures
+	size_t totalBytes;					// sum of the above
+} HashMapMemoryStats;
+
+/**
+ * The hash table. An optional BloomFilter of the keys answers most
+ * lookups of absent keys without following a hash chain, and an
+ * optional ValueIndex of the values answers value lookups without
+ * scanning the entries.
+ *
+ * In HASH_MAP_ROBIN_HOOD mode, entries are stored in the table slots
+ * with linear probing. An entry being inserted takes the slot of any
+ * entry that is closer to its home slot, which keeps probe lengths short
+ * at high load, and removal shifts later entries back rather than
+ * leaving a deleted marker. A MapEntry returned by a map in this mode
+ * is valid until the next change to the map.
+ *
+ * The table is halved when removal leaves it less than a quarter as
+ * full as the load that makes it grow, so a map that held many entries
+ * for a while gives the memory back, but a map whose size varies by
+ * less than a factor of two is not resized back and forth.
+ */
+typedef struct {
+	HashTableEntry* hashTable;			// the hash table, or NULL in Robin Hood mode
+	HashSlotEntry* slots;				// the entry slots, or NULL in chained mode
+	HashMapMode mode;					// how the entries are stored
 	int capacity;						// the current size of the hash table
 	float loadFactor;					// % full before resizing table
 	int size;							// number of entries in table
+	BloomFilter* filter;				// filter of the entry keys, or NULL
+	ValueIndex* valueIndex;				// index of the entry values, or NULL
 } HashMap;
 
 /**
@@ -46,6 +113,14 @@ typedef struct {
  */
 HashMap* createHashMap(void);
 
+/**
+ * Create new empty HashMap that stores its entries in a given way.
+ *
+ * @param mode how the entries are stored
+ * @return new HashMap
+ */
+HashMap* createHashMapWithMode(HashMapMode mode);
+
 /**
  * Frees a HashMap.
  *
@@ -84,7 +159,7 @@ bool containsHashMapValue(HashMap* map, MapValue* value);
  * @param map the HashMap
  * @return the set of HashMap entries for the map
  */
-MapEntry** getHashMapEntrySet(HashMap* map);
+MapEntry** getHashMapEntries(HashMap* map);
 
 /**
  * Returns the entry to which the specified key is mapped, or null if
@@ -167,4 +242,73 @@ MapValue* removeHashMapEntryForKey(HashMap* map, MapKey key);
  */
 int getHashMapSize(HashMap* map);
 
+/**
+ * Keeps a BloomFilter of the entry keys, which getHashMapEntry() and
+ * removeHashMapEntryForKey() test before following a hash chain.
+ * Lookups that test the filter update its statistics, so a map with a
+ * filter must not be used by more than one thread at a time.
+ *
+ * @param map the HashMap
+ */
+void enableHashMapFilter(HashMap* map);
+
+/**
+ * Discards the BloomFilter of the entry keys, if any.
+ *
+ * @param map the HashMap
+ */
+void disableHashMapFilter(HashMap* map);
+
+/**
+ * Keeps a ValueIndex of the entry values, which containsHashMapValue()
+ * and getHashMapKeysForValue() use instead of scanning the entries. The
+ * valuestr of a value must not change while the value is in the map.
+ *
+ * @param map the HashMap
+ */
+void enableHashMapValueIndex(HashMap* map);
+
+/**
+ * Discards the ValueIndex of the entry values, if any.
+ *
+ * @param map the HashMap
+ */
+void disableHashMapValueIndex(HashMap* map);
+
+/**
+ * Returns the keys that are mapped to the specified value. Caller is
+ * responsible for freeing the set.
+ *
+ * @param map the HashMap
+ * @param value the value
+ * @return a new HashSet of the keys mapped to a value equal to value
+ */
+HashSet* getHashMapKeysForValue(HashMap* map, MapValue* value);
+
+/**
+ * Returns the probe length statistics of the keys in the map.
+ *
+ * @param map the HashMap
+ * @param stats the HashMapProbeStats to fill in
+ */
+void getHashMapProbeStats(HashMap* map, HashMapProbeStats* stats);
+
+/**
+ * Returns the memory used by the map.
+ *
+ * @param map the HashMap
+ * @param stats the HashMapMemoryStats to fill in
+ */
+void getHashMapMemoryStats(HashMap* map, HashMapMemoryStats* stats);
+
+/**
+ * Resizes the table to the smallest capacity that holds the entries
+ * without growing, and resizes the BloomFilter, if any, for the entries.
+ * A MapEntry returned by a map in Robin Hood mode is no longer valid.
+ *
+ * @param map the HashMap
+ * @return the number of bytes released
+ */
+size_t shrinkHashMapToFit(HashMap* map);
+
 #endif /* HASH_MAP_H_ */
@@ -0,0 +1,292 @@
+/*
+ * hash_map_file.c
+ *
+ * This file provides the implementations of a HashMapFile, a read-only
+ * copy of a HashMap in a file that is mapped into memory and queried in
+ * place.
+ *
+ * The file is a header, an open-addressed table of slots with linear
+ * probing that is at most half full, and a pool of the distinct value
+ * strings. Opening a file checks the header, so that a lookup can only
+ * read inside the mapping even if the file is not a valid HashMapFile.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "hash_map_file.h"
+#include "hash_map_iterator.h"
+#include "hash_table_template.h"
+
+DEFINE_HASH_MAP(StringOffsetMap, const char*, uint32_t, hashTemplateString, equalTemplateStrings)
+
+/**
+ * Returns the home slot of a vertex index.
+ *
+ * @param keyIndex the vertex index of the key
+ * @param slotMask the number of slots - 1
+ * @return the slot index
+ */
+static inline int getHashMapFileHomeSlot(int32_t keyIndex, int slotMask) {
+	return (int)mixHashTemplateCode(hashTemplateInt(keyIndex)) & slotMask;
+}
+
+/**
+ * Adds the value strings of the map to a pool, each distinct string once.
+ *
+ * @param slots the slots whose valueOffset is set to the offset of the string
+ * @param values the value of each slot, or NULL
+ * @param slotCount the number of slots
+ * @param size set to the size of the pool in bytes
+ * @return the pool
+ */
+static char* createHashMapFileStrings(HashMapFileSlot* slots, MapValue** values,
+		int slotCount, uint64_t* size) {
+	StringOffsetMap* offsets = createStringOffsetMap();
+	uint64_t capacity = 256;
+	char* strings = (char*)malloc(capacity);
+	assert(strings != (char*)NULL);
+	*size = 0;
+	for (int i = 0; i < slotCount; i++) {
+		if (values[i] == (MapValue*)NULL || values[i]->valuestr == (char*)NULL) {
+			continue;
+		}
+		const char* str = values[i]->valuestr;
+		uint32_t* offset = getStringOffsetMapValue(offsets, str);
+		if (offset != (uint32_t*)NULL) {
+			slots[i].valueOffset = *offset;
+			continue;
+		}
+		uint64_t length = strlen(str) + 1;
+		if (*size + length > capacity) {
+			while (*size + length > capacity) {
+				capacity *= 2;
+			}
+			strings = (char*)realloc(strings, capacity);
+			assert(strings != (char*)NULL);
+		}
+		memcpy(&strings[*size], str, length);
+		slots[i].valueOffset = (uint32_t)*size;
+		putStringOffsetMapEntry(offsets, str, (uint32_t)*size);
+		*size += length;
+	}
+	freeStringOffsetMap(offsets);
+	return strings;
+}
+
+/**
+ * Writes the entries of a map to a HashMapFile. The file is written
+ * under a temporary name and renamed, so processes that open the path
+ * see either the old file or the complete new one.
+ *
+ * @param map the HashMap
+ * @param path the path of the file
+ * @return true if the file was written, false if a key is not in a
+ *   graph or the file could not be written
+ */
+bool writeHashMapFile(HashMap* map, const char* path) {
+	int slotCount = 16;
+	while (slotCount < 2 * map->size) {
+		slotCount *= 2;
+	}
+	int slotMask = slotCount - 1;
+	HashMapFileSlot* slots = (HashMapFileSlot*)malloc(slotCount * sizeof(HashMapFileSlot));
+	MapValue** values = (MapValue**)calloc(slotCount, sizeof(MapValue*));
+	assert(slots != (HashMapFileSlot*)NULL && values != (MapValue**)NULL);
+	for (int i = 0; i < slotCount; i++) {
+		slots[i].keyIndex = -1;
+		slots[i].valueOffset = HASH_MAP_FILE_NO_VALUE;
+	}
+
+	// place each entry by the vertex index of its key
+	bool valid = true;
+	HashMapIterator* itr = createHashMapIterator(map);
+	while (valid && hasNextHashMapEntry(itr)) {
+		MapEntry* entry = getNextHashMapEntry(itr);
+		int32_t keyIndex = entry->key->index;
+		if (keyIndex < 0) {
+			valid = false;
+			break;
+		}
+		int i = getHashMapFileHomeSlot(keyIndex, slotMask);
+		for ( ; valid && slots[i].keyIndex != -1; i = (i+1) & slotMask) {
+			valid = (slots[i].keyIndex != keyIndex);  // keys from different graphs
+		}
+		slots[i].keyIndex = keyIndex;
+		values[i] = entry->value;
+	}
+	freeHashMapIterator(itr);
+	if (!valid) {
+		free(values);
+		free(slots);
+		return false;
+	}
+
+	uint64_t stringsSize;
+	char* strings = createHashMapFileStrings(slots, values, slotCount, &stringsSize);
+	HashMapFileHeader header;
+	memset(&header, 0, sizeof(HashMapFileHeader));
+	memcpy(header.magic, HASH_MAP_FILE_MAGIC, sizeof(header.magic));
+	header.slotCount = (uint32_t)slotCount;
+	header.entryCount = (uint32_t)map->size;
+	header.slotsOffset = sizeof(HashMapFileHeader);
+	header.stringsOffset = header.slotsOffset + slotCount * sizeof(HashMapFileSlot);
+	header.fileSize = header.stringsOffset + stringsSize;
+
+	char* tempPath = (char*)malloc(strlen(path) + 32);
+	sprintf(tempPath, "%s.tmp%ld", path, (long)getpid());
+	FILE* out = fopen(tempPath, "wb");
+	if (out != (FILE*)NULL) {
+		valid = fwrite(&header, sizeof(HashMapFileHeader), 1, out) == 1
+			 && fwrite(slots, sizeof(HashMapFileSlot), slotCount, out) == (size_t)slotCount
+			 && fwrite(strings, 1, stringsSize, out) == stringsSize;
+		valid = (fclose(out) == 0) && valid;
+		valid = valid && rename(tempPath, path) == 0;
+		if (!valid) {
+			unlink(tempPath);
+		}
+	} else {
+		valid = false;
+	}
+	free(tempPath);
+	free(strings);
+	free(values);
+	free(slots);
+	return valid;
+}
+
+/**
+ * Maps a HashMapFile into memory for reading.
+ *
+ * @param path the path of the file
+ * @return a new HashMapFile, or NULL if the file could not be mapped or
+ *   is not a valid HashMapFile
+ */
+HashMapFile* openHashMapFile(const char* path) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return (HashMapFile*)NULL;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(HashMapFileHeader)) {
+		close(fd);
+		return (HashMapFile*)NULL;
+	}
+	size_t size = (size_t)st.st_size;
+	void* base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);  // the mapping stays valid
+	if (base == MAP_FAILED) {
+		return (HashMapFile*)NULL;
+	}
+
+	// check that every lookup stays inside the mapping
+	const HashMapFileHeader* header = (const HashMapFileHeader*)base;
+	uint64_t slotCount = header->slotCount;
+	bool valid = memcmp(header->magic, HASH_MAP_FILE_MAGIC, sizeof(header->magic)) == 0
+		&& header->fileSize == size
+		&& slotCount > 0 && slotCount <= (1U << 30) && (slotCount & (slotCount-1)) == 0
+		&& header->entryCount < slotCount
+		&& header->slotsOffset >= sizeof(HashMapFileHeader)
+		&& header->slotsOffset % sizeof(HashMapFileSlot) == 0
+		&& header->slotsOffset <= size
+		&& header->slotsOffset + slotCount * sizeof(HashMapFileSlot) <= header->stringsOffset
+		&& header->stringsOffset <= size;
+	if (valid && header->stringsOffset < size) {
+		valid = ((const char*)base)[size-1] == '\0';  // the last string is terminated
+	}
+	if (!valid) {
+		munmap(base, size);
+		return (HashMapFile*)NULL;
+	}
+
+	HashMapFile* file = (HashMapFile*)malloc(sizeof(HashMapFile));
+	file->base = base;
+	file->size = size;
+	file->header = header;
+	file->slots = (const HashMapFileSlot*)((const char*)base + header->slotsOffset);
+	file->strings = (const char*)base + header->stringsOffset;
+	file->stringsSize = size - header->stringsOffset;
+	file->slotMask = (int)slotCount - 1;
+	return file;
+}
+
+/**
+ * Unmaps and frees a HashMapFile.
+ *
+ * @param file the HashMapFile to close
+ */
+void closeHashMapFile(HashMapFile* file) {
+	munmap(file->base, file->size);
+	file->base = NULL;
+	file->header = (const HashMapFileHeader*)NULL;
+	file->slots = (const HashMapFileSlot*)NULL;
+	file->strings = (const char*)NULL;
+	free(file);
+}
+
+/**
+ * Returns the number of entries in the file.
+ *
+ * @param file the HashMapFile
+ * @return the number of entries
+ */
+int getHashMapFileSize(HashMapFile* file) {
+	return (int)file->header->entryCount;
+}
+
+/**
+ * Returns the slot of the key.
+ *
+ * @param file the HashMapFile
+ * @param key the entry key to find
+ * @return the slot of the key, or NULL if the file has no entry for the key
+ */
+static const HashMapFileSlot* findHashMapFileSlot(HashMapFile* file, MapKey key) {
+	if (key == (MapKey)NULL || key->index < 0) {
+		return (const HashMapFileSlot*)NULL;
+	}
+	int32_t keyIndex = key->index;
+	int i = getHashMapFileHomeSlot(keyIndex, file->slotMask);
+	// the probe count is bounded in case the file has no empty slot
+	for (int n = 0; n <= file->slotMask && file->slots[i].keyIndex != -1; n++) {
+		if (file->slots[i].keyIndex == keyIndex) {
+			return &file->slots[i];
+		}
+		i = (i+1) & file->slotMask;
+	}
+	return (const HashMapFileSlot*)NULL;
+}
+
+/**
+ * Returns true if the file contains an entry for the key.
+ *
+ * @param file the HashMapFile
+ * @param key the entry key to check
+ * @return true if there is an entry for the key
+ */
+bool containsHashMapFileKey(HashMapFile* file, MapKey key) {
+	return findHashMapFileSlot(file, key) != (const HashMapFileSlot*)NULL;
+}
+
+/**
+ * Returns the valuestr of the value to which the key is mapped, as
+ * getHashMapValue() returns the value. The string is in the mapping and
+ * is valid until the file is closed.
+ *
+ * @param file the HashMapFile
+ * @param key the entry key for the value to get
+ * @return the valuestr for the key, or NULL if the file has no entry for
+ *   the key or its value or valuestr was NULL
+ */
+const char* getHashMapFileValue(HashMapFile* file, MapKey key) {
+	const HashMapFileSlot* slot = findHashMapFileSlot(file, key);
+	if (slot == (const HashMapFileSlot*)NULL || slot->valueOffset >= file->stringsSize) {
+		return (const char*)NULL;
+	}
+	return &file->strings[slot->valueOffset];
+}
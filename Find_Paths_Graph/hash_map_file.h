@@ -0,0 +1,126 @@
+/*
+ * hash_map_file.h
+ *
+ * This file provides the structures and function declarations of a
+ * HashMapFile, a read-only copy of a HashMap in a file that is mapped
+ * into memory and queried in place. Processes that open the same file
+ * share its pages through the page cache, and opening a file does not
+ * rebuild the table.
+ *
+ * The file holds no pointers. A key is stored as the index of its vertex
+ * in the graph, so a file must be queried with vertices of a graph whose
+ * vertices have the same indexes, and a value is stored as the offset of
+ * its valuestr in a pool of null-terminated strings. The numbers in the
+ * file are in the byte order of the writer.
+ */
+
+#ifndef HASH_MAP_FILE_H_
+#define HASH_MAP_FILE_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "hash_map.h"
+
+/**
+ * Identifies a HashMapFile and its format version
+ */
+#define HASH_MAP_FILE_MAGIC "HMAPFIL1"
+
+/**
+ * valueOffset of an entry whose value or valuestr is NULL
+ */
+#define HASH_MAP_FILE_NO_VALUE UINT32_MAX
+
+/**
+ * The header at the start of a HashMapFile. Offsets are from the start
+ * of the file.
+ */
+typedef struct {
+	char magic[8];					// HASH_MAP_FILE_MAGIC
+	uint32_t slotCount;				// number of slots (power of 2)
+	uint32_t entryCount;			// number of entries
+	uint64_t slotsOffset;			// offset of the slots
+	uint64_t stringsOffset;			// offset of the value strings
+	uint64_t fileSize;				// size of the file in bytes
+} HashMapFileHeader;
+
+/**
+ * A slot of the open-addressed table in a HashMapFile
+ */
+typedef struct {
+	int32_t keyIndex;				// vertex index of the key, or -1 if empty
+	uint32_t valueOffset;			// offset of the value string in the pool
+} HashMapFileSlot;
+
+/**
+ * A HashMapFile mapped into memory
+ */
+typedef struct {
+	void* base;						// start of the mapping
+	size_t size;					// size of the mapping in bytes
+	const HashMapFileHeader* header;	// the header
+	const HashMapFileSlot* slots;	// the slots
+	const char* strings;			// the value string pool
+	uint64_t stringsSize;			// size of the string pool in bytes
+	int slotMask;					// number of slots - 1
+} HashMapFile;
+
+/**
+ * Writes the entries of a map to a HashMapFile. The file is written
+ * under a temporary name and renamed, so processes that open the path
+ * see either the old file or the complete new one.
+ *
+ * @param map the HashMap
+ * @param path the path of the file
+ * @return true if the file was written, false if a key is not in a
+ *   graph or the file could not be written
+ */
+bool writeHashMapFile(HashMap* map, const char* path);
+
+/**
+ * Maps a HashMapFile into memory for reading.
+ *
+ * @param path the path of the file
+ * @return a new HashMapFile, or NULL if the file could not be mapped or
+ *   is not a valid HashMapFile
+ */
+HashMapFile* openHashMapFile(const char* path);
+
+/**
+ * Unmaps and frees a HashMapFile.
+ *
+ * @param file the HashMapFile to close
+ */
+void closeHashMapFile(HashMapFile* file);
+
+/**
+ * Returns the number of entries in the file.
+ *
+ * @param file the HashMapFile
+ * @return the number of entries
+ */
+int getHashMapFileSize(HashMapFile* file);
+
+/**
+ * Returns true if the file contains an entry for the key.
+ *
+ * @param file the HashMapFile
+ * @param key the entry key to check
+ * @return true if there is an entry for the key
+ */
+bool containsHashMapFileKey(HashMapFile* file, MapKey key);
+
+/**
+ * Returns the valuestr of the value to which the key is mapped, as
+ * getHashMapValue() returns the value. The string is in the mapping and
+ * is valid until the file is closed.
+ *
+ * @param file the HashMapFile
+ * @param key the entry key for the value to get
+ * @return the valuestr for the key, or NULL if the file has no entry for
+ *   the key or its value or valuestr was NULL
+ */
+const char* getHashMapFileValue(HashMapFile* file, MapKey key);
+
+#endif /* HASH_MAP_FILE_H_ */
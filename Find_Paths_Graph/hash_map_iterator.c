@@ -2,7 +2,14 @@
  * hash_map_iterator.c
  *
  * This file provides the implementations of a HashMapIterator that
- * iterates over a HashMap.
+ * iterates over a HashMap. For a map in Robin Hood mode, hashTableIndex
+ * is the slot after the last entry returned, and hashChainEntry is not
+ * used.
+ *
+ * A prefetching iterator keeps prefetchIndex up to prefetchDistance
+ * table entries ahead of hashTableIndex, prefetching the head of each
+ * hash chain it passes, or the slots in Robin Hood mode, and prefetches
+ * the next entry of the chain it is in.
  *
  * @since 2017-03-22
  * @author philip gust
@@ -12,6 +19,53 @@
 #include <stdbool.h>
 #include "hash_map_iterator.h"
 
+/**
+ * Number of table entries ahead of the current one that a prefetching
+ * iterator prefetches; enough to cover memory latency at a few
+ * nanoseconds per entry
+ */
+#ifndef DEFAULT_HASH_MAP_PREFETCH_DISTANCE
+#define DEFAULT_HASH_MAP_PREFETCH_DISTANCE 16
+#endif
+
+/**
+ * Prefetches memory that an iterator will read.
+ *
+ * @param addr the address to prefetch
+ */
+static inline void prefetchHashMapIteratorData(const void* addr) {
+#if defined(__GNUC__)
+	__builtin_prefetch(addr);
+#else
+	(void)addr;
+#endif
+}
+
+/**
+ * Prefetches the hash chains or slots of the table entries up to the
+ * prefetch distance ahead of the current one.
+ *
+ * @param itr the HashMapIterator
+ */
+static inline void prefetchHashMapIteratorEntries(HashMapIterator* itr) {
+	int end = itr->hashTableIndex + itr->prefetchDistance;
+	if (end > itr->map->capacity) {
+		end = itr->map->capacity;
+	}
+	if (itr->map->mode == HASH_MAP_ROBIN_HOOD) {
+		for ( ; itr->prefetchIndex < end; itr->prefetchIndex++) {
+			prefetchHashMapIteratorData(&itr->map->slots[itr->prefetchIndex]);
+		}
+		return;
+	}
+	HashTableEntry* hashTable = itr->map->hashTable;
+	for ( ; itr->prefetchIndex < end; itr->prefetchIndex++) {
+		HashChainEntry* hashChainHead = hashTable[itr->prefetchIndex].hashChain;
+		if (hashChainHead != (HashChainEntry*)NULL) {
+			prefetchHashMapIteratorData(hashChainHead);
+		}
+	}
+}
 
 /**
  * Create and initialize a new HashMapIterator
@@ -22,6 +76,21 @@
 HashMapIterator* createHashMapIterator(HashMap* map) {
 	HashMapIterator* itr = (HashMapIterator*)malloc(sizeof(HashMapIterator));
  	itr->map = map;
+ 	itr->prefetchDistance = 0;
+	resetHashMapIterator(itr);
+	return itr;
+}
+
+/**
+ * Create and initialize a new HashMapIterator that prefetches the
+ * entries ahead of the one it returns.
+ *
+ * @param map the map
+ * @return a prefetching iterator for the specified hash map
+ */
+HashMapIterator* createPrefetchingHashMapIterator(HashMap* map) {
+	HashMapIterator* itr = createHashMapIterator(map);
+	itr->prefetchDistance = DEFAULT_HASH_MAP_PREFETCH_DISTANCE;
 	resetHashMapIterator(itr);
 	return itr;
 }
@@ -36,6 +105,8 @@ void freeHashMapIterator(HashMapIterator* itr) {
 	itr->hashTableIndex = -1;
 	itr->hashChainEntry = (HashChainEntry*)NULL;
 	itr->count = -1;
+	itr->prefetchDistance = 0;
+	itr->prefetchIndex = -1;
 	free(itr);
 }
 
@@ -50,6 +121,18 @@ MapEntry* getNextHashMapEntry(HashMapIterator* itr) {
 		return (MapEntry*)NULL;
 	}
 
+	if (itr->map->mode == HASH_MAP_ROBIN_HOOD) {
+		HashSlotEntry* slots = itr->map->slots;
+		while (slots[itr->hashTableIndex].probeLength == 0) {
+			itr->hashTableIndex++;
+		}
+		if (itr->prefetchDistance > 0) {
+			prefetchHashMapIteratorEntries(itr);
+		}
+		itr->count++;
+		return &slots[itr->hashTableIndex++].entry;
+	}
+
 	if (itr->hashChainEntry == (HashChainEntry*)NULL) {
 		// pointing off end of entry chain, so need to
 		// search forward in next table entries
@@ -64,15 +147,70 @@ MapEntry* getNextHashMapEntry(HashMapIterator* itr) {
 				break;
 			}
 		}
+		if (itr->prefetchDistance > 0) {
+			prefetchHashMapIteratorEntries(itr);
+		}
 	}
 
 	// return current entry and advance listEntry to next one
 	MapEntry* entry = &itr->hashChainEntry->entry;
 	itr->hashChainEntry = itr->hashChainEntry->nextEntry;
+	if (itr->prefetchDistance > 0 && itr->hashChainEntry != (HashChainEntry*)NULL) {
+		prefetchHashMapIteratorData(itr->hashChainEntry);
+	}
 	itr->count++;
 	return entry;
 }
 
+/**
+ * Gets up to count next entries in the map.
+ *
+ * @param itr the HashMapIterator
+ * @param entries the array to fill with the entries
+ * @param count the size of the array
+ * @return the number of entries filled in, 0 if the iterator is at the
+ *   end of the map
+ */
+int getNextHashMapEntries(HashMapIterator* itr, MapEntry** entries, int count) {
+	int available = itr->map->size - itr->count;
+	if (count > available) {
+		count = available;
+	}
+
+	// each of the count entries exists, so the loops need no end checks
+	if (itr->map->mode == HASH_MAP_ROBIN_HOOD) {
+		HashSlotEntry* slots = itr->map->slots;
+		for (int n = 0; n < count; n++) {
+			while (slots[itr->hashTableIndex].probeLength == 0) {
+				itr->hashTableIndex++;
+			}
+			entries[n] = &slots[itr->hashTableIndex++].entry;
+		}
+		if (itr->prefetchDistance > 0) {
+			prefetchHashMapIteratorEntries(itr);
+		}
+	} else {
+		HashTableEntry* hashTable = itr->map->hashTable;
+		HashChainEntry* hashChainEntry = itr->hashChainEntry;
+		for (int n = 0; n < count; n++) {
+			if (hashChainEntry == (HashChainEntry*)NULL) {
+				do {
+					itr->hashTableIndex++;
+				} while (hashTable[itr->hashTableIndex].hashChain == (HashChainEntry*)NULL);
+				hashChainEntry = hashTable[itr->hashTableIndex].hashChain;
+				if (itr->prefetchDistance > 0) {
+					prefetchHashMapIteratorEntries(itr);
+				}
+			}
+			entries[n] = &hashChainEntry->entry;
+			hashChainEntry = hashChainEntry->nextEntry;
+		}
+		itr->hashChainEntry = hashChainEntry;
+	}
+	itr->count += count;
+	return count;
+}
+
 /**
  * Determines whether there is another entry in the map
  *
@@ -93,6 +231,14 @@ MapEntry* getPrevHashMapEntry(HashMapIterator* itr) {
 	if (!hasPrevHashMapEntry(itr)) {
 		return (MapEntry*)NULL;
 	}
+	if (itr->map->mode == HASH_MAP_ROBIN_HOOD) {
+		HashSlotEntry* slots = itr->map->slots;
+		do {
+			itr->hashTableIndex--;
+		} while (slots[itr->hashTableIndex].probeLength == 0);
+		itr->count--;
+		return &slots[itr->hashTableIndex].entry;
+	}
 	HashTableEntry* hashTable = itr->map->hashTable;
 	if (itr->hashChainEntry == hashTable[itr->hashTableIndex].hashChain) {
 		// pointing to start of entry chain for current entry,
@@ -142,8 +288,13 @@ bool hasPrevHashMapEntry(HashMapIterator* itr) {
  */
 bool resetHashMapIterator(HashMapIterator* itr) {
  	itr->hashTableIndex = 0;
- 	itr->hashChainEntry = itr->map->hashTable[itr->hashTableIndex].hashChain;
+ 	itr->hashChainEntry = (itr->map->mode == HASH_MAP_ROBIN_HOOD)
+ 		? (HashChainEntry*)NULL : itr->map->hashTable[itr->hashTableIndex].hashChain;
  	itr->count = 0;
+ 	itr->prefetchIndex = 0;
+ 	if (itr->prefetchDistance > 0) {
+ 		prefetchHashMapIteratorEntries(itr);
+ 	}
  	return true;
 }
 
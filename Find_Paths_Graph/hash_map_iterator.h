@@ -4,6 +4,11 @@
  * This file provides the structures and function declarations of a
  * HashMapIterator that iterates over a HashMap.
  *
+ * A prefetching iterator issues prefetches for the hash chains of the
+ * table entries ahead of the one it is at, so a scan of the map does not
+ * wait on memory for each chain entry. It is worth using for scans of
+ * the whole map, not for iterations that stop after a few entries.
+ *
  * @since 2017-02-22
  * @author philip gust
  */
@@ -22,6 +27,8 @@ typedef struct {
  	int hashTableIndex;					// current has table index
  	HashChainEntry* hashChainEntry;		// current hash chain entry
  	int count;							// count of entries returned
+ 	int prefetchDistance;				// table entries prefetched ahead, or 0
+ 	int prefetchIndex;					// next table entry to prefetch
 } HashMapIterator;
 
 /**
@@ -32,6 +39,15 @@ typedef struct {
  */
 HashMapIterator* createHashMapIterator(HashMap* map);
 
+/**
+ * Create and initialize a new HashMapIterator that prefetches the
+ * entries ahead of the one it returns.
+ *
+ * @param map the map
+ * @return a prefetching iterator for the specified hash map
+ */
+HashMapIterator* createPrefetchingHashMapIterator(HashMap* map);
+
 /**
  * Freeing iterator storage.
  *
@@ -47,6 +63,17 @@ void freeHashMapIterator(HashMapIterator* itr);
  */
 MapEntry* getNextHashMapEntry(HashMapIterator* itr);
 
+/**
+ * Gets up to count next entries in the map.
+ *
+ * @param itr the HashMapIterator
+ * @param entries the array to fill with the entries
+ * @param count the size of the array
+ * @return the number of entries filled in, 0 if the iterator is at the
+ *   end of the map
+ */
+int getNextHashMapEntries(HashMapIterator* itr, MapEntry** entries, int count);
+
 /**
  * Determines whether there is another entry in the map
  *
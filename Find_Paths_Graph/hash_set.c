@@ -2,7 +2,14 @@
  * tree_set.h
  *
  * This file provides the implementations of a HashSet, which is
- * a Set that is backed by a HashMap.
+ * a Set that is backed by an open-addressed hash table.
+ *
+ * Keys are stored in place rather than in chained map entries, so a
+ * set of pointer keys takes 12 to 24 bytes per key, and a probe reads
+ * the control bytes before any key. Removal shifts the following keys
+ * of the probe sequence back, so no deleted markers are left to
+ * lengthen later probes. An optional BloomFilter of the keys lets most
+ * lookups of absent keys skip the table.
  *
  * @since 2017-03-15
  * @author philip gust
@@ -12,14 +19,78 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
-#include <strings.h>
-#include "hash_map.h"
-#include "hash_set_iterator.h"
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "hash_table_template.h"
+
+/**
+ * Default capacity of a HashSet (power of 2)
+ */
+#define DEFAULT_SET_CAPACITY 16
+
+/**
+ * Largest capacity of a HashSet; the slot index is an int, so the table
+ * does not grow past 2^30 slots (about 805 million keys at 75% load)
+ */
+#define MAX_SET_CAPACITY (1 << 30)
+
+/**
+ * Percentage of slots in use before the table is resized
+ */
+#ifndef DEFAULT_SET_LOAD_PERCENT
+#define DEFAULT_SET_LOAD_PERCENT 75
+#endif
+
+/**
+ * Number of keys scanned by a bulk operation before it is divided among
+ * threads
+ */
+#ifndef HASH_SET_PARALLEL_THRESHOLD
+#define HASH_SET_PARALLEL_THRESHOLD (1 << 17)
+#endif
+
+/**
+ * Number of threads for bulk operations, or 0 for one per processor
+ */
+#ifndef HASH_SET_THREAD_COUNT
+#define HASH_SET_THREAD_COUNT 0
+#endif
+
+/**
+ * Returns the mixed hash code of a key. The slot index is taken from
+ * the low bits and the control tag from the high bits.
+ *
+ * @param key the key
+ * @return the hash code
+ */
+static inline uint64_t getHashSetKeyCode(MapKey key) {
+	return mixHashTemplateCode(hashTemplatePointer(key));
+}
 
 /**
- * The value assigned to all MapEntry value fields
+ * Returns the control byte for a hash code.
+ *
+ * @param code the hash code
+ * @return the control byte
+ */
+static inline uint8_t getHashSetControlTag(uint64_t code) {
+	return (uint8_t)(0x80 | (code >> 57));
+}
+
+/**
+ * Allocates the slot arrays for a capacity.
+ *
+ * @param set the HashSet
+ * @param capacity the number of slots (power of 2)
  */
-static MapValue* ENTRY_VALUE = &(MapValue){""};
+static void allocHashSetSlots(HashSet* set, int capacity) {
+	set->capacity = capacity;
+	set->keys = (MapKey*)malloc(capacity * sizeof(MapKey));
+	set->control = (uint8_t*)calloc(capacity, sizeof(uint8_t));
+	assert(set->keys != (MapKey*)NULL && set->control != (uint8_t*)NULL);
+}
 
 /**
  * Create new empty HashSet.
@@ -28,18 +99,71 @@ static MapValue* ENTRY_VALUE = &(MapValue){""};
  */
 HashSet* createHashSet(void) {
 	HashSet* set = (HashSet*)malloc(sizeof(HashSet));
-	set->map = createHashMap();
+	set->size = 0;
+	set->filter = (BloomFilter*)NULL;
+	allocHashSetSlots(set, DEFAULT_SET_CAPACITY);
+	return set;
+}
+
+/**
+ * Returns the number of slots that holds the specified number of keys
+ * without resizing.
+ *
+ * @param size the number of keys
+ * @return the number of slots (power of 2)
+ */
+static int getHashSetCapacityForSize(int size) {
+	int capacity = DEFAULT_SET_CAPACITY;
+	while (   capacity < MAX_SET_CAPACITY
+		   && (long)size * 100 > (long)capacity * DEFAULT_SET_LOAD_PERCENT) {
+		capacity *= 2;
+	}
+	return capacity;
+}
+
+/**
+ * Create new empty HashSet with room for the specified number of keys
+ * before it must be resized.
+ *
+ * @param size the expected number of keys
+ * @return a new HashSet
+ */
+HashSet* createHashSetWithCapacity(int size) {
+	HashSet* set = (HashSet*)malloc(sizeof(HashSet));
+	set->size = 0;
+	set->filter = (BloomFilter*)NULL;
+	allocHashSetSlots(set, getHashSetCapacityForSize(size));
 	return set;
 }
 
+/**
+ * Create a new HashSet with the keys of the set. The copy has no filter.
+ *
+ * @param set the HashSet
+ * @return a new HashSet
+ */
+HashSet* createHashSetCopy(HashSet* set) {
+	// the slot arrays are copied as they are, without hashing
+	HashSet* copy = (HashSet*)malloc(sizeof(HashSet));
+	copy->size = set->size;
+	copy->filter = (BloomFilter*)NULL;
+	allocHashSetSlots(copy, set->capacity);
+	memcpy(copy->control, set->control, set->capacity * sizeof(uint8_t));
+	memcpy(copy->keys, set->keys, set->capacity * sizeof(MapKey));
+	return copy;
+}
+
 /**
  * Frees a HashSet.
  *
  * @param set the HashSet to free
  */
 void freeHashSet(HashSet* set) {
-	freeHashMap(set->map);
-	set->map = (HashMap*)NULL;
+	disableHashSetFilter(set);
+	free(set->control);
+	free(set->keys);
+	set->control = (uint8_t*)NULL;
+	set->keys = (MapKey*)NULL;
 	free(set);
 }
 
@@ -49,7 +173,254 @@ void freeHashSet(HashSet* set) {
  * @param set the HashSet
  */
 void clearHashSet(HashSet* set) {
-	clearHashMap(set->map);
+	memset(set->control, 0, set->capacity * sizeof(uint8_t));
+	set->size = 0;
+	if (set->filter != (BloomFilter*)NULL) {
+		clearBloomFilter(set->filter, 0);
+	}
+}
+
+/**
+ * Clears the filter and adds the keys of the set, sizing the filter
+ * for twice the current number of keys.
+ *
+ * @param set the HashSet
+ */
+static void rebuildHashSetFilter(HashSet* set) {
+	clearBloomFilter(set->filter, 2 * set->size);
+	for (int i = 0; i < set->capacity; i++) {
+		if (set->control[i] != 0) {
+			addBloomFilterCode(set->filter, getHashSetKeyCode(set->keys[i]));
+		}
+	}
+}
+
+/**
+ * Adds the hash code of a key just added to the set to the filter,
+ * if there is one, and rebuilds the filter if it is full.
+ *
+ * @param set the HashSet
+ * @param code the hash code of the key
+ */
+static inline void addHashSetFilterCode(HashSet* set, uint64_t code) {
+	if (set->filter != (BloomFilter*)NULL) {
+		addBloomFilterCode(set->filter, code);
+		if (isBloomFilterStale(set->filter)) {
+			rebuildHashSetFilter(set);
+		}
+	}
+}
+
+/**
+ * Returns the slot of the key.
+ *
+ * @param set the HashSet
+ * @param key the key to find
+ * @return the slot of the key, or -1 if the key is not in the set
+ */
+static int findHashSetSlot(HashSet* set, MapKey key) {
+	uint64_t code = getHashSetKeyCode(key);
+	uint8_t tag = getHashSetControlTag(code);
+	int mask = set->capacity - 1;
+	for (int i = (int)code & mask; set->control[i] != 0; i = (i+1) & mask) {
+		if (set->control[i] == tag && set->keys[i] == key) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Moves the keys to slot arrays of a new capacity.
+ *
+ * @param set the HashSet
+ * @param newCapacity the new number of slots (power of 2)
+ */
+static void resizeHashSetSlots(HashSet* set, int newCapacity) {
+	MapKey* oldKeys = set->keys;
+	uint8_t* oldControl = set->control;
+	int oldCapacity = set->capacity;
+	allocHashSetSlots(set, newCapacity);
+	int mask = newCapacity - 1;
+	for (int j = 0; j < oldCapacity; j++) {
+		if (oldControl[j] != 0) {
+			int i = (int)getHashSetKeyCode(oldKeys[j]) & mask;
+			while (set->control[i] != 0) {
+				i = (i+1) & mask;
+			}
+			set->control[i] = oldControl[j];
+			set->keys[i] = oldKeys[j];
+		}
+	}
+	free(oldControl);
+	free(oldKeys);
+}
+
+/**
+ * Resizes the set if needed to hold the specified number of keys
+ * without resizing again.
+ *
+ * @param set the HashSet
+ * @param size the number of keys
+ */
+static void reserveHashSetSlots(HashSet* set, int size) {
+	int capacity = getHashSetCapacityForSize(size);
+	if (capacity > set->capacity) {
+		resizeHashSetSlots(set, capacity);
+	}
+}
+
+/**
+ * Adds a key that is known not to be in the set, without resizing.
+ *
+ * @param set the HashSet
+ * @param key the key to add
+ */
+static void addDistinctHashSetKey(HashSet* set, MapKey key) {
+	uint64_t code = getHashSetKeyCode(key);
+	int mask = set->capacity - 1;
+	int i = (int)code & mask;
+	while (set->control[i] != 0) {
+		i = (i+1) & mask;
+	}
+	set->control[i] = getHashSetControlTag(code);
+	set->keys[i] = key;
+	set->size++;
+	addHashSetFilterCode(set, code);
+}
+
+/**
+ * Replaces the keys of the set with distinct keys, in slot arrays sized
+ * for them.
+ *
+ * @param set the HashSet
+ * @param keys the distinct keys
+ * @param count the number of keys
+ */
+static void replaceHashSetKeys(HashSet* set, MapKey* keys, int count) {
+	free(set->control);
+	free(set->keys);
+	set->size = 0;
+	allocHashSetSlots(set, getHashSetCapacityForSize(count));
+	if (set->filter != (BloomFilter*)NULL) {
+		clearBloomFilter(set->filter, 2 * count);
+	}
+	for (int i = 0; i < count; i++) {
+		addDistinctHashSetKey(set, keys[i]);
+	}
+}
+
+/**
+ * Returns true if the set contains the key, testing the filter if there
+ * is one without changing its statistics, so that several threads can
+ * probe the same set.
+ *
+ * @param set the HashSet
+ * @param key the key to find
+ * @return true if the set contains the key
+ */
+static inline bool isHashSetKeyPresent(HashSet* set, MapKey key) {
+	if (set->filter != (BloomFilter*)NULL
+			&& !mayContainBloomFilterCode(set->filter, getHashSetKeyCode(key))) {
+		return false;
+	}
+	return findHashSetSlot(set, key) >= 0;
+}
+
+/**
+ * A range of slots scanned by one thread of a bulk operation
+ */
+typedef struct {
+	HashSet* scanSet;					// the set whose slots are scanned
+	HashSet* probeSet;					// the set probed for each key
+	bool keepPresent;					// keep keys in probeSet, or keys not in it
+	int begin;							// first slot of the range
+	int end;							// end of the range
+	MapKey* keys;						// where the kept keys are written, or NULL
+	int count;							// number of kept keys
+} HashSetScanRange;
+
+/**
+ * Scans a range of slots, and writes or counts the keys that are kept.
+ *
+ * @param arg the HashSetScanRange
+ * @return NULL
+ */
+static void* scanHashSetRange(void* arg) {
+	HashSetScanRange* range = (HashSetScanRange*)arg;
+	HashSet* scanSet = range->scanSet;
+	int count = 0;
+	for (int i = range->begin; i < range->end; i++) {
+		if (scanSet->control[i] != 0
+				&& isHashSetKeyPresent(range->probeSet, scanSet->keys[i]) == range->keepPresent) {
+			if (range->keys != (MapKey*)NULL) {
+				range->keys[count] = scanSet->keys[i];
+			}
+			count++;
+		}
+	}
+	range->count = count;
+	return NULL;
+}
+
+/**
+ * Scans the keys of scanSet, and writes or counts those that are in
+ * probeSet, or those that are not. Large sets are divided among threads
+ * by slot range; each range writes its keys where the occupied slots
+ * before it end, and the ranges are then moved together.
+ *
+ * @param scanSet the set whose keys are scanned
+ * @param probeSet the set probed for each key
+ * @param keepPresent true to keep keys in probeSet, false for keys not in it
+ * @param keys where the kept keys are written, or NULL to count them
+ *   (size >= scanSet size)
+ * @return the number of kept keys
+ */
+static int scanHashSetKeys(HashSet* scanSet, HashSet* probeSet, bool keepPresent, MapKey* keys) {
+	int threadCount = HASH_SET_THREAD_COUNT;
+	if (threadCount <= 0) {
+		threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if (scanSet->size < HASH_SET_PARALLEL_THRESHOLD || threadCount < 2) {
+		HashSetScanRange range = {scanSet, probeSet, keepPresent, 0, scanSet->capacity, keys, 0};
+		scanHashSetRange(&range);
+		return range.count;
+	}
+
+	HashSetScanRange* ranges =
+		(HashSetScanRange*)malloc(threadCount * sizeof(HashSetScanRange));
+	pthread_t* threads = (pthread_t*)malloc(threadCount * sizeof(pthread_t));
+	int offset = 0;
+	for (int t = 0; t < threadCount; t++) {
+		HashSetScanRange* range = &ranges[t];
+		range->scanSet = scanSet;
+		range->probeSet = probeSet;
+		range->keepPresent = keepPresent;
+		range->begin = (int)((long)scanSet->capacity * t / threadCount);
+		range->end = (int)((long)scanSet->capacity * (t+1) / threadCount);
+		range->keys = (MapKey*)NULL;
+		if (keys != (MapKey*)NULL) {
+			range->keys = &keys[offset];
+			for (int i = range->begin; i < range->end; i++) {
+				offset += (scanSet->control[i] != 0);
+			}
+		}
+	}
+	for (int t = 1; t < threadCount; t++) {
+		pthread_create(&threads[t], NULL, scanHashSetRange, &ranges[t]);
+	}
+	scanHashSetRange(&ranges[0]);
+	int count = ranges[0].count;
+	for (int t = 1; t < threadCount; t++) {
+		pthread_join(threads[t], NULL);
+		if (keys != (MapKey*)NULL) {
+			memmove(&keys[count], ranges[t].keys, ranges[t].count * sizeof(MapKey));
+		}
+		count += ranges[t].count;
+	}
+	free(threads);
+	free(ranges);
+	return count;
 }
 
 /**
@@ -60,7 +431,25 @@ void clearHashSet(HashSet* set) {
  * @return true if the key was added, false otherwise
  */
 bool addHashSetKey(HashSet* set, MapKey key) {
-	return putHashMapEntry(set->map, key, ENTRY_VALUE);
+	if (   set->capacity < MAX_SET_CAPACITY
+		&& (long)(set->size+1) * 100 > (long)set->capacity * DEFAULT_SET_LOAD_PERCENT) {
+		resizeHashSetSlots(set, set->capacity * 2);
+	}
+	assert(set->size+1 < set->capacity);  // probes need an empty slot
+	uint64_t code = getHashSetKeyCode(key);
+	uint8_t tag = getHashSetControlTag(code);
+	int mask = set->capacity - 1;
+	int i = (int)code & mask;
+	for ( ; set->control[i] != 0; i = (i+1) & mask) {
+		if (set->control[i] == tag && set->keys[i] == key) {
+			return false;
+		}
+	}
+	set->control[i] = tag;
+	set->keys[i] = key;
+	set->size++;
+	addHashSetFilterCode(set, code);
+	return true;
 }
 
 /**
@@ -71,11 +460,14 @@ bool addHashSetKey(HashSet* set, MapKey key) {
  * @return true if the set was modified as a result of this call
  */
 bool addAllHashSetKeys(HashSet* set, HashSet* otherSet) {
-	if (!containsAllHashSetKeys(set, otherSet)) {
-		putAllHashMapEntries(set->map, otherSet->map);
-		return true;
+	int oldSize = set->size;
+	reserveHashSetSlots(set, set->size + otherSet->size);
+	for (int i = 0; i < otherSet->capacity; i++) {
+		if (otherSet->control[i] != 0) {
+			addHashSetKey(set, otherSet->keys[i]);
+		}
 	}
-	return false;
+	return set->size != oldSize;
 }
 
 /**
@@ -86,7 +478,13 @@ bool addAllHashSetKeys(HashSet* set, HashSet* otherSet) {
  * @return true if the set contains the key, false otherwise
  */
 bool containsHashSetKey(HashSet* set, MapKey key) {
-	return containsHashMapKey(set->map, key);
+	if (set->filter == (BloomFilter*)NULL) {
+		return findHashSetSlot(set, key) >= 0;
+	}
+	bool passed = mayContainBloomFilterCode(set->filter, getHashSetKeyCode(key));
+	bool found = passed && findHashSetSlot(set, key) >= 0;
+	countBloomFilterQuery(set->filter, passed, found);
+	return found;
 }
 
 /**
@@ -97,15 +495,16 @@ bool containsHashSetKey(HashSet* set, MapKey key) {
  * @return true if the set contains all the keys, false otherwise
  */
 bool containsAllHashSetKeys(HashSet* set, HashSet* otherSet) {
-	HashSetIterator* otherItr = createHashSetIterator(otherSet);
-	bool result = true;
-	MapKey* key = getNextHashSetKey(otherItr);
-	while (result && key != (MapKey*)NULL) {
-		result &= containsHashSetKey(set, *key);
-		key = getNextHashSetKey(otherItr);
-	}
-	freeHashSetIterator(otherItr);
-	return result;
+	// a larger set of distinct keys cannot be contained
+	if (otherSet->size > set->size) {
+		return false;
+	}
+	for (int i = 0; i < otherSet->capacity; i++) {
+		if (otherSet->control[i] != 0 && !containsHashSetKey(set, otherSet->keys[i])) {
+			return false;
+		}
+	}
+	return true;
 }
 
 /**
@@ -115,7 +514,7 @@ bool containsAllHashSetKeys(HashSet* set, HashSet* otherSet) {
  * @return the size of the HashSet
  */
 int getHashSetSize(HashSet* set) {
-	return getHashMapSize(set->map);
+	return set->size;
 }
 
 /**
@@ -125,7 +524,35 @@ int getHashSetSize(HashSet* set) {
  * @return true of the set is entry, false otherwise
  */
 bool isHashSetEmpty(HashSet* set) {
-	return isHashMapEmpty(set->map);
+	return set->size == 0;
+}
+
+/**
+ * Removes the key in a slot, and shifts back each following key of the
+ * run that can move closer to its home slot.
+ *
+ * @param set the HashSet
+ * @param i the slot of the key
+ */
+static void removeHashSetSlot(HashSet* set, int i) {
+	int mask = set->capacity - 1;
+	for (int j = (i+1) & mask; set->control[j] != 0; j = (j+1) & mask) {
+		int home = (int)getHashSetKeyCode(set->keys[j]) & mask;
+		// the key at j can move to i if i is between its home and j
+		if (((j - home) & mask) >= ((j - i) & mask)) {
+			set->control[i] = set->control[j];
+			set->keys[i] = set->keys[j];
+			i = j;
+		}
+	}
+	set->control[i] = 0;
+	set->size--;
+	if (set->filter != (BloomFilter*)NULL) {
+		countBloomFilterRemoval(set->filter);
+		if (isBloomFilterStale(set->filter)) {
+			rebuildHashSetFilter(set);
+		}
+	}
 }
 
 /**
@@ -136,52 +563,182 @@ bool isHashSetEmpty(HashSet* set) {
  * @return true if the key was removed, false otherwise
  */
 bool removeHashSetKey(HashSet* set, MapKey key) {
-	return (removeHashMapEntryForKey(set->map, key) != (MapValue*)NULL);
+	if (set->filter != (BloomFilter*)NULL
+			&& !mayContainBloomFilterCode(set->filter, getHashSetKeyCode(key))) {
+		return false;
+	}
+	int i = findHashSetSlot(set, key);
+	if (i < 0) {
+		return false;
+	}
+	removeHashSetSlot(set, i);
+	return true;
 }
 
 /**
  * Removes all elements from this set that are present in the other set.
+ * If the other set is smaller, its keys are removed one at a time;
+ * otherwise the keys of this set not in the other set are kept.
  *
  * @param set the HashSet
  * @param key the entry key to check
  * @return true if the set changed as a result of this call
  */
 bool removeAllHashSetKeys(HashSet* set, HashSet* otherSet) {
-	HashSetIterator* otherItr = createHashSetIterator(otherSet);
-	MapKey* keyptr = getNextHashSetKey(otherItr);
-	bool result = false;
-	while (keyptr != (MapKey*)NULL) {
-		result |= removeHashSetKey(set, *keyptr);
-		keyptr = getNextHashSetKey(otherItr);
-	}
-	freeHashSetIterator(otherItr);
-	return result;
+	int oldSize = set->size;
+	if (otherSet->size < set->size) {
+		for (int i = 0; i < otherSet->capacity; i++) {
+			if (otherSet->control[i] != 0) {
+				removeHashSetKey(set, otherSet->keys[i]);
+			}
+		}
+	} else {
+		MapKey* keys = (MapKey*)malloc((set->size+1) * sizeof(MapKey));
+		int count = scanHashSetKeys(set, otherSet, false, keys);
+		if (count < oldSize) {
+			replaceHashSetKeys(set, keys, count);
+		}
+		free(keys);
+	}
+	return set->size != oldSize;
 }
 
 /**
  * Retains only the elements in this set that are present in the other set.
+ * The keys of the smaller set are probed in the larger set.
  *
  * @param set the HashSet
  * @param key the entry key to check
  * @return true if the set changed as a result of this call
  */
 bool retainAllHashSetKeys(HashSet* set, HashSet* otherSet) {
-	// set of keys in set that are not present in the other set
-	HashSet* removeSet = createHashSet();
-
-	// collect all keys in set that are not present in the other set
-	HashSetIterator* itr = createHashSetIterator(set);
-	MapKey* keyptr = getNextHashSetKey(itr);
-	while (keyptr != (MapKey*)NULL) {
-		if (!containsHashSetKey(otherSet, *keyptr)) {
-			addHashSetKey(removeSet, *keyptr);
-		}
-		keyptr = getNextHashSetKey(itr);
+	// removal moves keys between slots, so collect the kept keys first
+	HashSet* scanSet = (otherSet->size < set->size) ? otherSet : set;
+	HashSet* probeSet = (scanSet == set) ? otherSet : set;
+	MapKey* keys = (MapKey*)malloc((scanSet->size+1) * sizeof(MapKey));
+	int count = scanHashSetKeys(scanSet, probeSet, true, keys);
+	bool result = (count != set->size);
+	if (result) {
+		replaceHashSetKeys(set, keys, count);
 	}
-	freeHashSetIterator(itr);
+	free(keys);
+	return result;
+}
 
-	// remove all keys not present in other set from set
-	bool result = removeAllHashSetKeys(set, removeSet);
-	freeHashSet(removeSet);
+/**
+ * Create a new HashSet with the keys that are in either set.
+ *
+ * @param set the HashSet
+ * @param otherSet the other HashSet
+ * @return a new HashSet
+ */
+HashSet* createHashSetUnion(HashSet* set, HashSet* otherSet) {
+	bool otherLarger = (otherSet->size > set->size);
+	HashSet* result = createHashSetCopy(otherLarger ? otherSet : set);
+	addAllHashSetKeys(result, otherLarger ? set : otherSet);
+	return result;
+}
+
+/**
+ * Create a new HashSet with the keys that are in both sets.
+ *
+ * @param set the HashSet
+ * @param otherSet the other HashSet
+ * @return a new HashSet
+ */
+HashSet* createHashSetIntersection(HashSet* set, HashSet* otherSet) {
+	HashSet* scanSet = (otherSet->size < set->size) ? otherSet : set;
+	HashSet* probeSet = (scanSet == set) ? otherSet : set;
+	MapKey* keys = (MapKey*)malloc((scanSet->size+1) * sizeof(MapKey));
+	int count = scanHashSetKeys(scanSet, probeSet, true, keys);
+	HashSet* result = createHashSetWithCapacity(count);
+	for (int i = 0; i < count; i++) {
+		addDistinctHashSetKey(result, keys[i]);
+	}
+	free(keys);
+	return result;
+}
+
+/**
+ * Create a new HashSet with the keys of the set that are not in the
+ * other set.
+ *
+ * @param set the HashSet
+ * @param otherSet the other HashSet
+ * @return a new HashSet
+ */
+HashSet* createHashSetDifference(HashSet* set, HashSet* otherSet) {
+	if (otherSet->size < set->size) {
+		// copy the set and remove the fewer keys of the other set
+		HashSet* result = createHashSetCopy(set);
+		removeAllHashSetKeys(result, otherSet);
+		return result;
+	}
+	MapKey* keys = (MapKey*)malloc((set->size+1) * sizeof(MapKey));
+	int count = scanHashSetKeys(set, otherSet, false, keys);
+	HashSet* result = createHashSetWithCapacity(count);
+	for (int i = 0; i < count; i++) {
+		addDistinctHashSetKey(result, keys[i]);
+	}
+	free(keys);
 	return result;
 }
+
+/**
+ * Returns the number of keys that are in both sets.
+ *
+ * @param set the HashSet
+ * @param otherSet the other HashSet
+ * @return the size of the intersection
+ */
+int getHashSetIntersectionSize(HashSet* set, HashSet* otherSet) {
+	HashSet* scanSet = (otherSet->size < set->size) ? otherSet : set;
+	HashSet* probeSet = (scanSet == set) ? otherSet : set;
+	return scanHashSetKeys(scanSet, probeSet, true, (MapKey*)NULL);
+}
+
+/**
+ * Returns true if any key is in both sets, such as when the frontiers
+ * of a bidirectional search meet.
+ *
+ * @param set the HashSet
+ * @param otherSet the other HashSet
+ * @return true if the sets have a key in common, false otherwise
+ */
+bool hasCommonHashSetKey(HashSet* set, HashSet* otherSet) {
+	HashSet* scanSet = (otherSet->size < set->size) ? otherSet : set;
+	HashSet* probeSet = (scanSet == set) ? otherSet : set;
+	for (int i = 0; i < scanSet->capacity; i++) {
+		if (scanSet->control[i] != 0 && containsHashSetKey(probeSet, scanSet->keys[i])) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Keeps a BloomFilter of the keys, which containsHashSetKey() and
+ * removeHashSetKey() test before probing the table. Lookups that test
+ * the filter update its statistics, so a set with a filter must not be
+ * used by more than one thread at a time.
+ *
+ * @param set the HashSet
+ */
+void enableHashSetFilter(HashSet* set) {
+	if (set->filter == (BloomFilter*)NULL) {
+		set->filter = createBloomFilter(0);
+		rebuildHashSetFilter(set);
+	}
+}
+
+/**
+ * Discards the BloomFilter of the keys, if any.
+ *
+ * @param set the HashSet
+ */
+void disableHashSetFilter(HashSet* set) {
+	if (set->filter != (BloomFilter*)NULL) {
+		freeBloomFilter(set->filter);
+		set->filter = (BloomFilter*)NULL;
+	}
+}
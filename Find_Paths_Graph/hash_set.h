@@ -2,7 +2,7 @@
  * Hash_map.h
  *
  * This file provides the structures and function declarations of a HashSet,
- * which is a set that is backed by a HashMap
+ * which is a set that is backed by an open-addressed hash table
  *
  * @since 2017-03-15
  * @author philip gust
@@ -13,13 +13,27 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
-#include "hash_map.h"
+#include <stdint.h>
+#include "map_entry.h"
+#include "bloom_filter.h"
 
 /**
  * Structure that defines a HashSet. All entries are private
+ *
+ * The keys are stored in an open-addressed table with linear probing.
+ * Each slot has a control byte that is 0 if the slot is empty, or
+ * 7 bits of the key hash with the high bit set, so most probes of other
+ * keys are rejected without reading the key slot.
+ *
+ * An optional BloomFilter of the keys answers most lookups of absent
+ * keys before the table is probed.
  */
 typedef struct {
-	HashMap* map;
+	MapKey* keys;						// the key slots
+	uint8_t* control;					// 0 if slot empty, else 0x80 | hash tag
+	int capacity;						// number of slots (power of 2)
+	int size;							// number of keys in the set
+	BloomFilter* filter;				// filter of the keys, or NULL
 } HashSet;
 
 /**
@@ -27,6 +41,23 @@ typedef struct {
  */
 HashSet* createHashSet(void);
 
+/**
+ * Create new empty HashSet with room for the specified number of keys
+ * before it must be resized.
+ *
+ * @param size the expected number of keys
+ * @return a new HashSet
+ */
+HashSet* createHashSetWithCapacity(int size);
+
+/**
+ * Create a new HashSet with the keys of the set. The copy has no filter.
+ *
+ * @param set the HashSet
+ * @return a new HashSet
+ */
+HashSet* createHashSetCopy(HashSet* set);
+
 /**
  * Frees a HashSet.
  *
@@ -120,4 +151,68 @@ bool removeAllHashSetKeys(HashSet* set, HashSet* otherSet);
  */
 bool retainAllHashSetKeys(HashSet* set, HashSet* otherSet);
 
+/**
+ * Create a new HashSet with the keys that are in either set.
+ *
+ * @param set the HashSet
+ * @param otherSet the other HashSet
+ * @return a new HashSet
+ */
+HashSet* createHashSetUnion(HashSet* set, HashSet* otherSet);
+
+/**
+ * Create a new HashSet with the keys that are in both sets.
+ *
+ * @param set the HashSet
+ * @param otherSet the other HashSet
+ * @return a new HashSet
+ */
+HashSet* createHashSetIntersection(HashSet* set, HashSet* otherSet);
+
+/**
+ * Create a new HashSet with the keys of the set that are not in the
+ * other set.
+ *
+ * @param set the HashSet
+ * @param otherSet the other HashSet
+ * @return a new HashSet
+ */
+HashSet* createHashSetDifference(HashSet* set, HashSet* otherSet);
+
+/**
+ * Returns the number of keys that are in both sets.
+ *
+ * @param set the HashSet
+ * @param otherSet the other HashSet
+ * @return the size of the intersection
+ */
+int getHashSetIntersectionSize(HashSet* set, HashSet* otherSet);
+
+/**
+ * Returns true if any key is in both sets, such as when the frontiers
+ * of a bidirectional search meet.
+ *
+ * @param set the HashSet
+ * @param otherSet the other HashSet
+ * @return true if the sets have a key in common, false otherwise
+ */
+bool hasCommonHashSetKey(HashSet* set, HashSet* otherSet);
+
+/**
+ * Keeps a BloomFilter of the keys, which containsHashSetKey() and
+ * removeHashSetKey() test before probing the table. Lookups that test
+ * the filter update its statistics, so a set with a filter must not be
+ * used by more than one thread at a time.
+ *
+ * @param set the HashSet
+ */
+void enableHashSetFilter(HashSet* set);
+
+/**
+ * Discards the BloomFilter of the keys, if any.
+ *
+ * @param set the HashSet
+ */
+void disableHashSetFilter(HashSet* set);
+
 #endif /* HASH_SET_H_ */
@@ -21,7 +21,8 @@
  */
 HashSetIterator* createHashSetIterator(HashSet* set) {
 	HashSetIterator* itr = (HashSetIterator*)malloc(sizeof(HashSetIterator));
-	itr->mapIterator = createHashMapIterator(set->map);
+	itr->set = set;
+	resetHashSetIterator(itr);
 	return itr;
 }
 
@@ -31,8 +32,7 @@ HashSetIterator* createHashSetIterator(HashSet* set) {
  * @param itr the HashSetIterator to delete
  */
 void freeHashSetIterator(HashSetIterator* itr) {
-	freeHashMapIterator(itr->mapIterator);
-	itr->mapIterator = (HashMapIterator*)NULL;
+	itr->set = (HashSet*)NULL;
 	free(itr);
 }
 
@@ -43,8 +43,15 @@ void freeHashSetIterator(HashSetIterator* itr) {
  * @return the next key or NULL if iterator is at end the set
  */
 MapKey* getNextHashSetKey(HashSetIterator* itr) {
-	MapEntry* entry = getNextHashMapEntry(itr->mapIterator);
-	return (entry == (MapEntry*)NULL) ? (MapKey*)NULL : &(entry->key);
+	if (!hasNextHashSetKey(itr)) {
+		return (MapKey*)NULL;
+	}
+	// search forward for the next occupied slot
+	while (itr->set->control[itr->slotIndex] == 0) {
+		itr->slotIndex++;
+	}
+	itr->count++;
+	return &itr->set->keys[itr->slotIndex++];
 }
 
 /**
@@ -54,7 +61,7 @@ MapKey* getNextHashSetKey(HashSetIterator* itr) {
  * @return true if there is another key, false otherwise
  */
 bool hasNextHashSetKey(HashSetIterator* itr) {
-	return hasNextHashMapEntry(itr->mapIterator);
+	return itr->count < itr->set->size;
 }
 
 /**
@@ -64,8 +71,15 @@ bool hasNextHashSetKey(HashSetIterator* itr) {
  * @return the previous key or NULL if iterator is at end of list
  */
 MapKey* getPrevHashSetKey(HashSetIterator* itr) {
-	MapEntry* entry = getPrevHashMapEntry(itr->mapIterator);
-	return (entry == (MapEntry*)NULL) ? (MapKey*)NULL : &(entry->key);
+	if (!hasPrevHashSetKey(itr)) {
+		return (MapKey*)NULL;
+	}
+	// search back for the previous occupied slot
+	do {
+		itr->slotIndex--;
+	} while (itr->set->control[itr->slotIndex] == 0);
+	itr->count--;
+	return &itr->set->keys[itr->slotIndex];
 }
 
 /**
@@ -75,7 +89,7 @@ MapKey* getPrevHashSetKey(HashSetIterator* itr) {
  * @return the previous key or NULL if iterator is at beginning of the set
  */
 bool hasPrevHashSetKey(HashSetIterator* itr) {
-	return hasPrevHashMapEntry(itr->mapIterator);
+	return itr->count > 0;
 }
 
 /**
@@ -85,7 +99,9 @@ bool hasPrevHashSetKey(HashSetIterator* itr) {
  * @return true if successful, false if not supported
  */
 bool resetHashSetIterator(HashSetIterator* itr) {
-	return resetHashMapIterator(itr->mapIterator);
+	itr->slotIndex = 0;
+	itr->count = 0;
+	return true;
 }
 
 /**
@@ -95,7 +111,7 @@ bool resetHashSetIterator(HashSetIterator* itr) {
  * @return the number of keys returned so far
  */
 int getHashSetIteratorCount(HashSetIterator* itr) {
-	return getHashMapIteratorCount(itr->mapIterator);
+	return itr->count;
 }
 
 /**
@@ -105,5 +121,5 @@ int getHashSetIteratorCount(HashSetIterator* itr) {
  * @return available number of keys or UNAVAILABLE if cannot perform operation.
  */
 int getHashSetIteratorAvailable(HashSetIterator* itr) {
-	return getHashMapIteratorAvailable(itr->mapIterator);
+	return itr->set->size - itr->count;
 }
@@ -14,13 +14,15 @@
 #include <stdbool.h>
 
 #include "hash_set.h"
-#include "hash_map_iterator.h"
 
 /**
- * An iterator for a HashSet
+ * An iterator for a HashSet. The iterator is positioned between slots:
+ * slots before slotIndex have been passed.
  */
 typedef struct {
-  HashMapIterator* mapIterator;
+	HashSet* set;						// the hash set
+	int slotIndex;						// index of the next slot to examine
+	int count;							// count of keys returned
 } HashSetIterator;
 
 /**
@@ -0,0 +1,327 @@
+/*
+ * hash_table_template.h
+ *
+ * This file provides macros that define hash maps and hash sets
+ * specialized for a key type and value type. Unlike HashMap and HashSet,
+ * whose MapKey and MapValue types are fixed, the generated containers
+ * store keys and values by value, and the hash and equality functions
+ * are inlined into the generated functions.
+ *
+ * DEFINE_HASH_MAP(IdMap, long, double, hashTemplateInt, HASH_TEMPLATE_EQUAL)
+ * defines the type IdMap and the functions createIdMap(), freeIdMap(),
+ * clearIdMap(), getIdMapSize(), isIdMapEmpty(), containsIdMapKey(),
+ * getIdMapValue(), putIdMapEntry(), removeIdMapEntryForKey(), and
+ * getNextIdMapEntry(). DEFINE_HASH_SET(IdSet, long, ...) defines the type
+ * IdSet and the functions createIdSet(), freeIdSet(), clearIdSet(),
+ * getIdSetSize(), isIdSetEmpty(), containsIdSetKey(), addIdSetKey(),
+ * removeIdSetKey(), and getNextIdSetEntry().
+ *
+ * The tables are open addressed with linear probing. Each slot has a
+ * control byte that is 0 if the slot is empty, or 7 bits of the key hash
+ * with the high bit set, so most probes of other keys are rejected
+ * without calling the equality function. Removal shifts the following
+ * keys of the probe sequence back, so no deleted markers are left.
+ */
+
+#ifndef HASH_TABLE_TEMPLATE_H_
+#define HASH_TABLE_TEMPLATE_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#ifndef HASH_TEMPLATE_INITIAL_CAPACITY
+#define HASH_TEMPLATE_INITIAL_CAPACITY 16
+#endif
+
+#ifndef HASH_TEMPLATE_LOAD_PERCENT
+#define HASH_TEMPLATE_LOAD_PERCENT 75
+#endif
+
+/**
+ * Largest capacity of a table; the slot index is an int, so a table
+ * does not grow past 2^30 slots
+ */
+#define HASH_TEMPLATE_MAX_CAPACITY (1 << 30)
+
+/**
+ * Equality of keys that can be compared with ==.
+ */
+#define HASH_TEMPLATE_EQUAL(key1, key2) ((key1) == (key2))
+
+/**
+ * Mixes the bits of a hash code, so that the slot index from the low
+ * bits and the control tag from the high bits are both well distributed
+ * even for hash codes such as small integers or aligned pointers.
+ *
+ * @param hashCode the hash code
+ * @return the mixed hash code
+ */
+static inline uint64_t mixHashTemplateCode(uint64_t hashCode) {
+	hashCode ^= hashCode >> 33;
+	hashCode *= 0xFF51AFD7ED558CCDULL;
+	hashCode ^= hashCode >> 33;
+	return hashCode;
+}
+
+/**
+ * Hash code of an integer key.
+ *
+ * @param key the key
+ * @return the hash code
+ */
+static inline uint64_t hashTemplateInt(long key) {
+	return (uint64_t)key;
+}
+
+/**
+ * Hash code of a pointer key.
+ *
+ * @param key the key
+ * @return the hash code
+ */
+static inline uint64_t hashTemplatePointer(const void* key) {
+	return (uint64_t)(uintptr_t)key;
+}
+
+/**
+ * Hash code of a null-terminated string key (64-bit FNV-1a).
+ *
+ * @param key the key
+ * @return the hash code
+ */
+static inline uint64_t hashTemplateString(const char* key) {
+	uint64_t hashCode = 0xCBF29CE484222325ULL;
+	for ( ; *key != '\0'; key++) {
+		hashCode = (hashCode ^ (unsigned char)*key) * 0x100000001B3ULL;
+	}
+	return hashCode;
+}
+
+/**
+ * Equality of null-terminated string keys.
+ *
+ * @param key1 the first key
+ * @param key2 the second key
+ * @return true if the strings are equal
+ */
+static inline bool equalTemplateStrings(const char* key1, const char* key2) {
+	return strcmp(key1, key2) == 0;
+}
+
+/**
+ * Defines the table type and the functions that are the same for maps
+ * and sets. The entry type name##Entry must have a key field.
+ */
+#define DEFINE_HASH_TABLE_CORE_(name, K, hash, eq)								\
+typedef struct {																\
+	name##Entry* entries;		/* the entry slots */							\
+	uint8_t* control;			/* 0 if slot empty, else 0x80 | hash tag */		\
+	int capacity;				/* number of slots (power of 2) */				\
+	int size;					/* number of entries */							\
+} name;																			\
+																				\
+static inline name* create##name(void) {										\
+	name* table = (name*)malloc(sizeof(name));									\
+	table->capacity = HASH_TEMPLATE_INITIAL_CAPACITY;							\
+	table->size = 0;															\
+	table->entries = (name##Entry*)malloc(table->capacity * sizeof(name##Entry));	\
+	table->control = (uint8_t*)calloc(table->capacity, sizeof(uint8_t));		\
+	assert(table->entries != NULL && table->control != NULL);					\
+	return table;																\
+}																				\
+																				\
+static inline void free##name(name* table) {									\
+	free(table->control);														\
+	free(table->entries);														\
+	table->control = NULL;														\
+	table->entries = NULL;														\
+	free(table);																\
+}																				\
+																				\
+static inline void clear##name(name* table) {									\
+	memset(table->control, 0, table->capacity * sizeof(uint8_t));				\
+	table->size = 0;															\
+}																				\
+																				\
+static inline int get##name##Size(const name* table) {							\
+	return table->size;															\
+}																				\
+																				\
+static inline bool is##name##Empty(const name* table) {							\
+	return table->size == 0;													\
+}																				\
+																				\
+/* returns the slot of the key, or -1 if the key is not in the table */		\
+static inline int find##name##Slot_(const name* table, K key) {				\
+	uint64_t code = mixHashTemplateCode(hash(key));								\
+	uint8_t tag = (uint8_t)(0x80 | (code >> 57));								\
+	int mask = table->capacity - 1;												\
+	for (int i = (int)code & mask; table->control[i] != 0; i = (i+1) & mask) {	\
+		if (table->control[i] == tag && eq(table->entries[i].key, key)) {		\
+			return i;															\
+		}																		\
+	}																			\
+	return -1;																	\
+}																				\
+																				\
+/* moves the entries to slot arrays of the new capacity */						\
+static inline void resize##name##_(name* table, int newCapacity) {				\
+	name##Entry* oldEntries = table->entries;									\
+	uint8_t* oldControl = table->control;										\
+	int oldCapacity = table->capacity;											\
+	table->entries = (name##Entry*)malloc(newCapacity * sizeof(name##Entry));	\
+	table->control = (uint8_t*)calloc(newCapacity, sizeof(uint8_t));			\
+	assert(table->entries != NULL && table->control != NULL);					\
+	table->capacity = newCapacity;												\
+	int mask = newCapacity - 1;													\
+	for (int j = 0; j < oldCapacity; j++) {										\
+		if (oldControl[j] != 0) {												\
+			uint64_t code = mixHashTemplateCode(hash(oldEntries[j].key));		\
+			int i = (int)code & mask;											\
+			while (table->control[i] != 0) {									\
+				i = (i+1) & mask;												\
+			}																	\
+			table->control[i] = oldControl[j];									\
+			table->entries[i] = oldEntries[j];									\
+		}																		\
+	}																			\
+	free(oldControl);															\
+	free(oldEntries);															\
+}																				\
+																				\
+/* returns the slot of the key, adding it if it is not in the table */		\
+static inline int insert##name##Slot_(name* table, K key, bool* added) {		\
+	if (   table->capacity < HASH_TEMPLATE_MAX_CAPACITY							\
+		&& (long)(table->size+1) * 100											\
+		   > (long)table->capacity * HASH_TEMPLATE_LOAD_PERCENT) {				\
+		resize##name##_(table, table->capacity * 2);							\
+	}																			\
+	assert(table->size+1 < table->capacity);  /* probes need an empty slot */	\
+	uint64_t code = mixHashTemplateCode(hash(key));								\
+	uint8_t tag = (uint8_t)(0x80 | (code >> 57));								\
+	int mask = table->capacity - 1;												\
+	int i = (int)code & mask;													\
+	for ( ; table->control[i] != 0; i = (i+1) & mask) {							\
+		if (table->control[i] == tag && eq(table->entries[i].key, key)) {		\
+			*added = false;														\
+			return i;															\
+		}																		\
+	}																			\
+	table->control[i] = tag;													\
+	table->entries[i].key = key;												\
+	table->size++;																\
+	*added = true;																\
+	return i;																	\
+}																				\
+																				\
+/* removes the entry in the slot, shifting back later entries of the run */	\
+static inline void remove##name##Slot_(name* table, int i) {					\
+	int mask = table->capacity - 1;												\
+	for (int j = (i+1) & mask; table->control[j] != 0; j = (j+1) & mask) {		\
+		int home = (int)mixHashTemplateCode(hash(table->entries[j].key)) & mask;	\
+		/* the entry at j can move to i if i is between its home and j */		\
+		if (((j - home) & mask) >= ((j - i) & mask)) {							\
+			table->control[i] = table->control[j];								\
+			table->entries[i] = table->entries[j];								\
+			i = j;																\
+		}																		\
+	}																			\
+	table->control[i] = 0;														\
+	table->size--;																\
+}																				\
+																				\
+static inline name##Entry* getNext##name##Entry(name* table, int* position) {	\
+	for ( ; *position < table->capacity; (*position)++) {						\
+		if (table->control[*position] != 0) {									\
+			return &table->entries[(*position)++];								\
+		}																		\
+	}																			\
+	return NULL;																\
+}
+
+/**
+ * Defines a hash map type name with keys of type K and values of type V,
+ * using the hash function hash(K) returning uint64_t and the equality
+ * function or macro eq(K, K).
+ *
+ * getNext##name##Entry(map, &position) returns the next entry, starting
+ * with position 0, or NULL after the last entry. Entries must not be
+ * added or removed during an iteration.
+ */
+#define DEFINE_HASH_MAP(name, K, V, hash, eq)									\
+typedef struct {																\
+	K key;																		\
+	V value;																	\
+} name##Entry;																	\
+																				\
+DEFINE_HASH_TABLE_CORE_(name, K, hash, eq)										\
+																				\
+static inline bool contains##name##Key(const name* map, K key) {				\
+	return find##name##Slot_(map, key) >= 0;									\
+}																				\
+																				\
+/* returns the value for the key, or NULL if there is none */					\
+static inline V* get##name##Value(const name* map, K key) {						\
+	int i = find##name##Slot_(map, key);										\
+	return (i >= 0) ? &map->entries[i].value : NULL;							\
+}																				\
+																				\
+/* returns true if the key was added, false if its value was replaced */		\
+static inline bool put##name##Entry(name* map, K key, V value) {				\
+	bool added;																	\
+	int i = insert##name##Slot_(map, key, &added);								\
+	map->entries[i].value = value;												\
+	return added;																\
+}																				\
+																				\
+/* returns true if the key was removed, false if it was not in the map */		\
+static inline bool remove##name##EntryForKey(name* map, K key) {				\
+	int i = find##name##Slot_(map, key);										\
+	if (i < 0) {																\
+		return false;															\
+	}																			\
+	remove##name##Slot_(map, i);												\
+	return true;																\
+}
+
+/**
+ * Defines a hash set type name with keys of type K, using the hash
+ * function hash(K) returning uint64_t and the equality function or macro
+ * eq(K, K). Entries hold only the key.
+ *
+ * getNext##name##Entry(set, &position) returns the next entry, starting
+ * with position 0, or NULL after the last entry. Keys must not be added
+ * or removed during an iteration.
+ */
+#define DEFINE_HASH_SET(name, K, hash, eq)										\
+typedef struct {																\
+	K key;																		\
+} name##Entry;																	\
+																				\
+DEFINE_HASH_TABLE_CORE_(name, K, hash, eq)										\
+																				\
+static inline bool contains##name##Key(const name* set, K key) {				\
+	return find##name##Slot_(set, key) >= 0;									\
+}																				\
+																				\
+/* returns true if the key was added, false if it was already in the set */	\
+static inline bool add##name##Key(name* set, K key) {							\
+	bool added;																	\
+	insert##name##Slot_(set, key, &added);										\
+	return added;																\
+}																				\
+																				\
+/* returns true if the key was removed, false if it was not in the set */		\
+static inline bool remove##name##Key(name* set, K key) {						\
+	int i = find##name##Slot_(set, key);										\
+	if (i < 0) {																\
+		return false;															\
+	}																			\
+	remove##name##Slot_(set, i);												\
+	return true;																\
+}
+
+#endif /* HASH_TABLE_TEMPLATE_H_ */
@@ -10,6 +10,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
 #include "map_entry.h"
 
 /**
@@ -53,12 +54,12 @@ int compareMapValue(MapValue* val1, MapValue* val2) {
  * @param key of the MapEntry
  */
 int getMapEntryKeyHashCode(MapKey key) {
-	// reinterpret pointer as a long
-	long l = *(long*)((GraphNodeVertex*)key);
+	// reinterpret pointer as an integer
+	uint64_t l = (uint64_t)(uintptr_t)key;
 
-	// treats the upper and lower halves of the long
-	// as separate values, and combined by XORing
-	int hashCode = (int) ((l >> 32) ^ l);
+	// multiplicative (Fibonacci) hashing spreads the aligned low bits
+	// of the pointer into the bits used to index the table
+	int hashCode = (int) ((l * 0x9E3779B97F4A7C15ULL) >> 32);
 	return hashCode;
 }
 
@@ -27,6 +27,23 @@ NodeGraph* createNodeGraph() {
 	graph->vertexCount = 0;
 	graph->vertexCapacity = INITIAL_NODE_GRAPH_CAPACITY;
 	graph->vertices = (GraphNodeVertex**)malloc(graph->vertexCapacity * sizeof(GraphNodeVertex*));
+	graph->arena = (GraphArena*)NULL;
+	graph->version = 0;
+	return graph;
+}
+
+/**
+ * Create a node graph whose vertices and edge arrays are allocated
+ * from a graph arena. Vertices are allocated in slabs, and edge arrays
+ * from size-classed pools. Freeing or clearing the graph releases the
+ * storage in bulk rather than vertex by vertex.
+ *
+ * @param blockSize the size of arena blocks, or 0 for the default size
+ * @return a new NodeGraph
+ */
+NodeGraph* createNodeGraphWithArena(size_t blockSize) {
+	NodeGraph* graph = createNodeGraph();
+	graph->arena = createGraphArena(blockSize);
 	return graph;
 }
 
@@ -36,7 +53,13 @@ NodeGraph* createNodeGraph() {
  * @param graph the graph to free
  */
 void freeNodeGraph(NodeGraph* graph) {
-	clearNodeGraph(graph);
+	if (graph->arena != (GraphArena*)NULL) {
+		// release arena storage in bulk
+		freeGraphArena(graph->arena);
+		graph->arena = (GraphArena*)NULL;
+	} else {
+		clearNodeGraph(graph);
+	}
 	free(graph->vertices);
 	graph->vertices = (GraphNodeVertex**)NULL;
 	graph->vertexCount = INT_MIN;
@@ -50,11 +73,19 @@ void freeNodeGraph(NodeGraph* graph) {
  * @param graph the graph to free
  */
 void clearNodeGraph(NodeGraph* graph) {
-	for (int i = 0; i < graph->vertexCount; i++) {
-		deleteGraphNodeVertex(graph->vertices[i]);
-		graph->vertices[i] = (GraphNodeVertex*)NULL;
+	if (graph->arena != (GraphArena*)NULL) {
+		// release arena storage in bulk and start a new arena
+		size_t blockSize = graph->arena->blockSize;
+		freeGraphArena(graph->arena);
+		graph->arena = createGraphArena(blockSize);
+	} else {
+		for (int i = 0; i < graph->vertexCount; i++) {
+			deleteGraphNodeVertex(graph->vertices[i]);
+			graph->vertices[i] = (GraphNodeVertex*)NULL;
+		}
 	}
 	graph->vertexCount = 0;
+	graph->version++;
 }
 
 /**
@@ -77,6 +108,17 @@ int getNodeGraphSize(NodeGraph *graph) {
 	return getNodeGraphVertexCount(graph);
 }
 
+/**
+ * Get the mutation version of the graph. The version changes whenever
+ * a vertex or edge of the graph is added or removed.
+ *
+ * @param the node graph
+ * @return the current version of the graph
+ */
+unsigned long getNodeGraphVersion(NodeGraph *graph) {
+	return graph->version;
+}
+
 /**
  * Finds the graph node vertex in the graph
  *
@@ -214,8 +256,12 @@ GraphNodeVertex* addGraphNodeVertexForData(NodeGraph* graph, GraphVertexData dat
 		graph->vertices =
 			(GraphNodeVertex**)realloc(graph->vertices, graph->vertexCapacity * sizeof(GraphNodeVertex*));
 	}
-	GraphNodeVertex* vertex = newGraphNodeVertex(data);
+	GraphNodeVertex* vertex = (graph->arena == (GraphArena*)NULL)
+		? newGraphNodeVertex(data) : newGraphNodeVertexInArena(graph->arena, data);
+	vertex->index = graph->vertexCount;
+	vertex->graph = graph;
 	graph->vertices[graph->vertexCount++] = vertex;
+	graph->version++;
 	return vertex;
 }
 
@@ -242,12 +288,14 @@ bool removeGraphNodeVertex(NodeGraph* graph, GraphNodeVertex* node) {
 			if (foundAt >= 0) {
 				// if past found node vertex, move others down
 				graph->vertices[ig-1] = graph->vertices[ig];
+				graph->vertices[ig-1]->index = ig-1;
 			}
 		}
 	}
 
 	if (foundAt != -1) {
 		graph->vertexCount--;
+		graph->version++;
 
 		// free the node vertex if found
 		deleteGraphNodeVertex(node);
@@ -13,6 +13,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include "graph_node_vertex.h"
+#include "graph_arena.h"
 
 /**
  * Data structure for a NodeGraph
@@ -21,6 +22,8 @@ typedef struct _NodeGraph {
 	GraphNodeVertex** vertices;
 	int vertexCount;
 	int vertexCapacity;
+	GraphArena* arena;		// storage for vertices and edges, or NULL for heap
+	unsigned long version;	// incremented by every change to vertices or edges
 } NodeGraph;
 
 /**
@@ -30,6 +33,17 @@ typedef struct _NodeGraph {
  */
 NodeGraph* createNodeGraph();
 
+/**
+ * Create a node graph whose vertices and edge arrays are allocated
+ * from a graph arena. Vertices are allocated in slabs, and edge arrays
+ * from size-classed pools. Freeing or clearing the graph releases the
+ * storage in bulk rather than vertex by vertex.
+ *
+ * @param blockSize the size of arena blocks, or 0 for the default size
+ * @return a new NodeGraph
+ */
+NodeGraph* createNodeGraphWithArena(size_t blockSize);
+
 /**
  * Free a node graph and its vertices and edges
  */
@@ -56,6 +70,15 @@ int getNodeGraphVertexCount(NodeGraph *graph);
  */
 int getNodeGraphSize(NodeGraph *graph);
 
+/**
+ * Get the mutation version of the graph. The version changes whenever
+ * a vertex or edge of the graph is added or removed.
+ *
+ * @param the node graph
+ * @return the current version of the graph
+ */
+unsigned long getNodeGraphVersion(NodeGraph *graph);
+
 /**
  * Determines whether the graph contains the node vertex.
  *
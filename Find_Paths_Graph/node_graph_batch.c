@@ -0,0 +1,221 @@
+/*
+ * node_graph_batch.c
+ *
+ * This file provides the implementations of a NodeGraphBatch, which
+ * queues edge additions and removals for a NodeGraph and applies them
+ * together when the batch is committed.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "node_graph_batch.h"
+#include "graph_node_vertex_impl.h"
+
+#ifndef DEFAULT_BATCH_CAPACITY
+#define DEFAULT_BATCH_CAPACITY 64
+#endif
+
+/**
+ * Begin a batch of edge changes for the graph.
+ *
+ * @param graph the graph
+ * @return a new NodeGraphBatch
+ */
+NodeGraphBatch* beginNodeGraphBatch(NodeGraph* graph) {
+	NodeGraphBatch* batch = (NodeGraphBatch*)malloc(sizeof(NodeGraphBatch));
+	batch->graph = graph;
+	batch->changeCount = 0;
+	batch->changeCapacity = DEFAULT_BATCH_CAPACITY;
+	batch->changes =
+		(NodeGraphEdgeChange*)malloc(batch->changeCapacity * sizeof(NodeGraphEdgeChange));
+	return batch;
+}
+
+/**
+ * Queue an edge change in the batch.
+ *
+ * @param batch the NodeGraphBatch
+ * @param change the change to queue
+ */
+static void queueNodeGraphEdgeChange(NodeGraphBatch* batch, NodeGraphEdgeChange change) {
+	if (batch->changeCount == batch->changeCapacity) {
+		batch->changeCapacity *= 2;
+		batch->changes = (NodeGraphEdgeChange*)realloc(
+			batch->changes, batch->changeCapacity * sizeof(NodeGraphEdgeChange));
+		assert(batch->changes != (NodeGraphEdgeChange*)NULL);
+	}
+	change.sequence = batch->changeCount;
+	batch->changes[batch->changeCount++] = change;
+}
+
+/**
+ * Queues the addition of an edge from node vertex to the specified node
+ * vertex. The edge is not added if it already exists when the batch is
+ * committed.
+ *
+ * @param batch the NodeGraphBatch
+ * @param node the node vertex
+ * @param toNode the other node vertex
+ * @param edgeData the edge data
+ */
+void addEdgeToNodeGraphBatch(NodeGraphBatch* batch,
+		GraphNodeVertex* node, GraphNodeVertex* toNode, GraphEdgeData edgeData) {
+	queueNodeGraphEdgeChange(batch, (NodeGraphEdgeChange){node, toNode, edgeData, true, 0});
+}
+
+/**
+ * Queues the removal of an edge from node vertex to the specified node
+ * vertex.
+ *
+ * @param batch the NodeGraphBatch
+ * @param node the node vertex
+ * @param toNode the other node vertex
+ */
+void removeEdgeFromNodeGraphBatch(NodeGraphBatch* batch,
+		GraphNodeVertex* node, GraphNodeVertex* toNode) {
+	queueNodeGraphEdgeChange(batch, (NodeGraphEdgeChange){node, toNode, {}, false, 0});
+}
+
+/**
+ * Returns the number of changes queued in the batch.
+ *
+ * @param batch the NodeGraphBatch
+ * @return the number of queued changes
+ */
+int getNodeGraphBatchSize(NodeGraphBatch* batch) {
+	return batch->changeCount;
+}
+
+/**
+ * Compares two edge changes by from vertex, then to vertex, then
+ * the order in which they were queued.
+ *
+ * @param c1 the first NodeGraphEdgeChange
+ * @param c2 the second NodeGraphEdgeChange
+ * @return <0 if c1<c2, =0 if c1=c2, >0 if c1>c2
+ */
+static int compareNodeGraphEdgeChange(const void* c1, const void* c2) {
+	const NodeGraphEdgeChange* change1 = (const NodeGraphEdgeChange*)c1;
+	const NodeGraphEdgeChange* change2 = (const NodeGraphEdgeChange*)c2;
+	if (change1->node != change2->node) {
+		return (change1->node < change2->node) ? -1 : 1;
+	}
+	if (change1->toNode != change2->toNode) {
+		return (change1->toNode < change2->toNode) ? -1 : 1;
+	}
+	return change1->sequence - change2->sequence;
+}
+
+/**
+ * Compares two edge changes by the order in which they were queued.
+ *
+ * @param c1 the first NodeGraphEdgeChange
+ * @param c2 the second NodeGraphEdgeChange
+ * @return <0 if c1<c2, =0 if c1=c2, >0 if c1>c2
+ */
+static int compareNodeGraphEdgeChangeSequence(const void* c1, const void* c2) {
+	return ((const NodeGraphEdgeChange*)c1)->sequence
+		 - ((const NodeGraphEdgeChange*)c2)->sequence;
+}
+
+/**
+ * Applies the queued changes to the graph and frees the batch. The
+ * result is the same as applying the changes one at a time in the order
+ * they were queued, except that remaining edges keep their order and new
+ * edges are appended in queued order. The changes for each vertex are
+ * applied in one pass over its edges with at most one reallocation.
+ *
+ * @param batch the NodeGraphBatch
+ * @return the number of edges added, removed, or given new data
+ */
+int commitNodeGraphBatch(NodeGraphBatch* batch) {
+	NodeGraphEdgeChange* changes = batch->changes;
+	int changeCount = batch->changeCount;
+	qsort(changes, changeCount, sizeof(NodeGraphEdgeChange), compareNodeGraphEdgeChange);
+
+	// scratch arrays sized for the largest group of changes
+	GraphNodeVertex** removeVertices =
+		(GraphNodeVertex**)malloc((changeCount+1) * sizeof(GraphNodeVertex*));
+	NodeGraphEdgeChange* addChanges =
+		(NodeGraphEdgeChange*)malloc((changeCount+1) * sizeof(NodeGraphEdgeChange));
+	GraphNodeEdge* addEdges = (GraphNodeEdge*)malloc((changeCount+1) * sizeof(GraphNodeEdge));
+
+	int edgesChanged = 0;
+	for (int start = 0; start < changeCount; ) {
+		GraphNodeVertex* node = changes[start].node;
+		int removeCount = 0;
+		int addCount = 0;
+		int replaceCount = 0;
+
+		// resolve the final state of each edge changed for this vertex
+		int next = start;
+		for ( ; next < changeCount && changes[next].node == node; ) {
+			GraphNodeVertex* toNode = changes[next].toNode;
+			GraphNodeEdge* edge = getEdgeToGraphNodeVertex(node, toNode);
+			bool present = (edge != (GraphNodeEdge*)NULL);
+			NodeGraphEdgeChange* lastAdd = (NodeGraphEdgeChange*)NULL;
+			for ( ; next < changeCount && changes[next].node == node
+					&& changes[next].toNode == toNode; next++) {
+				if (changes[next].add && !present) {
+					lastAdd = &changes[next];
+					present = true;
+				} else if (!changes[next].add && present) {
+					lastAdd = (NodeGraphEdgeChange*)NULL;
+					present = false;
+				}
+			}
+
+			if (edge != (GraphNodeEdge*)NULL) {
+				if (!present) {
+					removeVertices[removeCount++] = toNode;
+				} else if (lastAdd != (NodeGraphEdgeChange*)NULL) {
+					edge->data = lastAdd->edgeData;  // removed and added again
+					replaceCount++;
+				}
+			} else if (present) {
+				addChanges[addCount++] = *lastAdd;
+			}
+		}
+
+		// new edges are appended in the order they were queued
+		qsort(addChanges, addCount, sizeof(NodeGraphEdgeChange),
+			  compareNodeGraphEdgeChangeSequence);
+		for (int i = 0; i < addCount; i++) {
+			addEdges[i].vertex = addChanges[i].toNode;
+			addEdges[i].data = addChanges[i].edgeData;
+		}
+		if (removeCount > 0 || addCount > 0) {
+			applyGraphNodeEdgeChanges(node, removeVertices, removeCount, addEdges, addCount);
+			edgesChanged += removeCount + addCount;
+		}
+		if (replaceCount > 0) {
+			// new edge data is a change that snapshots and caches must see
+			if (node->graph != (struct _NodeGraph*)NULL) {
+				node->graph->version++;
+			}
+			edgesChanged += replaceCount;
+		}
+		start = next;
+	}
+
+	free(addEdges);
+	free(addChanges);
+	free(removeVertices);
+	abortNodeGraphBatch(batch);
+	return edgesChanged;
+}
+
+/**
+ * Discards the queued changes and frees the batch.
+ *
+ * @param batch the NodeGraphBatch
+ */
+void abortNodeGraphBatch(NodeGraphBatch* batch) {
+	free(batch->changes);
+	batch->changes = (NodeGraphEdgeChange*)NULL;
+	batch->graph = (NodeGraph*)NULL;
+	batch->changeCount = 0;
+	batch->changeCapacity = 0;
+	free(batch);
+}
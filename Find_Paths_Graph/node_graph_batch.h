@@ -0,0 +1,95 @@
+/*
+ * node_graph_batch.h
+ *
+ * This file provides the structures and function declarations of a
+ * NodeGraphBatch, which queues edge additions and removals for a
+ * NodeGraph and applies them together when the batch is committed.
+ */
+
+#ifndef NODE_GRAPH_BATCH_H_
+#define NODE_GRAPH_BATCH_H_
+
+#include <stdbool.h>
+#include "node_graph.h"
+
+/**
+ * A queued edge addition or removal
+ */
+typedef struct {
+	GraphNodeVertex* node;			// the vertex the edge is from
+	GraphNodeVertex* toNode;		// the vertex the edge is to
+	GraphEdgeData edgeData;			// the edge data for an addition
+	bool add;						// true for addition, false for removal
+	int sequence;					// order in which the change was queued
+} NodeGraphEdgeChange;
+
+/**
+ * A batch of edge changes for a graph
+ */
+typedef struct {
+	NodeGraph* graph;				// the graph
+	NodeGraphEdgeChange* changes;	// the queued changes
+	int changeCount;				// number of queued changes
+	int changeCapacity;				// capacity of the changes array
+} NodeGraphBatch;
+
+/**
+ * Begin a batch of edge changes for the graph.
+ *
+ * @param graph the graph
+ * @return a new NodeGraphBatch
+ */
+NodeGraphBatch* beginNodeGraphBatch(NodeGraph* graph);
+
+/**
+ * Queues the addition of an edge from node vertex to the specified node
+ * vertex. The edge is not added if it already exists when the batch is
+ * committed.
+ *
+ * @param batch the NodeGraphBatch
+ * @param node the node vertex
+ * @param toNode the other node vertex
+ * @param edgeData the edge data
+ */
+void addEdgeToNodeGraphBatch(NodeGraphBatch* batch,
+		GraphNodeVertex* node, GraphNodeVertex* toNode, GraphEdgeData edgeData);
+
+/**
+ * Queues the removal of an edge from node vertex to the specified node
+ * vertex.
+ *
+ * @param batch the NodeGraphBatch
+ * @param node the node vertex
+ * @param toNode the other node vertex
+ */
+void removeEdgeFromNodeGraphBatch(NodeGraphBatch* batch,
+		GraphNodeVertex* node, GraphNodeVertex* toNode);
+
+/**
+ * Returns the number of changes queued in the batch.
+ *
+ * @param batch the NodeGraphBatch
+ * @return the number of queued changes
+ */
+int getNodeGraphBatchSize(NodeGraphBatch* batch);
+
+/**
+ * Applies the queued changes to the graph and frees the batch. The
+ * result is the same as applying the changes one at a time in the order
+ * they were queued, except that remaining edges keep their order and new
+ * edges are appended in queued order. The changes for each vertex are
+ * applied in one pass over its edges with at most one reallocation.
+ *
+ * @param batch the NodeGraphBatch
+ * @return the number of edges added, removed, or given new data
+ */
+int commitNodeGraphBatch(NodeGraphBatch* batch);
+
+/**
+ * Discards the queued changes and frees the batch.
+ *
+ * @param batch the NodeGraphBatch
+ */
+void abortNodeGraphBatch(NodeGraphBatch* batch);
+
+#endif /* NODE_GRAPH_BATCH_H_ */
@@ -0,0 +1,407 @@
+/*
+ * node_graph_bench_main.c
+ *
+ * This file provides a benchmark that builds synthetic graphs and
+ * measures build time, BFS and DFS iterator throughput, PageRank time,
+ * weakly connected component time, random walk and 2-hop neighborhood
+ * throughput, path search time with and without a query cache, and peak
+ * memory. Results are written as CSV or JSON records so that runs can be
+ * compared to catch performance regressions. Path search counters and
+ * phase times are also written when compiled with
+ * NODEGRAPH_STATS.
+ *
+ * Usage: node_graph_bench [-g graph] [-n vertices] [-d degree]
+ *                         [-r repeat] [-s seed] [-l layers] [-f csv|json]
+ *
+ *   graph is one of er, rmat, grid, dag, powerlaw, or all (default)
+ *   layers is the number of layers of the path search DAG
+ */
+
+#define _POSIX_C_SOURCE 200112L	// clock_gettime()
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "node_graph.h"
+#include "node_graph_bfs_iterator.h"
+#include "node_graph_dfs_iterator.h"
+#include "node_graph_paths.h"
+#include "node_graph_generators.h"
+#include "node_graph_path_set.h"
+#include "node_graph_rank.h"
+#include "node_graph_components.h"
+#include "node_graph_walks.h"
+#include "node_graph_cache.h"
+#include "node_graph_neighborhood.h"
+
+/**
+ * Benchmark options
+ */
+typedef struct {
+	const char* graph;		// name of graph generator, or "all"
+	int vertices;			// approximate number of vertices
+	int degree;				// average out-degree
+	int repeat;				// number of times to repeat each traversal
+	unsigned long seed;		// random seed
+	int layers;				// layers in the path search DAG
+	bool json;				// true for JSON output, false for CSV
+} BenchOptions;
+
+/** true if no record has been written yet */
+static bool firstRecord = true;
+
+/**
+ * Returns the current time in seconds.
+ *
+ * @return the current monotonic time in seconds
+ */
+static double getTimeSeconds(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Returns the peak resident set size of the process.
+ *
+ * @return the peak resident set size in kilobytes
+ */
+static long getPeakRSSKilobytes(void) {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;  // kilobytes on Linux
+}
+
+/**
+ * Returns the number of edges in the graph.
+ *
+ * @param graph the graph
+ * @return the number of edges
+ */
+static long getNodeGraphEdgeCount(NodeGraph* graph) {
+	long edges = 0;
+	for (int i = 0; i < graph->vertexCount; i++) {
+		edges += graph->vertices[i]->edgeCount;
+	}
+	return edges;
+}
+
+/**
+ * Writes one measurement record.
+ *
+ * @param options the benchmark options
+ * @param name the name of the graph
+ * @param graph the graph measured
+ * @param metric the name of the measurement
+ * @param param the parameter of the measurement, or 0
+ * @param value the measured value
+ * @param unit the unit of the value
+ */
+static void writeRecord(const BenchOptions* options, const char* name, NodeGraph* graph,
+		const char* metric, long param, double value, const char* unit) {
+	int vertices = graph->vertexCount;
+	long edges = getNodeGraphEdgeCount(graph);
+	if (options->json) {
+		printf("%s\n  {\"graph\": \"%s\", \"vertices\": %d, \"edges\": %ld, "
+			   "\"metric\": \"%s\", \"param\": %ld, \"value\": %.6g, \"unit\": \"%s\"}",
+			   firstRecord ? "[" : ",", name, vertices, edges, metric, param, value, unit);
+	} else {
+		if (firstRecord) {
+			printf("graph,vertices,edges,metric,param,value,unit\n");
+		}
+		printf("%s,%d,%ld,%s,%ld,%.6g,%s\n", name, vertices, edges, metric, param, value, unit);
+	}
+	firstRecord = false;
+	fflush(stdout);
+}
+
+/**
+ * Builds the named graph with approximately the specified number of
+ * vertices and average out-degree.
+ *
+ * @param name the name of the graph generator
+ * @param options the benchmark options
+ * @return the graph, or NULL if the name is unknown
+ */
+static NodeGraph* buildBenchGraph(const char* name, const BenchOptions* options) {
+	int n = options->vertices;
+	int d = options->degree;
+	if (strcmp(name, "er") == 0) {
+		return createErdosRenyiNodeGraph(n, (long)n * d, options->seed);
+	} else if (strcmp(name, "rmat") == 0) {
+		int scale = (int)ceil(log2(n));
+		return createRMATNodeGraph(scale, d, 0.57, 0.19, 0.19, options->seed);
+	} else if (strcmp(name, "grid") == 0) {
+		int width = (int)sqrt(n);
+		return createGridNodeGraph(width, n / width);
+	} else if (strcmp(name, "dag") == 0) {
+		int width = (int)sqrt(n);
+		return createLayeredDAGNodeGraph(n / width, width, d, options->seed);
+	} else if (strcmp(name, "powerlaw") == 0) {
+		return createPowerLawNodeGraph(n, (d+1) / 2, options->seed);
+	}
+	return (NodeGraph*)NULL;
+}
+
+/**
+ * Measures BFS iterator throughput from the first vertex of the graph.
+ *
+ * @param graph the graph
+ * @param repeat the number of traversals
+ * @return the number of edges scanned per second
+ */
+static double benchmarkBFS(NodeGraph* graph, int repeat) {
+	long edges = 0;
+	double start = getTimeSeconds();
+	for (int r = 0; r < repeat; r++) {
+		NodeGraphBFSIterator* itr = createNodeGraphBFSIterator(graph, graph->vertices[0]);
+		while (hasNextGraphNodeVertexBFS(itr)) {
+			edges += getNextGraphNodeVertexBFS(itr)->edgeCount;
+		}
+		freeNodeGraphBFSIterator(itr);
+	}
+	return edges / (getTimeSeconds() - start);
+}
+
+/**
+ * Measures DFS iterator throughput from the first vertex of the graph.
+ *
+ * @param graph the graph
+ * @param repeat the number of traversals
+ * @return the number of edges scanned per second
+ */
+static double benchmarkDFS(NodeGraph* graph, int repeat) {
+	long edges = 0;
+	double start = getTimeSeconds();
+	for (int r = 0; r < repeat; r++) {
+		NodeGraphDFSIterator* itr = createNodeGraphDFSIterator(graph, graph->vertices[0]);
+		while (hasNextGraphNodeVertexDFS(itr)) {
+			edges += getNextGraphNodeVertexDFS(itr)->edgeCount;
+		}
+		freeNodeGraphDFSIterator(itr);
+	}
+	return edges / (getTimeSeconds() - start);
+}
+
+/**
+ * Measures uniform random walk throughput with one walk of the default
+ * length from each vertex of the graph.
+ *
+ * @param graph the graph
+ * @param seed the seed of the walks
+ * @return the number of walk steps per second
+ */
+static double benchmarkWalks(NodeGraph* graph, unsigned long seed) {
+	NodeGraphWalker* walker = createNodeGraphWalker(graph, false);
+	NodeGraphWalkOptions walkOptions = NODEGRAPH_WALK_DEFAULTS;
+	walkOptions.seed = seed;
+	int* starts = (int*)malloc(graph->vertexCount * sizeof(int));
+	for (int v = 0; v < graph->vertexCount; v++) {
+		starts[v] = v;
+	}
+	int* walks = (int*)malloc((long)graph->vertexCount * walkOptions.walkLength * sizeof(int));
+	double start = getTimeSeconds();
+	long steps = getNodeGraphWalks(walker, &walkOptions, starts, graph->vertexCount, walks);
+	double elapsed = getTimeSeconds() - start;
+	free(walks);
+	free(starts);
+	freeNodeGraphWalker(walker);
+	return steps / elapsed;
+}
+
+/**
+ * Measures 2-hop neighborhood expansion around single seeds spread over
+ * the vertices of the graph, reusing one neighborhood.
+ *
+ * @param graph the graph
+ * @param repeat the number of seeds in thousands
+ * @return the number of expansions per second
+ */
+static double benchmarkNeighborhoods(NodeGraph* graph, int repeat) {
+	NodeGraphNeighborhood* neighborhood = createNodeGraphNeighborhood(graph);
+	int seedCount = 1000 * repeat;
+	double start = getTimeSeconds();
+	for (int i = 0; i < seedCount; i++) {
+		GraphNodeVertex* seed = graph->vertices[(int)((long)i * 7919 % graph->vertexCount)];
+		expandNodeGraphNeighborhood(neighborhood, &seed, 1, 2);
+	}
+	double elapsed = getTimeSeconds() - start;
+	freeNodeGraphNeighborhood(neighborhood);
+	return seedCount / elapsed;
+}
+
+/**
+ * Builds the named graph and writes its build, traversal, and memory
+ * measurements.
+ *
+ * @param name the name of the graph generator
+ * @param options the benchmark options
+ * @return true if the graph was measured, false if the name is unknown
+ */
+static bool benchmarkGraph(const char* name, const BenchOptions* options) {
+	double start = getTimeSeconds();
+	NodeGraph* graph = buildBenchGraph(name, options);
+	if (graph == (NodeGraph*)NULL) {
+		return false;
+	}
+	writeRecord(options, name, graph, "build", 0, getTimeSeconds() - start, "s");
+	writeRecord(options, name, graph, "bfs", 0, benchmarkBFS(graph, options->repeat), "edges/s");
+	writeRecord(options, name, graph, "dfs", 0, benchmarkDFS(graph, options->repeat), "edges/s");
+
+	double* rank = (double*)malloc(graph->vertexCount * sizeof(double));
+	NodeGraphCSR* transposed = createTransposedNodeGraphCSR(graph);
+	start = getTimeSeconds();
+	int iterations = getNodeGraphCSRPageRank(transposed, NULL, NULL, rank);
+	double elapsed = getTimeSeconds() - start;
+	writeRecord(options, name, graph, "pagerank", iterations, elapsed, "s");
+	writeRecord(options, name, graph, "pagerank_spmv", iterations,
+				transposed->edgeCount * (double)iterations / elapsed, "edges/s");
+	freeNodeGraphCSR(transposed);
+	free(rank);
+
+	int* component = (int*)malloc(graph->vertexCount * sizeof(int));
+	start = getTimeSeconds();
+	int componentCount = getNodeGraphWeakComponents(graph, 0, component);
+	writeRecord(options, name, graph, "components", componentCount, getTimeSeconds() - start, "s");
+	free(component);
+
+	writeRecord(options, name, graph, "walks", 0, benchmarkWalks(graph, options->seed), "steps/s");
+	writeRecord(options, name, graph, "khop", 2,
+				benchmarkNeighborhoods(graph, options->repeat), "seeds/s");
+	writeRecord(options, name, graph, "peak_rss", 0, getPeakRSSKilobytes(), "KB");
+	freeNodeGraph(graph);
+	return true;
+}
+
+/**
+ * Measures getNodeGraphPaths() between the first and last vertex of a
+ * layered DAG of width 2 with every edge between adjacent layers, which
+ * has 2^(layers-2) paths, at increasing values of maxPaths.
+ *
+ * @param options the benchmark options
+ */
+static void benchmarkPaths(const BenchOptions* options) {
+	NodeGraph* graph = createLayeredDAGNodeGraph(options->layers, 2, 2, options->seed);
+	GraphNodeVertex* fromVertex = graph->vertices[0];
+	GraphNodeVertex* toVertex = graph->vertices[graph->vertexCount-1];
+	for (int maxPaths = 1; maxPaths <= 10000; maxPaths *= 10) {
+		GraphNodeVertex*** paths =
+			(GraphNodeVertex***)malloc((maxPaths+1) * sizeof(GraphNodeVertex**));
+		int pathCount = 0;
+		long pathBytes = 0;
+		NodeGraphStats stats;
+		double start = getTimeSeconds();
+		for (int r = 0; r < options->repeat; r++) {
+			pathCount = getNodeGraphPathsWithStats(fromVertex, toVertex, paths, maxPaths, &stats);
+			pathBytes = (maxPaths+1) * sizeof(GraphNodeVertex**);
+			for (int i = 0; paths[i] != NULL; i++) {
+				for (int j = 0; paths[i][j] != NULL; j++) {
+					pathBytes += sizeof(GraphNodeVertex*);
+				}
+				pathBytes += sizeof(GraphNodeVertex*);
+				free(paths[i]);
+			}
+		}
+		double elapsed = (getTimeSeconds() - start) / options->repeat;
+		writeRecord(options, "paths", graph, "paths_time", maxPaths, elapsed, "s");
+		writeRecord(options, "paths", graph, "paths_found", maxPaths, pathCount, "paths");
+		writeRecord(options, "paths", graph, "paths_bytes", maxPaths, pathBytes, "bytes");
+
+		// same search storing the paths as a prefix trie
+		NodeGraphPathSet* pathSet = createNodeGraphPathSet();
+		start = getTimeSeconds();
+		for (int r = 0; r < options->repeat; r++) {
+			getNodeGraphPathSet(fromVertex, toVertex, pathSet, maxPaths);
+		}
+		elapsed = (getTimeSeconds() - start) / options->repeat;
+		writeRecord(options, "paths", graph, "path_set_time", maxPaths, elapsed, "s");
+		writeRecord(options, "paths", graph, "path_set_bytes", maxPaths,
+					getNodeGraphPathSetStorageSize(pathSet), "bytes");
+		freeNodeGraphPathSet(pathSet);
+
+		// same query repeated through a cache, after the first computes it
+		NodeGraphQueryCache* cache = createNodeGraphQueryCache(graph, 16);
+		start = getTimeSeconds();
+		for (int r = 0; r <= options->repeat; r++) {
+			getCachedNodeGraphPaths(cache, fromVertex, toVertex, paths, maxPaths);
+			for (int i = 0; paths[i] != NULL; i++) {
+				free(paths[i]);
+			}
+			if (r == 0) {
+				start = getTimeSeconds();
+			}
+		}
+		elapsed = (getTimeSeconds() - start) / options->repeat;
+		writeRecord(options, "paths", graph, "paths_cached_time", maxPaths, elapsed, "s");
+		freeNodeGraphQueryCache(cache);
+		if (isNodeGraphStatsEnabled()) {
+			// stats of the last repetition
+			writeRecord(options, "paths", graph, "paths_expanded", maxPaths,
+						stats.verticesExpanded, "vertices");
+			writeRecord(options, "paths", graph, "paths_scanned", maxPaths,
+						stats.edgesScanned, "edges");
+			writeRecord(options, "paths", graph, "paths_search_time", maxPaths,
+						stats.phaseSeconds[NODEGRAPH_PHASE_SEARCH], "s");
+			writeRecord(options, "paths", graph, "paths_output_time", maxPaths,
+						stats.phaseSeconds[NODEGRAPH_PHASE_OUTPUT], "s");
+		}
+		free(paths);
+	}
+	writeRecord(options, "paths", graph, "peak_rss", 0, getPeakRSSKilobytes(), "KB");
+	freeNodeGraph(graph);
+}
+
+/**
+ * Main program to run the benchmark
+ *
+ * @return the exit status of the program
+ */
+int main(int argc, char* argv[]) {
+	BenchOptions options = {"all", 100000, 8, 3, 2017, 16, false};
+	int opt;
+	while ((opt = getopt(argc, argv, "g:n:d:r:s:l:f:")) != -1) {
+		switch (opt) {
+		case 'g': options.graph = optarg; break;
+		case 'n': options.vertices = atoi(optarg); break;
+		case 'd': options.degree = atoi(optarg); break;
+		case 'r': options.repeat = atoi(optarg); break;
+		case 's': options.seed = strtoul(optarg, NULL, 10); break;
+		case 'l': options.layers = atoi(optarg); break;
+		case 'f': options.json = (strcmp(optarg, "json") == 0); break;
+		default:
+			fprintf(stderr, "usage: %s [-g graph] [-n vertices] [-d degree] "
+					"[-r repeat] [-s seed] [-l layers] [-f csv|json]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (options.vertices < 4 || options.degree < 1 || options.repeat < 1 || options.layers < 2) {
+		fprintf(stderr, "%s: invalid option value\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	const char* names[] = {"er", "rmat", "grid", "dag", "powerlaw"};
+	bool all = (strcmp(options.graph, "all") == 0);
+	bool found = all;
+	for (int i = 0; i < 5; i++) {
+		if (all || strcmp(options.graph, names[i]) == 0) {
+			found = benchmarkGraph(names[i], &options);
+		}
+	}
+	if (all || strcmp(options.graph, "paths") == 0) {
+		benchmarkPaths(&options);
+		found = true;
+	}
+	if (options.json && !firstRecord) {
+		printf("\n]\n");
+	}
+	if (!found) {
+		fprintf(stderr, "%s: unknown graph %s\n", argv[0], options.graph);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
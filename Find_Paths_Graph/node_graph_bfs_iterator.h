@@ -14,6 +14,7 @@
 #include "array_queue.h"
 #include "node_graph.h"
 #include "hash_set.h"
+#include "node_graph_stats.h"
 
 typedef struct {
 	NodeGraph* graph;
@@ -21,6 +22,9 @@ typedef struct {
 	GraphNodeVertex* startNodeVertex;
 	HashSet* visited;
 	int count;
+#ifdef NODEGRAPH_STATS
+	NodeGraphStats stats;		// traversal stats
+#endif
 } NodeGraphBFSIterator;
 
 /**
@@ -100,4 +104,13 @@ int getNodeGraphBFSIteratorCount(NodeGraphBFSIterator* itr);
  */
 int getNodeGraphBFSIteratorAvailable(NodeGraphBFSIterator* itr);
 
+/**
+ * Returns the traversal stats of the iterator. The stats are recorded
+ * only if compiled with NODEGRAPH_STATS, and are cleared on reset.
+ *
+ * @param itr the NodeGraphBFSIterator
+ * @return the stats for the traversal so far
+ */
+const NodeGraphStats* getNodeGraphBFSIteratorStats(NodeGraphBFSIterator* itr);
+
 #endif /* NODE_GRAPH_BFS_ITERATOR_H_ */
@@ -0,0 +1,300 @@
+/*
+ * node_graph_cache.c
+ *
+ * This file provides the implementations of a NodeGraphQueryCache, a
+ * bounded cache of path and reachability query results for a NodeGraph.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include "node_graph_cache.h"
+#include "node_graph_paths.h"
+
+/** maxPaths of a reachability query */
+#define REACHABILITY_QUERY -1
+
+/**
+ * Create a query cache for the graph.
+ *
+ * @param graph the graph
+ * @param capacity the maximum number of cached results
+ * @return a new NodeGraphQueryCache
+ */
+NodeGraphQueryCache* createNodeGraphQueryCache(NodeGraph* graph, int capacity) {
+	NodeGraphQueryCache* cache = (NodeGraphQueryCache*)malloc(sizeof(NodeGraphQueryCache));
+	cache->graph = graph;
+	cache->version = graph->version;
+	cache->capacity = (capacity > 0) ? capacity : 1;
+	cache->entries =
+		(NodeGraphCacheEntry*)malloc(cache->capacity * sizeof(NodeGraphCacheEntry));
+	cache->entryCount = 0;
+	cache->hand = 0;
+
+	// at least two buckets per entry keeps chains short
+	int bucketCount = 2;
+	while (bucketCount < 2 * cache->capacity) {
+		bucketCount <<= 1;
+	}
+	cache->buckets = (int*)malloc(bucketCount * sizeof(int));
+	assert(cache->entries != (NodeGraphCacheEntry*)NULL && cache->buckets != (int*)NULL);
+	memset(cache->buckets, -1, bucketCount * sizeof(int));
+	cache->bucketMask = bucketCount - 1;
+	cache->dfs = (NodeGraphDFS*)NULL;
+	memset(&cache->stats, 0, sizeof(NodeGraphQueryCacheStats));
+	return cache;
+}
+
+/**
+ * Discards the results in the cache. The statistics are not changed.
+ *
+ * @param cache the NodeGraphQueryCache
+ */
+void clearNodeGraphQueryCache(NodeGraphQueryCache* cache) {
+	for (int i = 0; i < cache->entryCount; i++) {
+		free(cache->entries[i].paths);
+	}
+	cache->entryCount = 0;
+	cache->hand = 0;
+	memset(cache->buckets, -1, (cache->bucketMask+1) * sizeof(int));
+}
+
+/**
+ * Frees a query cache and its results.
+ *
+ * @param cache the NodeGraphQueryCache to free
+ */
+void freeNodeGraphQueryCache(NodeGraphQueryCache* cache) {
+	clearNodeGraphQueryCache(cache);
+	if (cache->dfs != (NodeGraphDFS*)NULL) {
+		freeNodeGraphDFS(cache->dfs);
+	}
+	free(cache->buckets);
+	free(cache->entries);
+	cache->dfs = (NodeGraphDFS*)NULL;
+	cache->buckets = (int*)NULL;
+	cache->entries = (NodeGraphCacheEntry*)NULL;
+	cache->graph = (NodeGraph*)NULL;
+	free(cache);
+}
+
+/**
+ * Returns the hash bucket of a query.
+ *
+ * @param cache the NodeGraphQueryCache
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param maxPaths the maximum number of paths, or -1 for reachability
+ * @return the bucket index
+ */
+static int getQueryBucket(NodeGraphQueryCache* cache,
+		GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex, int maxPaths) {
+	uint64_t h = (uint64_t)(uintptr_t)fromVertex * 0x9E3779B97F4A7C15ULL;
+	h ^= (uint64_t)(uintptr_t)toVertex * 0xC2B2AE3D27D4EB4FULL;
+	h ^= (uint64_t)(unsigned)maxPaths * 0x165667B19E3779F9ULL;
+	h ^= h >> 32;
+	return (int)(h & (uint64_t)cache->bucketMask);
+}
+
+/**
+ * Finds the entry for a query, first discarding all entries if the graph
+ * has changed since they were computed. Counts a hit or a miss.
+ *
+ * @param cache the NodeGraphQueryCache
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param maxPaths the maximum number of paths, or -1 for reachability
+ * @return the entry, or NULL if the query is not cached
+ */
+static NodeGraphCacheEntry* findQueryEntry(NodeGraphQueryCache* cache,
+		GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex, int maxPaths) {
+	if (cache->version != cache->graph->version) {
+		if (cache->entryCount > 0) {
+			clearNodeGraphQueryCache(cache);
+			cache->stats.invalidations++;
+		}
+		cache->version = cache->graph->version;
+	}
+	int bucket = getQueryBucket(cache, fromVertex, toVertex, maxPaths);
+	for (int i = cache->buckets[bucket]; i >= 0; i = cache->entries[i].next) {
+		NodeGraphCacheEntry* entry = &cache->entries[i];
+		if (entry->fromVertex == fromVertex && entry->toVertex == toVertex
+				&& entry->maxPaths == maxPaths) {
+			entry->referenced = true;
+			cache->stats.hits++;
+			return entry;
+		}
+	}
+	cache->stats.misses++;
+	return (NodeGraphCacheEntry*)NULL;
+}
+
+/**
+ * Removes an entry from its hash chain.
+ *
+ * @param cache the NodeGraphQueryCache
+ * @param index the entry index
+ */
+static void unlinkQueryEntry(NodeGraphQueryCache* cache, int index) {
+	NodeGraphCacheEntry* entry = &cache->entries[index];
+	int* link = &cache->buckets[
+		getQueryBucket(cache, entry->fromVertex, entry->toVertex, entry->maxPaths)];
+	while (*link != index) {
+		link = &cache->entries[*link].next;
+	}
+	*link = entry->next;
+}
+
+/**
+ * Adds an entry for a query, replacing the first entry the clock hand
+ * finds that has not been used since the hand last passed it.
+ *
+ * @param cache the NodeGraphQueryCache
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param maxPaths the maximum number of paths, or -1 for reachability
+ * @param result the result of the query
+ * @return the new entry
+ */
+static NodeGraphCacheEntry* addQueryEntry(NodeGraphQueryCache* cache,
+		GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex, int maxPaths, int result) {
+	int index;
+	if (cache->entryCount < cache->capacity) {
+		index = cache->entryCount++;
+	} else {
+		while (cache->entries[cache->hand].referenced) {
+			cache->entries[cache->hand].referenced = false;
+			cache->hand = (cache->hand + 1) % cache->capacity;
+		}
+		index = cache->hand;
+		cache->hand = (cache->hand + 1) % cache->capacity;
+		unlinkQueryEntry(cache, index);
+		free(cache->entries[index].paths);
+		cache->stats.evictions++;
+	}
+
+	NodeGraphCacheEntry* entry = &cache->entries[index];
+	int bucket = getQueryBucket(cache, fromVertex, toVertex, maxPaths);
+	entry->fromVertex = fromVertex;
+	entry->toVertex = toVertex;
+	entry->maxPaths = maxPaths;
+	entry->result = result;
+	entry->paths = (GraphNodeVertex**)NULL;
+	entry->referenced = false;
+	entry->next = cache->buckets[bucket];
+	cache->buckets[bucket] = index;
+	return entry;
+}
+
+/**
+ * Return up to maxPaths paths between the initial fromNode and the
+ * final toNode in the graph, as getNodeGraphPaths() does, from the cache
+ * if the same query was made for the current version of the graph. The
+ * allocated path arrays must be freed when no longer needed.
+ *
+ * @param cache the NodeGraphQueryCache
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param paths an array of pointers to null-terminated path arrays
+ *   where up to maxPaths paths will be returned (size must be maxPaths+1)
+ * @param maxPaths the maximum number of paths to return
+ * @return the total number of paths available from fromVertex to
+ *   toVertex; may be greater than maxPaths
+ */
+int getCachedNodeGraphPaths(NodeGraphQueryCache* cache,
+		GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
+		GraphNodeVertex*** paths, int maxPaths) {
+	NodeGraphCacheEntry* entry = findQueryEntry(cache, fromVertex, toVertex, maxPaths);
+	if (entry == (NodeGraphCacheEntry*)NULL) {
+		int count = getNodeGraphPaths(fromVertex, toVertex, paths, maxPaths);
+
+		// keep the returned paths back to back, each null-terminated
+		int length = 0;
+		for (int i = 0; paths[i] != (GraphNodeVertex**)NULL; i++) {
+			for (int j = 0; paths[i][j] != (GraphNodeVertex*)NULL; j++) {
+				length++;
+			}
+			length++;
+		}
+		entry = addQueryEntry(cache, fromVertex, toVertex, maxPaths, count);
+		entry->paths = (GraphNodeVertex**)malloc((length+1) * sizeof(GraphNodeVertex*));
+		assert(entry->paths != (GraphNodeVertex**)NULL);
+		GraphNodeVertex** next = entry->paths;
+		for (int i = 0; paths[i] != (GraphNodeVertex**)NULL; i++) {
+			int j = 0;
+			do {
+				*next++ = paths[i][j];
+			} while (paths[i][j++] != (GraphNodeVertex*)NULL);
+		}
+		return count;
+	}
+
+	int pathCount = (entry->result < maxPaths) ? entry->result : maxPaths;
+	GraphNodeVertex** path = entry->paths;
+	for (int i = 0; i < pathCount; i++) {
+		int size = 0;
+		while (path[size] != (GraphNodeVertex*)NULL) {
+			size++;
+		}
+		paths[i] = (GraphNodeVertex**)malloc((size+1) * sizeof(GraphNodeVertex*));
+		memcpy(paths[i], path, (size+1) * sizeof(GraphNodeVertex*));
+		path += size+1;
+	}
+	paths[pathCount] = (GraphNodeVertex**)NULL;
+	return entry->result;
+}
+
+/**
+ * Determines whether there is a path from one vertex to another, from
+ * the cache if the same query was made for the current version of the
+ * graph.
+ *
+ * @param cache the NodeGraphQueryCache
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @return true if toVertex is reachable from fromVertex
+ */
+bool isCachedNodeGraphVertexReachable(NodeGraphQueryCache* cache,
+		GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex) {
+	NodeGraphCacheEntry* entry =
+		findQueryEntry(cache, fromVertex, toVertex, REACHABILITY_QUERY);
+	if (entry != (NodeGraphCacheEntry*)NULL) {
+		return entry->result != 0;
+	}
+
+	// depth-first search that stops when toVertex is discovered
+	if (cache->dfs == (NodeGraphDFS*)NULL) {
+		cache->dfs = createNodeGraphDFS(cache->graph);
+	}
+	resetNodeGraphDFS(cache->dfs);
+	bool reachable = false;
+	NodeGraphDFSEvent event;
+	startNodeGraphDFS(cache->dfs, fromVertex);
+	while (!reachable && getNextNodeGraphDFSEvent(cache->dfs, &event)) {
+		reachable = (event.type == NODEGRAPH_DFS_DISCOVER && event.vertex == toVertex);
+	}
+	addQueryEntry(cache, fromVertex, toVertex, REACHABILITY_QUERY, reachable ? 1 : 0);
+	return reachable;
+}
+
+/**
+ * Returns the statistics of the cache.
+ *
+ * @param cache the NodeGraphQueryCache
+ * @param stats the NodeGraphQueryCacheStats to fill in
+ */
+void getNodeGraphQueryCacheStats(NodeGraphQueryCache* cache, NodeGraphQueryCacheStats* stats) {
+	*stats = cache->stats;
+}
+
+/**
+ * Returns the fraction of queries answered from the cache.
+ *
+ * @param cache the NodeGraphQueryCache
+ * @return the hit rate, or 0 if there have been no queries
+ */
+double getNodeGraphQueryCacheHitRate(NodeGraphQueryCache* cache) {
+	long queries = cache->stats.hits + cache->stats.misses;
+	return (queries > 0) ? cache->stats.hits / (double)queries : 0.0;
+}
@@ -0,0 +1,130 @@
+/*
+ * node_graph_cache.h
+ *
+ * This file provides the structures and function declarations of a
+ * NodeGraphQueryCache, a bounded cache of path and reachability query
+ * results for a NodeGraph.
+ */
+
+#ifndef NODE_GRAPH_CACHE_H_
+#define NODE_GRAPH_CACHE_H_
+
+#include <stdbool.h>
+#include "node_graph.h"
+#include "node_graph_dfs.h"
+
+/**
+ * A cached query result
+ */
+typedef struct {
+	GraphNodeVertex* fromVertex;	// the initial vertex of the query
+	GraphNodeVertex* toVertex;		// the final vertex of the query
+	int maxPaths;					// maximum paths of the query, or -1 for reachability
+	int result;						// total number of paths, or 1 if reachable
+	GraphNodeVertex** paths;		// the returned paths, each null-terminated, or NULL
+	int next;						// next entry in the hash chain, or -1
+	bool referenced;				// true if used since the clock hand last passed
+} NodeGraphCacheEntry;
+
+/**
+ * Statistics of a query cache
+ */
+typedef struct {
+	long hits;						// queries answered from the cache
+	long misses;					// queries that were computed
+	long evictions;					// entries replaced to make room
+	long invalidations;				// times the cache was emptied by a graph change
+} NodeGraphQueryCacheStats;
+
+/**
+ * A bounded cache of query results for a graph. Results are valid for
+ * one version of the graph, and all results are discarded on the first
+ * query after the graph changes. When the cache is full, an entry is
+ * replaced in CLOCK order, which approximates least recently used.
+ * A cache must not be used by more than one thread at a time.
+ */
+typedef struct {
+	NodeGraph* graph;				// the graph
+	unsigned long version;			// version of the graph of the cached results
+	NodeGraphCacheEntry* entries;	// the entries
+	int entryCount;					// number of entries in use
+	int capacity;					// maximum number of entries
+	int hand;						// the clock hand
+	int* buckets;					// first entry by hash bucket, or -1
+	int bucketMask;					// number of buckets - 1 (power of 2)
+	NodeGraphDFS* dfs;				// traversal for reachability, or NULL
+	NodeGraphQueryCacheStats stats;	// the statistics
+} NodeGraphQueryCache;
+
+/**
+ * Create a query cache for the graph.
+ *
+ * @param graph the graph
+ * @param capacity the maximum number of cached results
+ * @return a new NodeGraphQueryCache
+ */
+NodeGraphQueryCache* createNodeGraphQueryCache(NodeGraph* graph, int capacity);
+
+/**
+ * Frees a query cache and its results.
+ *
+ * @param cache the NodeGraphQueryCache to free
+ */
+void freeNodeGraphQueryCache(NodeGraphQueryCache* cache);
+
+/**
+ * Discards the results in the cache. The statistics are not changed.
+ *
+ * @param cache the NodeGraphQueryCache
+ */
+void clearNodeGraphQueryCache(NodeGraphQueryCache* cache);
+
+/**
+ * Return up to maxPaths paths between the initial fromNode and the
+ * final toNode in the graph, as getNodeGraphPaths() does, from the cache
+ * if the same query was made for the current version of the graph. The
+ * allocated path arrays must be freed when no longer needed.
+ *
+ * @param cache the NodeGraphQueryCache
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param paths an array of pointers to null-terminated path arrays
+ *   where up to maxPaths paths will be returned (size must be maxPaths+1)
+ * @param maxPaths the maximum number of paths to return
+ * @return the total number of paths available from fromVertex to
+ *   toVertex; may be greater than maxPaths
+ */
+int getCachedNodeGraphPaths(NodeGraphQueryCache* cache,
+		GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
+		GraphNodeVertex*** paths, int maxPaths);
+
+/**
+ * Determines whether there is a path from one vertex to another, from
+ * the cache if the same query was made for the current version of the
+ * graph.
+ *
+ * @param cache the NodeGraphQueryCache
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @return true if toVertex is reachable from fromVertex
+ */
+bool isCachedNodeGraphVertexReachable(NodeGraphQueryCache* cache,
+		GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex);
+
+/**
+ * Returns the statistics of the cache.
+ *
+ * @param cache the NodeGraphQueryCache
+ * @param stats the NodeGraphQueryCacheStats to fill in
+ */
+void getNodeGraphQueryCacheStats(NodeGraphQueryCache* cache, NodeGraphQueryCacheStats* stats);
+
+/**
+ * Returns the fraction of queries answered from the cache.
+ *
+ * @param cache the NodeGraphQueryCache
+ * @return the hit rate, or 0 if there have been no queries
+ */
+double getNodeGraphQueryCacheHitRate(NodeGraphQueryCache* cache);
+
+#endif /* NODE_GRAPH_CACHE_H_ */
@@ -0,0 +1,241 @@
+/*
+ * node_graph_components.c
+ *
+ * This file provides the implementations for computing the weakly
+ * connected components of a NodeGraph with a concurrent union-find.
+ *
+ * Vertices are linked by compare-and-swap of their parent, always from
+ * the higher root index to the lower one so that no cycles can form,
+ * and finds compress paths by halving. As in Afforest, a first pass
+ * links each vertex with only its first few neighbors, which already
+ * joins most of a large component; after the trees are flattened, most
+ * remaining edges are found to be within a component by comparing the
+ * parents of their vertices, without a find.
+ */
+
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "node_graph_components.h"
+
+#ifndef COMPONENT_SAMPLE_EDGES
+#define COMPONENT_SAMPLE_EDGES 2
+#endif
+
+#ifndef COMPONENT_CHUNK_SIZE
+#define COMPONENT_CHUNK_SIZE 1024
+#endif
+
+/**
+ * Passes over the vertices of the graph
+ */
+typedef enum {
+	COMPONENT_PASS_SAMPLE,			// link the first few edges of each vertex
+	COMPONENT_PASS_COMPRESS,		// point each vertex at its root
+	COMPONENT_PASS_FINISH			// link the remaining edges of each vertex
+} NodeGraphComponentPass;
+
+/**
+ * State shared by the component threads
+ */
+typedef struct {
+	NodeGraph* graph;
+	atomic_int* parent;				// union-find parent by vertex index
+	atomic_int nextChunk;			// first vertex of the next unclaimed chunk
+	NodeGraphComponentPass pass;	// the current pass
+} NodeGraphComponentState;
+
+/**
+ * Finds the root of the vertex, halving the path to it.
+ *
+ * @param parent the union-find parents
+ * @param v the vertex index
+ * @return the index of the root
+ */
+static int findComponentRoot(atomic_int* parent, int v) {
+	for (;;) {
+		int p = atomic_load_explicit(&parent[v], memory_order_relaxed);
+		int gp = atomic_load_explicit(&parent[p], memory_order_relaxed);
+		if (p == gp) {
+			return p;
+		}
+		// another thread may have changed the parent; either way is valid
+		atomic_compare_exchange_weak_explicit(&parent[v], &p, gp,
+			memory_order_relaxed, memory_order_relaxed);
+		v = gp;
+	}
+}
+
+/**
+ * Links the components of two vertices.
+ *
+ * @param parent the union-find parents
+ * @param u the first vertex index
+ * @param v the second vertex index
+ */
+static void linkComponents(atomic_int* parent, int u, int v) {
+	for (;;) {
+		int ru = findComponentRoot(parent, u);
+		int rv = findComponentRoot(parent, v);
+		if (ru == rv) {
+			return;
+		}
+		if (ru < rv) {
+			int tmp = ru;
+			ru = rv;
+			rv = tmp;
+		}
+		// link the higher root under the lower one if it is still a root
+		int expected = ru;
+		if (atomic_compare_exchange_strong_explicit(&parent[ru], &expected, rv,
+				memory_order_relaxed, memory_order_relaxed)) {
+			return;
+		}
+		u = ru;
+		v = rv;
+	}
+}
+
+/**
+ * Performs the current pass for a vertex.
+ *
+ * @param state the component state
+ * @param v the vertex index
+ */
+static void passComponentVertex(NodeGraphComponentState* state, int v) {
+	atomic_int* parent = state->parent;
+	GraphNodeVertex* vtx = state->graph->vertices[v];
+	switch (state->pass) {
+	case COMPONENT_PASS_SAMPLE:
+		for (int iv = 0; iv < vtx->edgeCount && iv < COMPONENT_SAMPLE_EDGES; iv++) {
+			linkComponents(parent, v, vtx->edgeTo[iv].vertex->index);
+		}
+		break;
+	case COMPONENT_PASS_COMPRESS:
+		atomic_store_explicit(&parent[v], findComponentRoot(parent, v), memory_order_relaxed);
+		break;
+	case COMPONENT_PASS_FINISH:
+		for (int iv = COMPONENT_SAMPLE_EDGES; iv < vtx->edgeCount; iv++) {
+			int to = vtx->edgeTo[iv].vertex->index;
+			// flattened trees: equal parents are the same component
+			if (atomic_load_explicit(&parent[v], memory_order_relaxed)
+					!= atomic_load_explicit(&parent[to], memory_order_relaxed)) {
+				linkComponents(parent, v, to);
+			}
+		}
+		break;
+	}
+}
+
+/**
+ * Performs the current pass for chunks of vertices until none remain.
+ *
+ * @param arg the NodeGraphComponentState
+ * @return NULL
+ */
+static void* runComponentThread(void* arg) {
+	NodeGraphComponentState* state = (NodeGraphComponentState*)arg;
+	int n = state->graph->vertexCount;
+	for (;;) {
+		int begin = atomic_fetch_add(&state->nextChunk, COMPONENT_CHUNK_SIZE);
+		if (begin >= n) {
+			return NULL;
+		}
+		int end = (begin + COMPONENT_CHUNK_SIZE < n) ? begin + COMPONENT_CHUNK_SIZE : n;
+		for (int v = begin; v < end; v++) {
+			passComponentVertex(state, v);
+		}
+	}
+}
+
+/**
+ * Performs a pass over all vertices with the specified number of threads.
+ *
+ * @param state the component state
+ * @param pass the pass to perform
+ * @param threads the threads
+ * @param threadCount the number of threads
+ */
+static void runComponentPass(NodeGraphComponentState* state, NodeGraphComponentPass pass,
+		pthread_t* threads, int threadCount) {
+	state->pass = pass;
+	atomic_store(&state->nextChunk, 0);
+	for (int t = 1; t < threadCount; t++) {
+		pthread_create(&threads[t], NULL, runComponentThread, state);
+	}
+	runComponentThread(state);
+	for (int t = 1; t < threadCount; t++) {
+		pthread_join(threads[t], NULL);
+	}
+}
+
+/**
+ * Computes the weakly connected components of the graph, in which
+ * vertices are connected if there is a path between them when edge
+ * direction is ignored. Each vertex is assigned the number of its
+ * component, and components are numbered from 0 in order of their
+ * lowest vertex index, so the numbering does not depend on the number
+ * of threads.
+ *
+ * Vertices in different components have no path between them, so path
+ * requests between components can be rejected without a search.
+ *
+ * @param graph the graph
+ * @param threadCount the number of threads, or 0 for one per processor
+ * @param component array of component numbers by vertex index
+ *   (size of array == vertex count)
+ * @return the number of components
+ */
+int getNodeGraphWeakComponents(NodeGraph* graph, int threadCount, int* component) {
+	int n = graph->vertexCount;
+	if (threadCount <= 0) {
+		threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	int chunks = (n + COMPONENT_CHUNK_SIZE-1) / COMPONENT_CHUNK_SIZE;
+	if (threadCount > chunks) {
+		threadCount = chunks;
+	}
+	if (threadCount < 1) {
+		threadCount = 1;
+	}
+
+	NodeGraphComponentState state;
+	state.graph = graph;
+	state.parent = (atomic_int*)malloc((n+1) * sizeof(atomic_int));
+	for (int v = 0; v < n; v++) {
+		atomic_init(&state.parent[v], v);
+	}
+	atomic_init(&state.nextChunk, 0);
+	pthread_t* threads = (pthread_t*)malloc(threadCount * sizeof(pthread_t));
+
+	runComponentPass(&state, COMPONENT_PASS_SAMPLE, threads, threadCount);
+	runComponentPass(&state, COMPONENT_PASS_COMPRESS, threads, threadCount);
+	runComponentPass(&state, COMPONENT_PASS_FINISH, threads, threadCount);
+	runComponentPass(&state, COMPONENT_PASS_COMPRESS, threads, threadCount);
+
+	// every root is the lowest index of its component, so it precedes its members
+	int componentCount = 0;
+	for (int v = 0; v < n; v++) {
+		int root = atomic_load_explicit(&state.parent[v], memory_order_relaxed);
+		component[v] = (root == v) ? componentCount++ : component[root];
+	}
+
+	free(threads);
+	free(state.parent);
+	return componentCount;
+}
+
+/**
+ * Determines whether two vertices are in the same component, using the
+ * component numbers of getNodeGraphWeakComponents().
+ *
+ * @param component array of component numbers by vertex index
+ * @param fromVertex the first vertex
+ * @param toVertex the second vertex
+ * @return true if the vertices are in the same component
+ */
+bool inSameNodeGraphComponent(const int* component,
+		GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex) {
+	return component[fromVertex->index] == component[toVertex->index];
+}
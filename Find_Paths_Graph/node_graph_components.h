@@ -0,0 +1,45 @@
+/*
+ * node_graph_components.h
+ *
+ * This file provides the function declarations for computing the weakly
+ * connected components of a NodeGraph with a concurrent union-find.
+ */
+
+#ifndef NODE_GRAPH_COMPONENTS_H_
+#define NODE_GRAPH_COMPONENTS_H_
+
+#include <stdbool.h>
+#include "node_graph.h"
+
+/**
+ * Computes the weakly connected components of the graph, in which
+ * vertices are connected if there is a path between them when edge
+ * direction is ignored. Each vertex is assigned the number of its
+ * component, and components are numbered from 0 in order of their
+ * lowest vertex index, so the numbering does not depend on the number
+ * of threads.
+ *
+ * Vertices in different components have no path between them, so path
+ * requests between components can be rejected without a search.
+ *
+ * @param graph the graph
+ * @param threadCount the number of threads, or 0 for one per processor
+ * @param component array of component numbers by vertex index
+ *   (size of array == vertex count)
+ * @return the number of components
+ */
+int getNodeGraphWeakComponents(NodeGraph* graph, int threadCount, int* component);
+
+/**
+ * Determines whether two vertices are in the same component, using the
+ * component numbers of getNodeGraphWeakComponents().
+ *
+ * @param component array of component numbers by vertex index
+ * @param fromVertex the first vertex
+ * @param toVertex the second vertex
+ * @return true if the vertices are in the same component
+ */
+bool inSameNodeGraphComponent(const int* component,
+		GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex);
+
+#endif /* NODE_GRAPH_COMPONENTS_H_ */
@@ -0,0 +1,167 @@
+/*
+ * node_graph_csr.c
+ *
+ * This file provides the implementations of a NodeGraphCSR, a compressed
+ * sparse row view of the adjacency of a NodeGraph by vertex index, and
+ * of a sparse matrix-vector kernel over the view.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "node_graph_csr.h"
+
+/**
+ * Allocates a CSR view with storage for the vertices and edges of the
+ * graph, and fills in the out degrees.
+ *
+ * @param graph the graph
+ * @param transposed true for a transposed view
+ * @return the new NodeGraphCSR
+ */
+static NodeGraphCSR* allocNodeGraphCSR(NodeGraph* graph, bool transposed) {
+	NodeGraphCSR* csr = (NodeGraphCSR*)malloc(sizeof(NodeGraphCSR));
+	int n = graph->vertexCount;
+	csr->vertexCount = n;
+	csr->transposed = transposed;
+	csr->outDegree = (int*)malloc((n+1) * sizeof(int));
+	csr->edgeCount = 0;
+	for (int i = 0; i < n; i++) {
+		csr->outDegree[i] = graph->vertices[i]->edgeCount;
+		csr->edgeCount += csr->outDegree[i];
+	}
+	csr->offsets = (long*)malloc((n+1) * sizeof(long));
+	csr->neighbors = (int*)malloc((csr->edgeCount+1) * sizeof(int));
+	assert(csr->offsets != (long*)NULL && csr->neighbors != (int*)NULL);
+	return csr;
+}
+
+/**
+ * Create a CSR view of the out edges of the graph. The view is a copy,
+ * and does not change when the graph changes.
+ *
+ * @param graph the graph
+ * @return a new NodeGraphCSR
+ */
+NodeGraphCSR* createNodeGraphCSR(NodeGraph* graph) {
+	NodeGraphCSR* csr = allocNodeGraphCSR(graph, false);
+	long edge = 0;
+	for (int ig = 0; ig < csr->vertexCount; ig++) {
+		GraphNodeVertex* vtx = graph->vertices[ig];
+		csr->offsets[ig] = edge;
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			csr->neighbors[edge++] = vtx->edgeTo[iv].vertex->index;
+		}
+	}
+	csr->offsets[csr->vertexCount] = edge;
+	return csr;
+}
+
+/**
+ * Create a transposed CSR view of the graph, in which the neighbors of
+ * a vertex are the vertices with edges to it. Pull-based kernels read
+ * the in-neighbors of each vertex and write only the vertex itself.
+ *
+ * @param graph the graph
+ * @return a new NodeGraphCSR
+ */
+NodeGraphCSR* createTransposedNodeGraphCSR(NodeGraph* graph) {
+	NodeGraphCSR* csr = allocNodeGraphCSR(graph, true);
+	int n = csr->vertexCount;
+
+	// count in edges, then convert counts to offsets
+	memset(csr->offsets, 0, (n+1) * sizeof(long));
+	for (int ig = 0; ig < n; ig++) {
+		GraphNodeVertex* vtx = graph->vertices[ig];
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			csr->offsets[vtx->edgeTo[iv].vertex->index + 1]++;
+		}
+	}
+	for (int i = 0; i < n; i++) {
+		csr->offsets[i+1] += csr->offsets[i];
+	}
+
+	// sources are added in increasing order, so each row is sorted
+	long* fill = (long*)malloc((n+1) * sizeof(long));
+	memcpy(fill, csr->offsets, (n+1) * sizeof(long));
+	for (int ig = 0; ig < n; ig++) {
+		GraphNodeVertex* vtx = graph->vertices[ig];
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			csr->neighbors[fill[vtx->edgeTo[iv].vertex->index]++] = ig;
+		}
+	}
+	free(fill);
+	return csr;
+}
+
+/**
+ * Frees a NodeGraphCSR.
+ *
+ * @param csr the NodeGraphCSR to free
+ */
+void freeNodeGraphCSR(NodeGraphCSR* csr) {
+	free(csr->offsets);
+	csr->offsets = (long*)NULL;
+	free(csr->neighbors);
+	csr->neighbors = (int*)NULL;
+	free(csr->outDegree);
+	csr->outDegree = (int*)NULL;
+	free(csr);
+}
+
+/**
+ * Multiplies the adjacency matrix of the view by a vector for a range
+ * of rows: y[v] = sum of x[u] for each neighbor u of v, for v in
+ * [begin, end). Rows in disjoint ranges can be computed concurrently.
+ *
+ * @param csr the NodeGraphCSR
+ * @param x the input vector by vertex index
+ * @param y the output vector by vertex index
+ * @param begin the first row
+ * @param end one past the last row
+ */
+void multiplyNodeGraphCSR(const NodeGraphCSR* csr, const double* x, double* y, int begin, int end) {
+	const long* offsets = csr->offsets;
+	const int* neighbors = csr->neighbors;
+	for (int v = begin; v < end; v++) {
+		// independent partial sums let the gathers and adds overlap
+		double sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+		long k = offsets[v];
+		long last = offsets[v+1];
+		for ( ; k+4 <= last; k += 4) {
+			sum0 += x[neighbors[k]];
+			sum1 += x[neighbors[k+1]];
+			sum2 += x[neighbors[k+2]];
+			sum3 += x[neighbors[k+3]];
+		}
+		for ( ; k < last; k++) {
+			sum0 += x[neighbors[k]];
+		}
+		y[v] = (sum0 + sum1) + (sum2 + sum3);
+	}
+}
+
+/**
+ * Divides the rows of the view into ranges with about the same number
+ * of neighbors, for dividing row-wise work among threads.
+ *
+ * @param csr the NodeGraphCSR
+ * @param rangeCount the number of ranges
+ * @param bounds the range bounds; range i is [bounds[i], bounds[i+1])
+ *   (size of array == rangeCount+1)
+ */
+void getNodeGraphCSRRanges(const NodeGraphCSR* csr, int rangeCount, int* bounds) {
+	int n = csr->vertexCount;
+	// weight each row by its neighbors plus one, so empty rows count too
+	long total = csr->edgeCount + n;
+	bounds[0] = 0;
+	int v = 0;
+	for (int r = 1; r < rangeCount; r++) {
+		long target = total * r / rangeCount;
+		while (v < n && csr->offsets[v] + v < target) {
+			v++;
+		}
+		bounds[r] = v;
+	}
+	bounds[rangeCount] = n;
+}
@@ -0,0 +1,80 @@
+/*
+ * node_graph_csr.h
+ *
+ * This file provides the structures and function declarations of a
+ * NodeGraphCSR, a compressed sparse row view of the adjacency of a
+ * NodeGraph by vertex index, and of a sparse matrix-vector kernel over
+ * the view.
+ */
+
+#ifndef NODE_GRAPH_CSR_H_
+#define NODE_GRAPH_CSR_H_
+
+#include <stdbool.h>
+#include "node_graph.h"
+
+/**
+ * Compressed sparse row adjacency of a graph. The neighbors of vertex v
+ * are neighbors[offsets[v]] to neighbors[offsets[v+1]-1]. In a transposed
+ * view, the neighbors of a vertex are the vertices with edges to it.
+ */
+typedef struct {
+	int vertexCount;				// number of vertices
+	long edgeCount;					// number of edges
+	long* offsets;					// start of neighbors by vertex (size vertexCount+1)
+	int* neighbors;					// neighbor vertex indexes (size edgeCount)
+	int* outDegree;					// number of out edges by vertex
+	bool transposed;				// true if neighbors are in-neighbors
+} NodeGraphCSR;
+
+/**
+ * Create a CSR view of the out edges of the graph. The view is a copy,
+ * and does not change when the graph changes.
+ *
+ * @param graph the graph
+ * @return a new NodeGraphCSR
+ */
+NodeGraphCSR* createNodeGraphCSR(NodeGraph* graph);
+
+/**
+ * Create a transposed CSR view of the graph, in which the neighbors of
+ * a vertex are the vertices with edges to it. Pull-based kernels read
+ * the in-neighbors of each vertex and write only the vertex itself.
+ *
+ * @param graph the graph
+ * @return a new NodeGraphCSR
+ */
+NodeGraphCSR* createTransposedNodeGraphCSR(NodeGraph* graph);
+
+/**
+ * Frees a NodeGraphCSR.
+ *
+ * @param csr the NodeGraphCSR to free
+ */
+void freeNodeGraphCSR(NodeGraphCSR* csr);
+
+/**
+ * Multiplies the adjacency matrix of the view by a vector for a range
+ * of rows: y[v] = sum of x[u] for each neighbor u of v, for v in
+ * [begin, end). Rows in disjoint ranges can be computed concurrently.
+ *
+ * @param csr the NodeGraphCSR
+ * @param x the input vector by vertex index
+ * @param y the output vector by vertex index
+ * @param begin the first row
+ * @param end one past the last row
+ */
+void multiplyNodeGraphCSR(const NodeGraphCSR* csr, const double* x, double* y, int begin, int end);
+
+/**
+ * Divides the rows of the view into ranges with about the same number
+ * of neighbors, for dividing row-wise work among threads.
+ *
+ * @param csr the NodeGraphCSR
+ * @param rangeCount the number of ranges
+ * @param bounds the range bounds; range i is [bounds[i], bounds[i+1])
+ *   (size of array == rangeCount+1)
+ */
+void getNodeGraphCSRRanges(const NodeGraphCSR* csr, int rangeCount, int* bounds);
+
+#endif /* NODE_GRAPH_CSR_H_ */
@@ -0,0 +1,372 @@
+/*
+ * node_graph_dag.c
+ *
+ * This file provides the implementations of functions that compute a
+ * topological order for a NodeGraph, and path functions for directed
+ * acyclic graphs (DAGs) that are built on the topological order.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "node_graph_dag.h"
+
+/**
+ * Value returned by countNodeGraphDAGPaths if the path count is too
+ * large to be represented. The count saturates at this value.
+ */
+const long NODEGRAPH_DAG_PATHS_SATURATED = LONG_MAX;
+
+/**
+ * Places the indexes of the node vertices of the graph in topological
+ * order in the order array using Kahn's algorithm. The in-degree of
+ * each vertex is computed, then vertices whose in-degree drops to 0
+ * are appended to the order, which also serves as the work queue.
+ *
+ * @param graph the graph
+ * @param order array of vertex indexes (size of array == vertex count)
+ * @return the number of vertex indexes placed in order
+ */
+static int getTopologicalIndexOrder(NodeGraph* graph, int* order) {
+	int* inDegree = (int*)calloc(graph->vertexCount, sizeof(int));
+	for (int ig = 0; ig < graph->vertexCount; ig++) {
+		GraphNodeVertex* vtx = graph->vertices[ig];
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			inDegree[vtx->edgeTo[iv].vertex->index]++;
+		}
+	}
+
+	// start with the roots of the graph
+	int tail = 0;
+	for (int ig = 0; ig < graph->vertexCount; ig++) {
+		if (inDegree[ig] == 0) {
+			order[tail++] = ig;
+		}
+	}
+
+	// remove edges of each ordered vertex and add newly freed vertices
+	for (int head = 0; head < tail; head++) {
+		GraphNodeVertex* vtx = graph->vertices[order[head]];
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			int to = vtx->edgeTo[iv].vertex->index;
+			if (--inDegree[to] == 0) {
+				order[tail++] = to;
+			}
+		}
+	}
+
+	free(inDegree);
+	return tail;
+}
+
+/**
+ * Places the node vertices of the graph in topological order in the
+ * order array, using Kahn's algorithm. Every vertex precedes the
+ * vertices that its edges point to. The order array is null-terminated
+ * after the ordered vertices.
+ *
+ * If the graph has a cycle, the vertices on or reachable from the cycle
+ * cannot be ordered, and the return count is less than the number of
+ * vertices in the graph.
+ *
+ * @param graph the graph
+ * @param order an array of GraphNodeVertex* for the results
+ *   (size of array must be vertex count+1)
+ * @return the number of vertices placed in topological order
+ */
+int getNodeGraphTopologicalOrder(NodeGraph* graph, GraphNodeVertex** order) {
+	int* indexOrder = (int*)malloc(graph->vertexCount * sizeof(int));
+	int count = getTopologicalIndexOrder(graph, indexOrder);
+	for (int i = 0; i < count; i++) {
+		order[i] = graph->vertices[indexOrder[i]];
+	}
+	order[count] = (GraphNodeVertex*)NULL;
+	free(indexOrder);
+	return count;
+}
+
+/**
+ * Determines whether the graph is acyclic.
+ *
+ * @param graph the graph
+ * @return true if the graph has no cycles, false otherwise
+ */
+bool isNodeGraphAcyclic(NodeGraph* graph) {
+	int* indexOrder = (int*)malloc(graph->vertexCount * sizeof(int));
+	int count = getTopologicalIndexOrder(graph, indexOrder);
+	free(indexOrder);
+	return count == graph->vertexCount;
+}
+
+/**
+ * Returns the number of paths between the initial fromVertex and the
+ * final toVertex in the acyclic graph. The count is computed in time
+ * linear in the size of the graph, rather than by enumerating paths.
+ * The count saturates at NODEGRAPH_DAG_PATHS_SATURATED.
+ *
+ * @param graph the acyclic graph
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @return the number of paths from fromVertex to toVertex, or -1 if
+ *   the graph has a cycle
+ */
+long countNodeGraphDAGPaths(
+		NodeGraph* graph, GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex) {
+	int* order = (int*)malloc(graph->vertexCount * sizeof(int));
+	if (getTopologicalIndexOrder(graph, order) != graph->vertexCount) {
+		free(order);
+		return -1;
+	}
+
+	// count paths into each vertex from fromVertex in topological order
+	long* pathCount = (long*)calloc(graph->vertexCount, sizeof(long));
+	pathCount[fromVertex->index] = 1;
+	for (int i = 0; i < graph->vertexCount; i++) {
+		int ig = order[i];
+		if (pathCount[ig] == 0) {
+			continue;  // not reachable from fromVertex
+		}
+		if (ig == toVertex->index) {
+			break;  // no vertex after toVertex can lead back to it
+		}
+		GraphNodeVertex* vtx = graph->vertices[ig];
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			int to = vtx->edgeTo[iv].vertex->index;
+			if (pathCount[to] > NODEGRAPH_DAG_PATHS_SATURATED - pathCount[ig]) {
+				pathCount[to] = NODEGRAPH_DAG_PATHS_SATURATED;
+			} else {
+				pathCount[to] += pathCount[ig];
+			}
+		}
+	}
+
+	long count = pathCount[toVertex->index];
+	free(pathCount);
+	free(order);
+	return count;
+}
+
+/**
+ * Places the node vertices of the shortest or longest path between the
+ * initial fromVertex and the final toVertex of the acyclic graph in the
+ * path array. The path length to each vertex is relaxed in topological
+ * order, recording the predecessor vertex for the best path.
+ *
+ * @param graph the acyclic graph
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param path an array of GraphNodeVertex* for the path
+ *   (size of array == maxLength+1)
+ * @param maxLength the maximum number of vertices to return
+ * @param longest true for the longest path, false for the shortest path
+ * @return the number of vertices in the path, 0 if there is no path,
+ *   or -1 if the graph has a cycle
+ */
+static int getNodeGraphDAGPath(
+		NodeGraph* graph, GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
+		GraphNodeVertex** path, int maxLength, bool longest) {
+	path[0] = (GraphNodeVertex*)NULL;
+
+	int* order = (int*)malloc(graph->vertexCount * sizeof(int));
+	if (getTopologicalIndexOrder(graph, order) != graph->vertexCount) {
+		free(order);
+		return -1;
+	}
+
+	// number of vertices on best path to each vertex; 0 if unreached
+	int* length = (int*)calloc(graph->vertexCount, sizeof(int));
+	int* pred = (int*)malloc(graph->vertexCount * sizeof(int));
+	length[fromVertex->index] = 1;
+	pred[fromVertex->index] = -1;
+	for (int i = 0; i < graph->vertexCount; i++) {
+		int ig = order[i];
+		if (length[ig] == 0) {
+			continue;  // not reachable from fromVertex
+		}
+		if (ig == toVertex->index) {
+			break;  // no vertex after toVertex can lead back to it
+		}
+		GraphNodeVertex* vtx = graph->vertices[ig];
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			int to = vtx->edgeTo[iv].vertex->index;
+			if (   length[to] == 0
+				|| (longest ? length[ig]+1 > length[to] : length[ig]+1 < length[to])) {
+				length[to] = length[ig]+1;
+				pred[to] = ig;
+			}
+		}
+	}
+
+	// no path if toVertex was not reached; path[0] is already NULL
+	int pathLength = length[toVertex->index];
+	if (pathLength == 0) {
+		free(pred);
+		free(length);
+		free(order);
+		return 0;
+	}
+
+	// fill in path from toVertex back to fromVertex
+	int end = (pathLength < maxLength) ? pathLength : maxLength;
+	int pos = pathLength - 1;
+	for (int ig = toVertex->index; ig != -1; ig = pred[ig], pos--) {
+		if (pos < end) {
+			path[pos] = graph->vertices[ig];
+		}
+	}
+	path[end] = (GraphNodeVertex*)NULL;
+
+	free(pred);
+	free(length);
+	free(order);
+	return pathLength;
+}
+
+/**
+ * Places the node vertices of the shortest path between the initial
+ * fromVertex and the final toVertex of the acyclic graph in the path
+ * array. At most maxLength vertices will be returned. The path array
+ * is null-terminated after the returned vertices.
+ *
+ * @param graph the acyclic graph
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param path an array of GraphNodeVertex* for the path
+ *   (size of array == maxLength+1)
+ * @param maxLength the maximum number of vertices to return
+ * @return the number of vertices in the path, 0 if there is no path,
+ *   or -1 if the graph has a cycle
+ */
+int getNodeGraphDAGShortestPath(
+		NodeGraph* graph, GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
+		GraphNodeVertex** path, int maxLength) {
+	return getNodeGraphDAGPath(graph, fromVertex, toVertex, path, maxLength, false);
+}
+
+/**
+ * Places the node vertices of the longest path between the initial
+ * fromVertex and the final toVertex of the acyclic graph in the path
+ * array. At most maxLength vertices will be returned. The path array
+ * is null-terminated after the returned vertices.
+ *
+ * @param graph the acyclic graph
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param path an array of GraphNodeVertex* for the path
+ *   (size of array == maxLength+1)
+ * @param maxLength the maximum number of vertices to return
+ * @return the number of vertices in the path, 0 if there is no path,
+ *   or -1 if the graph has a cycle
+ */
+int getNodeGraphDAGLongestPath(
+		NodeGraph* graph, GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
+		GraphNodeVertex** path, int maxLength) {
+	return getNodeGraphDAGPath(graph, fromVertex, toVertex, path, maxLength, true);
+}
+
+/**
+ * Return up to maxPaths shortest paths between the initial fromVertex
+ * and the final toVertex in the acyclic graph, in order of increasing
+ * length.
+ *
+ * Each vertex keeps a list of up to maxPaths best path lengths into it,
+ * sorted by length. Each entry records the predecessor vertex and the
+ * rank of the entry in the predecessor's list, so that every entry
+ * describes a distinct path. Lists are extended in topological order.
+ *
+ * @param graph the acyclic graph
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param paths an array of pointers to null-terminated path arrays
+ *   where up to maxPaths paths will be returned (size must be maxPaths+1)
+ * @param maxPaths the maximum number of paths to return
+ * @return the number of paths returned, or -1 if the graph has a cycle
+ */
+int getNodeGraphDAGShortestPaths(
+		NodeGraph* graph, GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
+		GraphNodeVertex*** paths, int maxPaths) {
+	paths[0] = (GraphNodeVertex**)NULL;
+	if (maxPaths <= 0) {
+		return 0;
+	}
+
+	int* order = (int*)malloc(graph->vertexCount * sizeof(int));
+	if (getTopologicalIndexOrder(graph, order) != graph->vertexCount) {
+		free(order);
+		return -1;
+	}
+
+	// per-vertex lists of best path entries: entry k of vertex ig is at ig*maxPaths+k
+	size_t nEntries = (size_t)graph->vertexCount * maxPaths;
+	int* entryCount = (int*)calloc(graph->vertexCount, sizeof(int));
+	int* length = (int*)malloc(nEntries * sizeof(int));
+	int* pred = (int*)malloc(nEntries * sizeof(int));
+	int* predRank = (int*)malloc(nEntries * sizeof(int));
+
+	int from = fromVertex->index;
+	entryCount[from] = 1;
+	length[(size_t)from*maxPaths] = 1;
+	pred[(size_t)from*maxPaths] = -1;
+	predRank[(size_t)from*maxPaths] = -1;
+
+	for (int i = 0; i < graph->vertexCount; i++) {
+		int ig = order[i];
+		if (entryCount[ig] == 0) {
+			continue;  // not reachable from fromVertex
+		}
+		if (ig == toVertex->index) {
+			break;  // no vertex after toVertex can lead back to it
+		}
+		GraphNodeVertex* vtx = graph->vertices[ig];
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			int to = vtx->edgeTo[iv].vertex->index;
+			int* toLength = &length[(size_t)to*maxPaths];
+			int* toPred = &pred[(size_t)to*maxPaths];
+			int* toPredRank = &predRank[(size_t)to*maxPaths];
+
+			// merge entries of ig extended by one vertex into list for "to"
+			for (int k = 0; k < entryCount[ig]; k++) {
+				int newLength = length[(size_t)ig*maxPaths + k] + 1;
+				if (entryCount[to] == maxPaths && newLength >= toLength[maxPaths-1]) {
+					break;  // remaining entries of ig are no shorter
+				}
+				int pos = (entryCount[to] < maxPaths) ? entryCount[to]++ : maxPaths-1;
+				for ( ; pos > 0 && toLength[pos-1] > newLength; pos--) {
+					toLength[pos] = toLength[pos-1];
+					toPred[pos] = toPred[pos-1];
+					toPredRank[pos] = toPredRank[pos-1];
+				}
+				toLength[pos] = newLength;
+				toPred[pos] = ig;
+				toPredRank[pos] = k;
+			}
+		}
+	}
+
+	// build a path array for each entry of toVertex
+	int to = toVertex->index;
+	int nPaths = entryCount[to];
+	for (int k = 0; k < nPaths; k++) {
+		int pathLength = length[(size_t)to*maxPaths + k];
+		GraphNodeVertex** path =
+			(GraphNodeVertex**)malloc((pathLength+1) * sizeof(GraphNodeVertex*));
+		path[pathLength] = (GraphNodeVertex*)NULL;
+		int ig = to;
+		int rank = k;
+		for (int pos = pathLength-1; pos >= 0; pos--) {
+			path[pos] = graph->vertices[ig];
+			size_t entry = (size_t)ig*maxPaths + rank;
+			ig = pred[entry];
+			rank = predRank[entry];
+		}
+		paths[k] = path;
+	}
+	paths[nPaths] = (GraphNodeVertex**)NULL;
+
+	free(predRank);
+	free(pred);
+	free(length);
+	free(entryCount);
+	free(order);
+	return nPaths;
+}
@@ -0,0 +1,122 @@
+/*
+ * node_graph_dag.h
+ *
+ * This file provides the declarations of functions that compute a
+ * topological order for a NodeGraph, and path functions for directed
+ * acyclic graphs (DAGs) that are built on the topological order.
+ */
+
+#ifndef NODE_GRAPH_DAG_H_
+#define NODE_GRAPH_DAG_H_
+
+#include <stdbool.h>
+#include "node_graph.h"
+
+/**
+ * Value returned by countNodeGraphDAGPaths if the path count is too
+ * large to be represented. The count saturates at this value.
+ */
+extern const long NODEGRAPH_DAG_PATHS_SATURATED;
+
+/**
+ * Places the node vertices of the graph in topological order in the
+ * order array, using Kahn's algorithm. Every vertex precedes the
+ * vertices that its edges point to. The order array is null-terminated
+ * after the ordered vertices.
+ *
+ * If the graph has a cycle, the vertices on or reachable from the cycle
+ * cannot be ordered, and the return count is less than the number of
+ * vertices in the graph.
+ *
+ * @param graph the graph
+ * @param order an array of GraphNodeVertex* for the results
+ *   (size of array must be vertex count+1)
+ * @return the number of vertices placed in topological order
+ */
+int getNodeGraphTopologicalOrder(NodeGraph* graph, GraphNodeVertex** order);
+
+/**
+ * Determines whether the graph is acyclic.
+ *
+ * @param graph the graph
+ * @return true if the graph has no cycles, false otherwise
+ */
+bool isNodeGraphAcyclic(NodeGraph* graph);
+
+/**
+ * Returns the number of paths between the initial fromVertex and the
+ * final toVertex in the acyclic graph. The count is computed in time
+ * linear in the size of the graph, rather than by enumerating paths.
+ * The count saturates at NODEGRAPH_DAG_PATHS_SATURATED.
+ *
+ * @param graph the acyclic graph
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @return the number of paths from fromVertex to toVertex, or -1 if
+ *   the graph has a cycle
+ */
+long countNodeGraphDAGPaths(
+		NodeGraph* graph, GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex);
+
+/**
+ * Places the node vertices of the shortest path between the initial
+ * fromVertex and the final toVertex of the acyclic graph in the path
+ * array. At most maxLength vertices will be returned. The path array
+ * is null-terminated after the returned vertices.
+ *
+ * @param graph the acyclic graph
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param path an array of GraphNodeVertex* for the path
+ *   (size of array == maxLength+1)
+ * @param maxLength the maximum number of vertices to return
+ * @return the number of vertices in the path, 0 if there is no path,
+ *   or -1 if the graph has a cycle
+ */
+int getNodeGraphDAGShortestPath(
+		NodeGraph* graph, GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
+		GraphNodeVertex** path, int maxLength);
+
+/**
+ * Places the node vertices of the longest path between the initial
+ * fromVertex and the final toVertex of the acyclic graph in the path
+ * array. At most maxLength vertices will be returned. The path array
+ * is null-terminated after the returned vertices.
+ *
+ * @param graph the acyclic graph
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param path an array of GraphNodeVertex* for the path
+ *   (size of array == maxLength+1)
+ * @param maxLength the maximum number of vertices to return
+ * @return the number of vertices in the path, 0 if there is no path,
+ *   or -1 if the graph has a cycle
+ */
+int getNodeGraphDAGLongestPath(
+		NodeGraph* graph, GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
+		GraphNodeVertex** path, int maxLength);
+
+/**
+ * Return up to maxPaths shortest paths between the initial fromVertex
+ * and the final toVertex in the acyclic graph, in order of increasing
+ * length.
+ *
+ * Paths are returned in the same form as getNodeGraphPaths(). Adds up
+ * to maxPaths paths to paths array passed in, then a null terminator
+ * at the end. Each path is allocated as a null-terminated array of
+ * GraphNodeVertex pointers in the path. The allocated path arrays must
+ * be freed when no longer needed.
+ *
+ * @param graph the acyclic graph
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param paths an array of pointers to null-terminated path arrays
+ *   where up to maxPaths paths will be returned (size must be maxPaths+1)
+ * @param maxPaths the maximum number of paths to return
+ * @return the number of paths returned, or -1 if the graph has a cycle
+ */
+int getNodeGraphDAGShortestPaths(
+		NodeGraph* graph, GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
+		GraphNodeVertex*** paths, int maxPaths);
+
+#endif /* NODE_GRAPH_DAG_H_ */
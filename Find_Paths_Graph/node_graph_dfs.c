@@ -0,0 +1,337 @@
+/*
+ * node_graph_dfs.c
+ *
+ * This file provides the implementations of a NodeGraphDFS, an
+ * event-based depth-first traversal of a NodeGraph, and of graph
+ * algorithms that are built on it.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "node_graph_dfs.h"
+
+#ifndef DEFAULT_DFS_STACK_SIZE
+#define DEFAULT_DFS_STACK_SIZE 64
+#endif
+
+/**
+ * Ensures the mark arrays have a mark for every vertex of the graph.
+ *
+ * @param dfs the NodeGraphDFS
+ */
+static void ensureNodeGraphDFSMarks(NodeGraphDFS* dfs) {
+	int n = dfs->graph->vertexCount;
+	if (n <= dfs->markCapacity) {
+		return;
+	}
+	int capacity = (dfs->markCapacity > 0) ? dfs->markCapacity : DEFAULT_DFS_STACK_SIZE;
+	while (capacity < n) {
+		capacity *= 2;
+	}
+	dfs->discovered = (unsigned*)realloc(dfs->discovered, capacity * sizeof(unsigned));
+	dfs->finished = (unsigned*)realloc(dfs->finished, capacity * sizeof(unsigned));
+	assert(dfs->discovered != (unsigned*)NULL && dfs->finished != (unsigned*)NULL);
+	int added = capacity - dfs->markCapacity;
+	memset(&dfs->discovered[dfs->markCapacity], 0, added * sizeof(unsigned));
+	memset(&dfs->finished[dfs->markCapacity], 0, added * sizeof(unsigned));
+	dfs->markCapacity = capacity;
+}
+
+/**
+ * Create a new depth-first traversal state for the graph.
+ *
+ * @param graph the graph
+ * @return a new NodeGraphDFS
+ */
+NodeGraphDFS* createNodeGraphDFS(NodeGraph* graph) {
+	NodeGraphDFS* dfs = (NodeGraphDFS*)malloc(sizeof(NodeGraphDFS));
+	dfs->graph = graph;
+	dfs->discovered = (unsigned*)NULL;
+	dfs->finished = (unsigned*)NULL;
+	dfs->markCapacity = 0;
+	dfs->generation = 1;
+	dfs->frameCapacity = DEFAULT_DFS_STACK_SIZE;
+	dfs->frames = (NodeGraphDFSFrame*)malloc(dfs->frameCapacity * sizeof(NodeGraphDFSFrame));
+	dfs->top = -1;
+	ensureNodeGraphDFSMarks(dfs);
+	return dfs;
+}
+
+/**
+ * Frees a depth-first traversal state.
+ *
+ * @param dfs the NodeGraphDFS
+ */
+void freeNodeGraphDFS(NodeGraphDFS* dfs) {
+	free(dfs->discovered);
+	dfs->discovered = (unsigned*)NULL;
+	free(dfs->finished);
+	dfs->finished = (unsigned*)NULL;
+	free(dfs->frames);
+	dfs->frames = (NodeGraphDFSFrame*)NULL;
+	dfs->graph = (NodeGraph*)NULL;
+	free(dfs);
+}
+
+/**
+ * Clears the discovered and finished marks of all vertices, and empties
+ * the traversal stack. Clearing the marks takes constant time.
+ *
+ * @param dfs the NodeGraphDFS
+ */
+void resetNodeGraphDFS(NodeGraphDFS* dfs) {
+	dfs->top = -1;
+	if (++dfs->generation == 0) {
+		// marks from a previous use of this generation must be cleared
+		memset(dfs->discovered, 0, dfs->markCapacity * sizeof(unsigned));
+		memset(dfs->finished, 0, dfs->markCapacity * sizeof(unsigned));
+		dfs->generation = 1;
+	}
+	ensureNodeGraphDFSMarks(dfs);
+}
+
+/**
+ * Pushes an undiscovered vertex on the traversal stack and marks it
+ * discovered.
+ *
+ * @param dfs the NodeGraphDFS
+ * @param vertex the vertex
+ */
+static void pushNodeGraphDFSFrame(NodeGraphDFS* dfs, GraphNodeVertex* vertex) {
+	if (dfs->top+1 == dfs->frameCapacity) {
+		dfs->frameCapacity *= 2;
+		dfs->frames = (NodeGraphDFSFrame*)realloc(
+			dfs->frames, dfs->frameCapacity * sizeof(NodeGraphDFSFrame));
+		assert(dfs->frames != (NodeGraphDFSFrame*)NULL);
+	}
+	dfs->frames[++dfs->top] = (NodeGraphDFSFrame){vertex, -1};
+	dfs->discovered[vertex->index] = dfs->generation;
+}
+
+/**
+ * Starts traversing from the start vertex. Vertices discovered by
+ * earlier traversals since the last reset are not discovered again, so
+ * starting from each vertex in turn traverses a depth-first forest.
+ *
+ * @param dfs the NodeGraphDFS
+ * @param startVertex the start vertex
+ * @return true if the traversal started, false if the start vertex
+ *   was already discovered
+ */
+bool startNodeGraphDFS(NodeGraphDFS* dfs, GraphNodeVertex* startVertex) {
+	ensureNodeGraphDFSMarks(dfs);
+	dfs->top = -1;
+	if (isNodeGraphDFSDiscovered(dfs, startVertex)) {
+		return false;
+	}
+	pushNodeGraphDFSFrame(dfs, startVertex);
+	return true;
+}
+
+/**
+ * Gets the next event of the traversal.
+ *
+ * @param dfs the NodeGraphDFS
+ * @param event the event
+ * @return true if there was another event, false if the traversal from
+ *   the start vertex is complete
+ */
+bool getNextNodeGraphDFSEvent(NodeGraphDFS* dfs, NodeGraphDFSEvent* event) {
+	if (dfs->top < 0) {
+		return false;
+	}
+	NodeGraphDFSFrame* frame = &dfs->frames[dfs->top];
+	GraphNodeVertex* vertex = frame->vertex;
+	event->vertex = vertex;
+	event->depth = dfs->top;
+
+	if (frame->nextEdge < 0) {
+		frame->nextEdge = 0;
+		event->type = NODEGRAPH_DFS_DISCOVER;
+		event->toVertex = (GraphNodeVertex*)NULL;
+		return true;
+	}
+
+	if (frame->nextEdge >= vertex->edgeCount) {
+		dfs->finished[vertex->index] = dfs->generation;
+		dfs->top--;
+		event->type = NODEGRAPH_DFS_FINISH;
+		event->toVertex = (dfs->top >= 0) ? dfs->frames[dfs->top].vertex : (GraphNodeVertex*)NULL;
+		return true;
+	}
+
+	GraphNodeVertex* toVertex = vertex->edgeTo[frame->nextEdge++].vertex;
+	event->toVertex = toVertex;
+	if (dfs->discovered[toVertex->index] != dfs->generation) {
+		event->type = NODEGRAPH_DFS_TREE_EDGE;
+		pushNodeGraphDFSFrame(dfs, toVertex);
+	} else if (dfs->finished[toVertex->index] != dfs->generation) {
+		event->type = NODEGRAPH_DFS_BACK_EDGE;
+	} else {
+		event->type = NODEGRAPH_DFS_CROSS_EDGE;
+	}
+	return true;
+}
+
+/**
+ * Skips the remaining edges of the vertex on top of the traversal
+ * stack, so that the next event finishes it.
+ *
+ * @param dfs the NodeGraphDFS
+ */
+void skipNodeGraphDFSEdges(NodeGraphDFS* dfs) {
+	if (dfs->top >= 0) {
+		dfs->frames[dfs->top].nextEdge = dfs->frames[dfs->top].vertex->edgeCount;
+	}
+}
+
+/**
+ * Clears the discovered and finished marks of a finished vertex, so that
+ * it can be discovered again through another path. Forgetting vertices
+ * as they finish enumerates simple paths rather than a tree.
+ *
+ * @param dfs the NodeGraphDFS
+ * @param vertex the vertex
+ */
+void forgetNodeGraphDFSVertex(NodeGraphDFS* dfs, GraphNodeVertex* vertex) {
+	dfs->discovered[vertex->index] = 0;
+	dfs->finished[vertex->index] = 0;
+}
+
+/**
+ * Determines whether the vertex has been discovered since the last reset.
+ *
+ * @param dfs the NodeGraphDFS
+ * @param vertex the vertex
+ * @return true if the vertex has been discovered
+ */
+bool isNodeGraphDFSDiscovered(NodeGraphDFS* dfs, GraphNodeVertex* vertex) {
+	return dfs->discovered[vertex->index] == dfs->generation;
+}
+
+/**
+ * Returns the number of vertices on the current traversal path.
+ *
+ * @param dfs the NodeGraphDFS
+ * @return the number of vertices on the path
+ */
+int getNodeGraphDFSPathLength(NodeGraphDFS* dfs) {
+	return dfs->top + 1;
+}
+
+/**
+ * Returns a vertex on the current traversal path.
+ *
+ * @param dfs the NodeGraphDFS
+ * @param depth the depth of the vertex on the path, from 0 for the start vertex
+ * @return the vertex at that depth, or NULL if depth is out of range
+ */
+GraphNodeVertex* getNodeGraphDFSPathVertex(NodeGraphDFS* dfs, int depth) {
+	if (depth < 0 || depth > dfs->top) {
+		return (GraphNodeVertex*)NULL;
+	}
+	return dfs->frames[depth].vertex;
+}
+
+/**
+ * Places the vertices of a cycle of the graph in the cycle array. The
+ * first vertex of the cycle has an edge from the last one. The cycle
+ * array is null-terminated after the vertices of the cycle.
+ *
+ * @param graph the graph
+ * @param cycle an array of GraphNodeVertex* for the cycle
+ *   (size of array must be vertex count+1)
+ * @return the number of vertices in the cycle, or 0 if the graph is acyclic
+ */
+int findNodeGraphCycle(NodeGraph* graph, GraphNodeVertex** cycle) {
+	NodeGraphDFS* dfs = createNodeGraphDFS(graph);
+	int length = 0;
+	NodeGraphDFSEvent event;
+	for (int ig = 0; ig < graph->vertexCount && length == 0; ig++) {
+		startNodeGraphDFS(dfs, graph->vertices[ig]);
+		while (length == 0 && getNextNodeGraphDFSEvent(dfs, &event)) {
+			if (event.type == NODEGRAPH_DFS_BACK_EDGE) {
+				// the cycle is the path from the edge target to the top
+				int depth = event.depth;
+				while (dfs->frames[depth].vertex != event.toVertex) {
+					depth--;
+				}
+				for ( ; depth <= event.depth; depth++) {
+					cycle[length++] = dfs->frames[depth].vertex;
+				}
+			}
+		}
+	}
+	cycle[length] = (GraphNodeVertex*)NULL;
+	freeNodeGraphDFS(dfs);
+	return length;
+}
+
+/**
+ * Computes the strongly connected components of the graph with Tarjan's
+ * algorithm. Each vertex is assigned the number of its component, and
+ * components are numbered in reverse topological order of the component
+ * graph: edges between components go from higher to lower numbers.
+ *
+ * @param graph the graph
+ * @param component array of component numbers by vertex index
+ *   (size of array == vertex count)
+ * @return the number of components
+ */
+int getNodeGraphStronglyConnectedComponents(NodeGraph* graph, int* component) {
+	int n = graph->vertexCount;
+	int* order = (int*)malloc((n+1) * sizeof(int));		// discovery order
+	int* low = (int*)malloc((n+1) * sizeof(int));		// lowest order reachable
+	int* stack = (int*)malloc((n+1) * sizeof(int));		// vertices not yet assigned
+	for (int i = 0; i < n; i++) {
+		component[i] = -1;
+	}
+
+	NodeGraphDFS* dfs = createNodeGraphDFS(graph);
+	NodeGraphDFSEvent event;
+	int discovered = 0;
+	int stackSize = 0;
+	int componentCount = 0;
+	for (int ig = 0; ig < n; ig++) {
+		startNodeGraphDFS(dfs, graph->vertices[ig]);
+		while (getNextNodeGraphDFSEvent(dfs, &event)) {
+			int v = event.vertex->index;
+			switch (event.type) {
+			case NODEGRAPH_DFS_DISCOVER:
+				order[v] = low[v] = discovered++;
+				stack[stackSize++] = v;
+				break;
+			case NODEGRAPH_DFS_BACK_EDGE:
+			case NODEGRAPH_DFS_CROSS_EDGE:
+				// only vertices not yet in a component are on the stack
+				if (component[event.toVertex->index] < 0 && order[event.toVertex->index] < low[v]) {
+					low[v] = order[event.toVertex->index];
+				}
+				break;
+			case NODEGRAPH_DFS_FINISH:
+				if (low[v] == order[v]) {
+					int w;
+					do {
+						w = stack[--stackSize];
+						component[w] = componentCount;
+					} while (w != v);
+					componentCount++;
+				}
+				if (event.toVertex != (GraphNodeVertex*)NULL
+						&& low[v] < low[event.toVertex->index]) {
+					low[event.toVertex->index] = low[v];
+				}
+				break;
+			case NODEGRAPH_DFS_TREE_EDGE:
+				break;
+			}
+		}
+	}
+
+	freeNodeGraphDFS(dfs);
+	free(stack);
+	free(low);
+	free(order);
+	return componentCount;
+}
@@ -0,0 +1,181 @@
+/*
+ * node_graph_dfs.h
+ *
+ * This file provides the structures and function declarations of a
+ * NodeGraphDFS, an event-based depth-first traversal of a NodeGraph.
+ * The traversal reports when vertices are discovered and finished, and
+ * classifies each edge it examines. Its state can be reused for many
+ * traversals of the same graph without reallocation, so algorithms such
+ * as cycle detection and strongly connected components share one
+ * traversal core.
+ */
+
+#ifndef NODE_GRAPH_DFS_H_
+#define NODE_GRAPH_DFS_H_
+
+#include <stdbool.h>
+#include "node_graph.h"
+
+/**
+ * Types of depth-first traversal events
+ */
+typedef enum {
+	NODEGRAPH_DFS_DISCOVER,			// vertex is reached for the first time
+	NODEGRAPH_DFS_FINISH,			// all edges of vertex have been examined
+	NODEGRAPH_DFS_TREE_EDGE,		// edge to an undiscovered vertex
+	NODEGRAPH_DFS_BACK_EDGE,		// edge to a vertex on the current path
+	NODEGRAPH_DFS_CROSS_EDGE		// edge to a finished vertex (forward or cross)
+} NodeGraphDFSEventType;
+
+/**
+ * A depth-first traversal event. For edge events, vertex is the vertex
+ * the edge is from and toVertex is the vertex it is to. For a finish
+ * event, toVertex is the parent of the finished vertex in the traversal,
+ * or NULL for the start vertex. For a discover event, toVertex is NULL.
+ */
+typedef struct {
+	NodeGraphDFSEventType type;		// the type of event
+	GraphNodeVertex* vertex;		// the vertex of the event
+	GraphNodeVertex* toVertex;		// the other vertex of the event, or NULL
+	int depth;						// depth of vertex in the traversal
+} NodeGraphDFSEvent;
+
+/**
+ * A frame of the traversal stack
+ */
+typedef struct {
+	GraphNodeVertex* vertex;		// vertex on the current path
+	int nextEdge;					// next edge to examine, or -1 if not discovered
+} NodeGraphDFSFrame;
+
+/**
+ * The state of a depth-first traversal. Vertices are marked discovered
+ * and finished with the generation of the traversal, so that all marks
+ * are cleared by starting a new generation.
+ */
+typedef struct {
+	NodeGraph* graph;				// the graph
+	unsigned* discovered;			// generation in which vertex was discovered
+	unsigned* finished;				// generation in which vertex was finished
+	int markCapacity;				// capacity of the mark arrays
+	unsigned generation;			// the current generation
+	NodeGraphDFSFrame* frames;		// the traversal stack
+	int top;						// index of the top frame, or -1 if empty
+	int frameCapacity;				// capacity of the traversal stack
+} NodeGraphDFS;
+
+/**
+ * Create a new depth-first traversal state for the graph.
+ *
+ * @param graph the graph
+ * @return a new NodeGraphDFS
+ */
+NodeGraphDFS* createNodeGraphDFS(NodeGraph* graph);
+
+/**
+ * Frees a depth-first traversal state.
+ *
+ * @param dfs the NodeGraphDFS
+ */
+void freeNodeGraphDFS(NodeGraphDFS* dfs);
+
+/**
+ * Clears the discovered and finished marks of all vertices, and empties
+ * the traversal stack. Clearing the marks takes constant time.
+ *
+ * @param dfs the NodeGraphDFS
+ */
+void resetNodeGraphDFS(NodeGraphDFS* dfs);
+
+/**
+ * Starts traversing from the start vertex. Vertices discovered by
+ * earlier traversals since the last reset are not discovered again, so
+ * starting from each vertex in turn traverses a depth-first forest.
+ *
+ * @param dfs the NodeGraphDFS
+ * @param startVertex the start vertex
+ * @return true if the traversal started, false if the start vertex
+ *   was already discovered
+ */
+bool startNodeGraphDFS(NodeGraphDFS* dfs, GraphNodeVertex* startVertex);
+
+/**
+ * Gets the next event of the traversal.
+ *
+ * @param dfs the NodeGraphDFS
+ * @param event the event
+ * @return true if there was another event, false if the traversal from
+ *   the start vertex is complete
+ */
+bool getNextNodeGraphDFSEvent(NodeGraphDFS* dfs, NodeGraphDFSEvent* event);
+
+/**
+ * Skips the remaining edges of the vertex on top of the traversal
+ * stack, so that the next event finishes it.
+ *
+ * @param dfs the NodeGraphDFS
+ */
+void skipNodeGraphDFSEdges(NodeGraphDFS* dfs);
+
+/**
+ * Clears the discovered and finished marks of a finished vertex, so that
+ * it can be discovered again through another path. Forgetting vertices
+ * as they finish enumerates simple paths rather than a tree.
+ *
+ * @param dfs the NodeGraphDFS
+ * @param vertex the vertex
+ */
+void forgetNodeGraphDFSVertex(NodeGraphDFS* dfs, GraphNodeVertex* vertex);
+
+/**
+ * Determines whether the vertex has been discovered since the last reset.
+ *
+ * @param dfs the NodeGraphDFS
+ * @param vertex the vertex
+ * @return true if the vertex has been discovered
+ */
+bool isNodeGraphDFSDiscovered(NodeGraphDFS* dfs, GraphNodeVertex* vertex);
+
+/**
+ * Returns the number of vertices on the current traversal path.
+ *
+ * @param dfs the NodeGraphDFS
+ * @return the number of vertices on the path
+ */
+int getNodeGraphDFSPathLength(NodeGraphDFS* dfs);
+
+/**
+ * Returns a vertex on the current traversal path.
+ *
+ * @param dfs the NodeGraphDFS
+ * @param depth the depth of the vertex on the path, from 0 for the start vertex
+ * @return the vertex at that depth, or NULL if depth is out of range
+ */
+GraphNodeVertex* getNodeGraphDFSPathVertex(NodeGraphDFS* dfs, int depth);
+
+/**
+ * Places the vertices of a cycle of the graph in the cycle array. The
+ * first vertex of the cycle has an edge from the last one. The cycle
+ * array is null-terminated after the vertices of the cycle.
+ *
+ * @param graph the graph
+ * @param cycle an array of GraphNodeVertex* for the cycle
+ *   (size of array must be vertex count+1)
+ * @return the number of vertices in the cycle, or 0 if the graph is acyclic
+ */
+int findNodeGraphCycle(NodeGraph* graph, GraphNodeVertex** cycle);
+
+/**
+ * Computes the strongly connected components of the graph with Tarjan's
+ * algorithm. Each vertex is assigned the number of its component, and
+ * components are numbered in reverse topological order of the component
+ * graph: edges between components go from higher to lower numbers.
+ *
+ * @param graph the graph
+ * @param component array of component numbers by vertex index
+ *   (size of array == vertex count)
+ * @return the number of components
+ */
+int getNodeGraphStronglyConnectedComponents(NodeGraph* graph, int* component);
+
+#endif /* NODE_GRAPH_DFS_H_ */
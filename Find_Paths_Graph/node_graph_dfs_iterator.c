@@ -35,6 +35,9 @@ NodeGraphDFSIterator* createNodeGraphDFSIterator(
 	itr->count = 0;
 	itr->startNodeVertex = startNodeVertex;
 	itr->visited = createHashSet();
+#ifdef NODEGRAPH_STATS
+	clearNodeGraphStats(&itr->stats);
+#endif
 
 	// Mark the current node vertex as visited and enqueue it
 	addHashSetKey(itr->visited, startNodeVertex);
@@ -66,7 +69,10 @@ void freeNodeGraphDFSIterator(NodeGraphDFSIterator* itr) {
  * @return true if node vertex has been visited
  */
 static bool isGraphNodeVertexVisited(NodeGraphDFSIterator* itr, GraphNodeVertex* node) {
-	return containsHashSetKey(itr->visited, node);
+	bool visited = containsHashSetKey(itr->visited, node);
+	NODEGRAPH_STATS_COUNT(&itr->stats, visitedProbes, 1);
+	NODEGRAPH_STATS_COUNT(&itr->stats, visitedHits, visited);
+	return visited;
 }
 
 
@@ -94,6 +100,9 @@ GraphNodeVertex* getNextGraphNodeVertexDFS(NodeGraphDFSIterator* itr) {
 		QueueData* data = popArrayQueueData(itr->queue, &(QueueData){});
 		nextNode = data->node;
 		itr->count++;
+		NODEGRAPH_STATS_TIMER_START(searchStart);
+		NODEGRAPH_STATS_COUNT(&itr->stats, verticesExpanded, 1);
+		NODEGRAPH_STATS_COUNT(&itr->stats, edgesScanned, nextNode->edgeCount);
 
         // Get all adjacent vertices of the dequeued vertex nextNode
         // If a adjacent has not been visited, then mark it visited
@@ -105,6 +114,8 @@ GraphNodeVertex* getNextGraphNodeVertexDFS(NodeGraphDFSIterator* itr) {
 				pushArrayQueueData(itr->queue, (QueueData){vertexForEdge});
 			}
 		}
+		NODEGRAPH_STATS_HIGH_WATER(&itr->stats, queueHighWater, getArrayQueueSize(itr->queue));
+		NODEGRAPH_STATS_TIMER_STOP(&itr->stats, NODEGRAPH_PHASE_SEARCH, searchStart);
 	}
 	return nextNode;
 }
@@ -149,6 +160,9 @@ bool resetNodeGraphDFSIterator(NodeGraphDFSIterator* itr) {
 	clearArrayQueue(itr->queue);
 	enqueueArrayQueueData(itr->queue, (QueueData){itr->startNodeVertex});
 	clearHashSet(itr->visited);
+#ifdef NODEGRAPH_STATS
+	clearNodeGraphStats(&itr->stats);
+#endif
 	return true;
 }
 
@@ -171,3 +185,19 @@ int getNodeGraphDFSIteratorAvailable(NodeGraphDFSIterator* itr)
 {
 	return NODEGRAPH_DFS_ITR_UNAVAILABLE;
 }
+
+/**
+ * Returns the traversal stats of the iterator. The stats are recorded
+ * only if compiled with NODEGRAPH_STATS, and are cleared on reset.
+ *
+ * @param itr the NodeGraphDFSIterator
+ * @return the stats for the traversal so far
+ */
+const NodeGraphStats* getNodeGraphDFSIteratorStats(NodeGraphDFSIterator* itr) {
+#ifdef NODEGRAPH_STATS
+	return &itr->stats;
+#else
+	static const NodeGraphStats noStats;	// stats are not recorded
+	return &noStats;
+#endif
+}
@@ -0,0 +1,237 @@
+/*
+ * node_graph_generators.c
+ *
+ * This file provides the implementations of generators that build
+ * synthetic NodeGraphs with well-known structure for tests and
+ * benchmarks.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "node_graph_generators.h"
+
+/**
+ * Vertex data label of generated node vertices
+ */
+const char* const GENERATED_VERTEX_LABEL = "generated";
+
+/**
+ * Returns the next value of a splitmix64 random sequence. Unlike rand(),
+ * the sequence is the same on every platform and does not share state
+ * with other users of the C library generator.
+ *
+ * @param state the random state
+ * @return the next 64-bit random value
+ */
+static uint64_t nextGeneratorRandom(uint64_t* state) {
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/**
+ * Returns a random index in the range [0, n).
+ *
+ * @param state the random state
+ * @param n the size of the range
+ * @return a random index
+ */
+static int nextGeneratorIndex(uint64_t* state, int n) {
+	return (int)(nextGeneratorRandom(state) % (uint64_t)n);
+}
+
+/**
+ * Returns a random double in the range [0, 1).
+ *
+ * @param state the random state
+ * @return a random double
+ */
+static double nextGeneratorDouble(uint64_t* state) {
+	return (nextGeneratorRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * Create a graph with the specified number of vertices and no edges.
+ *
+ * @param vertexCount the number of vertices
+ * @return the new graph
+ */
+static NodeGraph* createGeneratedNodeGraph(int vertexCount) {
+	NodeGraph* graph = createNodeGraph();
+	for (int i = 0; i < vertexCount; i++) {
+		addGraphNodeVertexForData(graph, (GraphVertexData){GENERATED_VERTEX_LABEL});
+	}
+	return graph;
+}
+
+/**
+ * Create an Erdos-Renyi G(n,m) random graph with the specified number
+ * of vertices and distinct directed edges chosen uniformly at random.
+ * Self edges are not generated.
+ *
+ * @param vertexCount the number of vertices
+ * @param edgeCount the number of edges; limited to n*(n-1)
+ * @param seed the random seed
+ * @return the new graph
+ */
+NodeGraph* createErdosRenyiNodeGraph(int vertexCount, long edgeCount, unsigned long seed) {
+	NodeGraph* graph = createGeneratedNodeGraph(vertexCount);
+	long maxEdges = (long)vertexCount * (vertexCount-1);
+	if (edgeCount > maxEdges) {
+		edgeCount = maxEdges;
+	}
+	uint64_t state = seed;
+	for (long added = 0; added < edgeCount; ) {
+		int from = nextGeneratorIndex(&state, vertexCount);
+		int to = nextGeneratorIndex(&state, vertexCount);
+		if (from != to && addEdgeToGraphNodeVertex(
+				graph->vertices[from], graph->vertices[to], (GraphEdgeData){}) != NULL) {
+			added++;
+		}
+	}
+	return graph;
+}
+
+/**
+ * Create an R-MAT (recursive matrix) graph with 2^scale vertices. Each
+ * edge is placed by recursively choosing a quadrant of the adjacency
+ * matrix with probabilities a, b, c, and 1-a-b-c, which gives a skewed,
+ * community-structured degree distribution like the Graph500 Kronecker
+ * generator. Duplicate and self edges are discarded, so the graph may
+ * have fewer than edgeFactor * 2^scale edges.
+ *
+ * @param scale log2 of the number of vertices
+ * @param edgeFactor the number of edges to generate per vertex
+ * @param a probability of the upper left quadrant
+ * @param b probability of the upper right quadrant
+ * @param c probability of the lower left quadrant
+ * @param seed the random seed
+ * @return the new graph
+ */
+NodeGraph* createRMATNodeGraph(int scale, int edgeFactor,
+		double a, double b, double c, unsigned long seed) {
+	assert(scale >= 0 && scale < 31);
+	int vertexCount = 1 << scale;
+	NodeGraph* graph = createGeneratedNodeGraph(vertexCount);
+	uint64_t state = seed;
+	long edgeCount = (long)edgeFactor * vertexCount;
+	for (long e = 0; e < edgeCount; e++) {
+		int from = 0;
+		int to = 0;
+		for (int bit = scale-1; bit >= 0; bit--) {
+			double r = nextGeneratorDouble(&state);
+			if (r < a) {
+				// upper left quadrant
+			} else if (r < a+b) {
+				to |= 1 << bit;
+			} else if (r < a+b+c) {
+				from |= 1 << bit;
+			} else {
+				from |= 1 << bit;
+				to |= 1 << bit;
+			}
+		}
+		if (from != to) {
+			addEdgeToGraphNodeVertex(
+				graph->vertices[from], graph->vertices[to], (GraphEdgeData){});
+		}
+	}
+	return graph;
+}
+
+/**
+ * Create a width x height grid graph with bidirectional edges between
+ * horizontally and vertically neighboring cells. Vertex index is
+ * y * width + x.
+ *
+ * @param width the width of the grid
+ * @param height the height of the grid
+ * @return the new graph
+ */
+NodeGraph* createGridNodeGraph(int width, int height) {
+	NodeGraph* graph = createGeneratedNodeGraph(width * height);
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			GraphNodeVertex* cell = graph->vertices[y*width + x];
+			if (x+1 < width) {
+				addBidirectionalEdgeToGraphNodeVertex(
+					cell, graph->vertices[y*width + x+1], (GraphEdgeData){});
+			}
+			if (y+1 < height) {
+				addBidirectionalEdgeToGraphNodeVertex(
+					cell, graph->vertices[(y+1)*width + x], (GraphEdgeData){});
+			}
+		}
+	}
+	return graph;
+}
+
+/**
+ * Create a layered directed acyclic graph. Each vertex in a layer has
+ * edges to degree distinct random vertices in the next layer. Vertex
+ * index is layer * width + position, so vertex 0 is in the first layer
+ * and the last vertex is in the last layer.
+ *
+ * @param layers the number of layers
+ * @param width the number of vertices in each layer
+ * @param degree the number of edges from each vertex; limited to width
+ * @param seed the random seed
+ * @return the new graph
+ */
+NodeGraph* createLayeredDAGNodeGraph(int layers, int width, int degree, unsigned long seed) {
+	NodeGraph* graph = createGeneratedNodeGraph(layers * width);
+	if (degree > width) {
+		degree = width;
+	}
+	uint64_t state = seed;
+	for (int layer = 0; layer+1 < layers; layer++) {
+		GraphNodeVertex** nextLayer = &graph->vertices[(layer+1) * width];
+		for (int i = 0; i < width; i++) {
+			GraphNodeVertex* vertex = graph->vertices[layer*width + i];
+			while (vertex->edgeCount < degree) {
+				addEdgeToGraphNodeVertex(vertex,
+					nextLayer[nextGeneratorIndex(&state, width)], (GraphEdgeData){});
+			}
+		}
+	}
+	return graph;
+}
+
+/**
+ * Create a power-law graph by Barabasi-Albert preferential attachment.
+ * Each new vertex adds bidirectional edges to degree distinct existing
+ * vertices chosen with probability proportional to their degree.
+ *
+ * @param vertexCount the number of vertices
+ * @param degree the number of edges added by each new vertex
+ * @param seed the random seed
+ * @return the new graph
+ */
+NodeGraph* createPowerLawNodeGraph(int vertexCount, int degree, unsigned long seed) {
+	NodeGraph* graph = createGeneratedNodeGraph(vertexCount);
+	uint64_t state = seed;
+
+	// each edge adds both of its vertices, so a vertex appears once per degree
+	int* endpoints = (int*)malloc(((long)2*degree*vertexCount + 1) * sizeof(int));
+	assert(endpoints != (int*)NULL);
+	long endpointCount = 0;
+	for (int i = 1; i < vertexCount; i++) {
+		GraphNodeVertex* vertex = graph->vertices[i];
+		int targets = (degree < i) ? degree : i;
+		for (int attempts = 0; vertex->edgeCount < targets; attempts++) {
+			// fall back to a uniform choice if repeatedly choosing existing edges
+			int to = (endpointCount == 0 || attempts > 8*degree)
+				? nextGeneratorIndex(&state, i)
+				: endpoints[nextGeneratorRandom(&state) % (uint64_t)endpointCount];
+			if (addBidirectionalEdgeToGraphNodeVertex(
+					vertex, graph->vertices[to], (GraphEdgeData){}) != NULL) {
+				endpoints[endpointCount++] = i;
+				endpoints[endpointCount++] = to;
+			}
+		}
+	}
+	free(endpoints);
+	return graph;
+}
@@ -0,0 +1,88 @@
+/*
+ * node_graph_generators.h
+ *
+ * This file provides the function declarations of generators that build
+ * synthetic NodeGraphs with well-known structure for tests and
+ * benchmarks. Generators that are random take a seed, and produce the
+ * same graph for the same seed on every platform.
+ */
+
+#ifndef NODE_GRAPH_GENERATORS_H_
+#define NODE_GRAPH_GENERATORS_H_
+
+#include "node_graph.h"
+
+/**
+ * Vertex data label of generated node vertices
+ */
+extern const char* const GENERATED_VERTEX_LABEL;
+
+/**
+ * Create an Erdos-Renyi G(n,m) random graph with the specified number
+ * of vertices and distinct directed edges chosen uniformly at random.
+ * Self edges are not generated.
+ *
+ * @param vertexCount the number of vertices
+ * @param edgeCount the number of edges; limited to n*(n-1)
+ * @param seed the random seed
+ * @return the new graph
+ */
+NodeGraph* createErdosRenyiNodeGraph(int vertexCount, long edgeCount, unsigned long seed);
+
+/**
+ * Create an R-MAT (recursive matrix) graph with 2^scale vertices. Each
+ * edge is placed by recursively choosing a quadrant of the adjacency
+ * matrix with probabilities a, b, c, and 1-a-b-c, which gives a skewed,
+ * community-structured degree distribution like the Graph500 Kronecker
+ * generator. Duplicate and self edges are discarded, so the graph may
+ * have fewer than edgeFactor * 2^scale edges.
+ *
+ * @param scale log2 of the number of vertices
+ * @param edgeFactor the number of edges to generate per vertex
+ * @param a probability of the upper left quadrant
+ * @param b probability of the upper right quadrant
+ * @param c probability of the lower left quadrant
+ * @param seed the random seed
+ * @return the new graph
+ */
+NodeGraph* createRMATNodeGraph(int scale, int edgeFactor,
+		double a, double b, double c, unsigned long seed);
+
+/**
+ * Create a width x height grid graph with bidirectional edges between
+ * horizontally and vertically neighboring cells. Vertex index is
+ * y * width + x.
+ *
+ * @param width the width of the grid
+ * @param height the height of the grid
+ * @return the new graph
+ */
+NodeGraph* createGridNodeGraph(int width, int height);
+
+/**
+ * Create a layered directed acyclic graph. Each vertex in a layer has
+ * edges to degree distinct random vertices in the next layer. Vertex
+ * index is layer * width + position, so vertex 0 is in the first layer
+ * and the last vertex is in the last layer.
+ *
+ * @param layers the number of layers
+ * @param width the number of vertices in each layer
+ * @param degree the number of edges from each vertex; limited to width
+ * @param seed the random seed
+ * @return the new graph
+ */
+NodeGraph* createLayeredDAGNodeGraph(int layers, int width, int degree, unsigned long seed);
+
+/**
+ * Create a power-law graph by Barabasi-Albert preferential attachment.
+ * Each new vertex adds bidirectional edges to degree distinct existing
+ * vertices chosen with probability proportional to their degree.
+ *
+ * @param vertexCount the number of vertices
+ * @param degree the number of edges added by each new vertex
+ * @param seed the random seed
+ * @return the new graph
+ */
+NodeGraph* createPowerLawNodeGraph(int vertexCount, int degree, unsigned long seed);
+
+#endif /* NODE_GRAPH_GENERATORS_H_ */
@@ -0,0 +1,275 @@
+/*
+ * node_graph_neighborhood.c
+ *
+ * This file provides the implementations of a NodeGraphNeighborhood,
+ * which finds the vertices within k hops of a set of seed vertices and
+ * extracts the subgraph they induce.
+ *
+ * Reached vertices are marked in a bitmap, and each hop expands the
+ * range of the vertex list that the previous hop added, so the frontier
+ * needs no storage of its own. Expansions around small seed sets touch
+ * only the words of the bitmap they set, rather than the whole bitmap.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "node_graph_neighborhood.h"
+
+#ifndef DEFAULT_NEIGHBORHOOD_CAPACITY
+#define DEFAULT_NEIGHBORHOOD_CAPACITY 64
+#endif
+
+/**
+ * Ensures the bitmap and position arrays cover every vertex of the graph.
+ *
+ * @param neighborhood the NodeGraphNeighborhood
+ */
+static void ensureNeighborhoodMarks(NodeGraphNeighborhood* neighborhood) {
+	int n = neighborhood->graph->vertexCount;
+	if (n <= neighborhood->markCapacity) {
+		return;
+	}
+	int capacity = (neighborhood->markCapacity > 0)
+				 ? neighborhood->markCapacity : DEFAULT_NEIGHBORHOOD_CAPACITY;
+	while (capacity < n) {
+		capacity *= 2;
+	}
+	int oldWords = neighborhood->markCapacity / 64;
+	int words = capacity / 64;
+	neighborhood->reached =
+		(uint64_t*)realloc(neighborhood->reached, words * sizeof(uint64_t));
+	neighborhood->position = (int*)realloc(neighborhood->position, capacity * sizeof(int));
+	neighborhood->vertices = (int*)realloc(neighborhood->vertices, capacity * sizeof(int));
+	assert(neighborhood->reached != (uint64_t*)NULL
+		&& neighborhood->position != (int*)NULL && neighborhood->vertices != (int*)NULL);
+	memset(&neighborhood->reached[oldWords], 0, (words - oldWords) * sizeof(uint64_t));
+	neighborhood->markCapacity = capacity;
+}
+
+/**
+ * Create a neighborhood for the graph.
+ *
+ * @param graph the graph
+ * @return a new NodeGraphNeighborhood
+ */
+NodeGraphNeighborhood* createNodeGraphNeighborhood(NodeGraph* graph) {
+	NodeGraphNeighborhood* neighborhood =
+		(NodeGraphNeighborhood*)malloc(sizeof(NodeGraphNeighborhood));
+	neighborhood->graph = graph;
+	neighborhood->reached = (uint64_t*)NULL;
+	neighborhood->position = (int*)NULL;
+	neighborhood->vertices = (int*)NULL;
+	neighborhood->markCapacity = 0;
+	neighborhood->vertexCount = 0;
+	neighborhood->hopCount = 0;
+	neighborhood->levelCapacity = 8;
+	neighborhood->levelStart = (int*)calloc(neighborhood->levelCapacity, sizeof(int));
+	ensureNeighborhoodMarks(neighborhood);
+	return neighborhood;
+}
+
+/**
+ * Frees a neighborhood.
+ *
+ * @param neighborhood the NodeGraphNeighborhood to free
+ */
+void freeNodeGraphNeighborhood(NodeGraphNeighborhood* neighborhood) {
+	free(neighborhood->levelStart);
+	free(neighborhood->vertices);
+	free(neighborhood->position);
+	free(neighborhood->reached);
+	neighborhood->levelStart = (int*)NULL;
+	neighborhood->vertices = (int*)NULL;
+	neighborhood->position = (int*)NULL;
+	neighborhood->reached = (uint64_t*)NULL;
+	neighborhood->graph = (NodeGraph*)NULL;
+	free(neighborhood);
+}
+
+/**
+ * Determines whether the vertex index is marked reached.
+ *
+ * @param neighborhood the NodeGraphNeighborhood
+ * @param v the vertex index
+ * @return true if the vertex is reached
+ */
+static inline bool isNeighborhoodReached(const NodeGraphNeighborhood* neighborhood, int v) {
+	return (neighborhood->reached[v >> 6] >> (v & 63)) & 1;
+}
+
+/**
+ * Marks the vertex index reached and appends it to the vertex list if
+ * it was not already reached.
+ *
+ * @param neighborhood the NodeGraphNeighborhood
+ * @param v the vertex index
+ */
+static inline void reachNeighborhoodVertex(NodeGraphNeighborhood* neighborhood, int v) {
+	uint64_t bit = 1ULL << (v & 63);
+	if ((neighborhood->reached[v >> 6] & bit) == 0) {
+		neighborhood->reached[v >> 6] |= bit;
+		neighborhood->position[v] = neighborhood->vertexCount;
+		neighborhood->vertices[neighborhood->vertexCount++] = v;
+	}
+}
+
+/**
+ * Finds the vertices that can be reached from the seed vertices by
+ * following at most hops edges, replacing the previous contents of the
+ * neighborhood. The seeds are at hop 0.
+ *
+ * @param neighborhood the NodeGraphNeighborhood
+ * @param seeds the seed vertices
+ * @param seedCount the number of seed vertices
+ * @param hops the maximum number of edges from a seed
+ * @return the number of vertices in the neighborhood
+ */
+int expandNodeGraphNeighborhood(NodeGraphNeighborhood* neighborhood,
+		GraphNodeVertex** seeds, int seedCount, int hops) {
+	// every set bit belongs to a listed vertex, so clear only their words
+	for (int i = 0; i < neighborhood->vertexCount; i++) {
+		neighborhood->reached[neighborhood->vertices[i] >> 6] = 0;
+	}
+	neighborhood->vertexCount = 0;
+	ensureNeighborhoodMarks(neighborhood);
+	if (hops + 2 > neighborhood->levelCapacity) {
+		neighborhood->levelCapacity = hops + 2;
+		neighborhood->levelStart = (int*)realloc(
+			neighborhood->levelStart, neighborhood->levelCapacity * sizeof(int));
+		assert(neighborhood->levelStart != (int*)NULL);
+	}
+
+	GraphNodeVertex** vertices = neighborhood->graph->vertices;
+	for (int i = 0; i < seedCount; i++) {
+		reachNeighborhoodVertex(neighborhood, seeds[i]->index);
+	}
+	neighborhood->levelStart[0] = 0;
+	int hop = 0;
+	for ( ; hop < hops; hop++) {
+		// the frontier is the range of vertices added by the previous hop
+		int begin = neighborhood->levelStart[hop];
+		int end = neighborhood->vertexCount;
+		neighborhood->levelStart[hop+1] = end;
+		if (begin == end) {
+			break;
+		}
+		for (int i = begin; i < end; i++) {
+			GraphNodeVertex* vtx = vertices[neighborhood->vertices[i]];
+			for (int iv = 0; iv < vtx->edgeCount; iv++) {
+				reachNeighborhoodVertex(neighborhood, vtx->edgeTo[iv].vertex->index);
+			}
+		}
+	}
+	neighborhood->levelStart[hop+1] = neighborhood->vertexCount;
+	// the last hop may have reached no new vertices
+	if (hop > 0 && neighborhood->levelStart[hop] == neighborhood->vertexCount) {
+		hop--;
+	}
+	neighborhood->hopCount = hop;
+	return neighborhood->vertexCount;
+}
+
+/**
+ * Determines whether a vertex is in the neighborhood.
+ *
+ * @param neighborhood the NodeGraphNeighborhood
+ * @param vertex the vertex
+ * @return true if the vertex is in the neighborhood
+ */
+bool isInNodeGraphNeighborhood(NodeGraphNeighborhood* neighborhood, GraphNodeVertex* vertex) {
+	return vertex->index >= 0 && vertex->index < neighborhood->markCapacity
+		&& isNeighborhoodReached(neighborhood, vertex->index);
+}
+
+/**
+ * Returns the number of hops from the seeds to a vertex.
+ *
+ * @param neighborhood the NodeGraphNeighborhood
+ * @param vertex the vertex
+ * @return the number of hops, or -1 if the vertex is not in the neighborhood
+ */
+int getNodeGraphNeighborhoodHops(NodeGraphNeighborhood* neighborhood, GraphNodeVertex* vertex) {
+	if (!isInNodeGraphNeighborhood(neighborhood, vertex)) {
+		return -1;
+	}
+	int position = neighborhood->position[vertex->index];
+	int hop = 0;
+	while (position >= neighborhood->levelStart[hop+1]) {
+		hop++;
+	}
+	return hop;
+}
+
+/**
+ * Create a graph of the neighborhood vertices and the edges between
+ * them. Vertex i of the new graph has the data of neighborhood vertex i,
+ * and edges keep their data.
+ *
+ * @param neighborhood the NodeGraphNeighborhood
+ * @return a new NodeGraph
+ */
+NodeGraph* createNodeGraphNeighborhoodSubgraph(NodeGraphNeighborhood* neighborhood) {
+	NodeGraph* subgraph = createNodeGraphWithArena(0);
+	GraphNodeVertex** vertices = neighborhood->graph->vertices;
+	for (int i = 0; i < neighborhood->vertexCount; i++) {
+		addGraphNodeVertexForData(subgraph, vertices[neighborhood->vertices[i]]->data);
+	}
+	for (int i = 0; i < neighborhood->vertexCount; i++) {
+		GraphNodeVertex* vtx = vertices[neighborhood->vertices[i]];
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			int to = vtx->edgeTo[iv].vertex->index;
+			if (isNeighborhoodReached(neighborhood, to)) {
+				addEdgeToGraphNodeVertex(subgraph->vertices[i],
+					subgraph->vertices[neighborhood->position[to]], vtx->edgeTo[iv].data);
+			}
+		}
+	}
+	return subgraph;
+}
+
+/**
+ * Create a CSR view of the neighborhood vertices and the edges between
+ * them, without creating a graph. Vertex i of the view is neighborhood
+ * vertex i.
+ *
+ * @param neighborhood the NodeGraphNeighborhood
+ * @return a new NodeGraphCSR
+ */
+NodeGraphCSR* createNodeGraphNeighborhoodCSR(NodeGraphNeighborhood* neighborhood) {
+	NodeGraphCSR* csr = (NodeGraphCSR*)malloc(sizeof(NodeGraphCSR));
+	int n = neighborhood->vertexCount;
+	GraphNodeVertex** vertices = neighborhood->graph->vertices;
+	csr->vertexCount = n;
+	csr->transposed = false;
+	csr->outDegree = (int*)malloc((n+1) * sizeof(int));
+	csr->offsets = (long*)malloc((n+1) * sizeof(long));
+	assert(csr->outDegree != (int*)NULL && csr->offsets != (long*)NULL);
+
+	// count the edges that stay in the neighborhood, then fill them in
+	csr->edgeCount = 0;
+	for (int i = 0; i < n; i++) {
+		GraphNodeVertex* vtx = vertices[neighborhood->vertices[i]];
+		int degree = 0;
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			degree += isNeighborhoodReached(neighborhood, vtx->edgeTo[iv].vertex->index);
+		}
+		csr->offsets[i] = csr->edgeCount;
+		csr->outDegree[i] = degree;
+		csr->edgeCount += degree;
+	}
+	csr->offsets[n] = csr->edgeCount;
+	csr->neighbors = (int*)malloc((csr->edgeCount+1) * sizeof(int));
+	assert(csr->neighbors != (int*)NULL);
+	long edge = 0;
+	for (int i = 0; i < n; i++) {
+		GraphNodeVertex* vtx = vertices[neighborhood->vertices[i]];
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			int to = vtx->edgeTo[iv].vertex->index;
+			if (isNeighborhoodReached(neighborhood, to)) {
+				csr->neighbors[edge++] = neighborhood->position[to];
+			}
+		}
+	}
+	return csr;
+}
@@ -0,0 +1,102 @@
+/*
+ * node_graph_neighborhood.h
+ *
+ * This file provides the structures and function declarations of a
+ * NodeGraphNeighborhood, which finds the vertices within k hops of a set
+ * of seed vertices and extracts the subgraph they induce.
+ */
+
+#ifndef NODE_GRAPH_NEIGHBORHOOD_H_
+#define NODE_GRAPH_NEIGHBORHOOD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "node_graph.h"
+#include "node_graph_csr.h"
+
+/**
+ * The vertices within k hops of a set of seeds. The vertices are listed
+ * in order of hops: the vertices first reached at hop h are vertices
+ * [levelStart[h], levelStart[h+1]). A neighborhood is reused for many
+ * expansions, and each expansion clears only what the previous one set.
+ */
+typedef struct {
+	NodeGraph* graph;				// the graph
+	uint64_t* reached;				// bitmap of reached vertices by vertex index
+	int* position;					// position in vertices by vertex index, if reached
+	int markCapacity;				// number of vertices the bitmap and positions cover
+	int* vertices;					// indexes of reached vertices in order of hops
+	int vertexCount;				// number of reached vertices
+	int* levelStart;				// first position of each hop (size hopCount+2)
+	int hopCount;					// largest number of hops to a vertex
+	int levelCapacity;				// capacity of the levelStart array
+} NodeGraphNeighborhood;
+
+/**
+ * Create a neighborhood for the graph.
+ *
+ * @param graph the graph
+ * @return a new NodeGraphNeighborhood
+ */
+NodeGraphNeighborhood* createNodeGraphNeighborhood(NodeGraph* graph);
+
+/**
+ * Frees a neighborhood.
+ *
+ * @param neighborhood the NodeGraphNeighborhood to free
+ */
+void freeNodeGraphNeighborhood(NodeGraphNeighborhood* neighborhood);
+
+/**
+ * Finds the vertices that can be reached from the seed vertices by
+ * following at most hops edges, replacing the previous contents of the
+ * neighborhood. The seeds are at hop 0.
+ *
+ * @param neighborhood the NodeGraphNeighborhood
+ * @param seeds the seed vertices
+ * @param seedCount the number of seed vertices
+ * @param hops the maximum number of edges from a seed
+ * @return the number of vertices in the neighborhood
+ */
+int expandNodeGraphNeighborhood(NodeGraphNeighborhood* neighborhood,
+		GraphNodeVertex** seeds, int seedCount, int hops);
+
+/**
+ * Determines whether a vertex is in the neighborhood.
+ *
+ * @param neighborhood the NodeGraphNeighborhood
+ * @param vertex the vertex
+ * @return true if the vertex is in the neighborhood
+ */
+bool isInNodeGraphNeighborhood(NodeGraphNeighborhood* neighborhood, GraphNodeVertex* vertex);
+
+/**
+ * Returns the number of hops from the seeds to a vertex.
+ *
+ * @param neighborhood the NodeGraphNeighborhood
+ * @param vertex the vertex
+ * @return the number of hops, or -1 if the vertex is not in the neighborhood
+ */
+int getNodeGraphNeighborhoodHops(NodeGraphNeighborhood* neighborhood, GraphNodeVertex* vertex);
+
+/**
+ * Create a graph of the neighborhood vertices and the edges between
+ * them. Vertex i of the new graph has the data of neighborhood vertex i,
+ * and edges keep their data.
+ *
+ * @param neighborhood the NodeGraphNeighborhood
+ * @return a new NodeGraph
+ */
+NodeGraph* createNodeGraphNeighborhoodSubgraph(NodeGraphNeighborhood* neighborhood);
+
+/**
+ * Create a CSR view of the neighborhood vertices and the edges between
+ * them, without creating a graph. Vertex i of the view is neighborhood
+ * vertex i.
+ *
+ * @param neighborhood the NodeGraphNeighborhood
+ * @return a new NodeGraphCSR
+ */
+NodeGraphCSR* createNodeGraphNeighborhoodCSR(NodeGraphNeighborhood* neighborhood);
+
+#endif /* NODE_GRAPH_NEIGHBORHOOD_H_ */
@@ -0,0 +1,260 @@
+/*
+ * node_graph_path_set.c
+ *
+ * This file provides the implementations of a NodeGraphPathSet, which
+ * stores the paths found between two node vertices as a prefix trie.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include "node_graph_path_set.h"
+#include "hash_set.h"
+
+#ifndef DEFAULT_PATH_SET_CAPACITY
+#define DEFAULT_PATH_SET_CAPACITY 64
+#endif
+
+/**
+ * A frame of the iterative path search stack
+ */
+typedef struct {
+	GraphNodeVertex* vertex;		// vertex on the current path
+	int nextEdge;					// next edge of the vertex to follow
+	int node;						// trie node for the vertex, or -1 if none yet
+} NodeGraphPathFrame;
+
+/**
+ * Create a new empty NodeGraphPathSet.
+ *
+ * @return a new NodeGraphPathSet
+ */
+NodeGraphPathSet* createNodeGraphPathSet(void) {
+	NodeGraphPathSet* pathSet = (NodeGraphPathSet*)malloc(sizeof(NodeGraphPathSet));
+	pathSet->nodeCount = 0;
+	pathSet->nodeCapacity = DEFAULT_PATH_SET_CAPACITY;
+	pathSet->nodes =
+		(NodeGraphPathNode*)malloc(pathSet->nodeCapacity * sizeof(NodeGraphPathNode));
+	pathSet->pathCount = 0;
+	pathSet->pathCapacity = DEFAULT_PATH_SET_CAPACITY;
+	pathSet->pathEnds = (int*)malloc(pathSet->pathCapacity * sizeof(int));
+	return pathSet;
+}
+
+/**
+ * Frees a NodeGraphPathSet.
+ *
+ * @param pathSet the NodeGraphPathSet to free
+ */
+void freeNodeGraphPathSet(NodeGraphPathSet* pathSet) {
+	free(pathSet->nodes);
+	pathSet->nodes = (NodeGraphPathNode*)NULL;
+	free(pathSet->pathEnds);
+	pathSet->pathEnds = (int*)NULL;
+	pathSet->nodeCount = pathSet->pathCount = 0;
+	free(pathSet);
+}
+
+/**
+ * Removes all paths from the path set, keeping its storage for reuse.
+ *
+ * @param pathSet the NodeGraphPathSet
+ */
+void clearNodeGraphPathSet(NodeGraphPathSet* pathSet) {
+	pathSet->nodeCount = 0;
+	pathSet->pathCount = 0;
+}
+
+/**
+ * Appends a trie node to the path set.
+ *
+ * @param pathSet the NodeGraphPathSet
+ * @param vertex the vertex of the node
+ * @param parent the index of the parent node, or -1
+ * @param depth the position of the vertex in the path
+ * @return the index of the new node
+ */
+static int addNodeGraphPathNode(NodeGraphPathSet* pathSet,
+		GraphNodeVertex* vertex, int parent, int depth) {
+	if (pathSet->nodeCount == pathSet->nodeCapacity) {
+		pathSet->nodeCapacity *= 2;
+		pathSet->nodes = (NodeGraphPathNode*)realloc(
+			pathSet->nodes, pathSet->nodeCapacity * sizeof(NodeGraphPathNode));
+		assert(pathSet->nodes != (NodeGraphPathNode*)NULL);
+	}
+	pathSet->nodes[pathSet->nodeCount] = (NodeGraphPathNode){vertex, parent, depth};
+	return pathSet->nodeCount++;
+}
+
+/**
+ * Adds the path on the search stack, followed by the final vertex, to
+ * the path set. Trie nodes already created for the stack are shared with
+ * the paths added before; nodes are created only for the rest.
+ *
+ * @param pathSet the NodeGraphPathSet
+ * @param frames the search stack
+ * @param top the index of the top frame, or -1 if the stack is empty
+ * @param toVertex the final vertex of the path
+ */
+static void addNodeGraphPath(NodeGraphPathSet* pathSet,
+		NodeGraphPathFrame* frames, int top, GraphNodeVertex* toVertex) {
+	// frames with trie nodes are always a prefix of the stack
+	int first = top+1;
+	while (first > 0 && frames[first-1].node == -1) {
+		first--;
+	}
+	for (int d = first; d <= top; d++) {
+		frames[d].node = addNodeGraphPathNode(
+			pathSet, frames[d].vertex, (d > 0) ? frames[d-1].node : -1, d);
+	}
+	int end = addNodeGraphPathNode(
+		pathSet, toVertex, (top >= 0) ? frames[top].node : -1, top+1);
+
+	if (pathSet->pathCount == pathSet->pathCapacity) {
+		pathSet->pathCapacity *= 2;
+		pathSet->pathEnds =
+			(int*)realloc(pathSet->pathEnds, pathSet->pathCapacity * sizeof(int));
+		assert(pathSet->pathEnds != (int*)NULL);
+	}
+	pathSet->pathEnds[pathSet->pathCount++] = end;
+}
+
+/**
+ * Finds the paths between the initial fromNode and the final toNode in
+ * the graph, as getNodeGraphPaths() does, and stores up to maxPaths of
+ * them in the path set, replacing its previous contents. The search is
+ * iterative, so it is not limited by the depth of the call stack.
+ *
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param pathSet the NodeGraphPathSet for the paths
+ * @param maxPaths the maximum number of paths to store
+ * @return the total number of paths available from fromVertex to
+ *   toVertex; may be greater than maxPaths
+ */
+int getNodeGraphPathSet(
+		GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
+		NodeGraphPathSet* pathSet, int maxPaths) {
+	clearNodeGraphPathSet(pathSet);
+	if (fromVertex == toVertex) {
+		if (maxPaths > 0) {
+			addNodeGraphPath(pathSet, (NodeGraphPathFrame*)NULL, -1, toVertex);
+		}
+		return 1;
+	}
+
+	HashSet* visited = createHashSet();
+	int frameCapacity = DEFAULT_PATH_SET_CAPACITY;
+	NodeGraphPathFrame* frames =
+		(NodeGraphPathFrame*)malloc(frameCapacity * sizeof(NodeGraphPathFrame));
+	int top = 0;
+	frames[0] = (NodeGraphPathFrame){fromVertex, 0, -1};
+	addHashSetKey(visited, fromVertex);
+
+	int count = 0;
+	while (top >= 0) {
+		NodeGraphPathFrame* frame = &frames[top];
+		if (frame->nextEdge == frame->vertex->edgeCount) {
+			// backtrack
+			removeHashSetKey(visited, frame->vertex);
+			top--;
+			continue;
+		}
+
+		GraphNodeVertex* vertexForEdge = frame->vertex->edgeTo[frame->nextEdge++].vertex;
+		if (vertexForEdge == toVertex) {
+			if (count < maxPaths) {
+				addNodeGraphPath(pathSet, frames, top, toVertex);
+			}
+			count++;
+		} else if (!containsHashSetKey(visited, vertexForEdge)) {
+			if (top+1 == frameCapacity) {
+				frameCapacity *= 2;
+				frames = (NodeGraphPathFrame*)realloc(
+					frames, frameCapacity * sizeof(NodeGraphPathFrame));
+				assert(frames != (NodeGraphPathFrame*)NULL);
+			}
+			frames[++top] = (NodeGraphPathFrame){vertexForEdge, 0, -1};
+			addHashSetKey(visited, vertexForEdge);
+		}
+	}
+
+	free(frames);
+	freeHashSet(visited);
+	return count;
+}
+
+/**
+ * Returns the number of paths stored in the path set.
+ *
+ * @param pathSet the NodeGraphPathSet
+ * @return the number of paths
+ */
+int getNodeGraphPathSetCount(NodeGraphPathSet* pathSet) {
+	return pathSet->pathCount;
+}
+
+/**
+ * Returns the number of vertices in a path of the path set.
+ *
+ * @param pathSet the NodeGraphPathSet
+ * @param pathIndex the index of the path
+ * @return the number of vertices in the path, or -1 if no such path
+ */
+int getNodeGraphPathSetLength(NodeGraphPathSet* pathSet, int pathIndex) {
+	if (pathIndex < 0 || pathIndex >= pathSet->pathCount) {
+		return -1;
+	}
+	return pathSet->nodes[pathSet->pathEnds[pathIndex]].depth + 1;
+}
+
+/**
+ * Copies the vertices of a path of the path set into the array,
+ * followed by a null terminator.
+ *
+ * @param pathSet the NodeGraphPathSet
+ * @param pathIndex the index of the path
+ * @param path array for the path (size must be path length+1)
+ * @return the number of vertices in the path, or -1 if no such path
+ */
+int copyNodeGraphPathSetPath(NodeGraphPathSet* pathSet, int pathIndex, GraphNodeVertex** path) {
+	int length = getNodeGraphPathSetLength(pathSet, pathIndex);
+	if (length < 0) {
+		return -1;
+	}
+	path[length] = (GraphNodeVertex*)NULL;
+	for (int node = pathSet->pathEnds[pathIndex]; node != -1; node = pathSet->nodes[node].parent) {
+		path[pathSet->nodes[node].depth] = pathSet->nodes[node].vertex;
+	}
+	return length;
+}
+
+/**
+ * Returns a path of the path set as a newly allocated, null-terminated
+ * array of vertices, in the same form as the paths of getNodeGraphPaths().
+ * The path array must be freed when no longer needed.
+ *
+ * @param pathSet the NodeGraphPathSet
+ * @param pathIndex the index of the path
+ * @return the path array, or NULL if no such path
+ */
+GraphNodeVertex** getNodeGraphPathSetPath(NodeGraphPathSet* pathSet, int pathIndex) {
+	int length = getNodeGraphPathSetLength(pathSet, pathIndex);
+	if (length < 0) {
+		return (GraphNodeVertex**)NULL;
+	}
+	GraphNodeVertex** path = (GraphNodeVertex**)malloc((length+1) * sizeof(GraphNodeVertex*));
+	copyNodeGraphPathSetPath(pathSet, pathIndex, path);
+	return path;
+}
+
+/**
+ * Returns the number of bytes of storage used by the path set.
+ *
+ * @param pathSet the NodeGraphPathSet
+ * @return the number of bytes allocated for the path set
+ */
+size_t getNodeGraphPathSetStorageSize(NodeGraphPathSet* pathSet) {
+	return sizeof(NodeGraphPathSet)
+		 + pathSet->nodeCapacity * sizeof(NodeGraphPathNode)
+		 + pathSet->pathCapacity * sizeof(int);
+}
@@ -0,0 +1,122 @@
+/*
+ * node_graph_path_set.h
+ *
+ * This file provides the structures and function declarations of a
+ * NodeGraphPathSet, which stores the paths found between two node
+ * vertices as a prefix trie. Paths that share a prefix share the trie
+ * nodes for that prefix, and all trie nodes are stored in one array.
+ */
+
+#ifndef NODE_GRAPH_PATH_SET_H_
+#define NODE_GRAPH_PATH_SET_H_
+
+#include <stdlib.h>
+#include "node_graph.h"
+
+/**
+ * A node of the path trie
+ */
+typedef struct {
+	GraphNodeVertex* vertex;		// the vertex at this position of the path
+	int parent;						// index of the previous trie node, or -1
+	int depth;						// position of the vertex in the path
+} NodeGraphPathNode;
+
+/**
+ * A set of paths stored as a prefix trie
+ */
+typedef struct {
+	NodeGraphPathNode* nodes;		// trie nodes
+	int nodeCount;					// number of trie nodes
+	int nodeCapacity;				// capacity of the nodes array
+	int* pathEnds;					// index of the last trie node of each path
+	int pathCount;					// number of paths stored
+	int pathCapacity;				// capacity of the pathEnds array
+} NodeGraphPathSet;
+
+/**
+ * Create a new empty NodeGraphPathSet.
+ *
+ * @return a new NodeGraphPathSet
+ */
+NodeGraphPathSet* createNodeGraphPathSet(void);
+
+/**
+ * Frees a NodeGraphPathSet.
+ *
+ * @param pathSet the NodeGraphPathSet to free
+ */
+void freeNodeGraphPathSet(NodeGraphPathSet* pathSet);
+
+/**
+ * Removes all paths from the path set, keeping its storage for reuse.
+ *
+ * @param pathSet the NodeGraphPathSet
+ */
+void clearNodeGraphPathSet(NodeGraphPathSet* pathSet);
+
+/**
+ * Finds the paths between the initial fromNode and the final toNode in
+ * the graph, as getNodeGraphPaths() does, and stores up to maxPaths of
+ * them in the path set, replacing its previous contents. The search is
+ * iterative, so it is not limited by the depth of the call stack.
+ *
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param pathSet the NodeGraphPathSet for the paths
+ * @param maxPaths the maximum number of paths to store
+ * @return the total number of paths available from fromVertex to
+ *   toVertex; may be greater than maxPaths
+ */
+int getNodeGraphPathSet(
+		GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
+		NodeGraphPathSet* pathSet, int maxPaths);
+
+/**
+ * Returns the number of paths stored in the path set.
+ *
+ * @param pathSet the NodeGraphPathSet
+ * @return the number of paths
+ */
+int getNodeGraphPathSetCount(NodeGraphPathSet* pathSet);
+
+/**
+ * Returns the number of vertices in a path of the path set.
+ *
+ * @param pathSet the NodeGraphPathSet
+ * @param pathIndex the index of the path
+ * @return the number of vertices in the path, or -1 if no such path
+ */
+int getNodeGraphPathSetLength(NodeGraphPathSet* pathSet, int pathIndex);
+
+/**
+ * Copies the vertices of a path of the path set into the array,
+ * followed by a null terminator.
+ *
+ * @param pathSet the NodeGraphPathSet
+ * @param pathIndex the index of the path
+ * @param path array for the path (size must be path length+1)
+ * @return the number of vertices in the path, or -1 if no such path
+ */
+int copyNodeGraphPathSetPath(NodeGraphPathSet* pathSet, int pathIndex, GraphNodeVertex** path);
+
+/**
+ * Returns a path of the path set as a newly allocated, null-terminated
+ * array of vertices, in the same form as the paths of getNodeGraphPaths().
+ * The path array must be freed when no longer needed.
+ *
+ * @param pathSet the NodeGraphPathSet
+ * @param pathIndex the index of the path
+ * @return the path array, or NULL if no such path
+ */
+GraphNodeVertex** getNodeGraphPathSetPath(NodeGraphPathSet* pathSet, int pathIndex);
+
+/**
+ * Returns the number of bytes of storage used by the path set.
+ *
+ * @param pathSet the NodeGraphPathSet
+ * @return the number of bytes allocated for the path set
+ */
+size_t getNodeGraphPathSetStorageSize(NodeGraphPathSet* pathSet);
+
+#endif /* NODE_GRAPH_PATH_SET_H_ */
@@ -16,6 +16,101 @@
 #include "array_queue.h"
 #include <string.h>
 
+#ifdef NODEGRAPH_STATS
+/** the stats parameter of the search functions, if compiled with NODEGRAPH_STATS */
+#define PATHS_STATS_PARAM , NodeGraphStats* stats
+/** the stats argument of the search functions, if compiled with NODEGRAPH_STATS */
+#define PATHS_STATS_ARG , stats
+#else
+#define PATHS_STATS_PARAM
+#define PATHS_STATS_ARG
+#endif
+
+/** is the helper function with the following parameters.
+
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param paths an array of pointers to null-terminated path arrays
+ *   where up to maxPaths paths will be returned (size must be maxPaths+1)
+ * @param maxPaths the maximum number of paths to return
+ * @param visited, HashSet to record visited node vertices
+ * @param stack, ArrayQueue used as a stack to record the node vertices in the current path
+ * @param count, an integer, the total number of paths from fromVertex to toVertex
+ * @param stats, NodeGraphStats to record the search if compiled with NODEGRAPH_STATS
+ * @return the total number of paths available from fromVertex to
+ *   toVertex; may be greater than maxPaths
+ */
+static int helper(GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
+		GraphNodeVertex*** paths, int maxPaths, HashSet* visited, ArrayQueue* stack, int* count
+		PATHS_STATS_PARAM){
+	addHashSetKey(visited, fromVertex);
+	pushArrayQueueData(stack, (QueueData){fromVertex});
+	NODEGRAPH_STATS_HIGH_WATER(stats, queueHighWater, stack->size);
+		if(fromVertex == toVertex){
+			if (*count < maxPaths) {
+				NODEGRAPH_STATS_TIMER_START(outputStart);
+				int size = stack->size;
+				paths[*count] = (GraphNodeVertex**)malloc(sizeof(GraphNodeVertex*) * (size + 1));
+				for(int i = 0; i < size; i++){
+					paths[*count][i] = stack->data[i].node;
+				}
+				paths[*count][size] = (GraphNodeVertex*)NULL;
+				NODEGRAPH_STATS_TIMER_STOP(stats, NODEGRAPH_PHASE_OUTPUT, outputStart);
+			}
+			(*count)++;
+		}else{
+			NODEGRAPH_STATS_COUNT(stats, verticesExpanded, 1);
+			NODEGRAPH_STATS_COUNT(stats, edgesScanned, fromVertex->edgeCount);
+			NODEGRAPH_STATS_COUNT(stats, visitedProbes, fromVertex->edgeCount);
+			for (int iv = 0; iv < fromVertex->edgeCount; iv++) {
+				GraphNodeVertex* vertexForEdge = fromVertex->edgeTo[iv].vertex;
+				if (!containsHashSetKey(visited, vertexForEdge)) {
+					helper(vertexForEdge, toVertex, paths, maxPaths, visited, stack, count PATHS_STATS_ARG);
+				} else {
+					NODEGRAPH_STATS_COUNT(stats, visitedHits, 1);
+				}
+			}
+		}
+		QueueData* popedNode = popArrayQueueData(stack, &(QueueData){});
+		removeHashSetKey(visited, popedNode->node);
+	return *count;
+}
+
+/**
+ * Searches for the paths between fromVertex and toVertex, recording the
+ * search in stats if compiled with NODEGRAPH_STATS.
+ *
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param paths an array of pointers to null-terminated path arrays
+ *   where up to maxPaths paths will be returned (size must be maxPaths+1)
+ * @param maxPaths the maximum number of paths to return
+ * @param stats, NodeGraphStats to record the search if compiled with NODEGRAPH_STATS
+ * @return the total number of paths available from fromVertex to
+ *   toVertex; may be greater than maxPaths
+ */
+static int findNodeGraphPaths(GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
+		GraphNodeVertex*** paths, int maxPaths PATHS_STATS_PARAM) {
+	NODEGRAPH_STATS_TIMER_START(setupStart);
+	HashSet* visited = createHashSet(); //to record visited node vertices
+	ArrayQueue* stack = createArrayQueue(); //to record the node vertices in the current path as a stack.
+	NODEGRAPH_STATS_TIMER_STOP(stats, NODEGRAPH_PHASE_SETUP, setupStart);
+
+	NODEGRAPH_STATS_TIMER_START(searchStart);
+	int count = 0; //number of path
+	count = helper(fromVertex, toVertex, paths, maxPaths, visited, stack, &count PATHS_STATS_ARG);
+	paths[(count < maxPaths) ? count : maxPaths] = (GraphNodeVertex**)NULL;
+	NODEGRAPH_STATS_TIMER_STOP(stats, NODEGRAPH_PHASE_SEARCH, searchStart);
+	NODEGRAPH_STATS_COUNT(stats, phaseSeconds[NODEGRAPH_PHASE_SEARCH],
+						  -stats->phaseSeconds[NODEGRAPH_PHASE_OUTPUT]);
+
+	NODEGRAPH_STATS_TIMER_START(cleanupStart);
+	freeArrayQueue(stack);
+	freeHashSet(visited);
+	NODEGRAPH_STATS_TIMER_STOP(stats, NODEGRAPH_PHASE_CLEANUP, cleanupStart);
+	return count;
+}
+
 /**
  * Return up to maxPaths paths between the initial fromNode and the
  * final toNode in the graph.
@@ -36,47 +131,33 @@
 int getNodeGraphPaths(
 		GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
 		GraphNodeVertex*** paths, int maxPaths) {
-
-	HashSet* visited = createHashSet(); //to record visited node vertices
-	ArrayQueue* stack = createArrayQueue(); //to record the node vertices in the current path as a stack.
-	int count = 0; //number of path
-	count = helper(fromVertex, toVertex, paths, visited, stack, &count);
-	return count;
+#ifdef NODEGRAPH_STATS
+	NodeGraphStats stats;
+	return getNodeGraphPathsWithStats(fromVertex, toVertex, paths, maxPaths, &stats);
+#else
+	return findNodeGraphPaths(fromVertex, toVertex, paths, maxPaths);
+#endif
 }
 
-/** is the helper function with the following parameters.
-
+/**
+ * Return up to maxPaths paths between the initial fromNode and the
+ * final toNode in the graph, as getNodeGraphPaths() does, and the stats
+ * for the search. The stats are recorded only if compiled with
+ * NODEGRAPH_STATS. Time spent in the output phase is not included in
+ * the search phase.
+ *
  * @param fromVertex the initial node vertex
  * @param toVertex the final node vertex
  * @param paths an array of pointers to null-terminated path arrays
  *   where up to maxPaths paths will be returned (size must be maxPaths+1)
- * @param visited, HashSet to record visited node vertices
- * @param stack, ArrayQueue used as a stack to record the node vertices in the current path
- * @param count, an integer, the total number of paths from fromVertex to toVertex
+ * @param maxPaths the maximum number of paths to return
+ * @param stats the NodeGraphStats for the search
  * @return the total number of paths available from fromVertex to
  *   toVertex; may be greater than maxPaths
  */
-
-int helper(GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex, GraphNodeVertex*** paths,HashSet* visited, ArrayQueue* stack, int* count){
-	addHashSetKey(visited, fromVertex);
-	pushArrayQueueData(stack, (QueueData){fromVertex});
-		if(fromVertex == toVertex){
-			paths[*count] = (GraphNodeVertex**)malloc(sizeof(GraphNodeVertex*) * stack->size + 1);
-			int size = stack->size;
-			for(int i = 0; i < size; i++){
-				paths[*count][i] = stack->data[i].node;
-			}
-			paths[*count][size] = (GraphNodeVertex*)NULL;
-			(*count)++;
-		}else{
-			for (int iv = 0; iv < fromVertex->edgeCount; iv++) {
-				GraphNodeVertex* vertexForEdge = fromVertex->edgeTo[iv].vertex;
-				if (!containsHashSetKey(visited, vertexForEdge)) {
-					helper(vertexForEdge, toVertex, paths, visited, stack, count);
-				}
-			}
-		}
-		QueueData* popedNode = popArrayQueueData(stack, &(QueueData){});
-		removeHashSetKey(visited, popedNode->node);
-	return *count;
+int getNodeGraphPathsWithStats(
+		GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
+		GraphNodeVertex*** paths, int maxPaths, NodeGraphStats* stats) {
+	clearNodeGraphStats(stats);
+	return findNodeGraphPaths(fromVertex, toVertex, paths, maxPaths PATHS_STATS_ARG);
 }
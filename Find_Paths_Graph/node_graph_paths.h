@@ -13,7 +13,7 @@
 #include "node_graph_iterator.h"
 #include "node_graph_bfs_iterator.h"
 #include "node_graph_dfs_iterator.h"
-#include "node_graph_paths.h"
+#include "node_graph_stats.h"
 
 /**
  * Return up to maxPaths paths between the initial fromNode and the
@@ -36,7 +36,24 @@ int getNodeGraphPaths(
 		GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
 		GraphNodeVertex*** paths, int maxPaths);
 
-int helper(GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
-		GraphNodeVertex*** paths,HashSet* visited, ArrayQueue* stack, int* count);
+/**
+ * Return up to maxPaths paths between the initial fromNode and the
+ * final toNode in the graph, as getNodeGraphPaths() does, and the stats
+ * for the search. The stats are recorded only if compiled with
+ * NODEGRAPH_STATS. Time spent in the output phase is not included in
+ * the search phase.
+ *
+ * @param fromVertex the initial node vertex
+ * @param toVertex the final node vertex
+ * @param paths an array of pointers to null-terminated path arrays
+ *   where up to maxPaths paths will be returned (size must be maxPaths+1)
+ * @param maxPaths the maximum number of paths to return
+ * @param stats the NodeGraphStats for the search
+ * @return the total number of paths available from fromVertex to
+ *   toVertex; may be greater than maxPaths
+ */
+int getNodeGraphPathsWithStats(
+		GraphNodeVertex* fromVertex, GraphNodeVertex* toVertex,
+		GraphNodeVertex*** paths, int maxPaths, NodeGraphStats* stats);
 
 #endif /* NODE_GRAPH_PATHS_H_ */
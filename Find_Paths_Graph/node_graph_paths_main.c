@@ -7,9 +7,13 @@
  * @author philip gust
  */
 
+#define _POSIX_C_SOURCE 200809L	// truncate()
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
+#include <unistd.h>
 #include "CUnit/CUnit.h"
 #include "CUnit/Basic.h"
 #include "node_graph.h"
@@ -17,6 +21,26 @@
 #include "node_graph_bfs_iterator.h"
 #include "node_graph_dfs_iterator.h"
 #include "node_graph_paths.h"
+#include "node_graph_dag.h"
+#include "node_graph_reorder.h"
+#include "node_graph_batch.h"
+#include "node_graph_snapshot.h"
+#include "node_graph_generators.h"
+#include "node_graph_path_set.h"
+#include "node_graph_dfs.h"
+#include "node_graph_csr.h"
+#include "node_graph_rank.h"
+#include "node_graph_components.h"
+#include "node_graph_walks.h"
+#include "node_graph_cache.h"
+#include "node_graph_neighborhood.h"
+#include "hash_table_template.h"
+#include "hash_set.h"
+#include "hash_set_iterator.h"
+#include "hash_map.h"
+#include "hash_map_iterator.h"
+#include "bloom_filter.h"
+#include "hash_map_file.h"
 
 /**
  * Build version of graph1 for use in other tests.
@@ -55,6 +79,39 @@ static NodeGraph* buildGraph1(void) {
 	return graph;
 }
 
+/**
+ * Build version of graph2, a directed acyclic graph, for use in other tests.
+ *
+ *          ,-->1------------.
+ *         /    |             \
+ *        /     v              v
+ *       0      3------------->5
+ *        \     ^              ^
+ *         \    |              |
+ *          '-->2----->4-------'
+ */
+static NodeGraph* buildGraph2(void) {
+	NodeGraph* graph = createNodeGraph();
+
+	GraphNodeVertex* node0 = addGraphNodeVertexForData(graph, (GraphVertexData){"0"});
+	GraphNodeVertex* node1 = addGraphNodeVertexForData(graph, (GraphVertexData){"1"});
+	GraphNodeVertex* node2 = addGraphNodeVertexForData(graph, (GraphVertexData){"2"});
+	GraphNodeVertex* node3 = addGraphNodeVertexForData(graph, (GraphVertexData){"3"});
+	GraphNodeVertex* node4 = addGraphNodeVertexForData(graph, (GraphVertexData){"4"});
+	GraphNodeVertex* node5 = addGraphNodeVertexForData(graph, (GraphVertexData){"5"});
+
+	addEdgeToGraphNodeVertex(node0, node1, (GraphEdgeData){});
+	addEdgeToGraphNodeVertex(node0, node2, (GraphEdgeData){});
+	addEdgeToGraphNodeVertex(node1, node3, (GraphEdgeData){});
+	addEdgeToGraphNodeVertex(node1, node5, (GraphEdgeData){});
+	addEdgeToGraphNodeVertex(node2, node3, (GraphEdgeData){});
+	addEdgeToGraphNodeVertex(node2, node4, (GraphEdgeData){});
+	addEdgeToGraphNodeVertex(node3, node5, (GraphEdgeData){});
+	addEdgeToGraphNodeVertex(node4, node5, (GraphEdgeData){});
+
+	return graph;
+}
+
 /**
  * Tests getNodeGraphPaths().
  */
@@ -105,6 +162,1741 @@ static void test_getNodeGraphPaths(void) {
 }
 
 
+/**
+ * Tests getNodeGraphTopologicalOrder() and isNodeGraphAcyclic().
+ */
+static void test_getNodeGraphTopologicalOrder(void) {
+	NodeGraph* graph = buildGraph1();
+	GraphNodeVertex* order[7];
+	CU_ASSERT_FALSE(isNodeGraphAcyclic(graph));
+	CU_ASSERT_TRUE(getNodeGraphTopologicalOrder(graph, order) < 6);
+	freeNodeGraph(graph);
+
+	graph = buildGraph2();
+	CU_ASSERT_TRUE(isNodeGraphAcyclic(graph));
+	int count = getNodeGraphTopologicalOrder(graph, order);
+	CU_ASSERT_EQUAL(count, 6);
+	CU_ASSERT_PTR_NULL(order[count]);
+
+	// every edge must point to a vertex later in the order
+	for (int i = 0; i < count; i++) {
+		for (int iv = 0; iv < order[i]->edgeCount; iv++) {
+			bool later = false;
+			for (int j = i+1; j < count; j++) {
+				later |= (order[j] == order[i]->edgeTo[iv].vertex);
+			}
+			CU_ASSERT_TRUE(later);
+		}
+	}
+	freeNodeGraph(graph);
+}
+
+/**
+ * Tests countNodeGraphDAGPaths(), getNodeGraphDAGShortestPath(),
+ * getNodeGraphDAGLongestPath() and getNodeGraphDAGShortestPaths().
+ */
+static void test_getNodeGraphDAGPaths(void) {
+	NodeGraph* graph = buildGraph2();
+	GraphNodeVertex* fromVertex = graph->vertices[0];
+	GraphNodeVertex* toVertex = graph->vertices[5];
+
+	CU_ASSERT_EQUAL(countNodeGraphDAGPaths(graph, fromVertex, toVertex), 4);
+	CU_ASSERT_EQUAL(countNodeGraphDAGPaths(graph, graph->vertices[2], toVertex), 2);
+	CU_ASSERT_EQUAL(countNodeGraphDAGPaths(graph, toVertex, fromVertex), 0);
+
+	// count must agree with enumerating the paths
+	GraphNodeVertex** allPaths[5];
+	int nPaths = getNodeGraphPaths(fromVertex, toVertex, allPaths, 4);
+	CU_ASSERT_EQUAL(nPaths, 4);
+	for (int i = 0; i < nPaths && i < 4; i++) {
+		free(allPaths[i]);
+	}
+
+	GraphNodeVertex* path[7];
+	int length = getNodeGraphDAGShortestPath(graph, fromVertex, toVertex, path, 6);
+	CU_ASSERT_EQUAL(length, 3);
+	const char* shortestPath[] = {"0", "1", "5"};
+	for (int i = 0; i < length && path[i] != NULL; i++) {
+		CU_ASSERT_STRING_EQUAL(path[i]->data.strval, shortestPath[i]);
+	}
+	CU_ASSERT_PTR_NULL(path[length]);
+
+	length = getNodeGraphDAGLongestPath(graph, fromVertex, toVertex, path, 6);
+	CU_ASSERT_EQUAL(length, 4);
+	CU_ASSERT_PTR_EQUAL(path[0], fromVertex);
+	CU_ASSERT_PTR_EQUAL(path[3], toVertex);
+
+	// truncated path
+	length = getNodeGraphDAGLongestPath(graph, fromVertex, toVertex, path, 2);
+	CU_ASSERT_EQUAL(length, 4);
+	CU_ASSERT_PTR_EQUAL(path[0], fromVertex);
+	CU_ASSERT_PTR_NULL(path[2]);
+
+	// no path back from the final vertex
+	path[0] = fromVertex;
+	CU_ASSERT_EQUAL(getNodeGraphDAGShortestPath(graph, toVertex, fromVertex, path, 6), 0);
+	CU_ASSERT_PTR_NULL(path[0]);
+	path[0] = fromVertex;
+	CU_ASSERT_EQUAL(getNodeGraphDAGLongestPath(graph, toVertex, fromVertex, path, 6), 0);
+	CU_ASSERT_PTR_NULL(path[0]);
+
+	GraphNodeVertex** paths[4];
+	nPaths = getNodeGraphDAGShortestPaths(graph, fromVertex, toVertex, paths, 3);
+	CU_ASSERT_EQUAL(nPaths, 3);
+	CU_ASSERT_PTR_NULL(paths[nPaths]);
+	int lengths[] = {3, 4, 4};
+	for (int i = 0; i < nPaths; i++) {
+		int n = 0;
+		while (paths[i][n] != NULL) {
+			n++;
+		}
+		CU_ASSERT_EQUAL(n, lengths[i]);
+		CU_ASSERT_PTR_EQUAL(paths[i][0], fromVertex);
+		CU_ASSERT_PTR_EQUAL(paths[i][n-1], toVertex);
+		free(paths[i]);
+	}
+	freeNodeGraph(graph);
+
+	// cyclic graph is rejected
+	graph = buildGraph1();
+	CU_ASSERT_EQUAL(countNodeGraphDAGPaths(graph, graph->vertices[5], graph->vertices[3]), -1);
+	freeNodeGraph(graph);
+}
+
+/**
+ * Tests reorderNodeGraph().
+ */
+static void test_reorderNodeGraph(void) {
+	NodeGraphOrder orders[] = {NODEGRAPH_ORDER_BFS, NODEGRAPH_ORDER_RCM, NODEGRAPH_ORDER_DEGREE};
+	for (int i = 0; i < 3; i++) {
+		NodeGraph* graph = buildGraph1();
+		const char* labels[6];
+		for (int ig = 0; ig < 6; ig++) {
+			labels[ig] = graph->vertices[ig]->data.strval;
+		}
+		int newIndex[6];
+		reorderNodeGraph(graph, orders[i], newIndex);
+		CU_ASSERT_EQUAL(getNodeGraphVertexCount(graph), 6);
+		CU_ASSERT_PTR_NOT_NULL(graph->arena);
+
+		// vertices are renumbered and keep their data
+		for (int ig = 0; ig < 6; ig++) {
+			CU_ASSERT_EQUAL(graph->vertices[ig]->index, ig);
+			CU_ASSERT_STRING_EQUAL(graph->vertices[newIndex[ig]]->data.strval, labels[ig]);
+		}
+
+		// edges are preserved
+		GraphNodeVertex* fromVertex = graph->vertices[newIndex[5]];
+		GraphNodeVertex* toVertex = graph->vertices[newIndex[3]];
+		GraphNodeVertex** paths[6];
+		int nPaths = getNodeGraphPaths(fromVertex, toVertex, paths, 5);
+		CU_ASSERT_EQUAL(nPaths, 3);
+		for (int ip = 0; ip < nPaths && ip < 5; ip++) {
+			free(paths[ip]);
+		}
+
+		// graph can still grow in the arena
+		GraphNodeVertex* node6 = addGraphNodeVertexForData(graph, (GraphVertexData){"6"});
+		for (int ig = 0; ig < 6; ig++) {
+			addEdgeToGraphNodeVertex(graph->vertices[ig], node6, (GraphEdgeData){});
+		}
+		CU_ASSERT_TRUE(hasEdgeToGraphNodeVertex(fromVertex, node6));
+		CU_ASSERT_TRUE(removeGraphNodeVertex(graph, toVertex));
+		CU_ASSERT_EQUAL(getNodeGraphVertexCount(graph), 6);
+		freeNodeGraph(graph);
+	}
+}
+
+/**
+ * Tests createNodeGraphWithArena().
+ */
+static void test_createNodeGraphWithArena(void) {
+	NodeGraph* graph = createNodeGraphWithArena(0);
+	CU_ASSERT_PTR_NOT_NULL(graph->arena);
+
+	GraphNodeVertex* nodes[100];
+	for (int i = 0; i < 100; i++) {
+		nodes[i] = addGraphNodeVertexForData(graph, (GraphVertexData){"node"});
+	}
+	for (int i = 0; i < 100; i++) {
+		for (int j = 0; j < 100; j += 1+i%7) {
+			addEdgeToGraphNodeVertex(nodes[i], nodes[j], (GraphEdgeData){});
+		}
+	}
+	CU_ASSERT_TRUE(hasEdgeToGraphNodeVertex(nodes[0], nodes[99]));
+	CU_ASSERT_EQUAL(graphNodeVertexCardinality(nodes[0]), 100);
+
+	// removed vertex storage is reused for a new vertex
+	CU_ASSERT_TRUE(removeGraphNodeVertex(graph, nodes[50]));
+	GraphNodeVertex* node = addGraphNodeVertexForData(graph, (GraphVertexData){"new"});
+	CU_ASSERT_PTR_EQUAL(node, nodes[50]);
+	CU_ASSERT_EQUAL(graphNodeVertexCardinality(node), 0);
+	CU_ASSERT_FALSE(hasEdgeToGraphNodeVertex(nodes[0], node));
+
+	// cleared graph remains arena-backed
+	clearNodeGraph(graph);
+	CU_ASSERT_EQUAL(getNodeGraphVertexCount(graph), 0);
+	CU_ASSERT_PTR_NOT_NULL(graph->arena);
+	node = addGraphNodeVertexForData(graph, (GraphVertexData){"node"});
+	CU_ASSERT_PTR_NOT_NULL(addEdgeToGraphNodeVertex(node, node, (GraphEdgeData){}));
+	freeNodeGraph(graph);
+}
+
+/**
+ * Tests edge lookup, addition and removal for a high degree vertex.
+ */
+static void test_graphNodeVertexEdgeIndex(void) {
+	NodeGraph* graph = createNodeGraph();
+	GraphNodeVertex* hub = addGraphNodeVertexForData(graph, (GraphVertexData){"hub"});
+	GraphNodeVertex* nodes[200];
+	bool hasEdge[200];
+	for (int i = 0; i < 200; i++) {
+		nodes[i] = addGraphNodeVertexForData(graph, (GraphVertexData){"node"});
+		CU_ASSERT_PTR_NOT_NULL(addEdgeToGraphNodeVertex(hub, nodes[i], (GraphEdgeData){}));
+		hasEdge[i] = true;
+	}
+	CU_ASSERT_PTR_NULL(addEdgeToGraphNodeVertex(hub, nodes[10], (GraphEdgeData){}));
+	CU_ASSERT_EQUAL(graphNodeVertexCardinality(hub), 200);
+
+	// remove and re-add edges in a scrambled order
+	int count = 200;
+	for (int k = 0; k < 1000; k++) {
+		int i = (k * 37) % 200;
+		if (hasEdge[i]) {
+			CU_ASSERT_TRUE(removeEdgeToGraphNodeVertex(hub, nodes[i]));
+			count--;
+		} else {
+			CU_ASSERT_PTR_NOT_NULL(addEdgeToGraphNodeVertex(hub, nodes[i], (GraphEdgeData){}));
+			count++;
+		}
+		hasEdge[i] = !hasEdge[i];
+	}
+	CU_ASSERT_EQUAL(graphNodeVertexCardinality(hub), count);
+	for (int i = 0; i < 200; i++) {
+		CU_ASSERT_EQUAL(hasEdgeToGraphNodeVertex(hub, nodes[i]), hasEdge[i]);
+		GraphNodeEdge* edge = getEdgeToGraphNodeVertex(hub, nodes[i]);
+		CU_ASSERT_TRUE(hasEdge[i] ? edge->vertex == nodes[i] : edge == NULL);
+	}
+
+	// removing vertices removes edges into them
+	for (int i = 0; i < 200; i += 2) {
+		CU_ASSERT_TRUE(removeGraphNodeVertex(graph, nodes[i]));
+	}
+	for (int i = 1; i < 200; i += 2) {
+		CU_ASSERT_EQUAL(hasEdgeToGraphNodeVertex(hub, nodes[i]), hasEdge[i]);
+	}
+	freeNodeGraph(graph);
+}
+
+/**
+ * Tests commitNodeGraphBatch() against applying the same changes
+ * one at a time.
+ */
+static void test_commitNodeGraphBatch(void) {
+	NodeGraph* graph = createNodeGraph();
+	NodeGraph* batchGraph = createNodeGraph();
+	for (int i = 0; i < 40; i++) {
+		addGraphNodeVertexForData(graph, (GraphVertexData){"node"});
+		addGraphNodeVertexForData(batchGraph, (GraphVertexData){"node"});
+	}
+
+	srand(2017);
+	for (int round = 0; round < 3; round++) {
+		NodeGraphBatch* batch = beginNodeGraphBatch(batchGraph);
+		int expectedChanges = 0;
+		for (int k = 0; k < 3000; k++) {
+			int from = rand() % 40;
+			int to = (from < 2) ? rand() % 40 : rand() % 8;  // vertices 0, 1 are hubs
+			if (rand() % 3 != 0) {
+				expectedChanges += addEdgeToGraphNodeVertex(
+					graph->vertices[from], graph->vertices[to], (GraphEdgeData){}) != NULL;
+				addEdgeToNodeGraphBatch(batch,
+					batchGraph->vertices[from], batchGraph->vertices[to], (GraphEdgeData){});
+			} else {
+				expectedChanges += removeEdgeToGraphNodeVertex(
+					graph->vertices[from], graph->vertices[to]);
+				removeEdgeFromNodeGraphBatch(batch,
+					batchGraph->vertices[from], batchGraph->vertices[to]);
+			}
+		}
+		CU_ASSERT_EQUAL(getNodeGraphBatchSize(batch), 3000);
+		CU_ASSERT_TRUE(commitNodeGraphBatch(batch) <= expectedChanges);
+
+		for (int from = 0; from < 40; from++) {
+			CU_ASSERT_EQUAL(graphNodeVertexCardinality(graph->vertices[from]),
+							graphNodeVertexCardinality(batchGraph->vertices[from]));
+			for (int to = 0; to < 40; to++) {
+				CU_ASSERT_EQUAL(
+					hasEdgeToGraphNodeVertex(graph->vertices[from], graph->vertices[to]),
+					hasEdgeToGraphNodeVertex(batchGraph->vertices[from], batchGraph->vertices[to]));
+			}
+		}
+	}
+
+	// aborted batch makes no changes
+	NodeGraphBatch* batch = beginNodeGraphBatch(batchGraph);
+	addEdgeToNodeGraphBatch(batch, batchGraph->vertices[0], batchGraph->vertices[39], (GraphEdgeData){});
+	removeEdgeFromNodeGraphBatch(batch, batchGraph->vertices[0], batchGraph->vertices[39]);
+	addEdgeToNodeGraphBatch(batch, batchGraph->vertices[0], batchGraph->vertices[39], (GraphEdgeData){});
+	bool hadEdge = hasEdgeToGraphNodeVertex(batchGraph->vertices[0], batchGraph->vertices[39]);
+	abortNodeGraphBatch(batch);
+	CU_ASSERT_EQUAL(hasEdgeToGraphNodeVertex(batchGraph->vertices[0], batchGraph->vertices[39]), hadEdge);
+
+	// an edge removed and added again gets the new data and a new version
+	GraphNodeVertex* from = batchGraph->vertices[2];
+	GraphNodeVertex* to = batchGraph->vertices[39];
+	addEdgeToGraphNodeVertex(from, to, (GraphEdgeData){1.0});
+	unsigned long version = getNodeGraphVersion(batchGraph);
+	batch = beginNodeGraphBatch(batchGraph);
+	removeEdgeFromNodeGraphBatch(batch, from, to);
+	addEdgeToNodeGraphBatch(batch, from, to, (GraphEdgeData){5.0});
+	CU_ASSERT_EQUAL(commitNodeGraphBatch(batch), 1);
+	CU_ASSERT_TRUE(getNodeGraphVersion(batchGraph) > version);
+	CU_ASSERT_EQUAL(getEdgeToGraphNodeVertex(from, to)->data.weight, 5.0);
+
+	freeNodeGraph(batchGraph);
+	freeNodeGraph(graph);
+}
+
+/**
+ * Counts the vertices reachable from a vertex with a BFS iterator.
+ *
+ * @param graph the graph
+ * @param start the starting vertex
+ * @return the number of reachable vertices
+ */
+static int countReachableVertices(NodeGraph* graph, GraphNodeVertex* start) {
+	NodeGraphBFSIterator* itr = createNodeGraphBFSIterator(graph, start);
+	int count = 0;
+	while (hasNextGraphNodeVertexBFS(itr)) {
+		getNextGraphNodeVertexBFS(itr);
+		count++;
+	}
+	freeNodeGraphBFSIterator(itr);
+	return count;
+}
+
+/**
+ * Reader thread for test_publishNodeGraphSnapshot. Each snapshot of the
+ * growing chain must be internally consistent.
+ *
+ * @param arg the NodeGraphVersions
+ * @return the number of inconsistent snapshots
+ */
+static void* readNodeGraphSnapshots(void* arg) {
+	NodeGraphVersions* versions = (NodeGraphVersions*)arg;
+	long errors = 0;
+	for (int i = 0; i < 2000; i++) {
+		NodeGraphSnapshot* snapshot = pinNodeGraphSnapshot(versions);
+		NodeGraph* graph = getNodeGraphSnapshotGraph(snapshot);
+		GraphNodeVertex* first = getNodeGraphSnapshotVertex(snapshot, 0);
+		if (countReachableVertices(graph, first) != graph->vertexCount) {
+			errors++;
+		}
+		unpinNodeGraphSnapshot(versions, snapshot);
+	}
+	return (void*)errors;
+}
+
+/**
+ * Tests publishNodeGraphSnapshot(), pinNodeGraphSnapshot(), and
+ * unpinNodeGraphSnapshot().
+ */
+static void test_publishNodeGraphSnapshot(void) {
+	NodeGraph* graph = buildGraph2();
+	NodeGraphVersions* versions = createNodeGraphVersions(graph);
+
+	// pinned snapshot is unchanged by later changes to the graph
+	NodeGraphSnapshot* snapshot1 = pinNodeGraphSnapshot(versions);
+	NodeGraph* graph1 = getNodeGraphSnapshotGraph(snapshot1);
+	CU_ASSERT_EQUAL(getNodeGraphVertexCount(graph1), 6);
+	CU_ASSERT_PTR_NULL(getNodeGraphSnapshotVertex(snapshot1, 6));
+	GraphNodeVertex* start1 = getNodeGraphSnapshotVertex(snapshot1, 0);
+	CU_ASSERT_STRING_EQUAL(start1->data.strval, "0");
+	CU_ASSERT_EQUAL(publishNodeGraphSnapshot(versions), getNodeGraphVersion(graph));
+
+	unsigned long version = getNodeGraphVersion(graph);
+	removeEdgeToGraphNodeVertex(graph->vertices[0], graph->vertices[2]);
+	addGraphNodeVertexForData(graph, (GraphVertexData){"6"});
+	CU_ASSERT_TRUE(getNodeGraphVersion(graph) > version);
+	CU_ASSERT_EQUAL(countReachableVertices(graph1, start1), 6);
+	CU_ASSERT_TRUE(hasEdgeToGraphNodeVertex(start1, getNodeGraphSnapshotVertex(snapshot1, 2)));
+
+	// newly pinned snapshot sees the published changes
+	CU_ASSERT_EQUAL(publishNodeGraphSnapshot(versions), getNodeGraphVersion(graph));
+	NodeGraphSnapshot* snapshot2 = pinNodeGraphSnapshot(versions);
+	CU_ASSERT_PTR_NOT_EQUAL(snapshot1, snapshot2);
+	NodeGraph* graph2 = getNodeGraphSnapshotGraph(snapshot2);
+	GraphNodeVertex* start2 = getNodeGraphSnapshotVertex(snapshot2, 0);
+	CU_ASSERT_EQUAL(getNodeGraphVertexCount(graph2), 7);
+	CU_ASSERT_FALSE(hasEdgeToGraphNodeVertex(start2, getNodeGraphSnapshotVertex(snapshot2, 2)));
+	CU_ASSERT_EQUAL(countReachableVertices(graph2, start2), 4);
+
+	// path search runs against the pinned snapshot
+	GraphNodeVertex** paths[] = {NULL,NULL,NULL,NULL,NULL,NULL};
+	int nPaths = getNodeGraphPaths(start1, getNodeGraphSnapshotVertex(snapshot1, 5), paths, 5);
+	CU_ASSERT_EQUAL(nPaths, 4);
+	for (int i = 0; i < nPaths; i++) {
+		free(paths[i]);
+	}
+	unpinNodeGraphSnapshot(versions, snapshot1);  // retired snapshot is freed
+	unpinNodeGraphSnapshot(versions, snapshot2);
+
+	// readers see consistent snapshots while the writer publishes changes
+	GraphNodeVertex* last = graph->vertices[getNodeGraphVertexCount(graph)-1];
+	addEdgeToGraphNodeVertex(graph->vertices[5], last, (GraphEdgeData){});
+	addEdgeToGraphNodeVertex(graph->vertices[0], graph->vertices[2], (GraphEdgeData){});
+	publishNodeGraphSnapshot(versions);
+	pthread_t readers[4];
+	for (int i = 0; i < 4; i++) {
+		pthread_create(&readers[i], NULL, readNodeGraphSnapshots, versions);
+	}
+	for (int i = 0; i < 200; i++) {
+		GraphNodeVertex* next = addGraphNodeVertexForData(graph, (GraphVertexData){"chain"});
+		addEdgeToGraphNodeVertex(last, next, (GraphEdgeData){});
+		last = next;
+		publishNodeGraphSnapshot(versions);
+	}
+	for (int i = 0; i < 4; i++) {
+		void* errors;
+		pthread_join(readers[i], &errors);
+		CU_ASSERT_EQUAL((long)errors, 0);
+	}
+
+	freeNodeGraphVersions(versions);
+	freeNodeGraph(graph);
+}
+
+/**
+ * Returns the number of edges in a graph.
+ *
+ * @param graph the graph
+ * @return the number of edges
+ */
+static long countNodeGraphEdges(NodeGraph* graph) {
+	long edges = 0;
+	for (int i = 0; i < graph->vertexCount; i++) {
+		edges += graph->vertices[i]->edgeCount;
+	}
+	return edges;
+}
+
+/**
+ * Tests the graph generators and getNodeGraphPaths() with fewer
+ * maxPaths than available paths.
+ */
+static void test_createGeneratedNodeGraphs(void) {
+	NodeGraph* graph = createErdosRenyiNodeGraph(100, 500, 1);
+	CU_ASSERT_EQUAL(getNodeGraphVertexCount(graph), 100);
+	CU_ASSERT_EQUAL(countNodeGraphEdges(graph), 500);
+	NodeGraph* sameGraph = createErdosRenyiNodeGraph(100, 500, 1);
+	for (int i = 0; i < 100; i++) {
+		GraphNodeVertex* vertex = graph->vertices[i];
+		CU_ASSERT_EQUAL(vertex->edgeCount, sameGraph->vertices[i]->edgeCount);
+		for (int iv = 0; iv < vertex->edgeCount; iv++) {
+			CU_ASSERT_TRUE(hasEdgeToGraphNodeVertex(sameGraph->vertices[i],
+					sameGraph->vertices[vertex->edgeTo[iv].vertex->index]));
+		}
+	}
+	freeNodeGraph(sameGraph);
+	freeNodeGraph(graph);
+
+	graph = createRMATNodeGraph(8, 4, 0.57, 0.19, 0.19, 1);
+	CU_ASSERT_EQUAL(getNodeGraphVertexCount(graph), 256);
+	CU_ASSERT_TRUE(countNodeGraphEdges(graph) <= 4*256);
+	freeNodeGraph(graph);
+
+	graph = createGridNodeGraph(5, 4);
+	CU_ASSERT_EQUAL(countNodeGraphEdges(graph), 2*(4*4 + 5*3));
+	CU_ASSERT_TRUE(hasEdgeToGraphNodeVertex(graph->vertices[6], graph->vertices[11]));
+	CU_ASSERT_TRUE(hasEdgeToGraphNodeVertex(graph->vertices[11], graph->vertices[6]));
+	freeNodeGraph(graph);
+
+	graph = createPowerLawNodeGraph(200, 3, 1);
+	CU_ASSERT_EQUAL(countNodeGraphEdges(graph), 2*(1 + 2 + 3*197));
+	CU_ASSERT_EQUAL(countReachableVertices(graph, graph->vertices[0]), 200);
+	freeNodeGraph(graph);
+
+	graph = createLayeredDAGNodeGraph(10, 2, 2, 1);
+	CU_ASSERT_TRUE(isNodeGraphAcyclic(graph));
+	CU_ASSERT_EQUAL(countNodeGraphDAGPaths(graph, graph->vertices[0], graph->vertices[19]), 256);
+	GraphNodeVertex** paths[11];
+	int nPaths = getNodeGraphPaths(graph->vertices[0], graph->vertices[19], paths, 10);
+	CU_ASSERT_EQUAL(nPaths, 256);
+	for (int i = 0; i < 10; i++) {
+		CU_ASSERT_PTR_NOT_NULL(paths[i]);
+		CU_ASSERT_PTR_EQUAL(paths[i][9], graph->vertices[19]);
+		CU_ASSERT_PTR_NULL(paths[i][10]);
+		free(paths[i]);
+	}
+	CU_ASSERT_PTR_NULL(paths[10]);
+	freeNodeGraph(graph);
+}
+
+/**
+ * Tests getNodeGraphPathsWithStats() and the iterator stats.
+ */
+static void test_getNodeGraphPathsWithStats(void) {
+	NodeGraph* graph = buildGraph2();
+	GraphNodeVertex** paths[] = {NULL,NULL,NULL,NULL,NULL,NULL};
+	NodeGraphStats stats;
+	int nPaths = getNodeGraphPathsWithStats(graph->vertices[0], graph->vertices[5], paths, 5, &stats);
+	CU_ASSERT_EQUAL(nPaths, 4);
+	for (int i = 0; i < nPaths; i++) {
+		free(paths[i]);
+	}
+
+	NodeGraphBFSIterator* itr = createNodeGraphBFSIterator(graph, graph->vertices[0]);
+	while (hasNextGraphNodeVertexBFS(itr)) {
+		getNextGraphNodeVertexBFS(itr);
+	}
+	const NodeGraphStats* bfsStats = getNodeGraphBFSIteratorStats(itr);
+
+	if (isNodeGraphStatsEnabled()) {
+		// expands 0, 1, 3, then 2, 3, 4; vertex 5 is the final vertex
+		CU_ASSERT_EQUAL(stats.verticesExpanded, 6);
+		CU_ASSERT_EQUAL(stats.edgesScanned, 2+2+1+2+1+1);
+		CU_ASSERT_EQUAL(stats.visitedProbes, stats.edgesScanned);
+		CU_ASSERT_EQUAL(stats.visitedHits, 0);
+		CU_ASSERT_EQUAL(stats.queueHighWater, 4);
+		CU_ASSERT_TRUE(stats.phaseSeconds[NODEGRAPH_PHASE_SEARCH] >= 0);
+
+		CU_ASSERT_EQUAL(bfsStats->verticesExpanded, 6);
+		CU_ASSERT_EQUAL(bfsStats->edgesScanned, 8);
+		CU_ASSERT_EQUAL(bfsStats->visitedProbes, 8);
+		CU_ASSERT_EQUAL(bfsStats->visitedHits, 3);
+		CU_ASSERT_EQUAL(bfsStats->queueHighWater, 3);
+	} else {
+		CU_ASSERT_EQUAL(stats.verticesExpanded, 0);
+		CU_ASSERT_EQUAL(bfsStats->edgesScanned, 0);
+	}
+	resetNodeGraphBFSIterator(itr);
+	CU_ASSERT_EQUAL(getNodeGraphBFSIteratorStats(itr)->verticesExpanded, 0);
+	freeNodeGraphBFSIterator(itr);
+	freeNodeGraph(graph);
+}
+
+/**
+ * Tests getNodeGraphPathSet() against getNodeGraphPaths().
+ */
+static void test_getNodeGraphPathSet(void) {
+	NodeGraph* graph = buildGraph1();
+	NodeGraphPathSet* pathSet = createNodeGraphPathSet();
+	GraphNodeVertex* vertices[2];
+	getGraphNodeVerticesForData(graph, (GraphVertexData){"5"}, vertices, 1);
+	GraphNodeVertex* fromVertex = vertices[0];
+	getGraphNodeVerticesForData(graph, (GraphVertexData){"3"}, vertices, 1);
+	GraphNodeVertex* toVertex = vertices[0];
+
+	CU_ASSERT_EQUAL(getNodeGraphPathSet(fromVertex, toVertex, pathSet, 5), 3);
+	CU_ASSERT_EQUAL(getNodeGraphPathSetCount(pathSet), 3);
+	const char* testPath0[] = {"5", "0", "1", "2", "3"};
+	const char* testPath1[] = {"5", "0", "1", "3"};
+	const char* testPath2[] = {"5", "0", "2", "3"};
+	const char** testPaths[] = {testPath0, testPath1, testPath2};
+	int testLengths[] = {5, 4, 4};
+	for (int i = 0; i < 3; i++) {
+		CU_ASSERT_EQUAL(getNodeGraphPathSetLength(pathSet, i), testLengths[i]);
+		GraphNodeVertex** path = getNodeGraphPathSetPath(pathSet, i);
+		for (int j = 0; j < testLengths[i]; j++) {
+			CU_ASSERT_STRING_EQUAL(path[j]->data.strval, testPaths[i][j]);
+		}
+		CU_ASSERT_PTR_NULL(path[testLengths[i]]);
+		free(path);
+	}
+	CU_ASSERT_PTR_NULL(getNodeGraphPathSetPath(pathSet, 3));
+	CU_ASSERT_EQUAL(getNodeGraphPathSetLength(pathSet, -1), -1);
+
+	// paths 5-0-1-2-3 and 5-0-1-3 share the prefix 5-0-1
+	CU_ASSERT_EQUAL(pathSet->nodeCount, 5 + 1 + 2);
+
+	// fewer stored paths than found, and a path of one vertex
+	CU_ASSERT_EQUAL(getNodeGraphPathSet(fromVertex, toVertex, pathSet, 1), 3);
+	CU_ASSERT_EQUAL(getNodeGraphPathSetCount(pathSet), 1);
+	CU_ASSERT_EQUAL(getNodeGraphPathSet(fromVertex, fromVertex, pathSet, 1), 1);
+	CU_ASSERT_EQUAL(getNodeGraphPathSetLength(pathSet, 0), 1);
+	freeNodeGraph(graph);
+
+	// same paths in the same order as getNodeGraphPaths()
+	graph = createLayeredDAGNodeGraph(12, 3, 2, 7);
+	fromVertex = graph->vertices[0];
+	toVertex = graph->vertices[graph->vertexCount-1];
+	GraphNodeVertex*** paths = (GraphNodeVertex***)malloc(2001 * sizeof(GraphNodeVertex**));
+	int nPaths = getNodeGraphPaths(fromVertex, toVertex, paths, 2000);
+	CU_ASSERT_EQUAL(getNodeGraphPathSet(fromVertex, toVertex, pathSet, 2000), nPaths);
+	GraphNodeVertex* path[13];
+	for (int i = 0; i < nPaths && i < 2000; i++) {
+		CU_ASSERT_EQUAL(copyNodeGraphPathSetPath(pathSet, i, path), 12);
+		for (int j = 0; j <= 12; j++) {
+			CU_ASSERT_PTR_EQUAL(path[j], paths[i][j]);
+		}
+		free(paths[i]);
+	}
+	CU_ASSERT_TRUE(pathSet->nodeCount < 12 * getNodeGraphPathSetCount(pathSet));
+	free(paths);
+	freeNodeGraphPathSet(pathSet);
+	freeNodeGraph(graph);
+}
+
+/**
+ * Tests NodeGraphDFS events, findNodeGraphCycle(), and
+ * getNodeGraphStronglyConnectedComponents().
+ */
+static void test_getNextNodeGraphDFSEvent(void) {
+	NodeGraph* graph = buildGraph2();
+	NodeGraphDFS* dfs = createNodeGraphDFS(graph);
+	NodeGraphDFSFrame* frames = dfs->frames;
+	int counts[NODEGRAPH_DFS_CROSS_EDGE+1];
+	NodeGraphDFSEvent event;
+	for (int start = 0; start < 6; start++) {
+		resetNodeGraphDFS(dfs);
+		memset(counts, 0, sizeof(counts));
+		CU_ASSERT_TRUE(startNodeGraphDFS(dfs, graph->vertices[start]));
+		while (getNextNodeGraphDFSEvent(dfs, &event)) {
+			counts[event.type]++;
+			if (event.type == NODEGRAPH_DFS_FINISH && event.depth == 0) {
+				CU_ASSERT_PTR_NULL(event.toVertex);
+			}
+		}
+		CU_ASSERT_FALSE(startNodeGraphDFS(dfs, graph->vertices[start]));
+		CU_ASSERT_EQUAL(counts[NODEGRAPH_DFS_DISCOVER], counts[NODEGRAPH_DFS_FINISH]);
+		CU_ASSERT_EQUAL(counts[NODEGRAPH_DFS_TREE_EDGE], counts[NODEGRAPH_DFS_DISCOVER]-1);
+		CU_ASSERT_EQUAL(counts[NODEGRAPH_DFS_BACK_EDGE], 0);
+	}
+	CU_ASSERT_EQUAL(counts[NODEGRAPH_DFS_DISCOVER], 1);  // vertex 5 has no edges
+
+	// simple paths by forgetting vertices as they finish
+	resetNodeGraphDFS(dfs);
+	startNodeGraphDFS(dfs, graph->vertices[0]);
+	int nPaths = 0;
+	while (getNextNodeGraphDFSEvent(dfs, &event)) {
+		if (event.type == NODEGRAPH_DFS_DISCOVER && event.vertex == graph->vertices[5]) {
+			CU_ASSERT_PTR_EQUAL(getNodeGraphDFSPathVertex(dfs, 0), graph->vertices[0]);
+			CU_ASSERT_EQUAL(getNodeGraphDFSPathLength(dfs), event.depth+1);
+			skipNodeGraphDFSEdges(dfs);
+			nPaths++;
+		} else if (event.type == NODEGRAPH_DFS_FINISH) {
+			forgetNodeGraphDFSVertex(dfs, event.vertex);
+		}
+	}
+	CU_ASSERT_EQUAL(nPaths, 4);
+	CU_ASSERT_PTR_EQUAL(dfs->frames, frames);  // state reused without reallocation
+	freeNodeGraphDFS(dfs);
+
+	GraphNodeVertex* cycle[8];
+	CU_ASSERT_EQUAL(findNodeGraphCycle(graph, cycle), 0);
+	CU_ASSERT_PTR_NULL(cycle[0]);
+	freeNodeGraph(graph);
+
+	// 0->1->2->0, 2->3, 3->4->3, 5
+	graph = createNodeGraph();
+	for (int i = 0; i < 6; i++) {
+		addGraphNodeVertexForData(graph, (GraphVertexData){"scc"});
+	}
+	int edges[][2] = {{0,1}, {1,2}, {2,0}, {2,3}, {3,4}, {4,3}};
+	for (int i = 0; i < 6; i++) {
+		addEdgeToGraphNodeVertex(graph->vertices[edges[i][0]],
+								 graph->vertices[edges[i][1]], (GraphEdgeData){});
+	}
+	int length = findNodeGraphCycle(graph, cycle);
+	CU_ASSERT_EQUAL(length, 3);
+	for (int i = 0; i < length; i++) {
+		CU_ASSERT_TRUE(hasEdgeToGraphNodeVertex(cycle[i], cycle[(i+1) % length]));
+	}
+
+	int component[6];
+	CU_ASSERT_EQUAL(getNodeGraphStronglyConnectedComponents(graph, component), 3);
+	CU_ASSERT_EQUAL(component[0], component[1]);
+	CU_ASSERT_EQUAL(component[1], component[2]);
+	CU_ASSERT_EQUAL(component[3], component[4]);
+	CU_ASSERT_TRUE(component[2] > component[3]);
+	CU_ASSERT_NOT_EQUAL(component[5], component[0]);
+	CU_ASSERT_NOT_EQUAL(component[5], component[3]);
+	freeNodeGraph(graph);
+
+	// a layered DAG has one component per vertex
+	graph = createLayeredDAGNodeGraph(20, 50, 3, 5);
+	int* dagComponent = (int*)malloc(graph->vertexCount * sizeof(int));
+	CU_ASSERT_EQUAL(getNodeGraphStronglyConnectedComponents(graph, dagComponent), 1000);
+	free(dagComponent);
+	freeNodeGraph(graph);
+}
+
+/**
+ * Tests the CSR views and getNodeGraphPageRank() against a
+ * straightforward push-based power iteration.
+ */
+static void test_getNodeGraphPageRank(void) {
+	NodeGraph* graph = createPowerLawNodeGraph(500, 2, 3);
+	// one-way edges and vertices without edges
+	for (int i = 0; i < 500; i += 7) {
+		addGraphNodeVertexForData(graph, (GraphVertexData){"dangling"});
+		addEdgeToGraphNodeVertex(graph->vertices[i], graph->vertices[graph->vertexCount-1],
+								 (GraphEdgeData){});
+	}
+	int n = graph->vertexCount;
+
+	NodeGraphCSR* csr = createNodeGraphCSR(graph);
+	NodeGraphCSR* transposed = createTransposedNodeGraphCSR(graph);
+	CU_ASSERT_EQUAL(csr->edgeCount, transposed->edgeCount);
+	for (int v = 0; v < n; v++) {
+		CU_ASSERT_EQUAL(csr->offsets[v+1] - csr->offsets[v], graph->vertices[v]->edgeCount);
+		for (long k = transposed->offsets[v]; k < transposed->offsets[v+1]; k++) {
+			CU_ASSERT_TRUE(hasEdgeToGraphNodeVertex(
+				graph->vertices[transposed->neighbors[k]], graph->vertices[v]));
+		}
+	}
+	int bounds[5];
+	getNodeGraphCSRRanges(transposed, 4, bounds);
+	CU_ASSERT_TRUE(bounds[0] == 0 && bounds[4] == n);
+	for (int i = 0; i < 4; i++) {
+		CU_ASSERT_TRUE(bounds[i] <= bounds[i+1]);
+	}
+
+	// reference ranks pushed along out edges
+	double* expected = (double*)malloc(n * sizeof(double));
+	double* next = (double*)malloc(n * sizeof(double));
+	for (int v = 0; v < n; v++) {
+		expected[v] = 1.0 / n;
+	}
+	for (int iteration = 0; iteration < 200; iteration++) {
+		double dangling = 0;
+		for (int v = 0; v < n; v++) {
+			next[v] = 0;
+		}
+		for (int v = 0; v < n; v++) {
+			GraphNodeVertex* vtx = graph->vertices[v];
+			if (vtx->edgeCount == 0) {
+				dangling += expected[v];
+			}
+			for (int iv = 0; iv < vtx->edgeCount; iv++) {
+				next[vtx->edgeTo[iv].vertex->index] += expected[v] / vtx->edgeCount;
+			}
+		}
+		for (int v = 0; v < n; v++) {
+			expected[v] = 0.85 * next[v] + (0.85 * dangling + 0.15) / n;
+		}
+	}
+
+	double* rank = (double*)malloc(n * sizeof(double));
+	double* threadRank = (double*)malloc(n * sizeof(double));
+	NodeGraphRankOptions options = NODEGRAPH_RANK_DEFAULTS;
+	options.threadCount = 1;
+	int iterations = getNodeGraphPageRank(graph, &options, rank);
+	CU_ASSERT_TRUE(iterations > 1 && iterations < options.maxIterations);
+	options.threadCount = 4;
+	CU_ASSERT_EQUAL(getNodeGraphCSRPageRank(transposed, &options, NULL, threadRank), iterations);
+	double total = 0;
+	for (int v = 0; v < n; v++) {
+		CU_ASSERT_DOUBLE_EQUAL(rank[v], expected[v], 1e-9);
+		CU_ASSERT_DOUBLE_EQUAL(threadRank[v], rank[v], 1e-12);
+		total += rank[v];
+	}
+	CU_ASSERT_DOUBLE_EQUAL(total, 1.0, 1e-9);
+
+	// personalized to vertex 0, which only reaches its component
+	double* personalization = (double*)calloc(n, sizeof(double));
+	personalization[0] = 2.0;
+	getNodeGraphPersonalizedPageRank(graph, NULL, personalization, rank);
+	total = 0;
+	for (int v = 0; v < n; v++) {
+		total += rank[v];
+		CU_ASSERT_TRUE(rank[v] <= rank[0]);
+	}
+	CU_ASSERT_DOUBLE_EQUAL(total, 1.0, 1e-9);
+	CU_ASSERT_TRUE(rank[0] > 0.15);
+
+	free(personalization);
+	free(threadRank);
+	free(rank);
+	free(next);
+	free(expected);
+	freeNodeGraphCSR(transposed);
+	freeNodeGraphCSR(csr);
+	freeNodeGraph(graph);
+}
+
+/**
+ * Tests getNodeGraphWeakComponents() against components found by
+ * propagating the lowest vertex index along edges in both directions.
+ */
+static void test_getNodeGraphWeakComponents(void) {
+	// sparse enough to leave many components, large enough for several threads
+	NodeGraph* graph = createErdosRenyiNodeGraph(5000, 2400, 11);
+	int n = graph->vertexCount;
+
+	int* expected = (int*)malloc(n * sizeof(int));
+	for (int v = 0; v < n; v++) {
+		expected[v] = v;
+	}
+	for (bool changed = true; changed; ) {
+		changed = false;
+		for (int v = 0; v < n; v++) {
+			GraphNodeVertex* vtx = graph->vertices[v];
+			for (int iv = 0; iv < vtx->edgeCount; iv++) {
+				int to = vtx->edgeTo[iv].vertex->index;
+				if (expected[to] != expected[v]) {
+					int low = (expected[to] < expected[v]) ? expected[to] : expected[v];
+					expected[to] = expected[v] = low;
+					changed = true;
+				}
+			}
+		}
+	}
+	// number components in order of lowest vertex index
+	int expectedCount = 0;
+	for (int v = 0; v < n; v++) {
+		expected[v] = (expected[v] == v) ? expectedCount++ : expected[expected[v]];
+	}
+
+	int* component = (int*)malloc(n * sizeof(int));
+	for (int threadCount = 1; threadCount <= 4; threadCount *= 2) {
+		CU_ASSERT_EQUAL(getNodeGraphWeakComponents(graph, threadCount, component), expectedCount);
+		int mismatches = 0;
+		for (int v = 0; v < n; v++) {
+			mismatches += (component[v] != expected[v]);
+		}
+		CU_ASSERT_EQUAL(mismatches, 0);
+	}
+	CU_ASSERT_TRUE(expectedCount > 1);
+
+	// path requests between components find no paths
+	int other = 1;
+	while (component[other] == component[0]) {
+		other++;
+	}
+	CU_ASSERT_FALSE(inSameNodeGraphComponent(component, graph->vertices[0], graph->vertices[other]));
+	GraphNodeVertex** paths[2];
+	CU_ASSERT_EQUAL(getNodeGraphPaths(graph->vertices[0], graph->vertices[other], paths, 1), 0);
+
+	// edge direction is ignored
+	NodeGraph* graph2 = buildGraph2();
+	int component2[6];
+	CU_ASSERT_EQUAL(getNodeGraphWeakComponents(graph2, 0, component2), 1);
+	CU_ASSERT_TRUE(inSameNodeGraphComponent(component2, graph2->vertices[5], graph2->vertices[0]));
+
+	freeNodeGraph(graph2);
+	free(component);
+	free(expected);
+	freeNodeGraph(graph);
+}
+
+/**
+ * Tests getNodeGraphWalks() for valid walks, edge frequencies of weighted
+ * walks, independence of the thread count, and node2vec bias.
+ */
+static void test_getNodeGraphWalks(void) {
+	// hub 0 with weighted edges to 1, 2, 3, which return to it; 4 has no edges
+	NodeGraph* graph = createNodeGraph();
+	for (int i = 0; i < 5; i++) {
+		addGraphNodeVertexForData(graph, (GraphVertexData){"walk"});
+	}
+	double weights[] = {1.0, 2.0, 5.0};
+	for (int i = 1; i <= 3; i++) {
+		addEdgeToGraphNodeVertex(graph->vertices[0], graph->vertices[i],
+								 (GraphEdgeData){.weight = weights[i-1]});
+		addEdgeToGraphNodeVertex(graph->vertices[i], graph->vertices[0], (GraphEdgeData){});
+	}
+	addEdgeToGraphNodeVertex(graph->vertices[3], graph->vertices[4], (GraphEdgeData){});
+
+	int walkCount = 8000;
+	NodeGraphWalkOptions options = NODEGRAPH_WALK_DEFAULTS;
+	options.walkLength = 6;
+	int* starts = (int*)calloc(walkCount, sizeof(int));
+	int* walks = (int*)malloc(walkCount * options.walkLength * sizeof(int));
+	int* threadWalks = (int*)malloc(walkCount * options.walkLength * sizeof(int));
+
+	NodeGraphWalker* walker = createNodeGraphWalker(graph, true);
+	options.threadCount = 1;
+	long steps = getNodeGraphWalks(walker, &options, starts, walkCount, walks);
+	options.threadCount = 4;
+	CU_ASSERT_EQUAL(getNodeGraphWalks(walker, &options, starts, walkCount, threadWalks), steps);
+	int invalid = 0;
+	int differences = 0;
+	long counted = 0;
+	int firstSteps[4] = {0};
+	for (int w = 0; w < walkCount; w++) {
+		int* walk = &walks[w * options.walkLength];
+		CU_ASSERT_EQUAL(walk[0], 0);
+		firstSteps[walk[1]]++;
+		for (int i = 1; i < options.walkLength; i++) {
+			if (walk[i] < 0) {
+				// only a walk that ends at 4 stops early
+				invalid += (walk[i-1] != 4 && walk[i-1] != -1);
+			} else {
+				invalid += !hasEdgeToGraphNodeVertex(
+					graph->vertices[walk[i-1]], graph->vertices[walk[i]]);
+				counted++;
+			}
+		}
+		for (int i = 0; i < options.walkLength; i++) {
+			differences += (walk[i] != threadWalks[w * options.walkLength + i]);
+		}
+	}
+	CU_ASSERT_EQUAL(invalid, 0);
+	CU_ASSERT_EQUAL(differences, 0);
+	CU_ASSERT_EQUAL(counted, steps);
+	for (int i = 1; i <= 3; i++) {
+		CU_ASSERT_DOUBLE_EQUAL(firstSteps[i] / (double)walkCount, weights[i-1] / 8.0, 0.02);
+	}
+	freeNodeGraphWalker(walker);
+
+	// uniform walks ignore the weights
+	walker = createNodeGraphWalker(graph, false);
+	getNodeGraphWalks(walker, &options, starts, walkCount, walks);
+	memset(firstSteps, 0, sizeof(firstSteps));
+	for (int w = 0; w < walkCount; w++) {
+		firstSteps[walks[w * options.walkLength + 1]]++;
+	}
+	for (int i = 1; i <= 3; i++) {
+		CU_ASSERT_DOUBLE_EQUAL(firstSteps[i] / (double)walkCount, 1.0 / 3.0, 0.02);
+	}
+
+	// node2vec: a high return parameter avoids going back to the hub
+	starts[0] = 1;
+	options.walkLength = 3;
+	options.returnParam = 1e9;
+	getNodeGraphWalks(walker, &options, starts, 1, walks);
+	CU_ASSERT_EQUAL(walks[1], 0);
+	CU_ASSERT_NOT_EQUAL(walks[2], 1);
+	// a low return parameter almost always goes back
+	options.returnParam = 1e-9;
+	for (int w = 0; w < walkCount; w++) {
+		starts[w] = 1;
+	}
+	getNodeGraphWalks(walker, &options, starts, walkCount, walks);
+	int returns = 0;
+	for (int w = 0; w < walkCount; w++) {
+		returns += (walks[w * options.walkLength + 2] == 1);
+	}
+	CU_ASSERT_EQUAL(returns, walkCount);
+
+	// walks of no length write nothing
+	options.walkLength = 0;
+	walks[0] = -2;
+	CU_ASSERT_EQUAL(getNodeGraphWalks(walker, &options, starts, walkCount, walks), 0);
+	CU_ASSERT_EQUAL(walks[0], -2);
+
+	freeNodeGraphWalker(walker);
+	free(threadWalks);
+	free(walks);
+	free(starts);
+	freeNodeGraph(graph);
+}
+
+/**
+ * Frees the path arrays returned by a path query.
+ *
+ * @param paths the null-terminated array of paths
+ */
+static void freeNodeGraphPathArrays(GraphNodeVertex*** paths) {
+	for (int i = 0; paths[i] != (GraphNodeVertex**)NULL; i++) {
+		free(paths[i]);
+	}
+}
+
+/**
+ * Tests getCachedNodeGraphPaths() and isCachedNodeGraphVertexReachable()
+ * for hits, CLOCK eviction, and invalidation when the graph changes.
+ */
+static void test_getCachedNodeGraphPaths(void) {
+	NodeGraph* graph = buildGraph2();
+	GraphNodeVertex** v = graph->vertices;
+	NodeGraphQueryCache* cache = createNodeGraphQueryCache(graph, 2);
+	GraphNodeVertex** expected[5];
+	GraphNodeVertex** paths[5];
+
+	CU_ASSERT_EQUAL(getNodeGraphPaths(v[0], v[5], expected, 4), 4);
+	CU_ASSERT_EQUAL(getCachedNodeGraphPaths(cache, v[0], v[5], paths, 4), 4);
+	freeNodeGraphPathArrays(paths);
+	CU_ASSERT_EQUAL(getCachedNodeGraphPaths(cache, v[0], v[5], paths, 4), 4);
+	for (int i = 0; i < 4; i++) {
+		int j = 0;
+		for ( ; expected[i][j] != NULL; j++) {
+			CU_ASSERT_PTR_EQUAL(paths[i][j], expected[i][j]);
+		}
+		CU_ASSERT_PTR_NULL(paths[i][j]);
+	}
+	CU_ASSERT_PTR_NULL(paths[4]);
+	freeNodeGraphPathArrays(paths);
+	freeNodeGraphPathArrays(expected);
+
+	// a different maxPaths is a different query
+	CU_ASSERT_EQUAL(getCachedNodeGraphPaths(cache, v[0], v[5], paths, 1), 4);
+	CU_ASSERT_PTR_NOT_NULL(paths[0]);
+	CU_ASSERT_PTR_NULL(paths[1]);
+	freeNodeGraphPathArrays(paths);
+
+	NodeGraphQueryCacheStats stats;
+	getNodeGraphQueryCacheStats(cache, &stats);
+	CU_ASSERT_EQUAL(stats.hits, 1);
+	CU_ASSERT_EQUAL(stats.misses, 2);
+	CU_ASSERT_EQUAL(stats.evictions, 0);
+
+	// the full cache evicts an entry not referenced since the hand passed
+	CU_ASSERT_TRUE(isCachedNodeGraphVertexReachable(cache, v[2], v[5]));
+	CU_ASSERT_TRUE(isCachedNodeGraphVertexReachable(cache, v[2], v[5]));
+	CU_ASSERT_FALSE(isCachedNodeGraphVertexReachable(cache, v[5], v[0]));
+	CU_ASSERT_FALSE(isCachedNodeGraphVertexReachable(cache, v[5], v[0]));
+	getNodeGraphQueryCacheStats(cache, &stats);
+	CU_ASSERT_EQUAL(stats.hits, 3);
+	CU_ASSERT_EQUAL(stats.misses, 4);
+	CU_ASSERT_EQUAL(stats.evictions, 2);
+	CU_ASSERT_DOUBLE_EQUAL(getNodeGraphQueryCacheHitRate(cache), 3.0 / 7.0, 1e-12);
+
+	// a change to the graph discards the results
+	addEdgeToGraphNodeVertex(v[5], v[0], (GraphEdgeData){});
+	CU_ASSERT_TRUE(isCachedNodeGraphVertexReachable(cache, v[5], v[0]));
+	CU_ASSERT_EQUAL(getCachedNodeGraphPaths(cache, v[1], v[2], paths, 4), 2);
+	freeNodeGraphPathArrays(paths);
+	getNodeGraphQueryCacheStats(cache, &stats);
+	CU_ASSERT_EQUAL(stats.invalidations, 1);
+	CU_ASSERT_EQUAL(stats.misses, 6);
+
+	freeNodeGraphQueryCache(cache);
+	freeNodeGraph(graph);
+}
+
+/**
+ * Tests expandNodeGraphNeighborhood() on a grid with edges both ways
+ * between neighboring cells, so vertex (x, y) is x+y hops from (0, 0).
+ */
+static void test_expandNodeGraphNeighborhood(void) {
+	NodeGraph* graph = createGridNodeGraph(10, 10);
+	NodeGraphNeighborhood* neighborhood = createNodeGraphNeighborhood(graph);
+
+	GraphNodeVertex* seeds[2] = {graph->vertices[0], graph->vertices[99]};
+	CU_ASSERT_EQUAL(expandNodeGraphNeighborhood(neighborhood, seeds, 1, 3), 10);
+	int misplaced = 0;
+	for (int y = 0; y < 10; y++) {
+		for (int x = 0; x < 10; x++) {
+			GraphNodeVertex* vertex = graph->vertices[y*10 + x];
+			misplaced += (isInNodeGraphNeighborhood(neighborhood, vertex) != (x+y <= 3));
+			misplaced += (getNodeGraphNeighborhoodHops(neighborhood, vertex) != ((x+y <= 3) ? x+y : -1));
+		}
+	}
+	CU_ASSERT_EQUAL(misplaced, 0);
+
+	// induced subgraph has edges both ways between adjacent hops 0 to 3
+	NodeGraph* subgraph = createNodeGraphNeighborhoodSubgraph(neighborhood);
+	NodeGraphCSR* csr = createNodeGraphNeighborhoodCSR(neighborhood);
+	CU_ASSERT_EQUAL(subgraph->vertexCount, 10);
+	CU_ASSERT_EQUAL(countNodeGraphEdges(subgraph), 24);
+	CU_ASSERT_EQUAL(csr->vertexCount, 10);
+	CU_ASSERT_EQUAL(csr->edgeCount, 24);
+	for (int i = 0; i < 10; i++) {
+		GraphNodeVertex* vertex = graph->vertices[neighborhood->vertices[i]];
+		CU_ASSERT_PTR_EQUAL(subgraph->vertices[i]->data.strval, vertex->data.strval);
+		CU_ASSERT_EQUAL(csr->outDegree[i], subgraph->vertices[i]->edgeCount);
+		for (long k = csr->offsets[i]; k < csr->offsets[i+1]; k++) {
+			CU_ASSERT_TRUE(hasEdgeToGraphNodeVertex(
+				subgraph->vertices[i], subgraph->vertices[csr->neighbors[k]]));
+			CU_ASSERT_TRUE(hasEdgeToGraphNodeVertex(
+				vertex, graph->vertices[neighborhood->vertices[csr->neighbors[k]]]));
+		}
+	}
+	freeNodeGraphCSR(csr);
+	freeNodeGraph(subgraph);
+
+	// reuse clears the previous expansion
+	CU_ASSERT_EQUAL(expandNodeGraphNeighborhood(neighborhood, &seeds[1], 1, 5), 21);
+	CU_ASSERT_FALSE(isInNodeGraphNeighborhood(neighborhood, graph->vertices[0]));
+	CU_ASSERT_EQUAL(neighborhood->hopCount, 5);
+	CU_ASSERT_EQUAL(expandNodeGraphNeighborhood(neighborhood, seeds, 2, 20), 100);
+	CU_ASSERT_EQUAL(neighborhood->hopCount, 9);
+	CU_ASSERT_EQUAL(getNodeGraphNeighborhoodHops(neighborhood, graph->vertices[9]), 9);
+	CU_ASSERT_EQUAL(getNodeGraphNeighborhoodHops(neighborhood, graph->vertices[99]), 0);
+
+	// the graph may grow between expansions
+	for (int i = 0; i < 100; i++) {
+		GraphNodeVertex* vertex = addGraphNodeVertexForData(graph, (GraphVertexData){"extra"});
+		addEdgeToGraphNodeVertex(graph->vertices[99], vertex, (GraphEdgeData){});
+	}
+	CU_ASSERT_EQUAL(expandNodeGraphNeighborhood(neighborhood, &seeds[1], 1, 1), 103);
+
+	freeNodeGraphNeighborhood(neighborhood);
+	freeNodeGraph(graph);
+}
+
+/** Hash map of integer keys to integer values for test_defineHashMap */
+DEFINE_HASH_MAP(CountMap, long, int, hashTemplateInt, HASH_TEMPLATE_EQUAL)
+
+/** Hash set of string keys for test_defineHashMap */
+DEFINE_HASH_SET(LabelSet, const char*, hashTemplateString, equalTemplateStrings)
+
+/**
+ * Tests maps and sets defined by DEFINE_HASH_MAP and DEFINE_HASH_SET
+ * against arrays indexed by key, with keys that collide in the low bits
+ * to exercise probing and removal.
+ */
+static void test_defineHashMap(void) {
+	enum { KEY_COUNT = 1000 };
+	bool present[KEY_COUNT] = {false};
+	int expected[KEY_COUNT];
+	int size = 0;
+	int mismatches = 0;
+
+	CountMap* map = createCountMap();
+	CU_ASSERT_TRUE(isCountMapEmpty(map));
+	unsigned random = 1;
+	for (int op = 0; op < 50000; op++) {
+		random = random * 1103515245 + 12345;
+		int k = (random >> 8) % KEY_COUNT;
+		long key = (long)k << 20;
+		if ((random >> 28) < 10) {
+			mismatches += (putCountMapEntry(map, key, op) == present[k]);
+			size += !present[k];
+			present[k] = true;
+			expected[k] = op;
+		} else {
+			mismatches += (removeCountMapEntryForKey(map, key) != present[k]);
+			size -= present[k];
+			present[k] = false;
+		}
+		if (op % 1000 == 999) {
+			for (int i = 0; i < KEY_COUNT; i++) {
+				int* value = getCountMapValue(map, (long)i << 20);
+				mismatches += (containsCountMapKey(map, (long)i << 20) != present[i]);
+				mismatches += present[i] ? (value == NULL || *value != expected[i]) : (value != NULL);
+			}
+			mismatches += (getCountMapSize(map) != size);
+		}
+	}
+	CU_ASSERT_EQUAL(mismatches, 0);
+
+	// iteration visits each entry once
+	int visited = 0;
+	int position = 0;
+	for (CountMapEntry* entry; (entry = getNextCountMapEntry(map, &position)) != NULL; ) {
+		int k = (int)(entry->key >> 20);
+		mismatches += (!present[k] || entry->value != expected[k]);
+		visited++;
+	}
+	CU_ASSERT_EQUAL(mismatches, 0);
+	CU_ASSERT_EQUAL(visited, size);
+	clearCountMap(map);
+	CU_ASSERT_EQUAL(getCountMapSize(map), 0);
+	CU_ASSERT_FALSE(containsCountMapKey(map, 0));
+	freeCountMap(map);
+
+	// string keys are compared by content
+	LabelSet* set = createLabelSet();
+	for (int i = 0; i < 100; i++) {
+		char* label = (char*)malloc(16);
+		snprintf(label, 16, "v%d", i);
+		CU_ASSERT_TRUE(addLabelSetKey(set, label));
+	}
+	CU_ASSERT_FALSE(addLabelSetKey(set, "v7"));
+	CU_ASSERT_TRUE(containsLabelSetKey(set, "v42"));
+	CU_ASSERT_FALSE(containsLabelSetKey(set, "v100"));
+	CU_ASSERT_EQUAL(getLabelSetSize(set), 100);
+	position = 0;
+	for (LabelSetEntry* entry; (entry = getNextLabelSetEntry(set, &position)) != NULL; ) {
+		free((char*)entry->key);
+	}
+	freeLabelSet(set);
+}
+
+/**
+ * Tests HashSet against an array of flags by key, with removals that
+ * shift keys back in the table, and the HashSet iterator and bulk
+ * operations.
+ */
+static void test_hashSet(void) {
+	enum { KEY_COUNT = 2000 };
+	GraphNodeVertex* vertices = (GraphNodeVertex*)calloc(KEY_COUNT, sizeof(GraphNodeVertex));
+	bool present[KEY_COUNT] = {false};
+	int size = 0;
+	int mismatches = 0;
+
+	HashSet* set = createHashSet();
+	unsigned random = 7;
+	for (int op = 0; op < 60000; op++) {
+		random = random * 1103515245 + 12345;
+		int k = (random >> 8) % KEY_COUNT;
+		if ((random >> 28) < 9) {
+			mismatches += (addHashSetKey(set, &vertices[k]) == present[k]);
+			size += !present[k];
+			present[k] = true;
+		} else {
+			mismatches += (removeHashSetKey(set, &vertices[k]) != present[k]);
+			size -= present[k];
+			present[k] = false;
+		}
+		if (op % 2000 == 1999) {
+			for (int i = 0; i < KEY_COUNT; i++) {
+				mismatches += (containsHashSetKey(set, &vertices[i]) != present[i]);
+			}
+			mismatches += (getHashSetSize(set) != size);
+		}
+	}
+	CU_ASSERT_EQUAL(mismatches, 0);
+
+	// forward then backward iteration returns each key once
+	HashSetIterator* itr = createHashSetIterator(set);
+	bool* seen = (bool*)calloc(KEY_COUNT, sizeof(bool));
+	int count = 0;
+	for (MapKey* key; (key = getNextHashSetKey(itr)) != (MapKey*)NULL; count++) {
+		int k = (int)(*key - vertices);
+		mismatches += (!present[k] || seen[k]);
+		seen[k] = true;
+	}
+	CU_ASSERT_EQUAL(count, size);
+	CU_ASSERT_EQUAL(getHashSetIteratorAvailable(itr), 0);
+	for (MapKey* key; (key = getPrevHashSetKey(itr)) != (MapKey*)NULL; count--) {
+		int k = (int)(*key - vertices);
+		mismatches += !seen[k];
+		seen[k] = false;
+	}
+	CU_ASSERT_EQUAL(count, 0);
+	CU_ASSERT_EQUAL(mismatches, 0);
+	freeHashSetIterator(itr);
+
+	// bulk operations with the even keys
+	HashSet* evens = createHashSet();
+	for (int i = 0; i < KEY_COUNT; i += 2) {
+		addHashSetKey(evens, &vertices[i]);
+	}
+	HashSet* copy = createHashSet();
+	CU_ASSERT_TRUE(addAllHashSetKeys(copy, set));
+	CU_ASSERT_TRUE(containsAllHashSetKeys(copy, set));
+	CU_ASSERT_TRUE(retainAllHashSetKeys(copy, evens));
+	CU_ASSERT_TRUE(containsAllHashSetKeys(evens, copy));
+	CU_ASSERT_TRUE(removeAllHashSetKeys(set, evens));
+	for (int i = 0; i < KEY_COUNT; i++) {
+		mismatches += (containsHashSetKey(copy, &vertices[i]) != (present[i] && i % 2 == 0));
+		mismatches += (containsHashSetKey(set, &vertices[i]) != (present[i] && i % 2 == 1));
+	}
+	CU_ASSERT_EQUAL(mismatches, 0);
+	CU_ASSERT_EQUAL(getHashSetSize(copy) + getHashSetSize(set), size);
+	clearHashSet(set);
+	CU_ASSERT_TRUE(isHashSetEmpty(set));
+	CU_ASSERT_FALSE(containsHashSetKey(set, &vertices[1]));
+
+	freeHashSet(copy);
+	freeHashSet(evens);
+	freeHashSet(set);
+	free(seen);
+	free(vertices);
+}
+
+/**
+ * Checks that a set has exactly the keys of vertices whose index has
+ * the expected membership.
+ *
+ * @param set the HashSet
+ * @param vertices the array of vertices used as keys
+ * @param count the number of vertices
+ * @param isMember returns whether the key for an index should be in the set
+ * @return the number of keys with the wrong membership
+ */
+static int countHashSetMismatches(HashSet* set, GraphNodeVertex* vertices, int count,
+		bool (*isMember)(int)) {
+	int mismatches = 0;
+	int size = 0;
+	for (int i = 0; i < count; i++) {
+		mismatches += (containsHashSetKey(set, &vertices[i]) != isMember(i));
+		size += isMember(i);
+	}
+	return mismatches + (getHashSetSize(set) != size);
+}
+
+static bool isMultipleOf2(int i) { return i % 2 == 0; }
+static bool isMultipleOf3(int i) { return i % 3 == 0; }
+static bool isMultipleOf2Or3(int i) { return i % 2 == 0 || i % 3 == 0; }
+static bool isMultipleOf6(int i) { return i % 6 == 0; }
+static bool isMultipleOf2Not3(int i) { return i % 2 == 0 && i % 3 != 0; }
+static bool isMultipleOf3Not2(int i) { return i % 3 == 0 && i % 2 != 0; }
+
+/**
+ * Tests bulk union, intersection, difference and subset operations on
+ * HashSet, in both orders of operand size, with operands large enough
+ * to be divided among threads.
+ */
+static void test_hashSetAlgebra(void) {
+	enum { KEY_COUNT = 300000 };
+	GraphNodeVertex* vertices = (GraphNodeVertex*)calloc(KEY_COUNT, sizeof(GraphNodeVertex));
+	HashSet* twos = createHashSet();
+	HashSet* threes = createHashSetWithCapacity(KEY_COUNT / 3 + 1);
+	for (int i = 0; i < KEY_COUNT; i++) {
+		if (isMultipleOf2(i)) {
+			addHashSetKey(twos, &vertices[i]);
+		}
+		if (isMultipleOf3(i)) {
+			addHashSetKey(threes, &vertices[i]);
+		}
+	}
+
+	for (int order = 0; order < 2; order++) {
+		HashSet* a = (order == 0) ? twos : threes;
+		HashSet* b = (order == 0) ? threes : twos;
+		HashSet* u = createHashSetUnion(a, b);
+		CU_ASSERT_EQUAL(countHashSetMismatches(u, vertices, KEY_COUNT, isMultipleOf2Or3), 0);
+		HashSet* n = createHashSetIntersection(a, b);
+		CU_ASSERT_EQUAL(countHashSetMismatches(n, vertices, KEY_COUNT, isMultipleOf6), 0);
+		CU_ASSERT_EQUAL(getHashSetIntersectionSize(a, b), getHashSetSize(n));
+		CU_ASSERT_TRUE(hasCommonHashSetKey(a, b));
+		HashSet* d = createHashSetDifference(a, b);
+		CU_ASSERT_EQUAL(countHashSetMismatches(d, vertices, KEY_COUNT,
+			(order == 0) ? isMultipleOf2Not3 : isMultipleOf3Not2), 0);
+		CU_ASSERT_FALSE(hasCommonHashSetKey(d, b));
+		CU_ASSERT_TRUE(containsAllHashSetKeys(a, n));
+		CU_ASSERT_TRUE(containsAllHashSetKeys(u, a));
+		CU_ASSERT_FALSE(containsAllHashSetKeys(n, a));
+		CU_ASSERT_FALSE(containsAllHashSetKeys(a, b));
+
+		// destructive versions give the same results
+		HashSet* c = createHashSetCopy(a);
+		CU_ASSERT_TRUE(retainAllHashSetKeys(c, b));
+		CU_ASSERT_EQUAL(countHashSetMismatches(c, vertices, KEY_COUNT, isMultipleOf6), 0);
+		CU_ASSERT_FALSE(retainAllHashSetKeys(c, b));
+		CU_ASSERT_TRUE(addAllHashSetKeys(c, a));
+		CU_ASSERT_TRUE(addAllHashSetKeys(c, b));
+		CU_ASSERT_EQUAL(countHashSetMismatches(c, vertices, KEY_COUNT, isMultipleOf2Or3), 0);
+		CU_ASSERT_TRUE(removeAllHashSetKeys(c, b));
+		CU_ASSERT_EQUAL(countHashSetMismatches(c, vertices, KEY_COUNT,
+			(order == 0) ? isMultipleOf2Not3 : isMultipleOf3Not2), 0);
+		CU_ASSERT_TRUE(removeAllHashSetKeys(c, u));
+		CU_ASSERT_TRUE(isHashSetEmpty(c));
+
+		freeHashSet(c);
+		freeHashSet(d);
+		freeHashSet(n);
+		freeHashSet(u);
+	}
+
+	freeHashSet(threes);
+	freeHashSet(twos);
+	free(vertices);
+}
+
+/**
+ * Tests the BloomFilter of a HashSet and a HashMap: lookups give the
+ * same results as without the filter through growth, removal and bulk
+ * operations, and most lookups of absent keys are answered by the filter.
+ */
+static void test_bloomFilter(void) {
+	enum { KEY_COUNT = 100000 };
+	GraphNodeVertex* vertices = (GraphNodeVertex*)calloc(KEY_COUNT, sizeof(GraphNodeVertex));
+	BloomFilterStats stats;
+
+	// the filter is built from the keys already in the set
+	HashSet* set = createHashSet();
+	for (int i = 0; i < KEY_COUNT / 2; i += 2) {
+		addHashSetKey(set, &vertices[i]);
+	}
+	enableHashSetFilter(set);
+	for (int i = KEY_COUNT / 2; i < KEY_COUNT; i += 2) {
+		addHashSetKey(set, &vertices[i]);
+	}
+	CU_ASSERT_EQUAL(countHashSetMismatches(set, vertices, KEY_COUNT, isMultipleOf2), 0);
+	getBloomFilterStats(set->filter, &stats);
+	CU_ASSERT_EQUAL(stats.queries, KEY_COUNT);
+	CU_ASSERT_EQUAL(stats.negatives + stats.falsePositives, KEY_COUNT / 2);
+	CU_ASSERT_TRUE(getBloomFilterFalsePositiveRate(set->filter) < 0.1);
+
+	// removed keys leave stale bits until the filter is rebuilt
+	int mismatches = 0;
+	for (int i = 0; i < KEY_COUNT; i += 6) {
+		mismatches += !removeHashSetKey(set, &vertices[i]);
+		mismatches += removeHashSetKey(set, &vertices[i+1]);
+	}
+	CU_ASSERT_EQUAL(mismatches, 0);
+	CU_ASSERT_EQUAL(countHashSetMismatches(set, vertices, KEY_COUNT, isMultipleOf2Not3), 0);
+	CU_ASSERT_TRUE(set->filter->staleCount * 2 <= set->filter->keyCount);
+
+	// bulk operations keep the filter
+	HashSet* threes = createHashSet();
+	for (int i = 0; i < KEY_COUNT; i += 3) {
+		addHashSetKey(threes, &vertices[i]);
+	}
+	enableHashSetFilter(threes);
+	HashSet* copy = createHashSetCopy(threes);
+	CU_ASSERT_PTR_NULL(copy->filter);
+	freeHashSet(copy);
+	CU_ASSERT_TRUE(addAllHashSetKeys(set, threes));
+	CU_ASSERT_EQUAL(countHashSetMismatches(set, vertices, KEY_COUNT, isMultipleOf2Or3), 0);
+	CU_ASSERT_TRUE(retainAllHashSetKeys(set, threes));
+	CU_ASSERT_EQUAL(countHashSetMismatches(set, vertices, KEY_COUNT, isMultipleOf3), 0);
+	CU_ASSERT_EQUAL(getHashSetIntersectionSize(threes, set), KEY_COUNT / 3 + 1);
+	clearHashSet(set);
+	CU_ASSERT_FALSE(containsHashSetKey(set, &vertices[0]));
+	disableHashSetFilter(set);
+	CU_ASSERT_PTR_NULL(set->filter);
+	freeHashSet(threes);
+	freeHashSet(set);
+
+	// a map answers the same with and without its filter
+	HashMap* map = createHashMap();
+	MapValue value = { "value" };
+	enableHashMapFilter(map);
+	for (int i = 0; i < KEY_COUNT; i += 4) {
+		putHashMapEntry(map, &vertices[i], &value);
+	}
+	for (int i = 0; i < KEY_COUNT; i++) {
+		mismatches += (containsHashMapKey(map, &vertices[i]) != (i % 4 == 0));
+	}
+	CU_ASSERT_EQUAL(mismatches, 0);
+	getBloomFilterStats(map->filter, &stats);
+	CU_ASSERT_EQUAL(stats.queries, KEY_COUNT);
+	CU_ASSERT_EQUAL(stats.negatives + stats.falsePositives, KEY_COUNT - KEY_COUNT / 4);
+	CU_ASSERT_TRUE(getBloomFilterFalsePositiveRate(map->filter) < 0.1);
+	for (int i = 0; i < KEY_COUNT; i += 8) {
+		mismatches += (removeHashMapEntryForKey(map, &vertices[i]) != &value);
+		mismatches += (removeHashMapEntryForKey(map, &vertices[i+1]) != (MapValue*)NULL);
+	}
+	for (int i = 0; i < KEY_COUNT; i++) {
+		mismatches += (getHashMapValue(map, &vertices[i]) != ((i % 8 == 4) ? &value : (MapValue*)NULL));
+	}
+	CU_ASSERT_EQUAL(mismatches, 0);
+	CU_ASSERT_EQUAL(getHashMapSize(map), KEY_COUNT / 8);
+	clearHashMap(map);
+	CU_ASSERT_FALSE(containsHashMapKey(map, &vertices[4]));
+	freeHashMap(map);
+	free(vertices);
+}
+
+/**
+ * Tests writing a HashMap to a HashMapFile and looking up its values in
+ * the mapped file, and that invalid files are not opened.
+ */
+static void test_hashMapFile(void) {
+	enum { VERTEX_COUNT = 1000 };
+	char path[64];
+	sprintf(path, "/tmp/hash_map_file_test%ld", (long)getpid());
+	NodeGraph* graph = createErdosRenyiNodeGraph(VERTEX_COUNT, 0.0, 1);
+	MapValue values[3] = { { "zero" }, { "one" }, { (char*)NULL } };
+	HashMap* map = createHashMap();
+	for (int i = 0; i < VERTEX_COUNT; i += 2) {
+		putHashMapEntry(map, graph->vertices[i], &values[(i/2) % 3]);
+	}
+	putHashMapEntry(map, graph->vertices[1], (MapValue*)NULL);
+	CU_ASSERT_TRUE(writeHashMapFile(map, path));
+
+	HashMapFile* file = openHashMapFile(path);
+	CU_ASSERT_PTR_NOT_NULL(file);
+	if (file == (HashMapFile*)NULL) {
+		freeHashMap(map);
+		freeNodeGraph(graph);
+		return;
+	}
+	CU_ASSERT_EQUAL(getHashMapFileSize(file), getHashMapSize(map));
+	// two distinct strings are pooled once each
+	CU_ASSERT_EQUAL(file->stringsSize, strlen("zero") + strlen("one") + 2);
+	int mismatches = 0;
+	for (int i = 0; i < VERTEX_COUNT; i++) {
+		GraphNodeVertex* vertex = graph->vertices[i];
+		MapValue* value = getHashMapValue(map, vertex);
+		const char* str = getHashMapFileValue(file, vertex);
+		mismatches += (containsHashMapFileKey(file, vertex) != containsHashMapKey(map, vertex));
+		if (value == (MapValue*)NULL || value->valuestr == (char*)NULL) {
+			mismatches += (str != (const char*)NULL);
+		} else {
+			mismatches += (str == (const char*)NULL || strcmp(str, value->valuestr) != 0);
+		}
+	}
+	CU_ASSERT_EQUAL(mismatches, 0);
+	closeHashMapFile(file);
+
+	// keys must be vertices of a graph
+	GraphNodeVertex loose = { .index = -1 };
+	putHashMapEntry(map, &loose, &values[0]);
+	CU_ASSERT_FALSE(writeHashMapFile(map, path));
+
+	// a truncated or foreign file is not opened
+	CU_ASSERT_EQUAL(truncate(path, 100), 0);
+	CU_ASSERT_PTR_NULL(openHashMapFile(path));
+	unlink(path);
+	CU_ASSERT_PTR_NULL(openHashMapFile(path));
+
+	freeHashMap(map);
+	freeNodeGraph(graph);
+}
+
+/**
+ * Tests a HashMap in Robin Hood mode against one in chained mode through
+ * insert and remove churn, iteration, and probe length statistics.
+ */
+static void test_hashMapRobinHood(void) {
+	enum { KEY_COUNT = 30000, OP_COUNT = 200000 };
+	GraphNodeVertex* vertices = (GraphNodeVertex*)calloc(KEY_COUNT, sizeof(GraphNodeVertex));
+	MapValue* values = (MapValue*)calloc(KEY_COUNT, sizeof(MapValue));
+	HashMap* chained = createHashMap();
+	HashMap* robinHood = createHashMapWithMode(HASH_MAP_ROBIN_HOOD);
+	CU_ASSERT_EQUAL(robinHood->mode, HASH_MAP_ROBIN_HOOD);
+	enableHashMapFilter(robinHood);
+
+	// churn with about half of the keys present
+	unsigned long state = 46;
+	int mismatches = 0;
+	for (int op = 0; op < OP_COUNT; op++) {
+		state = state * 6364136223846793005UL + 1442695040888963407UL;
+		int k = (int)((state >> 33) % KEY_COUNT);
+		if ((state >> 20) & 1) {
+			mismatches += (putHashMapEntry(robinHood, &vertices[k], &values[k])
+						!= putHashMapEntry(chained, &vertices[k], &values[k]));
+		} else {
+			mismatches += (removeHashMapEntryForKey(robinHood, &vertices[k])
+						!= removeHashMapEntryForKey(chained, &vertices[k]));
+		}
+	}
+	CU_ASSERT_EQUAL(mismatches, 0);
+	CU_ASSERT_EQUAL(getHashMapSize(robinHood), getHashMapSize(chained));
+	for (int k = 0; k < KEY_COUNT; k++) {
+		mismatches += (getHashMapValue(robinHood, &vertices[k])
+					!= getHashMapValue(chained, &vertices[k]));
+	}
+	CU_ASSERT_EQUAL(mismatches, 0);
+
+	// forward then backward iteration returns each entry once
+	bool* seen = (bool*)calloc(KEY_COUNT, sizeof(bool));
+	HashMapIterator* itr = createHashMapIterator(robinHood);
+	int count = 0;
+	for (MapEntry* entry; (entry = getNextHashMapEntry(itr)) != (MapEntry*)NULL; count++) {
+		int k = (int)(entry->key - vertices);
+		mismatches += (seen[k] || entry->value != &values[k]);
+		seen[k] = true;
+	}
+	CU_ASSERT_EQUAL(count, getHashMapSize(chained));
+	for (MapEntry* entry; (entry = getPrevHashMapEntry(itr)) != (MapEntry*)NULL; count--) {
+		mismatches += !seen[entry->key - vertices];
+		seen[entry->key - vertices] = false;
+	}
+	CU_ASSERT_EQUAL(count, 0);
+	CU_ASSERT_EQUAL(mismatches, 0);
+	freeHashMapIterator(itr);
+
+	// probe lengths stay short near the 0.9 load factor
+	// 29000 keys fill 32768 slots to 0.885
+	clearHashMap(robinHood);
+	int fullSize = 29000;
+	for (int k = 0; k < fullSize; k++) {
+		putHashMapEntry(robinHood, &vertices[k], &values[k]);
+	}
+	HashMapProbeStats stats;
+	getHashMapProbeStats(robinHood, &stats);
+	int histogramCount = 0;
+	for (int i = 0; i < HASH_MAP_PROBE_HISTOGRAM; i++) {
+		histogramCount += stats.histogram[i];
+	}
+	CU_ASSERT_EQUAL(robinHood->capacity, 32768);
+	CU_ASSERT_EQUAL(histogramCount, fullSize);
+	CU_ASSERT_TRUE(stats.histogram[0] > 0);
+	CU_ASSERT_TRUE(stats.meanProbeLength >= 1.0 && stats.meanProbeLength < 6.0);
+	CU_ASSERT_TRUE(stats.maxProbeLength < 64);
+	getHashMapProbeStats(chained, &stats);
+	CU_ASSERT_TRUE(stats.meanProbeLength >= 1.0 && stats.meanProbeLength < 2.0);
+
+	freeHashMap(robinHood);
+	freeHashMap(chained);
+	free(seen);
+	free(values);
+	free(vertices);
+}
+
+/**
+ * Tests the memory accounting of HashMap, and that its table shrinks
+ * after removals and clearing, in both modes.
+ */
+static void test_hashMapMemory(void) {
+	enum { KEY_COUNT = 100000 };
+	GraphNodeVertex* vertices = (GraphNodeVertex*)calloc(KEY_COUNT, sizeof(GraphNodeVertex));
+	MapValue value = { "value" };
+	for (int mode = HASH_MAP_CHAINED; mode <= HASH_MAP_ROBIN_HOOD; mode++) {
+		HashMap* map = createHashMapWithMode((HashMapMode)mode);
+		HashMapMemoryStats empty, peak, stats;
+		getHashMapMemoryStats(map, &empty);
+		for (int i = 0; i < KEY_COUNT; i++) {
+			putHashMapEntry(map, &vertices[i], &value);
+		}
+		getHashMapMemoryStats(map, &peak);
+		CU_ASSERT_TRUE(peak.tableBytes > empty.tableBytes);
+		CU_ASSERT_EQUAL(peak.entryBytes,
+			(mode == HASH_MAP_CHAINED) ? KEY_COUNT * sizeof(HashChainEntry) : 0);
+		CU_ASSERT_EQUAL(peak.totalBytes,
+			peak.tableBytes + peak.entryBytes + peak.filterBytes + peak.overheadBytes);
+		int peakCapacity = map->capacity;
+
+		// removing half of the entries does not shrink the table
+		for (int i = 0; i < KEY_COUNT / 2; i++) {
+			removeHashMapEntryForKey(map, &vertices[i]);
+		}
+		CU_ASSERT_EQUAL(map->capacity, peakCapacity);
+		CU_ASSERT_TRUE(shrinkHashMapToFit(map) > 0);
+		CU_ASSERT_EQUAL(map->capacity, peakCapacity / 2);
+		CU_ASSERT_EQUAL(shrinkHashMapToFit(map), 0);
+
+		// removing almost all of them shrinks the table as they go
+		for (int i = KEY_COUNT / 2; i < KEY_COUNT - 100; i++) {
+			removeHashMapEntryForKey(map, &vertices[i]);
+		}
+		CU_ASSERT_TRUE(map->capacity <= 1024);
+		int mismatches = 0;
+		for (int i = 0; i < KEY_COUNT; i++) {
+			mismatches += (containsHashMapKey(map, &vertices[i]) != (i >= KEY_COUNT - 100));
+		}
+		CU_ASSERT_EQUAL(mismatches, 0);
+
+		// a cleared map has its initial table
+		enableHashMapFilter(map);
+		getHashMapMemoryStats(map, &stats);
+		CU_ASSERT_TRUE(stats.filterBytes > 0);
+		clearHashMap(map);
+		getHashMapMemoryStats(map, &stats);
+		CU_ASSERT_EQUAL(stats.tableBytes, empty.tableBytes);
+		CU_ASSERT_EQUAL(stats.entryBytes, 0);
+		freeHashMap(map);
+	}
+	free(vertices);
+}
+
+/**
+ * Tests that batches from a prefetching HashMapIterator return the same
+ * entries in the same order as single steps, and the scans that use
+ * them, in both modes.
+ */
+static void test_getNextHashMapEntries(void) {
+	enum { KEY_COUNT = 10000, BATCH = 7 };
+	GraphNodeVertex* vertices = (GraphNodeVertex*)calloc(KEY_COUNT, sizeof(GraphNodeVertex));
+	MapValue* values = (MapValue*)calloc(KEY_COUNT, sizeof(MapValue));
+	char (*names)[16] = (char (*)[16])calloc(KEY_COUNT, 16);
+	MapEntry** expected = (MapEntry**)calloc(KEY_COUNT, sizeof(MapEntry*));
+	for (int i = 0; i < KEY_COUNT; i++) {
+		sprintf(names[i], "v%d", i);
+		values[i].valuestr = names[i];
+	}
+	for (int mode = HASH_MAP_CHAINED; mode <= HASH_MAP_ROBIN_HOOD; mode++) {
+		HashMap* map = createHashMapWithMode((HashMapMode)mode);
+		MapEntry* batch[BATCH];
+		HashMapIterator* itr = createPrefetchingHashMapIterator(map);
+		CU_ASSERT_EQUAL(getNextHashMapEntries(itr, batch, BATCH), 0);
+		freeHashMapIterator(itr);
+		for (int i = 0; i < KEY_COUNT; i++) {
+			putHashMapEntry(map, &vertices[i], &values[i]);
+		}
+
+		itr = createHashMapIterator(map);
+		for (int i = 0; i < KEY_COUNT; i++) {
+			expected[i] = getNextHashMapEntry(itr);
+		}
+		freeHashMapIterator(itr);
+
+		// one step first, then batches to the end
+		itr = createPrefetchingHashMapIterator(map);
+		int mismatches = (getNextHashMapEntry(itr) != expected[0]);
+		int count = 1;
+		for (int n; (n = getNextHashMapEntries(itr, batch, BATCH)) > 0; ) {
+			for (int i = 0; i < n && count < KEY_COUNT; i++) {
+				mismatches += (batch[i] != expected[count++]);
+			}
+		}
+		CU_ASSERT_EQUAL(mismatches, 0);
+		CU_ASSERT_EQUAL(count, KEY_COUNT);
+		CU_ASSERT_EQUAL(getHashMapIteratorCount(itr), KEY_COUNT);
+		CU_ASSERT_FALSE(hasNextHashMapEntry(itr));
+		CU_ASSERT_PTR_EQUAL(getPrevHashMapEntry(itr), expected[KEY_COUNT-1]);
+		freeHashMapIterator(itr);
+
+		// scans of the whole map
+		MapValue absent = { "absent" };
+		CU_ASSERT_TRUE(containsHashMapValue(map, &values[KEY_COUNT-1]));
+		CU_ASSERT_FALSE(containsHashMapValue(map, &absent));
+		MapEntry** entries = getHashMapEntries(map);
+		MapKey** keys = getHashMapKeys(map);
+		MapValue** valueSet = getHashMapValues(map);
+		mismatches = 0;
+		for (int i = 0; i < KEY_COUNT; i++) {
+			mismatches += (entries[i] != expected[i]) + (*keys[i] != expected[i]->key)
+						+ (valueSet[i] != expected[i]->value);
+		}
+		CU_ASSERT_EQUAL(mismatches, 0);
+		CU_ASSERT_PTR_NULL(entries[KEY_COUNT]);
+		CU_ASSERT_PTR_NULL(keys[KEY_COUNT]);
+		CU_ASSERT_PTR_NULL(valueSet[KEY_COUNT]);
+		free(valueSet);
+		free(keys);
+		free(entries);
+		freeHashMap(map);
+	}
+	free(expected);
+	free(names);
+	free(values);
+	free(vertices);
+}
+
+/**
+ * Tests that the ValueIndex of a HashMap answers value lookups as a
+ * scan of the entries does, as entries are added, replaced and removed,
+ * in both modes.
+ */
+static void test_hashMapValueIndex(void) {
+	enum { KEY_COUNT = 5000, VALUE_COUNT = 50 };
+	GraphNodeVertex* vertices = (GraphNodeVertex*)calloc(KEY_COUNT, sizeof(GraphNodeVertex));
+	char names[VALUE_COUNT][16];
+	MapValue values[VALUE_COUNT];
+	MapValue copies[VALUE_COUNT];		// different values with equal strings
+	for (int v = 0; v < VALUE_COUNT; v++) {
+		sprintf(names[v], "value%d", v);
+		values[v].valuestr = names[v];
+		copies[v].valuestr = names[v];
+	}
+	MapValue absent = { "absent" };
+	for (int mode = HASH_MAP_CHAINED; mode <= HASH_MAP_ROBIN_HOOD; mode++) {
+		HashMap* map = createHashMapWithMode((HashMapMode)mode);
+		for (int i = 0; i < KEY_COUNT / 2; i++) {
+			putHashMapEntry(map, &vertices[i], &values[i % VALUE_COUNT]);
+		}
+		enableHashMapValueIndex(map);
+		for (int i = KEY_COUNT / 2; i < KEY_COUNT; i++) {
+			putHashMapEntry(map, &vertices[i], &copies[i % VALUE_COUNT]);
+		}
+
+		// move the keys of value 0 to value 1, and remove the keys of value 2
+		for (int i = 0; i < KEY_COUNT; i += VALUE_COUNT) {
+			putHashMapEntry(map, &vertices[i], &values[1]);
+			removeHashMapEntryForKey(map, &vertices[i+2]);
+		}
+		CU_ASSERT_FALSE(containsHashMapValue(map, &values[0]));
+		CU_ASSERT_FALSE(containsHashMapValue(map, &copies[2]));
+		CU_ASSERT_FALSE(containsHashMapValue(map, &absent));
+		CU_ASSERT_TRUE(containsHashMapValue(map, &copies[1]));
+		HashMapMemoryStats stats;
+		getHashMapMemoryStats(map, &stats);
+		CU_ASSERT_TRUE(stats.indexBytes > 0);
+		CU_ASSERT_EQUAL(stats.totalBytes, stats.tableBytes + stats.entryBytes
+						+ stats.filterBytes + stats.indexBytes + stats.overheadBytes);
+
+		// the index gives the same keys as a scan
+		HashSet* indexed[VALUE_COUNT];
+		for (int v = 0; v < VALUE_COUNT; v++) {
+			indexed[v] = getHashMapKeysForValue(map, &values[v]);
+		}
+		disableHashMapValueIndex(map);
+		int mismatches = 0;
+		for (int v = 0; v < VALUE_COUNT; v++) {
+			HashSet* scanned = getHashMapKeysForValue(map, &values[v]);
+			int expected = (v == 0 || v == 2) ? 0 : (v == 1) ? 2 * KEY_COUNT / VALUE_COUNT
+						 : KEY_COUNT / VALUE_COUNT;
+			mismatches += (getHashSetSize(indexed[v]) != expected)
+						+ (getHashSetSize(scanned) != expected)
+						+ !containsAllHashSetKeys(indexed[v], scanned);
+			freeHashSet(scanned);
+			freeHashSet(indexed[v]);
+		}
+		CU_ASSERT_EQUAL(mismatches, 0);
+
+		// a cleared map has no values
+		enableHashMapValueIndex(map);
+		CU_ASSERT_TRUE(containsHashMapValue(map, &values[3]));
+		clearHashMap(map);
+		CU_ASSERT_FALSE(containsHashMapValue(map, &values[3]));
+		putHashMapEntry(map, &vertices[0], &values[3]);
+		CU_ASSERT_TRUE(containsHashMapValue(map, &copies[3]));
+		freeHashMap(map);
+	}
+	free(vertices);
+}
+
 /**
  * Test all the functions for this application.
  *
@@ -119,6 +1911,31 @@ static int test_all(void) {
 
 	// add the tests to the suite
 	CU_add_test(pSuite, "test_getNodeGraphPaths", test_getNodeGraphPaths);
+	CU_add_test(pSuite, "test_getNodeGraphTopologicalOrder", test_getNodeGraphTopologicalOrder);
+	CU_add_test(pSuite, "test_getNodeGraphDAGPaths", test_getNodeGraphDAGPaths);
+	CU_add_test(pSuite, "test_reorderNodeGraph", test_reorderNodeGraph);
+	CU_add_test(pSuite, "test_createNodeGraphWithArena", test_createNodeGraphWithArena);
+	CU_add_test(pSuite, "test_graphNodeVertexEdgeIndex", test_graphNodeVertexEdgeIndex);
+	CU_add_test(pSuite, "test_commitNodeGraphBatch", test_commitNodeGraphBatch);
+	CU_add_test(pSuite, "test_publishNodeGraphSnapshot", test_publishNodeGraphSnapshot);
+	CU_add_test(pSuite, "test_createGeneratedNodeGraphs", test_createGeneratedNodeGraphs);
+	CU_add_test(pSuite, "test_getNodeGraphPathsWithStats", test_getNodeGraphPathsWithStats);
+	CU_add_test(pSuite, "test_getNodeGraphPathSet", test_getNodeGraphPathSet);
+	CU_add_test(pSuite, "test_getNextNodeGraphDFSEvent", test_getNextNodeGraphDFSEvent);
+	CU_add_test(pSuite, "test_getNodeGraphPageRank", test_getNodeGraphPageRank);
+	CU_add_test(pSuite, "test_getNodeGraphWeakComponents", test_getNodeGraphWeakComponents);
+	CU_add_test(pSuite, "test_getNodeGraphWalks", test_getNodeGraphWalks);
+	CU_add_test(pSuite, "test_getCachedNodeGraphPaths", test_getCachedNodeGraphPaths);
+	CU_add_test(pSuite, "test_expandNodeGraphNeighborhood", test_expandNodeGraphNeighborhood);
+	CU_add_test(pSuite, "test_defineHashMap", test_defineHashMap);
+	CU_add_test(pSuite, "test_hashSet", test_hashSet);
+	CU_add_test(pSuite, "test_hashSetAlgebra", test_hashSetAlgebra);
+	CU_add_test(pSuite, "test_bloomFilter", test_bloomFilter);
+	CU_add_test(pSuite, "test_hashMapFile", test_hashMapFile);
+	CU_add_test(pSuite, "test_hashMapRobinHood", test_hashMapRobinHood);
+	CU_add_test(pSuite, "test_hashMapMemory", test_hashMapMemory);
+	CU_add_test(pSuite, "test_getNextHashMapEntries", test_getNextHashMapEntries);
+	CU_add_test(pSuite, "test_hashMapValueIndex", test_hashMapValueIndex);
 
 	// run all test suites using the basic interface
 	CU_basic_set_mode(CU_BRM_VERBOSE);
@@ -0,0 +1,266 @@
+/*
+ * node_graph_rank.c
+ *
+ * This file provides the implementations of PageRank and personalized
+ * PageRank for a NodeGraph. Each iteration pulls rank along the in edges
+ * of every vertex in a transposed CSR view, reading the current rank
+ * array and writing the next one, and the vertices are divided among
+ * threads in ranges with about the same number of edges.
+ */
+
+#define _POSIX_C_SOURCE 200112L	// pthread_barrier_t
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "node_graph_rank.h"
+
+/**
+ * Default PageRank options: damping 0.85, tolerance 1e-9, at most 100
+ * iterations, one thread per processor.
+ */
+const NodeGraphRankOptions NODEGRAPH_RANK_DEFAULTS = {0.85, 1e-9, 100, 0};
+
+/**
+ * State shared by the PageRank threads
+ */
+typedef struct {
+	const NodeGraphCSR* csr;		// transposed view of the graph
+	const NodeGraphRankOptions* options;
+	const double* jump;				// normalized personalization, or NULL if uniform
+	double* ranks[2];				// current and next rank arrays
+	double* contrib;				// rank / out degree by vertex
+	double* danglingSums;			// rank of vertices without edges by thread
+	double* changeSums;				// L1 change of ranks by thread
+	int* bounds;					// vertex range bounds by thread
+	int threadCount;
+	int iterations;					// iterations performed
+	int result;						// index of rank array with the result
+	pthread_barrier_t barrier;
+} NodeGraphRankState;
+
+/**
+ * Arguments of a PageRank thread
+ */
+typedef struct {
+	NodeGraphRankState* state;
+	int thread;						// index of the thread
+} NodeGraphRankThread;
+
+/**
+ * Sums the elements of an array.
+ *
+ * @param values the array
+ * @param count the number of elements
+ * @return the sum of the elements
+ */
+static double sumNodeGraphRanks(const double* values, int count) {
+	// independent partial sums can be computed in parallel vector lanes
+	double sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+	int i = 0;
+	for ( ; i+4 <= count; i += 4) {
+		sum0 += values[i];
+		sum1 += values[i+1];
+		sum2 += values[i+2];
+		sum3 += values[i+3];
+	}
+	for ( ; i < count; i++) {
+		sum0 += values[i];
+	}
+	return (sum0 + sum1) + (sum2 + sum3);
+}
+
+/**
+ * Runs the PageRank iterations for the vertex range of one thread. All
+ * threads perform the same iterations, and meet at a barrier after each
+ * phase that reads what other threads wrote.
+ *
+ * @param arg the NodeGraphRankThread
+ * @return NULL
+ */
+static void* runNodeGraphRankThread(void* arg) {
+	NodeGraphRankState* state = ((NodeGraphRankThread*)arg)->state;
+	int thread = ((NodeGraphRankThread*)arg)->thread;
+	const NodeGraphCSR* csr = state->csr;
+	const int* outDegree = csr->outDegree;
+	int begin = state->bounds[thread];
+	int end = state->bounds[thread+1];
+	double damping = state->options->damping;
+	double uniform = 1.0 / csr->vertexCount;
+	int current = 0;
+
+	int iteration = 0;
+	while (iteration < state->options->maxIterations) {
+		iteration++;
+		const double* rank = state->ranks[current];
+		double* next = state->ranks[1-current];
+
+		// rank spread along the out edges of each vertex
+		double dangling = 0;
+		for (int v = begin; v < end; v++) {
+			if (outDegree[v] > 0) {
+				state->contrib[v] = rank[v] / outDegree[v];
+			} else {
+				state->contrib[v] = 0;
+				dangling += rank[v];
+			}
+		}
+		state->danglingSums[thread] = dangling;
+		pthread_barrier_wait(&state->barrier);
+
+		// every thread sums the partial sums in the same order
+		dangling = sumNodeGraphRanks(state->danglingSums, state->threadCount);
+		double jumpRank = damping * dangling + (1 - damping);
+		multiplyNodeGraphCSR(csr, state->contrib, next, begin, end);
+		double change = 0;
+		for (int v = begin; v < end; v++) {
+			double jump = (state->jump != (double*)NULL) ? state->jump[v] : uniform;
+			next[v] = damping * next[v] + jumpRank * jump;
+			change += fabs(next[v] - rank[v]);
+		}
+		state->changeSums[thread] = change;
+		pthread_barrier_wait(&state->barrier);
+
+		current = 1 - current;
+		if (sumNodeGraphRanks(state->changeSums, state->threadCount) < state->options->tolerance) {
+			break;
+		}
+	}
+
+	if (thread == 0) {
+		state->iterations = iteration;
+		state->result = current;
+	}
+	return NULL;
+}
+
+/**
+ * Computes personalized PageRank over a transposed CSR view, so that a
+ * view built once can be ranked with many personalizations. If the
+ * personalization is NULL, random jumps are uniform, which computes
+ * PageRank.
+ *
+ * @param transposed the transposed NodeGraphCSR
+ * @param options the PageRank options, or NULL for the defaults
+ * @param personalization array of non-negative weights by vertex index,
+ *   with a positive sum, or NULL for uniform weights
+ * @param rank array of ranks by vertex index (size == vertex count)
+ * @return the number of iterations performed
+ */
+int getNodeGraphCSRPageRank(const NodeGraphCSR* transposed, const NodeGraphRankOptions* options,
+		const double* personalization, double* rank) {
+	assert(transposed->transposed);
+	int n = transposed->vertexCount;
+	if (n == 0) {
+		return 0;
+	}
+	if (options == (NodeGraphRankOptions*)NULL) {
+		options = &NODEGRAPH_RANK_DEFAULTS;
+	}
+
+	NodeGraphRankState state;
+	state.csr = transposed;
+	state.options = options;
+	state.threadCount = options->threadCount;
+	if (state.threadCount <= 0) {
+		state.threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if (state.threadCount > n) {
+		state.threadCount = n;
+	}
+	if (state.threadCount < 1) {
+		state.threadCount = 1;
+	}
+
+	// normalized jump probabilities
+	double* jump = (double*)NULL;
+	if (personalization != (double*)NULL) {
+		jump = (double*)malloc(n * sizeof(double));
+		double total = sumNodeGraphRanks(personalization, n);
+		assert(total > 0);
+		for (int v = 0; v < n; v++) {
+			jump[v] = personalization[v] / total;
+		}
+	}
+	state.jump = jump;
+
+	state.ranks[0] = rank;
+	state.ranks[1] = (double*)malloc(n * sizeof(double));
+	state.contrib = (double*)malloc(n * sizeof(double));
+	state.danglingSums = (double*)malloc(state.threadCount * sizeof(double));
+	state.changeSums = (double*)malloc(state.threadCount * sizeof(double));
+	state.bounds = (int*)malloc((state.threadCount+1) * sizeof(int));
+	getNodeGraphCSRRanges(transposed, state.threadCount, state.bounds);
+	for (int v = 0; v < n; v++) {
+		rank[v] = (jump != (double*)NULL) ? jump[v] : 1.0 / n;
+	}
+	state.iterations = 0;
+	state.result = 0;
+	pthread_barrier_init(&state.barrier, NULL, state.threadCount);
+
+	// the calling thread runs the first range
+	NodeGraphRankThread* args =
+		(NodeGraphRankThread*)malloc(state.threadCount * sizeof(NodeGraphRankThread));
+	pthread_t* threads = (pthread_t*)malloc(state.threadCount * sizeof(pthread_t));
+	for (int t = 0; t < state.threadCount; t++) {
+		args[t] = (NodeGraphRankThread){&state, t};
+	}
+	for (int t = 1; t < state.threadCount; t++) {
+		pthread_create(&threads[t], NULL, runNodeGraphRankThread, &args[t]);
+	}
+	runNodeGraphRankThread(&args[0]);
+	for (int t = 1; t < state.threadCount; t++) {
+		pthread_join(threads[t], NULL);
+	}
+
+	if (state.result != 0) {
+		memcpy(rank, state.ranks[1], n * sizeof(double));
+	}
+
+	pthread_barrier_destroy(&state.barrier);
+	free(threads);
+	free(args);
+	free(state.bounds);
+	free(state.changeSums);
+	free(state.danglingSums);
+	free(state.contrib);
+	free(state.ranks[1]);
+	free(jump);
+	return state.iterations;
+}
+
+/**
+ * Computes the PageRank of each vertex of the graph. The ranks sum to 1.
+ * The rank of vertices without edges is redistributed to all vertices.
+ *
+ * @param graph the graph
+ * @param options the PageRank options, or NULL for the defaults
+ * @param rank array of ranks by vertex index (size == vertex count)
+ * @return the number of iterations performed
+ */
+int getNodeGraphPageRank(NodeGraph* graph, const NodeGraphRankOptions* options, double* rank) {
+	return getNodeGraphPersonalizedPageRank(graph, options, (double*)NULL, rank);
+}
+
+/**
+ * Computes the personalized PageRank of each vertex of the graph. Random
+ * jumps, and the rank of vertices without edges, go to vertices in
+ * proportion to the personalization weights. The ranks sum to 1.
+ *
+ * @param graph the graph
+ * @param options the PageRank options, or NULL for the defaults
+ * @param personalization array of non-negative weights by vertex index,
+ *   with a positive sum (size == vertex count)
+ * @param rank array of ranks by vertex index (size == vertex count)
+ * @return the number of iterations performed
+ */
+int getNodeGraphPersonalizedPageRank(NodeGraph* graph, const NodeGraphRankOptions* options,
+		const double* personalization, double* rank) {
+	NodeGraphCSR* transposed = createTransposedNodeGraphCSR(graph);
+	int iterations = getNodeGraphCSRPageRank(transposed, options, personalization, rank);
+	freeNodeGraphCSR(transposed);
+	return iterations;
+}
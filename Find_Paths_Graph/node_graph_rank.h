@@ -0,0 +1,73 @@
+/*
+ * node_graph_rank.h
+ *
+ * This file provides the structures and function declarations of
+ * PageRank and personalized PageRank for a NodeGraph, computed by
+ * repeated sparse matrix-vector products over a transposed CSR view.
+ */
+
+#ifndef NODE_GRAPH_RANK_H_
+#define NODE_GRAPH_RANK_H_
+
+#include "node_graph.h"
+#include "node_graph_csr.h"
+
+/**
+ * Options for PageRank
+ */
+typedef struct {
+	double damping;					// probability of following an edge
+	double tolerance;				// L1 change in ranks at convergence
+	int maxIterations;				// maximum number of iterations
+	int threadCount;				// number of threads, or 0 for one per processor
+} NodeGraphRankOptions;
+
+/**
+ * Default PageRank options: damping 0.85, tolerance 1e-9, at most 100
+ * iterations, one thread per processor.
+ */
+extern const NodeGraphRankOptions NODEGRAPH_RANK_DEFAULTS;
+
+/**
+ * Computes the PageRank of each vertex of the graph. The ranks sum to 1.
+ * The rank of vertices without edges is redistributed to all vertices.
+ *
+ * @param graph the graph
+ * @param options the PageRank options, or NULL for the defaults
+ * @param rank array of ranks by vertex index (size == vertex count)
+ * @return the number of iterations performed
+ */
+int getNodeGraphPageRank(NodeGraph* graph, const NodeGraphRankOptions* options, double* rank);
+
+/**
+ * Computes the personalized PageRank of each vertex of the graph. Random
+ * jumps, and the rank of vertices without edges, go to vertices in
+ * proportion to the personalization weights. The ranks sum to 1.
+ *
+ * @param graph the graph
+ * @param options the PageRank options, or NULL for the defaults
+ * @param personalization array of non-negative weights by vertex index,
+ *   with a positive sum (size == vertex count)
+ * @param rank array of ranks by vertex index (size == vertex count)
+ * @return the number of iterations performed
+ */
+int getNodeGraphPersonalizedPageRank(NodeGraph* graph, const NodeGraphRankOptions* options,
+		const double* personalization, double* rank);
+
+/**
+ * Computes personalized PageRank over a transposed CSR view, so that a
+ * view built once can be ranked with many personalizations. If the
+ * personalization is NULL, random jumps are uniform, which computes
+ * PageRank.
+ *
+ * @param transposed the transposed NodeGraphCSR
+ * @param options the PageRank options, or NULL for the defaults
+ * @param personalization array of non-negative weights by vertex index,
+ *   with a positive sum, or NULL for uniform weights
+ * @param rank array of ranks by vertex index (size == vertex count)
+ * @return the number of iterations performed
+ */
+int getNodeGraphCSRPageRank(const NodeGraphCSR* transposed, const NodeGraphRankOptions* options,
+		const double* personalization, double* rank);
+
+#endif /* NODE_GRAPH_RANK_H_ */
@@ -0,0 +1,303 @@
+/*
+ * node_graph_reorder.c
+ *
+ * This file provides the implementations of functions that renumber the
+ * node vertices of a NodeGraph in an order that improves the memory
+ * locality of traversals.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "node_graph_reorder.h"
+#include "graph_arena.h"
+#include "graph_node_vertex_impl.h"
+
+/**
+ * Computes the in+out degree of each vertex in the graph.
+ *
+ * @param graph the graph
+ * @param degree array of degree by vertex index (size == vertex count)
+ */
+static void getVertexDegrees(NodeGraph* graph, int* degree) {
+	memset(degree, 0, graph->vertexCount * sizeof(int));
+	for (int ig = 0; ig < graph->vertexCount; ig++) {
+		GraphNodeVertex* vtx = graph->vertices[ig];
+		degree[ig] += vtx->edgeCount;
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			degree[vtx->edgeTo[iv].vertex->index]++;
+		}
+	}
+}
+
+/**
+ * Sorts vertex indexes by degree with a stable counting sort.
+ *
+ * @param n the number of vertices
+ * @param degree array of degree by vertex index
+ * @param sorted array of vertex indexes sorted by degree
+ * @param descending true for decreasing order, false for increasing order
+ */
+static void sortVerticesByDegree(int n, const int* degree, int* sorted, bool descending) {
+	int maxDegree = 0;
+	for (int i = 0; i < n; i++) {
+		if (degree[i] > maxDegree) {
+			maxDegree = degree[i];
+		}
+	}
+	int* start = (int*)calloc(maxDegree+2, sizeof(int));
+	for (int i = 0; i < n; i++) {
+		start[(descending ? maxDegree-degree[i] : degree[i]) + 1]++;
+	}
+	for (int d = 1; d <= maxDegree+1; d++) {
+		start[d] += start[d-1];
+	}
+	for (int i = 0; i < n; i++) {
+		sorted[start[descending ? maxDegree-degree[i] : degree[i]]++] = i;
+	}
+	free(start);
+}
+
+/**
+ * Computes breadth-first order along edges, starting from the roots
+ * of the graph, then from any vertices that remain unvisited.
+ *
+ * @param graph the graph
+ * @param newOrder array of current vertex indexes in the new order
+ */
+static void getBFSOrder(NodeGraph* graph, int* newOrder) {
+	int n = graph->vertexCount;
+	bool* visited = (bool*)calloc(n, sizeof(bool));
+	bool* hasInEdge = (bool*)calloc(n, sizeof(bool));
+	for (int ig = 0; ig < n; ig++) {
+		GraphNodeVertex* vtx = graph->vertices[ig];
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			hasInEdge[vtx->edgeTo[iv].vertex->index] = true;
+		}
+	}
+
+	// newOrder is also the BFS queue
+	int tail = 0;
+	for (int pass = 0; pass < 2; pass++) {
+		for (int start = 0; start < n; start++) {
+			if (visited[start] || (pass == 0 && hasInEdge[start])) {
+				continue;
+			}
+			int head = tail;
+			visited[start] = true;
+			newOrder[tail++] = start;
+			for ( ; head < tail; head++) {
+				GraphNodeVertex* vtx = graph->vertices[newOrder[head]];
+				for (int iv = 0; iv < vtx->edgeCount; iv++) {
+					int to = vtx->edgeTo[iv].vertex->index;
+					if (!visited[to]) {
+						visited[to] = true;
+						newOrder[tail++] = to;
+					}
+				}
+			}
+		}
+	}
+	free(hasInEdge);
+	free(visited);
+}
+
+/**
+ * Computes reverse Cuthill-McKee order, treating edges as undirected.
+ * Each neighbor list is built in order of increasing degree, so the
+ * breadth-first pass visits lower degree neighbors first.
+ *
+ * @param graph the graph
+ * @param newOrder array of current vertex indexes in the new order
+ */
+static void getRCMOrder(NodeGraph* graph, int* newOrder) {
+	int n = graph->vertexCount;
+	int* degree = (int*)malloc(n * sizeof(int));
+	getVertexDegrees(graph, degree);
+	int* byDegree = (int*)malloc(n * sizeof(int));
+	sortVerticesByDegree(n, degree, byDegree, false);
+
+	// offsets of undirected neighbor lists, and of in-neighbor lists
+	int* adjStart = (int*)malloc((n+1) * sizeof(int));
+	int* inStart = (int*)calloc(n+1, sizeof(int));
+	adjStart[0] = 0;
+	for (int ig = 0; ig < n; ig++) {
+		adjStart[ig+1] = adjStart[ig] + degree[ig];
+		inStart[ig+1] = inStart[ig] + degree[ig] - graph->vertices[ig]->edgeCount;
+	}
+	int* inAdj = (int*)malloc((inStart[n]+1) * sizeof(int));
+	int* inFill = (int*)malloc(n * sizeof(int));
+	memcpy(inFill, inStart, n * sizeof(int));
+	for (int ig = 0; ig < n; ig++) {
+		GraphNodeVertex* vtx = graph->vertices[ig];
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			int to = vtx->edgeTo[iv].vertex->index;
+			inAdj[inFill[to]++] = ig;
+		}
+	}
+
+	// append each vertex to the lists of its neighbors in degree order
+	int* adj = (int*)malloc((adjStart[n]+1) * sizeof(int));
+	int* adjFill = inFill;
+	memcpy(adjFill, adjStart, n * sizeof(int));
+	for (int i = 0; i < n; i++) {
+		int u = byDegree[i];
+		GraphNodeVertex* vtx = graph->vertices[u];
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			int to = vtx->edgeTo[iv].vertex->index;
+			adj[adjFill[to]++] = u;
+		}
+		for (int k = inStart[u]; k < inStart[u+1]; k++) {
+			adj[adjFill[inAdj[k]]++] = u;
+		}
+	}
+
+	// Cuthill-McKee order from lowest degree unvisited vertices
+	bool* visited = (bool*)calloc(n, sizeof(bool));
+	int tail = 0;
+	for (int i = 0; i < n; i++) {
+		int start = byDegree[i];
+		if (visited[start]) {
+			continue;
+		}
+		int head = tail;
+		visited[start] = true;
+		newOrder[tail++] = start;
+		for ( ; head < tail; head++) {
+			int u = newOrder[head];
+			for (int k = adjStart[u]; k < adjStart[u+1]; k++) {
+				if (!visited[adj[k]]) {
+					visited[adj[k]] = true;
+					newOrder[tail++] = adj[k];
+				}
+			}
+		}
+	}
+
+	// reverse the order
+	for (int i = 0, j = n-1; i < j; i++, j--) {
+		int tmp = newOrder[i];
+		newOrder[i] = newOrder[j];
+		newOrder[j] = tmp;
+	}
+
+	free(visited);
+	free(adj);
+	free(inFill);
+	free(inAdj);
+	free(inStart);
+	free(adjStart);
+	free(byDegree);
+	free(degree);
+}
+
+/**
+ * Computes an order with vertices sorted by decreasing in+out degree,
+ * so that frequently accessed hub vertices share cache lines.
+ *
+ * @param graph the graph
+ * @param newOrder array of current vertex indexes in the new order
+ */
+static void getDegreeOrder(NodeGraph* graph, int* newOrder) {
+	int* degree = (int*)malloc(graph->vertexCount * sizeof(int));
+	getVertexDegrees(graph, degree);
+	sortVerticesByDegree(graph->vertexCount, degree, newOrder, true);
+	free(degree);
+}
+
+/**
+ * Computes a new order for the node vertices of the graph. The result
+ * array receives the current index of the vertex for each position in
+ * the new order.
+ *
+ * @param graph the graph
+ * @param order the order to compute
+ * @param newOrder array of current vertex indexes in the new order
+ *   (size of array == vertex count)
+ */
+void getNodeGraphOrder(NodeGraph* graph, NodeGraphOrder order, int* newOrder) {
+	switch (order) {
+	case NODEGRAPH_ORDER_BFS:
+		getBFSOrder(graph, newOrder);
+		break;
+	case NODEGRAPH_ORDER_RCM:
+		getRCMOrder(graph, newOrder);
+		break;
+	case NODEGRAPH_ORDER_DEGREE:
+		getDegreeOrder(graph, newOrder);
+		break;
+	}
+}
+
+/**
+ * Renumbers the node vertices of the graph in the specified order, and
+ * relocates the node vertices and their edge arrays into the graph arena
+ * in that order, so that traversals access memory sequentially.
+ *
+ * All node vertices are moved, so GraphNodeVertex pointers held by the
+ * caller are no longer valid. If newIndex is not NULL, it receives the
+ * new index of each vertex by its old index, and the relocated vertices
+ * can be found in the graph vertex array by their new index.
+ *
+ * @param graph the graph
+ * @param order the order of the relocated vertices
+ * @param newIndex array of new indexes by old index, or NULL
+ *   (size of array == vertex count)
+ */
+void reorderNodeGraph(NodeGraph* graph, NodeGraphOrder order, int* newIndex) {
+	int n = graph->vertexCount;
+	int* newOrder = (int*)malloc(n * sizeof(int));
+	getNodeGraphOrder(graph, order, newOrder);
+
+	int* indexMap = (newIndex != (int*)NULL) ? newIndex : (int*)malloc(n * sizeof(int));
+	size_t edgeTotal = 0;
+	for (int i = 0; i < n; i++) {
+		indexMap[newOrder[i]] = i;
+		edgeTotal += graph->vertices[i]->edgeCount;
+	}
+
+	// vertex structs are contiguous, followed by edge arrays in the same order
+	GraphArena* arena = createGraphArena(0);
+	GraphNodeVertex* vertexBlock =
+		(GraphNodeVertex*)allocGraphArena(arena, n * sizeof(GraphNodeVertex));
+	GraphNodeEdge* edgeBlock =
+		(GraphNodeEdge*)allocGraphArena(arena, edgeTotal * sizeof(GraphNodeEdge));
+	for (int i = 0; i < n; i++) {
+		GraphNodeVertex* oldVertex = graph->vertices[newOrder[i]];
+		GraphNodeVertex* vertex = &vertexBlock[i];
+		*vertex = *oldVertex;
+		vertex->index = i;
+		vertex->edgeTo = edgeBlock;
+		vertex->edgeCapacity = oldVertex->edgeCount;
+		for (int iv = 0; iv < oldVertex->edgeCount; iv++) {
+			vertex->edgeTo[iv].data = oldVertex->edgeTo[iv].data;
+			vertex->edgeTo[iv].vertex =
+				&vertexBlock[indexMap[oldVertex->edgeTo[iv].vertex->index]];
+		}
+		edgeBlock += oldVertex->edgeCount;
+	}
+
+	// release storage for the old vertices
+	if (graph->arena != (GraphArena*)NULL) {
+		freeGraphArena(graph->arena);
+	} else {
+		for (int ig = 0; ig < n; ig++) {
+			free(graph->vertices[ig]->edgeIndex);
+			free(graph->vertices[ig]->edgeTo);
+			free(graph->vertices[ig]);
+		}
+	}
+
+	// edge indexes hash the relocated vertex addresses
+	graph->arena = arena;
+	graph->version++;
+	for (int i = 0; i < n; i++) {
+		graph->vertices[i] = &vertexBlock[i];
+		rebuildGraphNodeEdgeIndex(graph->vertices[i]);
+	}
+
+	if (indexMap != newIndex) {
+		free(indexMap);
+	}
+	free(newOrder);
+}
@@ -0,0 +1,52 @@
+/*
+ * node_graph_reorder.h
+ *
+ * This file provides the declarations of functions that renumber the
+ * node vertices of a NodeGraph in an order that improves the memory
+ * locality of traversals.
+ */
+
+#ifndef NODE_GRAPH_REORDER_H_
+#define NODE_GRAPH_REORDER_H_
+
+#include "node_graph.h"
+
+/**
+ * The vertex orders supported by reorderNodeGraph
+ */
+typedef enum {
+	NODEGRAPH_ORDER_BFS,		// breadth-first order from each root
+	NODEGRAPH_ORDER_RCM,		// reverse Cuthill-McKee order
+	NODEGRAPH_ORDER_DEGREE		// decreasing in+out degree order
+} NodeGraphOrder;
+
+/**
+ * Computes a new order for the node vertices of the graph. The result
+ * array receives the current index of the vertex for each position in
+ * the new order.
+ *
+ * @param graph the graph
+ * @param order the order to compute
+ * @param newOrder array of current vertex indexes in the new order
+ *   (size of array == vertex count)
+ */
+void getNodeGraphOrder(NodeGraph* graph, NodeGraphOrder order, int* newOrder);
+
+/**
+ * Renumbers the node vertices of the graph in the specified order, and
+ * relocates the node vertices and their edge arrays into the graph arena
+ * in that order, so that traversals access memory sequentially.
+ *
+ * All node vertices are moved, so GraphNodeVertex pointers held by the
+ * caller are no longer valid. If newIndex is not NULL, it receives the
+ * new index of each vertex by its old index, and the relocated vertices
+ * can be found in the graph vertex array by their new index.
+ *
+ * @param graph the graph
+ * @param order the order of the relocated vertices
+ * @param newIndex array of new indexes by old index, or NULL
+ *   (size of array == vertex count)
+ */
+void reorderNodeGraph(NodeGraph* graph, NodeGraphOrder order, int* newIndex);
+
+#endif /* NODE_GRAPH_REORDER_H_ */
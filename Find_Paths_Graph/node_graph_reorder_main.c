@@ -0,0 +1,188 @@
+/*
+ * node_graph_reorder_main.c
+ *
+ * This file provides a benchmark that measures traversal time of a
+ * NodeGraph before and after its vertices are reordered for locality.
+ *
+ * Usage: node_graph_reorder [width [height [repeat]]]
+ */
+
+#define _POSIX_C_SOURCE 200112L	// clock_gettime()
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <time.h>
+#include "node_graph.h"
+#include "node_graph_reorder.h"
+
+/**
+ * Returns the current time in seconds.
+ *
+ * @return the current monotonic time in seconds
+ */
+static double getTimeSeconds(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Build a width x height grid graph with bidirectional edges between
+ * neighboring cells. Vertices are added in random order, so that the
+ * vertex order and storage is unrelated to the grid structure.
+ *
+ * @param width the width of the grid
+ * @param height the height of the grid
+ * @return the grid graph
+ */
+static NodeGraph* buildShuffledGridGraph(int width, int height) {
+	int n = width * height;
+	int* cellOrder = (int*)malloc(n * sizeof(int));
+	for (int i = 0; i < n; i++) {
+		cellOrder[i] = i;
+	}
+	srand(2017);
+	for (int i = n-1; i > 0; i--) {
+		int j = rand() % (i+1);
+		int tmp = cellOrder[i];
+		cellOrder[i] = cellOrder[j];
+		cellOrder[j] = tmp;
+	}
+
+	NodeGraph* graph = createNodeGraph();
+	GraphNodeVertex** cells = (GraphNodeVertex**)malloc(n * sizeof(GraphNodeVertex*));
+	for (int i = 0; i < n; i++) {
+		cells[cellOrder[i]] = addGraphNodeVertexForData(graph, (GraphVertexData){"cell"});
+	}
+	for (int i = 0; i < n; i++) {
+		int cell = cellOrder[i];
+		int x = cell % width;
+		int y = cell / width;
+		if (x+1 < width) {
+			addBidirectionalEdgeToGraphNodeVertex(cells[cell], cells[cell+1], (GraphEdgeData){});
+		}
+		if (y+1 < height) {
+			addBidirectionalEdgeToGraphNodeVertex(cells[cell], cells[cell+width], (GraphEdgeData){});
+		}
+	}
+	free(cells);
+	free(cellOrder);
+	return graph;
+}
+
+/**
+ * Traverse the graph breadth-first from every unvisited vertex.
+ *
+ * @param graph the graph
+ * @param visited visited flags by vertex index
+ * @param queue queue of vertex pointers (size == vertex count)
+ * @return the number of edges scanned
+ */
+static long traverseBFS(NodeGraph* graph, bool* visited, GraphNodeVertex** queue) {
+	long edges = 0;
+	for (int i = 0; i < graph->vertexCount; i++) {
+		visited[i] = false;
+	}
+	int tail = 0;
+	for (int start = 0; start < graph->vertexCount; start++) {
+		if (visited[start]) {
+			continue;
+		}
+		int head = tail;
+		visited[start] = true;
+		queue[tail++] = graph->vertices[start];
+		for ( ; head < tail; head++) {
+			GraphNodeVertex* vtx = queue[head];
+			for (int iv = 0; iv < vtx->edgeCount; iv++) {
+				GraphNodeVertex* to = vtx->edgeTo[iv].vertex;
+				edges++;
+				if (!visited[to->index]) {
+					visited[to->index] = true;
+					queue[tail++] = to;
+				}
+			}
+		}
+	}
+	return edges;
+}
+
+/**
+ * Sweep the vertices in order, reading the degree of each neighbor.
+ *
+ * @param graph the graph
+ * @param degreeSum incremented by the sum of neighbor degrees
+ * @return the number of edges scanned
+ */
+static long sweepNeighbors(NodeGraph* graph, long* degreeSum) {
+	long edges = 0;
+	for (int ig = 0; ig < graph->vertexCount; ig++) {
+		GraphNodeVertex* vtx = graph->vertices[ig];
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			*degreeSum += vtx->edgeTo[iv].vertex->edgeCount;
+		}
+		edges += vtx->edgeCount;
+	}
+	return edges;
+}
+
+/**
+ * Time the traversals of the graph and print the results.
+ *
+ * @param label the label for the vertex order
+ * @param graph the graph
+ * @param repeat the number of times to repeat each traversal
+ */
+static void benchmarkGraph(const char* label, NodeGraph* graph, int repeat) {
+	bool* visited = (bool*)malloc(graph->vertexCount * sizeof(bool));
+	GraphNodeVertex** queue =
+		(GraphNodeVertex**)malloc(graph->vertexCount * sizeof(GraphNodeVertex*));
+
+	long edges = 0;
+	double start = getTimeSeconds();
+	for (int r = 0; r < repeat; r++) {
+		edges += traverseBFS(graph, visited, queue);
+	}
+	double bfsTime = getTimeSeconds() - start;
+
+	long degreeSum = 0;
+	long sweepEdges = 0;
+	start = getTimeSeconds();
+	for (int r = 0; r < repeat; r++) {
+		sweepEdges += sweepNeighbors(graph, &degreeSum);
+	}
+	double sweepTime = getTimeSeconds() - start;
+
+	printf("%-10s  bfs %8.2f Medges/s  sweep %8.2f Medges/s  (checksum %ld)\n",
+		   label, edges / bfsTime * 1e-6, sweepEdges / sweepTime * 1e-6, degreeSum);
+	free(queue);
+	free(visited);
+}
+
+/**
+ * Main program to run the benchmark
+ *
+ * @return the exit status of the program
+ */
+int main(int argc, char* argv[]) {
+	int width = (argc > 1) ? atoi(argv[1]) : 1000;
+	int height = (argc > 2) ? atoi(argv[2]) : width;
+	int repeat = (argc > 3) ? atoi(argv[3]) : 5;
+
+	printf("grid %d x %d, %d vertices\n", width, height, width*height);
+
+	const char* labels[] = {"insertion", "bfs", "rcm", "degree"};
+	NodeGraphOrder orders[] = {NODEGRAPH_ORDER_BFS, NODEGRAPH_ORDER_RCM, NODEGRAPH_ORDER_DEGREE};
+	for (int i = 0; i < 4; i++) {
+		NodeGraph* graph = buildShuffledGridGraph(width, height);
+		if (i > 0) {
+			double start = getTimeSeconds();
+			reorderNodeGraph(graph, orders[i-1], (int*)NULL);
+			printf("%-10s  reorder %.3f s\n", labels[i], getTimeSeconds() - start);
+		}
+		benchmarkGraph(labels[i], graph, repeat);
+		freeNodeGraph(graph);
+	}
+
+	return EXIT_SUCCESS;
+}
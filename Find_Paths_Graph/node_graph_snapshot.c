@@ -0,0 +1,200 @@
+/*
+ * node_graph_snapshot.c
+ *
+ * This file provides the implementations of NodeGraphVersions, which
+ * publishes read-only snapshots of a NodeGraph that query threads can
+ * pin and traverse while a writer continues to change the graph.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include "node_graph_snapshot.h"
+#include "graph_arena.h"
+#include "graph_node_vertex_impl.h"
+
+/**
+ * Copies the graph into a new snapshot. Vertex structs are contiguous in
+ * the snapshot arena, followed by edge arrays in the same order, so that
+ * readers traverse the snapshot sequentially.
+ *
+ * Edges point directly to other vertices, so a changed vertex cannot be
+ * copied without also copying every vertex with an edge to it; each
+ * snapshot is instead a complete copy made once per published version.
+ *
+ * @param graph the graph
+ * @return the new snapshot
+ */
+static NodeGraphSnapshot* copyNodeGraphSnapshot(NodeGraph* graph) {
+	NodeGraphSnapshot* snapshot = (NodeGraphSnapshot*)malloc(sizeof(NodeGraphSnapshot));
+	assert(snapshot != (NodeGraphSnapshot*)NULL);
+	int n = graph->vertexCount;
+	size_t edgeTotal = 0;
+	for (int i = 0; i < n; i++) {
+		edgeTotal += graph->vertices[i]->edgeCount;
+	}
+
+	NodeGraph* copy = &snapshot->graph;
+	copy->vertexCount = n;
+	copy->vertexCapacity = (n > 0) ? n : 1;
+	copy->vertices = (GraphNodeVertex**)malloc(copy->vertexCapacity * sizeof(GraphNodeVertex*));
+	assert(copy->vertices != (GraphNodeVertex**)NULL);
+	copy->arena = createGraphArena(0);
+	copy->version = graph->version;
+
+	GraphNodeVertex* vertexBlock =
+		(GraphNodeVertex*)allocGraphArena(copy->arena, n * sizeof(GraphNodeVertex));
+	GraphNodeEdge* edgeBlock =
+		(GraphNodeEdge*)allocGraphArena(copy->arena, edgeTotal * sizeof(GraphNodeEdge));
+	for (int i = 0; i < n; i++) {
+		GraphNodeVertex* vertex = graph->vertices[i];
+		GraphNodeVertex* vertexCopy = &vertexBlock[i];
+		vertexCopy->data = vertex->data;
+		vertexCopy->edgeTo = edgeBlock;
+		vertexCopy->edgeCount = vertex->edgeCount;
+		vertexCopy->edgeCapacity = vertex->edgeCount;
+		vertexCopy->index = i;
+		vertexCopy->graph = copy;
+		for (int iv = 0; iv < vertex->edgeCount; iv++) {
+			edgeBlock[iv].data = vertex->edgeTo[iv].data;
+			edgeBlock[iv].vertex = &vertexBlock[vertex->edgeTo[iv].vertex->index];
+		}
+		edgeBlock += vertex->edgeCount;
+		rebuildGraphNodeEdgeIndex(vertexCopy);
+		copy->vertices[i] = vertexCopy;
+	}
+
+	snapshot->version = graph->version;
+	snapshot->pinCount = 0;
+	snapshot->retired = false;
+	return snapshot;
+}
+
+/**
+ * Frees a snapshot and its graph storage.
+ *
+ * @param snapshot the snapshot
+ */
+static void freeNodeGraphSnapshot(NodeGraphSnapshot* snapshot) {
+	freeGraphArena(snapshot->graph.arena);
+	free(snapshot->graph.vertices);
+	free(snapshot);
+}
+
+/**
+ * Create versions for the graph and publish a snapshot of its current
+ * contents.
+ *
+ * @param graph the graph
+ * @return a new NodeGraphVersions
+ */
+NodeGraphVersions* createNodeGraphVersions(NodeGraph* graph) {
+	NodeGraphVersions* versions = (NodeGraphVersions*)malloc(sizeof(NodeGraphVersions));
+	versions->graph = graph;
+	versions->current = copyNodeGraphSnapshot(graph);
+	pthread_mutex_init(&versions->lock, NULL);
+	return versions;
+}
+
+/**
+ * Frees the versions and the current snapshot. All pinned snapshots
+ * must be unpinned first. The graph itself is not freed.
+ *
+ * @param versions the NodeGraphVersions
+ */
+void freeNodeGraphVersions(NodeGraphVersions* versions) {
+	assert(versions->current->pinCount == 0);
+	freeNodeGraphSnapshot(versions->current);
+	pthread_mutex_destroy(&versions->lock);
+	free(versions);
+}
+
+/**
+ * Publishes a snapshot of the current contents of the graph. Readers
+ * that pin a snapshot after this call see the new version; readers that
+ * already hold the previous snapshot keep it until they unpin it. Only
+ * the writer thread may call this function, and no snapshot is copied if
+ * the graph has not changed since the last publication.
+ *
+ * @param versions the NodeGraphVersions
+ * @return the version of the published snapshot
+ */
+unsigned long publishNodeGraphSnapshot(NodeGraphVersions* versions) {
+	// only the writer replaces current, so it can be read without the lock
+	if (versions->current->version == versions->graph->version) {
+		return versions->current->version;
+	}
+
+	// copy outside the lock so readers are not blocked while copying
+	NodeGraphSnapshot* snapshot = copyNodeGraphSnapshot(versions->graph);
+
+	pthread_mutex_lock(&versions->lock);
+	NodeGraphSnapshot* previous = versions->current;
+	versions->current = snapshot;
+	previous->retired = true;
+	bool reclaim = (previous->pinCount == 0);
+	pthread_mutex_unlock(&versions->lock);
+
+	if (reclaim) {
+		freeNodeGraphSnapshot(previous);
+	}
+	return snapshot->version;
+}
+
+/**
+ * Pins the most recently published snapshot so that it remains valid
+ * until it is unpinned. Any thread may pin a snapshot.
+ *
+ * @param versions the NodeGraphVersions
+ * @return the pinned NodeGraphSnapshot
+ */
+NodeGraphSnapshot* pinNodeGraphSnapshot(NodeGraphVersions* versions) {
+	pthread_mutex_lock(&versions->lock);
+	NodeGraphSnapshot* snapshot = versions->current;
+	snapshot->pinCount++;
+	pthread_mutex_unlock(&versions->lock);
+	return snapshot;
+}
+
+/**
+ * Unpins a snapshot. A snapshot that has been replaced by a newer one
+ * is freed when its last reader unpins it.
+ *
+ * @param versions the NodeGraphVersions
+ * @param snapshot the pinned NodeGraphSnapshot
+ */
+void unpinNodeGraphSnapshot(NodeGraphVersions* versions, NodeGraphSnapshot* snapshot) {
+	pthread_mutex_lock(&versions->lock);
+	assert(snapshot->pinCount > 0);
+	snapshot->pinCount--;
+	bool reclaim = (snapshot->retired && snapshot->pinCount == 0);
+	pthread_mutex_unlock(&versions->lock);
+
+	if (reclaim) {
+		freeNodeGraphSnapshot(snapshot);
+	}
+}
+
+/**
+ * Get the graph of a pinned snapshot.
+ *
+ * @param snapshot the pinned NodeGraphSnapshot
+ * @return the read-only snapshot graph
+ */
+NodeGraph* getNodeGraphSnapshotGraph(NodeGraphSnapshot* snapshot) {
+	return &snapshot->graph;
+}
+
+/**
+ * Get the snapshot copy of a graph node vertex by its index in the
+ * graph at the time the snapshot was published.
+ *
+ * @param snapshot the pinned NodeGraphSnapshot
+ * @param index the vertex index
+ * @return the snapshot node vertex, or NULL if index is out of range
+ */
+GraphNodeVertex* getNodeGraphSnapshotVertex(NodeGraphSnapshot* snapshot, int index) {
+	if (index < 0 || index >= snapshot->graph.vertexCount) {
+		return (GraphNodeVertex*)NULL;
+	}
+	return snapshot->graph.vertices[index];
+}
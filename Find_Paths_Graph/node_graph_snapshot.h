@@ -0,0 +1,102 @@
+/*
+ * node_graph_snapshot.h
+ *
+ * This file provides the structures and function declarations of
+ * NodeGraphVersions, which publishes read-only snapshots of a NodeGraph
+ * that query threads can pin and traverse while a writer continues to
+ * change the graph.
+ */
+
+#ifndef NODE_GRAPH_SNAPSHOT_H_
+#define NODE_GRAPH_SNAPSHOT_H_
+
+#include <pthread.h>
+#include "node_graph.h"
+
+/**
+ * A read-only copy of a graph at one version. The snapshot graph can be
+ * passed to any function that reads a NodeGraph, such as the iterators
+ * and path search, but must not be changed.
+ */
+typedef struct {
+	NodeGraph graph;				// compact copy of the graph
+	unsigned long version;			// version of the graph that was copied
+	int pinCount;					// number of readers holding the snapshot
+	bool retired;					// true if a newer snapshot was published
+} NodeGraphSnapshot;
+
+/**
+ * The published versions of a graph
+ */
+typedef struct {
+	NodeGraph* graph;				// the graph changed by the writer
+	NodeGraphSnapshot* current;		// the most recently published snapshot
+	pthread_mutex_t lock;			// guards current and snapshot pin counts
+} NodeGraphVersions;
+
+/**
+ * Create versions for the graph and publish a snapshot of its current
+ * contents.
+ *
+ * @param graph the graph
+ * @return a new NodeGraphVersions
+ */
+NodeGraphVersions* createNodeGraphVersions(NodeGraph* graph);
+
+/**
+ * Frees the versions and the current snapshot. All pinned snapshots
+ * must be unpinned first. The graph itself is not freed.
+ *
+ * @param versions the NodeGraphVersions
+ */
+void freeNodeGraphVersions(NodeGraphVersions* versions);
+
+/**
+ * Publishes a snapshot of the current contents of the graph. Readers
+ * that pin a snapshot after this call see the new version; readers that
+ * already hold the previous snapshot keep it until they unpin it. Only
+ * the writer thread may call this function, and no snapshot is copied if
+ * the graph has not changed since the last publication.
+ *
+ * @param versions the NodeGraphVersions
+ * @return the version of the published snapshot
+ */
+unsigned long publishNodeGraphSnapshot(NodeGraphVersions* versions);
+
+/**
+ * Pins the most recently published snapshot so that it remains valid
+ * until it is unpinned. Any thread may pin a snapshot.
+ *
+ * @param versions the NodeGraphVersions
+ * @return the pinned NodeGraphSnapshot
+ */
+NodeGraphSnapshot* pinNodeGraphSnapshot(NodeGraphVersions* versions);
+
+/**
+ * Unpins a snapshot. A snapshot that has been replaced by a newer one
+ * is freed when its last reader unpins it.
+ *
+ * @param versions the NodeGraphVersions
+ * @param snapshot the pinned NodeGraphSnapshot
+ */
+void unpinNodeGraphSnapshot(NodeGraphVersions* versions, NodeGraphSnapshot* snapshot);
+
+/**
+ * Get the graph of a pinned snapshot.
+ *
+ * @param snapshot the pinned NodeGraphSnapshot
+ * @return the read-only snapshot graph
+ */
+NodeGraph* getNodeGraphSnapshotGraph(NodeGraphSnapshot* snapshot);
+
+/**
+ * Get the snapshot copy of a graph node vertex by its index in the
+ * graph at the time the snapshot was published.
+ *
+ * @param snapshot the pinned NodeGraphSnapshot
+ * @param index the vertex index
+ * @return the snapshot node vertex, or NULL if index is out of range
+ */
+GraphNodeVertex* getNodeGraphSnapshotVertex(NodeGraphSnapshot* snapshot, int index);
+
+#endif /* NODE_GRAPH_SNAPSHOT_H_ */
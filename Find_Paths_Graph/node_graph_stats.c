@@ -0,0 +1,89 @@
+/*
+ * node_graph_stats.c
+ *
+ * This file provides the implementations of NodeGraphStats, which
+ * records counters and phase timers for graph traversals and path
+ * searches.
+ */
+
+#define _POSIX_C_SOURCE 200112L	// clock_gettime()
+
+#include <string.h>
+#include <time.h>
+#include "node_graph_stats.h"
+
+/**
+ * Names of the phases for printing
+ */
+static const char* phaseNames[NODEGRAPH_PHASE_COUNT] = {
+	"setup", "search", "output", "cleanup"
+};
+
+/**
+ * Determines whether stats recording was compiled in.
+ *
+ * @return true if stats are recorded, false otherwise
+ */
+bool isNodeGraphStatsEnabled(void) {
+#ifdef NODEGRAPH_STATS
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * Clears the counters and timers of the stats.
+ *
+ * @param stats the NodeGraphStats
+ */
+void clearNodeGraphStats(NodeGraphStats* stats) {
+	memset(stats, 0, sizeof(NodeGraphStats));
+}
+
+/**
+ * Adds the counters and timers of one stats to another. High-water
+ * marks are combined by taking the maximum.
+ *
+ * @param total the NodeGraphStats to add to
+ * @param stats the NodeGraphStats to add
+ */
+void addNodeGraphStats(NodeGraphStats* total, const NodeGraphStats* stats) {
+	total->verticesExpanded += stats->verticesExpanded;
+	total->edgesScanned += stats->edgesScanned;
+	total->visitedProbes += stats->visitedProbes;
+	total->visitedHits += stats->visitedHits;
+	if (stats->queueHighWater > total->queueHighWater) {
+		total->queueHighWater = stats->queueHighWater;
+	}
+	for (int i = 0; i < NODEGRAPH_PHASE_COUNT; i++) {
+		total->phaseSeconds[i] += stats->phaseSeconds[i];
+	}
+}
+
+/**
+ * Prints the stats on one line.
+ *
+ * @param out the output stream
+ * @param stats the NodeGraphStats
+ */
+void printNodeGraphStats(FILE* out, const NodeGraphStats* stats) {
+	fprintf(out, "expanded %ld  scanned %ld  probes %ld  hits %ld  high-water %d",
+			stats->verticesExpanded, stats->edgesScanned,
+			stats->visitedProbes, stats->visitedHits, stats->queueHighWater);
+	for (int i = 0; i < NODEGRAPH_PHASE_COUNT; i++) {
+		fprintf(out, "  %s %.6f s", phaseNames[i], stats->phaseSeconds[i]);
+	}
+	fprintf(out, "\n");
+}
+
+/**
+ * Returns the current time for phase timers.
+ *
+ * @return the current monotonic time in seconds
+ */
+double getNodeGraphStatsTime(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,106 @@
+/*
+ * node_graph_stats.h
+ *
+ * This file provides the structures, macros, and function declarations
+ * of NodeGraphStats, which records counters and phase timers for graph
+ * traversals and path searches.
+ *
+ * Recording is enabled by compiling with -DNODEGRAPH_STATS. Otherwise
+ * the recording macros expand to nothing, the iterators hold no stats,
+ * and the stats returned by traversals and searches remain zero. All
+ * files must be compiled with the same setting.
+ */
+
+#ifndef NODE_GRAPH_STATS_H_
+#define NODE_GRAPH_STATS_H_
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/**
+ * Phases timed by NodeGraphStats
+ */
+typedef enum {
+	NODEGRAPH_PHASE_SETUP,			// allocating traversal state
+	NODEGRAPH_PHASE_SEARCH,			// expanding vertices and scanning edges
+	NODEGRAPH_PHASE_OUTPUT,			// materializing results
+	NODEGRAPH_PHASE_CLEANUP,		// freeing traversal state
+	NODEGRAPH_PHASE_COUNT
+} NodeGraphPhase;
+
+/**
+ * Counters and phase timers for a traversal or search
+ */
+typedef struct {
+	long verticesExpanded;			// vertices whose edges were scanned
+	long edgesScanned;				// edges examined
+	long visitedProbes;				// lookups in the visited set
+	long visitedHits;				// lookups that found a visited vertex
+	int queueHighWater;				// largest size of the queue or stack
+	double phaseSeconds[NODEGRAPH_PHASE_COUNT];  // elapsed time by phase
+} NodeGraphStats;
+
+#ifdef NODEGRAPH_STATS
+
+/** add n to a stats counter */
+#define NODEGRAPH_STATS_COUNT(stats, field, n) ((stats)->field += (n))
+
+/** raise a stats high-water mark to value */
+#define NODEGRAPH_STATS_HIGH_WATER(stats, field, value) \
+	do { if ((value) > (stats)->field) (stats)->field = (value); } while (0)
+
+/** start a phase timer */
+#define NODEGRAPH_STATS_TIMER_START(timer) double timer = getNodeGraphStatsTime()
+
+/** add the time since the timer started to a phase */
+#define NODEGRAPH_STATS_TIMER_STOP(stats, phase, timer) \
+	((stats)->phaseSeconds[phase] += getNodeGraphStatsTime() - (timer))
+
+#else
+
+#define NODEGRAPH_STATS_COUNT(stats, field, n) ((void)0)
+#define NODEGRAPH_STATS_HIGH_WATER(stats, field, value) ((void)0)
+#define NODEGRAPH_STATS_TIMER_START(timer) ((void)0)
+#define NODEGRAPH_STATS_TIMER_STOP(stats, phase, timer) ((void)0)
+
+#endif /* NODEGRAPH_STATS */
+
+/**
+ * Determines whether stats recording was compiled in.
+ *
+ * @return true if stats are recorded, false otherwise
+ */
+bool isNodeGraphStatsEnabled(void);
+
+/**
+ * Clears the counters and timers of the stats.
+ *
+ * @param stats the NodeGraphStats
+ */
+void clearNodeGraphStats(NodeGraphStats* stats);
+
+/**
+ * Adds the counters and timers of one stats to another. High-water
+ * marks are combined by taking the maximum.
+ *
+ * @param total the NodeGraphStats to add to
+ * @param stats the NodeGraphStats to add
+ */
+void addNodeGraphStats(NodeGraphStats* total, const NodeGraphStats* stats);
+
+/**
+ * Prints the stats on one line.
+ *
+ * @param out the output stream
+ * @param stats the NodeGraphStats
+ */
+void printNodeGraphStats(FILE* out, const NodeGraphStats* stats);
+
+/**
+ * Returns the current time for phase timers.
+ *
+ * @return the current monotonic time in seconds
+ */
+double getNodeGraphStatsTime(void);
+
+#endif /* NODE_GRAPH_STATS_H_ */
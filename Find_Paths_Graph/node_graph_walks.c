@@ -0,0 +1,403 @@
+/*
+ * node_graph_walks.c
+ *
+ * This file provides the implementations of a NodeGraphWalker, which
+ * generates batches of uniform, weighted, and node2vec random walks over
+ * a NodeGraph. Walks read flat arrays of neighbor indexes rather than
+ * following edgeTo pointers, and weighted steps use Walker alias tables.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "node_graph_walks.h"
+
+#ifndef WALK_CHUNK_SIZE
+#define WALK_CHUNK_SIZE 64
+#endif
+
+/**
+ * Default walk options: 80 vertices per walk, p = q = 1 for first order
+ * walks, one thread per processor, seed 2017.
+ */
+const NodeGraphWalkOptions NODEGRAPH_WALK_DEFAULTS = {80, 1.0, 1.0, 0, 2017};
+
+/**
+ * An edge of a vertex while the walker is built
+ */
+typedef struct {
+	int neighbor;					// the neighbor vertex index
+	double weight;					// the edge weight
+} NodeGraphWalkEdge;
+
+/**
+ * State shared by the walk threads
+ */
+typedef struct {
+	NodeGraphWalker* walker;
+	const NodeGraphWalkOptions* options;
+	const int* starts;				// starting vertex by walk
+	int walkCount;					// number of walks
+	int* walks;						// walk output
+	atomic_int nextChunk;			// first walk of the next unclaimed chunk
+	atomic_long steps;				// total steps taken
+} NodeGraphWalkState;
+
+/**
+ * Returns the next value of a splitmix64 random sequence.
+ *
+ * @param state the random state
+ * @return the next 64-bit random value
+ */
+static uint64_t nextWalkRandom(uint64_t* state) {
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/**
+ * Returns a random double in the range [0, 1).
+ *
+ * @param state the random state
+ * @return a random double
+ */
+static double nextWalkDouble(uint64_t* state) {
+	return (nextWalkRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * Compares two walk edges by neighbor index.
+ *
+ * @param e1 the first NodeGraphWalkEdge
+ * @param e2 the second NodeGraphWalkEdge
+ * @return <0 if e1<e2, =0 if e1=e2, >0 if e1>e2
+ */
+static int compareNodeGraphWalkEdge(const void* e1, const void* e2) {
+	return ((const NodeGraphWalkEdge*)e1)->neighbor - ((const NodeGraphWalkEdge*)e2)->neighbor;
+}
+
+/**
+ * Builds the alias table for the edges of one vertex with Vose's method.
+ * Each position keeps its own edge with its probability, and otherwise
+ * takes its alias, so every position holds an equal share.
+ *
+ * @param edges the edges of the vertex
+ * @param degree the number of edges
+ * @param probability the alias table probabilities of the edges
+ * @param alias the alias table positions of the edges
+ * @param small scratch array of positions (size >= degree)
+ * @param large scratch array of positions (size >= degree)
+ */
+static void buildWalkAliasTable(const NodeGraphWalkEdge* edges, int degree,
+		double* probability, int* alias, int* small, int* large) {
+	double total = 0;
+	for (int i = 0; i < degree; i++) {
+		total += edges[i].weight;
+	}
+	int smallCount = 0;
+	int largeCount = 0;
+	for (int i = 0; i < degree; i++) {
+		// edges without weight are equally likely
+		probability[i] = (total > 0) ? edges[i].weight * degree / total : 1.0;
+		alias[i] = i;
+		if (probability[i] < 1.0) {
+			small[smallCount++] = i;
+		} else {
+			large[largeCount++] = i;
+		}
+	}
+	while (smallCount > 0 && largeCount > 0) {
+		int s = small[--smallCount];
+		int l = large[largeCount-1];
+		alias[s] = l;
+		probability[l] -= 1.0 - probability[s];
+		if (probability[l] < 1.0) {
+			largeCount--;
+			small[smallCount++] = l;
+		}
+	}
+	// the remainder are full up to rounding
+	while (largeCount > 0) {
+		probability[large[--largeCount]] = 1.0;
+	}
+	while (smallCount > 0) {
+		probability[small[--smallCount]] = 1.0;
+	}
+}
+
+/**
+ * Create a walker for the graph. The walker is a copy, and does not
+ * change when the graph changes. Weighted walkers choose each edge in
+ * proportion to its GraphEdgeData weight; the edges of a vertex whose
+ * weights are all 0 are equally likely.
+ *
+ * @param graph the graph
+ * @param weighted true to choose edges by weight, false for uniform choice
+ * @return a new NodeGraphWalker
+ */
+NodeGraphWalker* createNodeGraphWalker(NodeGraph* graph, bool weighted) {
+	NodeGraphWalker* walker = (NodeGraphWalker*)malloc(sizeof(NodeGraphWalker));
+	int n = graph->vertexCount;
+	walker->vertexCount = n;
+	walker->edgeCount = 0;
+	int maxDegree = 0;
+	for (int ig = 0; ig < n; ig++) {
+		int degree = graph->vertices[ig]->edgeCount;
+		walker->edgeCount += degree;
+		if (degree > maxDegree) {
+			maxDegree = degree;
+		}
+	}
+	walker->offsets = (long*)malloc((n+1) * sizeof(long));
+	walker->neighbors = (int*)malloc((walker->edgeCount+1) * sizeof(int));
+	assert(walker->offsets != (long*)NULL && walker->neighbors != (int*)NULL);
+	walker->probability = (double*)NULL;
+	walker->alias = (int*)NULL;
+	if (weighted) {
+		walker->probability = (double*)malloc((walker->edgeCount+1) * sizeof(double));
+		walker->alias = (int*)malloc((walker->edgeCount+1) * sizeof(int));
+		assert(walker->probability != (double*)NULL && walker->alias != (int*)NULL);
+	}
+
+	// sorted neighbors allow node2vec to test for an edge by binary search
+	NodeGraphWalkEdge* edges =
+		(NodeGraphWalkEdge*)malloc((maxDegree+1) * sizeof(NodeGraphWalkEdge));
+	int* small = (int*)malloc((maxDegree+1) * sizeof(int));
+	int* large = (int*)malloc((maxDegree+1) * sizeof(int));
+	long edge = 0;
+	for (int ig = 0; ig < n; ig++) {
+		GraphNodeVertex* vtx = graph->vertices[ig];
+		walker->offsets[ig] = edge;
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			edges[iv].neighbor = vtx->edgeTo[iv].vertex->index;
+			edges[iv].weight = vtx->edgeTo[iv].data.weight;
+		}
+		qsort(edges, vtx->edgeCount, sizeof(NodeGraphWalkEdge), compareNodeGraphWalkEdge);
+		for (int iv = 0; iv < vtx->edgeCount; iv++) {
+			walker->neighbors[edge + iv] = edges[iv].neighbor;
+		}
+		if (weighted) {
+			buildWalkAliasTable(edges, vtx->edgeCount,
+				&walker->probability[edge], &walker->alias[edge], small, large);
+		}
+		edge += vtx->edgeCount;
+	}
+	walker->offsets[n] = edge;
+
+	free(large);
+	free(small);
+	free(edges);
+	return walker;
+}
+
+/**
+ * Frees a NodeGraphWalker.
+ *
+ * @param walker the NodeGraphWalker to free
+ */
+void freeNodeGraphWalker(NodeGraphWalker* walker) {
+	free(walker->alias);
+	free(walker->probability);
+	free(walker->neighbors);
+	free(walker->offsets);
+	walker->alias = (int*)NULL;
+	walker->probability = (double*)NULL;
+	walker->neighbors = (int*)NULL;
+	walker->offsets = (long*)NULL;
+	free(walker);
+}
+
+/**
+ * Chooses the next vertex of a first order walk.
+ *
+ * @param walker the NodeGraphWalker
+ * @param v the current vertex index, which must have edges
+ * @param random the random state
+ * @return the next vertex index
+ */
+static inline int nextWalkVertex(const NodeGraphWalker* walker, int v, uint64_t* random) {
+	long begin = walker->offsets[v];
+	uint64_t degree = (uint64_t)(walker->offsets[v+1] - begin);
+	// position from the high 32 bits, alias test from the low 32 bits
+	uint64_t r = nextWalkRandom(random);
+	long k = (long)(((r >> 32) * degree) >> 32);
+	if (walker->probability != (double*)NULL
+			&& (r & 0xFFFFFFFFULL) * (1.0 / 4294967296.0) >= walker->probability[begin + k]) {
+		k = walker->alias[begin + k];
+	}
+	return walker->neighbors[begin + k];
+}
+
+/**
+ * Determines whether vertex u has an edge to vertex v.
+ *
+ * @param walker the NodeGraphWalker
+ * @param u the from vertex index
+ * @param v the to vertex index
+ * @return true if there is an edge from u to v
+ */
+static bool hasWalkEdge(const NodeGraphWalker* walker, int u, int v) {
+	long low = walker->offsets[u];
+	long high = walker->offsets[u+1] - 1;
+	while (low <= high) {
+		long mid = (low + high) >> 1;
+		int neighbor = walker->neighbors[mid];
+		if (neighbor == v) {
+			return true;
+		} else if (neighbor < v) {
+			low = mid + 1;
+		} else {
+			high = mid - 1;
+		}
+	}
+	return false;
+}
+
+/**
+ * Generates one walk.
+ *
+ * @param walker the NodeGraphWalker
+ * @param options the walk options
+ * @param start the starting vertex index
+ * @param random the random state of the walk
+ * @param walk the walk output (size == walkLength)
+ * @return the number of steps taken
+ */
+static int generateNodeGraphWalk(const NodeGraphWalker* walker,
+		const NodeGraphWalkOptions* options, int start, uint64_t* random, int* walk) {
+	bool biased = (options->returnParam != 1.0 || options->inOutParam != 1.0);
+	double returnBias = 1.0 / options->returnParam;
+	double outBias = 1.0 / options->inOutParam;
+	double maxBias = 1.0;
+	if (returnBias > maxBias) {
+		maxBias = returnBias;
+	}
+	if (outBias > maxBias) {
+		maxBias = outBias;
+	}
+
+	int length = options->walkLength;
+	int previous = -1;
+	int current = start;
+	int step = 0;
+	walk[0] = start;
+	for (step = 1; step < length; step++) {
+		if (walker->offsets[current] == walker->offsets[current+1]) {
+			break;
+		}
+		int next = nextWalkVertex(walker, current, random);
+		if (biased && previous >= 0) {
+			// accept the first order choice in proportion to its bias
+			for (;;) {
+				double bias = (next == previous) ? returnBias
+							: hasWalkEdge(walker, previous, next) ? 1.0 : outBias;
+				if (nextWalkDouble(random) * maxBias < bias) {
+					break;
+				}
+				next = nextWalkVertex(walker, current, random);
+			}
+		}
+		walk[step] = next;
+		previous = current;
+		current = next;
+	}
+	for (int i = step; i < length; i++) {
+		walk[i] = -1;
+	}
+	return step - 1;
+}
+
+/**
+ * Generates chunks of walks until none remain.
+ *
+ * @param arg the NodeGraphWalkState
+ * @return NULL
+ */
+static void* runNodeGraphWalkThread(void* arg) {
+	NodeGraphWalkState* state = (NodeGraphWalkState*)arg;
+	int length = state->options->walkLength;
+	long steps = 0;
+	for (;;) {
+		int begin = atomic_fetch_add(&state->nextChunk, WALK_CHUNK_SIZE);
+		if (begin >= state->walkCount) {
+			break;
+		}
+		int end = (begin + WALK_CHUNK_SIZE < state->walkCount)
+				? begin + WALK_CHUNK_SIZE : state->walkCount;
+		for (int w = begin; w < end; w++) {
+			// independent sequence for each walk
+			uint64_t random = state->options->seed ^ ((uint64_t)w * 0xD1B54A32D192ED03ULL);
+			nextWalkRandom(&random);
+			steps += generateNodeGraphWalk(state->walker, state->options,
+				state->starts[w], &random, &state->walks[(long)w * length]);
+		}
+	}
+	atomic_fetch_add(&state->steps, steps);
+	return NULL;
+}
+
+/**
+ * Generates a random walk from each of the starting vertices. Walk i is
+ * written to walks[i*walkLength] to walks[(i+1)*walkLength-1], starting
+ * with starts[i]; positions after a vertex without edges are -1.
+ *
+ * If the node2vec parameters are not both 1, each step after the first
+ * is biased by the previous vertex: by 1/p to return to it, by 1 to go
+ * to a vertex it has an edge to, and by 1/q otherwise. Biased steps are
+ * made by rejection sampling from the first order choice.
+ *
+ * Each walk has its own random sequence derived from the seed and its
+ * position, so the walks do not depend on the number of threads.
+ *
+ * @param walker the NodeGraphWalker
+ * @param options the walk options, or NULL for the defaults
+ * @param starts array of starting vertex indexes (size == walkCount)
+ * @param walkCount the number of walks
+ * @param walks array of walk vertex indexes (size == walkCount * walkLength)
+ * @return the total number of steps taken, 0 if walkLength is not positive
+ */
+long getNodeGraphWalks(NodeGraphWalker* walker, const NodeGraphWalkOptions* options,
+		const int* starts, int walkCount, int* walks) {
+	if (options == (const NodeGraphWalkOptions*)NULL) {
+		options = &NODEGRAPH_WALK_DEFAULTS;
+	}
+	if (options->walkLength <= 0) {
+		return 0;  // walks has no room for even the start vertex
+	}
+	int threadCount = options->threadCount;
+	if (threadCount <= 0) {
+		threadCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	int chunks = (walkCount + WALK_CHUNK_SIZE-1) / WALK_CHUNK_SIZE;
+	if (threadCount > chunks) {
+		threadCount = chunks;
+	}
+	if (threadCount < 1) {
+		threadCount = 1;
+	}
+
+	NodeGraphWalkState state;
+	state.walker = walker;
+	state.options = options;
+	state.starts = starts;
+	state.walkCount = walkCount;
+	state.walks = walks;
+	atomic_init(&state.nextChunk, 0);
+	atomic_init(&state.steps, 0);
+
+	// the calling thread takes chunks too
+	pthread_t* threads = (pthread_t*)malloc(threadCount * sizeof(pthread_t));
+	for (int t = 1; t < threadCount; t++) {
+		pthread_create(&threads[t], NULL, runNodeGraphWalkThread, &state);
+	}
+	runNodeGraphWalkThread(&state);
+	for (int t = 1; t < threadCount; t++) {
+		pthread_join(threads[t], NULL);
+	}
+	free(threads);
+	return atomic_load(&state.steps);
+}
@@ -0,0 +1,89 @@
+/*
+ * node_graph_walks.h
+ *
+ * This file provides the structures and function declarations of a
+ * NodeGraphWalker, which generates batches of uniform, weighted, and
+ * node2vec random walks over a NodeGraph.
+ */
+
+#ifndef NODE_GRAPH_WALKS_H_
+#define NODE_GRAPH_WALKS_H_
+
+#include <stdbool.h>
+#include "node_graph.h"
+
+/**
+ * Options for random walks
+ */
+typedef struct {
+	int walkLength;					// number of vertices in a walk, including the start
+	double returnParam;				// node2vec p: higher values make returns less likely
+	double inOutParam;				// node2vec q: higher values keep walks near the previous vertex
+	int threadCount;				// number of threads, or 0 for one per processor
+	unsigned long seed;				// seed of the random walks
+} NodeGraphWalkOptions;
+
+/**
+ * Default walk options: 80 vertices per walk, p = q = 1 for first order
+ * walks, one thread per processor, seed 2017.
+ */
+extern const NodeGraphWalkOptions NODEGRAPH_WALK_DEFAULTS;
+
+/**
+ * A copy of the adjacency of a graph for random walks. The neighbors of
+ * vertex v are neighbors[offsets[v]] to neighbors[offsets[v+1]-1], in
+ * increasing order. For weighted walks, each edge position also has a
+ * Walker alias table entry, so that a weighted step takes constant time.
+ */
+typedef struct {
+	int vertexCount;				// number of vertices
+	long edgeCount;					// number of edges
+	long* offsets;					// start of neighbors by vertex (size vertexCount+1)
+	int* neighbors;					// neighbor vertex indexes (size edgeCount)
+	double* probability;			// alias table probability by edge, or NULL if unweighted
+	int* alias;						// alias table edge position relative to offsets[v], or NULL
+} NodeGraphWalker;
+
+/**
+ * Create a walker for the graph. The walker is a copy, and does not
+ * change when the graph changes. Weighted walkers choose each edge in
+ * proportion to its GraphEdgeData weight; the edges of a vertex whose
+ * weights are all 0 are equally likely.
+ *
+ * @param graph the graph
+ * @param weighted true to choose edges by weight, false for uniform choice
+ * @return a new NodeGraphWalker
+ */
+NodeGraphWalker* createNodeGraphWalker(NodeGraph* graph, bool weighted);
+
+/**
+ * Frees a NodeGraphWalker.
+ *
+ * @param walker the NodeGraphWalker to free
+ */
+void freeNodeGraphWalker(NodeGraphWalker* walker);
+
+/**
+ * Generates a random walk from each of the starting vertices. Walk i is
+ * written to walks[i*walkLength] to walks[(i+1)*walkLength-1], starting
+ * with starts[i]; positions after a vertex without edges are -1.
+ *
+ * If the node2vec parameters are not both 1, each step after the first
+ * is biased by the previous vertex: by 1/p to return to it, by 1 to go
+ * to a vertex it has an edge to, and by 1/q otherwise. Biased steps are
+ * made by rejection sampling from the first order choice.
+ *
+ * Each walk has its own random sequence derived from the seed and its
+ * position, so the walks do not depend on the number of threads.
+ *
+ * @param walker the NodeGraphWalker
+ * @param options the walk options, or NULL for the defaults
+ * @param starts array of starting vertex indexes (size == walkCount)
+ * @param walkCount the number of walks
+ * @param walks array of walk vertex indexes (size == walkCount * walkLength)
+ * @return the total number of steps taken, 0 if walkLength is not positive
+ */
+long getNodeGraphWalks(NodeGraphWalker* walker, const NodeGraphWalkOptions* options,
+		const int* starts, int walkCount, int* walks);
+
+#endif /* NODE_GRAPH_WALKS_H_ */
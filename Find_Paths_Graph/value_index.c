@@ -0,0 +1,282 @@
+/*
+ * value_index.c
+ *
+ * This file provides the implementations of a ValueIndex, a reverse
+ * index from the valuestr of map values to the keys mapped to them.
+ *
+ * Removal shifts the following entries of the probe sequence back, as
+ * in a HashSet, so no deleted markers are left to lengthen later probes.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "value_index.h"
+#include "hash_table_template.h"
+
+/**
+ * Default capacity of a ValueIndex (power of 2)
+ */
+#define DEFAULT_VALUE_INDEX_CAPACITY 16
+
+/**
+ * Allocates empty slots.
+ *
+ * @param index the ValueIndex
+ * @param capacity the number of slots (power of 2)
+ */
+static void allocValueIndexEntries(ValueIndex* index, int capacity) {
+	index->entries = (ValueIndexEntry*)calloc(capacity, sizeof(ValueIndexEntry));
+	assert(index->entries != (ValueIndexEntry*)NULL);
+	index->capacity = capacity;
+}
+
+/**
+ * Create new empty ValueIndex.
+ *
+ * @return a new ValueIndex
+ */
+ValueIndex* createValueIndex(void) {
+	ValueIndex* index = (ValueIndex*)malloc(sizeof(ValueIndex));
+	index->size = 0;
+	allocValueIndexEntries(index, DEFAULT_VALUE_INDEX_CAPACITY);
+	return index;
+}
+
+/**
+ * Frees the string and key set of a slot.
+ *
+ * @param entry the ValueIndexEntry
+ */
+static void freeValueIndexEntry(ValueIndexEntry* entry) {
+	free(entry->valuestr);
+	if (entry->keys != (HashSet*)NULL) {
+		freeHashSet(entry->keys);
+	}
+	memset(entry, 0, sizeof(ValueIndexEntry));
+}
+
+/**
+ * Frees a ValueIndex.
+ *
+ * @param index the ValueIndex to free
+ */
+void freeValueIndex(ValueIndex* index) {
+	clearValueIndex(index);
+	free(index->entries);
+	index->entries = (ValueIndexEntry*)NULL;
+	free(index);
+}
+
+/**
+ * Removes all values from the index.
+ *
+ * @param index the ValueIndex
+ */
+void clearValueIndex(ValueIndex* index) {
+	for (int i = 0; i < index->capacity; i++) {
+		if (index->entries[i].valuestr != (char*)NULL) {
+			freeValueIndexEntry(&index->entries[i]);
+		}
+	}
+	index->size = 0;
+	if (index->capacity > DEFAULT_VALUE_INDEX_CAPACITY) {
+		free(index->entries);
+		allocValueIndexEntries(index, DEFAULT_VALUE_INDEX_CAPACITY);
+	}
+}
+
+/**
+ * Returns the hash code of a value string.
+ *
+ * @param valuestr the value string
+ * @return the hash code
+ */
+static inline uint64_t getValueIndexHashCode(const char* valuestr) {
+	return mixHashTemplateCode(hashTemplateString(valuestr));
+}
+
+/**
+ * Returns the slot of a value string, or the empty slot where it belongs.
+ *
+ * @param index the ValueIndex
+ * @param valuestr the value string
+ * @param hashCode the hash code of the value string
+ * @return the slot
+ */
+static ValueIndexEntry* findValueIndexEntry(ValueIndex* index, const char* valuestr,
+		uint64_t hashCode) {
+	int mask = index->capacity - 1;
+	for (int i = (int)(hashCode & (uint64_t)mask); ; i = (i+1) & mask) {
+		ValueIndexEntry* entry = &index->entries[i];
+		if (entry->valuestr == (char*)NULL
+			|| (entry->hashCode == hashCode && strcmp(entry->valuestr, valuestr) == 0)) {
+			return entry;
+		}
+	}
+}
+
+/**
+ * Doubles the number of slots, moving the entries to their new slots.
+ *
+ * @param index the ValueIndex
+ */
+static void growValueIndex(ValueIndex* index) {
+	ValueIndexEntry* oldEntries = index->entries;
+	int oldCapacity = index->capacity;
+	allocValueIndexEntries(index, 2 * oldCapacity);
+	for (int i = 0; i < oldCapacity; i++) {
+		if (oldEntries[i].valuestr != (char*)NULL) {
+			*findValueIndexEntry(index, oldEntries[i].valuestr, oldEntries[i].hashCode) =
+				oldEntries[i];
+		}
+	}
+	free(oldEntries);
+}
+
+/**
+ * Adds a key mapped to a value. A NULL value or valuestr is not indexed.
+ *
+ * @param index the ValueIndex
+ * @param value the value
+ * @param key the key mapped to the value
+ */
+void addValueIndexKey(ValueIndex* index, MapValue* value, MapKey key) {
+	if (value == (MapValue*)NULL || value->valuestr == (char*)NULL) {
+		return;
+	}
+	// grow first, so the table always has an empty slot
+	if ((index->size+1) * 4 > index->capacity * 3) {
+		growValueIndex(index);
+	}
+	uint64_t hashCode = getValueIndexHashCode(value->valuestr);
+	ValueIndexEntry* entry = findValueIndexEntry(index, value->valuestr, hashCode);
+	if (entry->valuestr == (char*)NULL) {
+		size_t length = strlen(value->valuestr) + 1;
+		entry->valuestr = (char*)malloc(length);
+		assert(entry->valuestr != (char*)NULL);
+		memcpy(entry->valuestr, value->valuestr, length);
+		entry->hashCode = hashCode;
+		entry->count = 1;
+		entry->key = key;
+		index->size++;
+		return;
+	}
+	if (entry->keys == (HashSet*)NULL) {
+		if (entry->key == key) {
+			return;
+		}
+		entry->keys = createHashSet();
+		addHashSetKey(entry->keys, entry->key);
+		entry->key = (MapKey)NULL;
+	}
+	addHashSetKey(entry->keys, key);
+	entry->count = getHashSetSize(entry->keys);
+}
+
+/**
+ * Empties a slot and shifts back the following entries of its probe
+ * sequence that may take it.
+ *
+ * @param index the ValueIndex
+ * @param entry the slot to empty
+ */
+static void removeValueIndexEntry(ValueIndex* index, ValueIndexEntry* entry) {
+	freeValueIndexEntry(entry);
+	index->size--;
+	int mask = index->capacity - 1;
+	int hole = (int)(entry - index->entries);
+	for (int i = (hole+1) & mask; index->entries[i].valuestr != (char*)NULL; i = (i+1) & mask) {
+		int home = (int)(index->entries[i].hashCode & (uint64_t)mask);
+		// move the entry if the hole is between its home slot and it
+		if (((i - home) & mask) >= ((i - hole) & mask)) {
+			index->entries[hole] = index->entries[i];
+			memset(&index->entries[i], 0, sizeof(ValueIndexEntry));
+			hole = i;
+		}
+	}
+}
+
+/**
+ * Removes a key that was mapped to a value.
+ *
+ * @param index the ValueIndex
+ * @param value the value
+ * @param key the key that was mapped to the value
+ */
+void removeValueIndexKey(ValueIndex* index, MapValue* value, MapKey key) {
+	if (value == (MapValue*)NULL || value->valuestr == (char*)NULL) {
+		return;
+	}
+	ValueIndexEntry* entry =
+		findValueIndexEntry(index, value->valuestr, getValueIndexHashCode(value->valuestr));
+	if (entry->valuestr == (char*)NULL) {
+		return;
+	}
+	if (entry->keys != (HashSet*)NULL) {
+		removeHashSetKey(entry->keys, key);
+		entry->count = getHashSetSize(entry->keys);
+	} else if (entry->key == key) {
+		entry->count = 0;
+	}
+	if (entry->count == 0) {
+		removeValueIndexEntry(index, entry);
+	}
+}
+
+/**
+ * Returns the number of keys mapped to a value.
+ *
+ * @param index the ValueIndex
+ * @param value the value
+ * @return the number of keys mapped to a value equal to value
+ */
+int getValueIndexKeyCount(ValueIndex* index, MapValue* value) {
+	if (value == (MapValue*)NULL || value->valuestr == (char*)NULL) {
+		return 0;
+	}
+	ValueIndexEntry* entry =
+		findValueIndexEntry(index, value->valuestr, getValueIndexHashCode(value->valuestr));
+	return entry->count;
+}
+
+/**
+ * Adds the keys mapped to a value to a set.
+ *
+ * @param index the ValueIndex
+ * @param value the value
+ * @param set the HashSet to add the keys to
+ */
+void addValueIndexKeysToSet(ValueIndex* index, MapValue* value, HashSet* set) {
+	if (value == (MapValue*)NULL || value->valuestr == (char*)NULL) {
+		return;
+	}
+	ValueIndexEntry* entry =
+		findValueIndexEntry(index, value->valuestr, getValueIndexHashCode(value->valuestr));
+	if (entry->keys != (HashSet*)NULL) {
+		addAllHashSetKeys(set, entry->keys);
+	} else if (entry->count > 0) {
+		addHashSetKey(set, entry->key);
+	}
+}
+
+/**
+ * Returns the memory used by the index, including the value strings
+ * and the key sets.
+ *
+ * @param index the ValueIndex
+ * @return the number of bytes
+ */
+size_t getValueIndexBytes(ValueIndex* index) {
+	size_t bytes = sizeof(ValueIndex) + index->capacity * sizeof(ValueIndexEntry);
+	for (int i = 0; i < index->capacity; i++) {
+		ValueIndexEntry* entry = &index->entries[i];
+		if (entry->valuestr != (char*)NULL) {
+			bytes += strlen(entry->valuestr) + 1;
+		}
+		if (entry->keys != (HashSet*)NULL) {
+			bytes += sizeof(HashSet) + entry->keys->capacity * (sizeof(MapKey) + sizeof(uint8_t));
+		}
+	}
+	return bytes;
+}
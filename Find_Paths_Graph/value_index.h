@@ -0,0 +1,110 @@
+/*
+ * value_index.h
+ *
+ * This file provides the structures and function declarations of a
+ * ValueIndex, a reverse index from the valuestr of map values to the
+ * keys mapped to them, which a HashMap can keep so that value lookups
+ * do not scan its entries.
+ *
+ * Values are indexed by the contents of their valuestr, as
+ * compareMapValue() compares them, and the index keeps its own copy of
+ * each distinct string. A value with one key holds it in place; a value
+ * with more keys holds them in a HashSet.
+ */
+
+#ifndef VALUE_INDEX_H_
+#define VALUE_INDEX_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "map_entry.h"
+#include "hash_set.h"
+
+/**
+ * A slot of a ValueIndex, with the keys mapped to one value
+ */
+typedef struct {
+	char* valuestr;					// copy of the value string, or NULL if empty
+	uint64_t hashCode;				// hash code of the value string
+	int count;						// number of keys mapped to the value
+	MapKey key;						// the key, if keys is NULL
+	HashSet* keys;					// the keys, once more than one was added
+} ValueIndexEntry;
+
+/**
+ * An open-addressed table of value strings with linear probing.
+ */
+typedef struct {
+	ValueIndexEntry* entries;		// the slots
+	int capacity;					// number of slots (power of 2)
+	int size;						// number of distinct values
+} ValueIndex;
+
+/**
+ * Create new empty ValueIndex.
+ *
+ * @return a new ValueIndex
+ */
+ValueIndex* createValueIndex(void);
+
+/**
+ * Frees a ValueIndex.
+ *
+ * @param index the ValueIndex to free
+ */
+void freeValueIndex(ValueIndex* index);
+
+/**
+ * Removes all values from the index.
+ *
+ * @param index the ValueIndex
+ */
+void clearValueIndex(ValueIndex* index);
+
+/**
+ * Adds a key mapped to a value. A NULL value or valuestr is not indexed.
+ *
+ * @param index the ValueIndex
+ * @param value the value
+ * @param key the key mapped to the value
+ */
+void addValueIndexKey(ValueIndex* index, MapValue* value, MapKey key);
+
+/**
+ * Removes a key that was mapped to a value.
+ *
+ * @param index the ValueIndex
+ * @param value the value
+ * @param key the key that was mapped to the value
+ */
+void removeValueIndexKey(ValueIndex* index, MapValue* value, MapKey key);
+
+/**
+ * Returns the number of keys mapped to a value.
+ *
+ * @param index the ValueIndex
+ * @param value the value
+ * @return the number of keys mapped to a value equal to value
+ */
+int getValueIndexKeyCount(ValueIndex* index, MapValue* value);
+
+/**
+ * Adds the keys mapped to a value to a set.
+ *
+ * @param index the ValueIndex
+ * @param value the value
+ * @param set the HashSet to add the keys to
+ */
+void addValueIndexKeysToSet(ValueIndex* index, MapValue* value, HashSet* set);
+
+/**
+ * Returns the memory used by the index, including the value strings
+ * and the key sets.
+ *
+ * @param index the ValueIndex
+ * @return the number of bytes
+ */
+size_t getValueIndexBytes(ValueIndex* index);
+
+#endif /* VALUE_INDEX_H_ */